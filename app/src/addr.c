@@ -17,9 +17,12 @@
 #include "app_mode.h"
 #include "coin.h"
 #include "crypto.h"
+#include "format_scratch.h"
 #include "zxformat.h"
 #include "zxmacros.h"
 
+#define PATH_TEXT_LEN 300
+
 zxerr_t addr_getNumItems(uint8_t *num_items) {
     if (*num_items == 0) {
         return zxerr_no_data;
@@ -51,10 +54,14 @@ zxerr_t addr_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *
                 return zxerr_no_data;
             }
 
+            char *buffer = format_scratch_borrow(PATH_TEXT_LEN);
+            if (buffer == NULL) {
+                return zxerr_unknown;
+            }
             snprintf(outKey, outKeyLen, "Your Path");
-            char buffer[300];
-            bip32_to_str(buffer, sizeof(buffer), hdPath, HDPATH_LEN_DEFAULT);
+            bip32_to_str(buffer, PATH_TEXT_LEN, hdPath, HDPATH_LEN_DEFAULT);
             pageString(outVal, outValLen, buffer, pageIdx, pageCount);
+            format_scratch_return();
             return zxerr_ok;
         }
         default:
@@ -28,6 +28,14 @@
 #include "coin_evm.h"
 #include "crypto.h"
 #include "crypto_helper.h"
+#include "evm_batch.h"
+#include "evm_eip191.h"
+#include "evm_eip191_batch.h"
+#include "evm_multipath.h"
+#include "evm_policy.h"
+#include "evm_profile.h"
+#include "evm_pubkey_cache.h"
+#include "evm_sig_cache.h"
 #include "tx.h"
 #include "view.h"
 #include "view_internal.h"
@@ -62,6 +70,228 @@ __Z_INLINE void handle_getversion(__Z_UNUSED volatile uint32_t *flags, volatile
     THROW(APDU_CODE_OK);
 }
 
+// [version (1)] [RAM buffer (4)] [flash buffer (4)] [max chunk (1)] [features (4)]
+// [EVM batch txs (1)] [EVM addresses (1)] [SS58 addresses (1)] [EIP-191 display bytes (2)], big-endian
+__Z_INLINE void handle_getcapabilities(volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_P1] != 0 || G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx != OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    uint32_t features = CAP_EVM_TX_STREAMING | CAP_EVM_BATCH_SIGN | CAP_EVM_ADDR_BATCH | CAP_EVM_PUBKEY_CACHE |
+                        CAP_EVM_EIP712 | CAP_EIP191_STREAMING | CAP_SUBSTRATE_SIGN_PREHASH | CAP_SS58_ADDR_RANGE |
+                        CAP_EIP191_BATCH_SIGN | CAP_EVM_SIGN_RETRY | CAP_EVM_UPLOAD_RESUME |
+                        CAP_SUBSTRATE_METADATA_HASH | CAP_EVM_SIGN_POLICY |
+                        CAP_EVM_MULTI_PATH | CAP_EVM_EIP7702;
+#if defined(APP_TESTING)
+    features |= CAP_PROFILING;
+#endif
+    const uint32_t ramCapacity = tx_get_ram_capacity();
+    const uint32_t flashCapacity = tx_get_flash_capacity();
+
+    uint8_t *out = G_io_apdu_buffer;
+    MEMZERO(out, IO_APDU_BUFFER_SIZE);
+    out[0] = CAPABILITIES_VERSION;
+    for (uint8_t i = 0; i < 4; i++) {
+        out[1 + i] = (uint8_t)(ramCapacity >> (24 - 8 * i));
+        out[5 + i] = (uint8_t)(flashCapacity >> (24 - 8 * i));
+        out[10 + i] = (uint8_t)(features >> (24 - 8 * i));
+    }
+    out[9] = (uint8_t)MIN(IO_APDU_BUFFER_SIZE - OFFSET_DATA, 0xFF);
+    out[14] = ETH_BATCH_MAX_TXS;
+    out[15] = ETH_ADDR_BATCH_MAX;
+    out[16] = SS58_ADDR_BATCH_MAX;
+    out[17] = (uint8_t)(EIP191_DISPLAY_MAX_LEN >> 8);
+    out[18] = (uint8_t)EIP191_DISPLAY_MAX_LEN;
+    out[19] = (uint8_t)(ETH_BATCH_MAX_BYTES >> 8);
+    out[20] = (uint8_t)ETH_BATCH_MAX_BYTES;
+
+    *tx += 21;
+    THROW(APDU_CODE_OK);
+}
+
+__Z_INLINE void extractHDPath(uint32_t rx, uint32_t offset) {
+    if (rx < offset + sizeof(uint32_t) * HDPATH_LEN_DEFAULT) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    MEMCPY(hdPath, G_io_apdu_buffer + offset, sizeof(uint32_t) * HDPATH_LEN_DEFAULT);
+    hdPath_len = HDPATH_LEN_DEFAULT;
+
+    const bool mainnet = hdPath[0] == HDPATH_0_DEFAULT && hdPath[1] == HDPATH_1_DEFAULT;
+    if (!mainnet) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+}
+
+__Z_INLINE bool process_chunk(uint32_t rx) {
+    const uint8_t payloadType = G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE];
+
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    if (rx < OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    const uint32_t len = rx - OFFSET_DATA;
+    switch (payloadType) {
+        case P1_SUBSTRATE_INIT:
+            tx_initialize();
+            tx_reset();
+            extractHDPath(rx, OFFSET_DATA);
+            if (tx_prehash_start() != zxerr_ok) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
+            }
+            return false;
+        case P1_SUBSTRATE_PROOF:
+            if (tx_prehash_evicted()) {
+                THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+            }
+            // the proof is not part of what is signed, so it is not hashed
+            if (tx_get_buffer_length() != tx_get_proof_length()) {
+                THROW(APDU_CODE_DATA_INVALID);
+            }
+            if (tx_append_proof(&(G_io_apdu_buffer[OFFSET_DATA]), len) != len) {
+                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            }
+            return false;
+        case P1_SUBSTRATE_ADD:
+        case P1_SUBSTRATE_LAST:
+            if (tx_prehash_evicted()) {
+                THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+            }
+            if (tx_append(&(G_io_apdu_buffer[OFFSET_DATA]), len) != len) {
+                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            }
+            // hashed while the chunk is still in the APDU buffer; only used when the payload ends up long
+            if (tx_prehash_absorb(&(G_io_apdu_buffer[OFFSET_DATA]), len) != zxerr_ok) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
+            }
+            if (payloadType == P1_SUBSTRATE_ADD) {
+                return false;
+            }
+            if (!tx_flush() || tx_prehash_finish() != zxerr_ok) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
+            }
+            return true;
+        default:
+            break;
+    }
+
+    THROW(APDU_CODE_INVALIDP1P2);
+}
+
+__Z_INLINE void handleGetAddr(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log("handleGetAddr\n");
+    const uint8_t mode = G_io_apdu_buffer[OFFSET_P1];
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    extractHDPath(rx, OFFSET_DATA);
+
+    if (mode == P1_SUBSTRATE_ADDR_RANGE) {
+        // [path] [count (1)]; indexes run from the last path element, which keeps its hardening
+        const uint32_t count_offset = OFFSET_DATA + sizeof(uint32_t) * HDPATH_LEN_DEFAULT;
+        if (rx < count_offset + 1) {
+            THROW(APDU_CODE_WRONG_LENGTH);
+        }
+        const uint8_t count = MIN(G_io_apdu_buffer[count_offset], SS58_ADDR_BATCH_MAX);
+        const uint32_t start = hdPath[HDPATH_LEN_DEFAULT - 1];
+        if (count == 0 || ((start ^ (start + count - 1)) & 0x80000000u) != 0) {
+            THROW(APDU_CODE_DATA_INVALID);
+        }
+
+        uint16_t replyLen = 0;
+        if (crypto_fillAddressRange(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, count, &replyLen) != zxerr_ok) {
+            *tx = 0;
+            THROW(APDU_CODE_EXECUTION_ERROR);
+        }
+        *tx = replyLen;
+        THROW(APDU_CODE_OK);
+    }
+
+    if (mode != P1_SUBSTRATE_ADDR_SILENT && mode != P1_SUBSTRATE_ADDR_SHOW) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    if (app_fill_address() != zxerr_ok) {
+        *tx = 0;
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    if (mode == P1_SUBSTRATE_ADDR_SHOW) {
+        view_review_init(addr_getItem, addr_getNumItems, app_reply_address);
+        set_review_pending(true);
+        view_review_show(REVIEW_ADDRESS);
+        *flags |= IO_ASYNCH_REPLY;
+        return;
+    }
+    *tx = action_addrResponseLen;
+    THROW(APDU_CODE_OK);
+}
+
+__Z_INLINE void handleSign(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleSign");
+    if (!process_chunk(rx)) {
+        THROW(APDU_CODE_OK);
+    }
+
+    CHECK_APP_CANARY()
+    const char *error_msg = tx_parse();
+    CHECK_APP_CANARY()
+
+    if (error_msg != NULL) {
+        const int error_msg_length = strnlen(error_msg, sizeof(G_io_apdu_buffer));
+        MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+        *tx += (error_msg_length);
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    view_review_init(tx_getItem, tx_getNumItems, app_sign);
+    set_review_pending(true);
+    view_review_show(REVIEW_TXN);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+// Substrate instructions reuse codes of the EVM ones, so they are dispatched on their own CLA
+__Z_INLINE void handleApduSubstrate(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx, uint8_t instruction) {
+    switch (instruction) {
+        case INS_GET_ADDR_SUBSTRATE:
+            CHECK_PIN_VALIDATED()
+            handleGetAddr(flags, tx, rx);
+            break;
+        case INS_SIGN_SUBSTRATE:
+            CHECK_PIN_VALIDATED()
+            handleSign(flags, tx, rx);
+            break;
+        default:
+            THROW(APDU_CODE_INS_NOT_SUPPORTED);
+    }
+}
+
+#if defined(APP_TESTING)
+// Stack use is attributed to the handler that started the flow; any other instruction closes the probe
+__Z_INLINE void profile_stack_probe(uint8_t instruction) {
+    switch (instruction) {
+        case INS_SIGN_ETH:
+            PROFILE_STACK_BEGIN(stack_probe_sign_eth);
+            break;
+        case INS_SIGN_PERSONAL_MESSAGE:
+            PROFILE_STACK_BEGIN(stack_probe_sign_eip191);
+            break;
+        case INS_GET_ADDR_ETH:
+            PROFILE_STACK_BEGIN(stack_probe_get_addr_eth);
+            break;
+        default:
+            PROFILE_STACK_END();
+            break;
+    }
+}
+#endif
+
 void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     volatile uint16_t sw = 0;
 
@@ -81,39 +311,147 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                 THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
             }
 
+            // cached public keys, signatures and the signing policy must not outlive a PIN lock
+            if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+                pubkey_cache_flush();
+                sig_cache_flush();
+                eth_policy_clear();
+            }
+
             const uint8_t instruction = G_io_apdu_buffer[OFFSET_INS];
-            switch (instruction) {
-                case INS_GET_VERSION: {
-                    handle_getversion(flags, tx);
-                    break;
-                }
-                case INS_GET_ADDR_ETH:
-                    CHECK_PIN_VALIDATED()
-                    if (cla != CLA_ETH) {
-                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+            // SIGN_ETH retry and resume windows are counted in other commands
+            if (cla != CLA_ETH || instruction != INS_SIGN_ETH) {
+                sig_cache_tick();
+                evm_upload_tick();
+            }
+            // signatures of an approved batch are served until another command comes in
+            if (instruction != INS_SIGN_BATCH_ETH) {
+                tx_set_batch_approved_eth(false);
+            }
+            if (instruction != INS_SIGN_BATCH_PERSONAL_MESSAGE) {
+                eip191_batch_set_approved(false);
+            }
+            if (instruction != INS_SIGN_ETH && instruction != INS_SIGN_PERSONAL_MESSAGE) {
+                eth_multipath_revoke();
+            }
+            if (instruction != INS_SIGN_EIP712_ETH) {
+                reset_eip712_session();
+            }
+#if defined(APP_TESTING)
+            profile_stack_probe(cla == CLA_ETH ? instruction : INS_GET_VERSION);
+#endif
+
+            if (cla == CLA && instruction != INS_GET_VERSION && instruction != INS_GET_CAPABILITIES) {
+                handleApduSubstrate(flags, tx, rx, instruction);
+            } else {
+                switch (instruction) {
+                    case INS_GET_VERSION: {
+                        handle_getversion(flags, tx);
+                        break;
                     }
-                    handleGetAddrEth(flags, tx, rx);
-                    break;
+                    case INS_GET_CAPABILITIES: {
+                        handle_getcapabilities(tx, rx);
+                        break;
+                    }
+                    case INS_GET_ADDR_ETH:
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleGetAddrEth(flags, tx, rx);
+                        break;
 
-                case INS_SIGN_ETH: {
-                    CHECK_PIN_VALIDATED()
-                    if (cla != CLA_ETH) {
-                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    case INS_GET_XPUB_ETH:
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleGetXpubEth(flags, tx, rx);
+                        break;
+
+                    case INS_GET_ADDR_BATCH_ETH:
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleGetAddrBatchEth(flags, tx, rx);
+                        break;
+
+                    case INS_SIGN_ETH: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSignEth(flags, tx, rx);
+                        break;
                     }
-                    handleSignEth(flags, tx, rx);
-                    break;
-                }
 
-                case INS_SIGN_PERSONAL_MESSAGE: {
-                    CHECK_PIN_VALIDATED()
-                    if (cla != CLA_ETH) {
-                        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                    case INS_SIGN_BATCH_ETH: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSignBatchEth(flags, tx, rx);
+                        break;
                     }
-                    handleSignEip191(flags, tx, rx);
-                    break;
+
+                    case INS_SIGN_PERSONAL_MESSAGE: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSignEip191(flags, tx, rx);
+                        break;
+                    }
+
+                    case INS_SIGN_BATCH_PERSONAL_MESSAGE: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSignBatchEip191(flags, tx, rx);
+                        break;
+                    }
+
+                    case INS_PROVIDE_ERC20_INFO: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleProvideErc20Info(flags, tx, rx);
+                        break;
+                    }
+
+                    case INS_SET_POLICY_ETH: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSetPolicyEth(flags, tx, rx);
+                        break;
+                    }
+
+                    case INS_SIGN_EIP712_ETH: {
+                        CHECK_PIN_VALIDATED()
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleSignEip712Eth(flags, tx, rx);
+                        break;
+                    }
+
+#if defined(APP_TESTING)
+                    case INS_GET_PROFILE_ETH: {
+                        if (cla != CLA_ETH) {
+                            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+                        }
+                        handleGetProfileEth(flags, tx, rx);
+                        break;
+                    }
+#endif
+                    default:
+                        THROW(APDU_CODE_INS_NOT_SUPPORTED);
                 }
-                default:
-                    THROW(APDU_CODE_INS_NOT_SUPPORTED);
             }
         }
         CATCH(EXCEPTION_IO_RESET) {
@@ -128,7 +466,7 @@ void handleApdu(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
                     sw = e;
                     break;
                 case 0x6000:
-                    reset_evm_chunk_state();
+                    evm_upload_error(rx, e);
                     sw = e;
                     break;
                 default:
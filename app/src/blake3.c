@@ -0,0 +1,186 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include "blake3.h"
+
+#include <string.h>
+
+#define FLAG_CHUNK_START (1u << 0)
+#define FLAG_CHUNK_END   (1u << 1)
+#define FLAG_PARENT      (1u << 2)
+#define FLAG_ROOT        (1u << 3)
+
+static const uint32_t IV[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                               0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+static const uint8_t MSG_PERMUTATION[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+
+static uint32_t rotr(uint32_t w, uint8_t c) {
+    return (w >> c) | (w << (32 - c));
+}
+
+static void g(uint32_t *state, uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint32_t mx, uint32_t my) {
+    state[a] = state[a] + state[b] + mx;
+    state[d] = rotr(state[d] ^ state[a], 16);
+    state[c] = state[c] + state[d];
+    state[b] = rotr(state[b] ^ state[c], 12);
+    state[a] = state[a] + state[b] + my;
+    state[d] = rotr(state[d] ^ state[a], 8);
+    state[c] = state[c] + state[d];
+    state[b] = rotr(state[b] ^ state[c], 7);
+}
+
+static void loadWords(const uint8_t *bytes, uint32_t *words, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *p = bytes + 4 * i;
+        words[i] = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+}
+
+// First 8 words of the compression output: the next chaining value
+static void compress(const uint32_t cv[8], const uint8_t block[BLAKE3_BLOCK_LEN], uint64_t counter, uint8_t blockLen,
+                     uint8_t flags, uint32_t out[8]) {
+    uint32_t m[16];
+    uint32_t permuted[16];
+    loadWords(block, m, 16);
+
+    uint32_t state[16] = {cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                          IV[0], IV[1], IV[2], IV[3], (uint32_t)counter, (uint32_t)(counter >> 32), blockLen, flags};
+    for (uint8_t round = 0; round < 7; round++) {
+        g(state, 0, 4, 8, 12, m[0], m[1]);
+        g(state, 1, 5, 9, 13, m[2], m[3]);
+        g(state, 2, 6, 10, 14, m[4], m[5]);
+        g(state, 3, 7, 11, 15, m[6], m[7]);
+        g(state, 0, 5, 10, 15, m[8], m[9]);
+        g(state, 1, 6, 11, 12, m[10], m[11]);
+        g(state, 2, 7, 8, 13, m[12], m[13]);
+        g(state, 3, 4, 9, 14, m[14], m[15]);
+        for (uint8_t i = 0; i < 16; i++) {
+            permuted[i] = m[MSG_PERMUTATION[i]];
+        }
+        memcpy(m, permuted, sizeof(m));
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        out[i] = state[i] ^ state[i + 8];
+    }
+}
+
+static void parentCv(const uint32_t left[8], const uint32_t right[8], uint8_t flags, uint32_t out[8]) {
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    for (uint8_t i = 0; i < 8; i++) {
+        for (uint8_t b = 0; b < 4; b++) {
+            block[4 * i + b] = (uint8_t)(left[i] >> (8 * b));
+            block[32 + 4 * i + b] = (uint8_t)(right[i] >> (8 * b));
+        }
+    }
+    compress(IV, block, 0, BLAKE3_BLOCK_LEN, FLAG_PARENT | flags, out);
+}
+
+static uint8_t chunkStartFlag(const blake3_chunk_t *chunk) {
+    return chunk->blocksCompressed == 0 ? FLAG_CHUNK_START : 0;
+}
+
+static size_t chunkLen(const blake3_chunk_t *chunk) {
+    return (size_t)BLAKE3_BLOCK_LEN * chunk->blocksCompressed + chunk->blockLen;
+}
+
+static void chunkInit(blake3_chunk_t *chunk, uint64_t counter) {
+    memset(chunk, 0, sizeof(*chunk));
+    memcpy(chunk->cv, IV, sizeof(IV));
+    chunk->chunkCounter = counter;
+}
+
+static void chunkUpdate(blake3_chunk_t *chunk, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        // the last block of a chunk is compressed by the output, with CHUNK_END
+        if (chunk->blockLen == BLAKE3_BLOCK_LEN) {
+            compress(chunk->cv, chunk->block, chunk->chunkCounter, BLAKE3_BLOCK_LEN, chunkStartFlag(chunk), chunk->cv);
+            chunk->blocksCompressed++;
+            chunk->blockLen = 0;
+            memset(chunk->block, 0, sizeof(chunk->block));
+        }
+        const size_t room = (size_t)BLAKE3_BLOCK_LEN - chunk->blockLen;
+        const size_t take = room < len ? room : len;
+        memcpy(chunk->block + chunk->blockLen, data, take);
+        chunk->blockLen += (uint8_t)take;
+        data += take;
+        len -= take;
+    }
+}
+
+static void chunkOutput(const blake3_chunk_t *chunk, uint8_t extraFlags, uint32_t out[8]) {
+    compress(chunk->cv, chunk->block, chunk->chunkCounter, chunk->blockLen,
+             chunkStartFlag(chunk) | FLAG_CHUNK_END | extraFlags, out);
+}
+
+void blake3_init(blake3_hasher_t *hasher) {
+    memset(hasher, 0, sizeof(*hasher));
+    chunkInit(&hasher->chunk, 0);
+}
+
+bool blake3_update(blake3_hasher_t *hasher, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        if (chunkLen(&hasher->chunk) == BLAKE3_CHUNK_LEN) {
+            uint32_t cv[8];
+            chunkOutput(&hasher->chunk, 0, cv);
+            uint64_t totalChunks = hasher->chunk.chunkCounter + 1;
+            // merge the completed subtrees: one per trailing zero bit of the chunk count
+            while ((totalChunks & 1) == 0) {
+                hasher->cvStackLen--;
+                parentCv(hasher->cvStack[hasher->cvStackLen], cv, 0, cv);
+                totalChunks >>= 1;
+            }
+            if (hasher->cvStackLen >= BLAKE3_MAX_DEPTH) {
+                return false;
+            }
+            memcpy(hasher->cvStack[hasher->cvStackLen++], cv, sizeof(cv));
+            chunkInit(&hasher->chunk, hasher->chunk.chunkCounter + 1);
+        }
+        const size_t room = BLAKE3_CHUNK_LEN - chunkLen(&hasher->chunk);
+        const size_t take = room < len ? room : len;
+        chunkUpdate(&hasher->chunk, data, take);
+        data += take;
+        len -= take;
+    }
+    return true;
+}
+
+void blake3_finalize(const blake3_hasher_t *hasher, uint8_t out[BLAKE3_OUT_LEN]) {
+    uint32_t words[8];
+    if (hasher->cvStackLen == 0) {
+        chunkOutput(&hasher->chunk, FLAG_ROOT, words);
+    } else {
+        // fold the stack from the right; the last parent is the root
+        chunkOutput(&hasher->chunk, 0, words);
+        for (uint8_t i = hasher->cvStackLen; i > 0; i--) {
+            parentCv(hasher->cvStack[i - 1], words, i == 1 ? FLAG_ROOT : 0, words);
+        }
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        for (uint8_t b = 0; b < 4; b++) {
+            out[4 * i + b] = (uint8_t)(words[i] >> (8 * b));
+        }
+    }
+}
+
+bool blake3_hash(const uint8_t *data, size_t len, uint8_t out[BLAKE3_OUT_LEN]) {
+    blake3_hasher_t hasher;
+    blake3_init(&hasher);
+    if (!blake3_update(&hasher, data, len)) {
+        return false;
+    }
+    blake3_finalize(&hasher, out);
+    return true;
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// BLAKE3 with 32-byte output, as used by the metadata hash of RFC-78. Not provided by the SDK.
+#define BLAKE3_OUT_LEN   32
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+// chaining values kept for 2^BLAKE3_MAX_DEPTH chunks, that is inputs up to 1 MiB
+#define BLAKE3_MAX_DEPTH 10
+
+typedef struct {
+    uint32_t cv[8];
+    uint64_t chunkCounter;
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint8_t blockLen;
+    uint8_t blocksCompressed;
+} blake3_chunk_t;
+
+typedef struct {
+    blake3_chunk_t chunk;
+    uint8_t cvStackLen;
+    uint32_t cvStack[BLAKE3_MAX_DEPTH][8];
+} blake3_hasher_t;
+
+void blake3_init(blake3_hasher_t *hasher);
+
+/// \return false once the input is longer than the chaining value stack allows
+bool blake3_update(blake3_hasher_t *hasher, const uint8_t *data, size_t len);
+
+void blake3_finalize(const blake3_hasher_t *hasher, uint8_t out[BLAKE3_OUT_LEN]);
+
+/// One-shot hash of data
+bool blake3_hash(const uint8_t *data, size_t len, uint8_t out[BLAKE3_OUT_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
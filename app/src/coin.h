@@ -21,6 +21,44 @@ extern "C" {
 
 #define CLA                           0x61
 
+// Answered on both CLAs, like GET_VERSION
+#define INS_GET_CAPABILITIES          0x4A
+
+// GET_CAPABILITIES: layout version and feature bits
+#define CAPABILITIES_VERSION          0x01
+#define CAP_EVM_TX_STREAMING          (1u << 0)
+#define CAP_EVM_BATCH_SIGN            (1u << 1)
+#define CAP_EVM_ADDR_BATCH            (1u << 2)
+#define CAP_EVM_PUBKEY_CACHE          (1u << 3)
+#define CAP_EVM_EIP712                (1u << 4)
+#define CAP_EIP191_STREAMING          (1u << 5)
+#define CAP_SUBSTRATE_SIGN_PREHASH    (1u << 6)
+#define CAP_SS58_ADDR_RANGE           (1u << 7)
+#define CAP_PROFILING                 (1u << 8)
+#define CAP_EIP191_BATCH_SIGN         (1u << 9)
+#define CAP_EVM_SIGN_RETRY            (1u << 10)
+#define CAP_EVM_UPLOAD_RESUME         (1u << 11)
+#define CAP_SUBSTRATE_METADATA_HASH   (1u << 12)
+#define CAP_EVM_SIGN_POLICY           (1u << 13)
+#define CAP_EVM_MULTI_PATH            (1u << 14)
+#define CAP_EVM_EIP7702               (1u << 15)
+
+// Substrate instructions, on CLA
+#define INS_GET_ADDR_SUBSTRATE        0x01
+#define INS_SIGN_SUBSTRATE            0x02
+
+// INS_GET_ADDR_SUBSTRATE: P1 selects the mode
+#define P1_SUBSTRATE_ADDR_SILENT      0x00
+#define P1_SUBSTRATE_ADDR_SHOW        0x01
+#define P1_SUBSTRATE_ADDR_RANGE       0x02
+
+// INS_SIGN_SUBSTRATE: the path comes first, then the payload in as many chunks as needed
+#define P1_SUBSTRATE_INIT             0x00
+#define P1_SUBSTRATE_ADD              0x01
+#define P1_SUBSTRATE_LAST             0x02
+// metadata proof of the payload, sent before its first chunk
+#define P1_SUBSTRATE_PROOF            0x03
+
 #define HDPATH_LEN_DEFAULT            5
 #define HDPATH_0_DEFAULT              (0x80000000u | 0x2c)   // 44
 #define HDPATH_1_DEFAULT              (0x80000000u | 0x3cu)  // 60
@@ -36,13 +74,23 @@ extern "C" {
 
 #define PK_LEN_25519                  32u
 #define PK_LEN_SECP256K1_UNCOMPRESSED 65u
+#define SECP256K1_PK_LEN_COMPRESSED   33u
 #define SS58_ADDRESS_MAX_LEN          60u
+// SS58 network prefix of the addresses shown and returned
+#ifndef SS58_ADDRESS_TYPE
+#define SS58_ADDRESS_TYPE 42u
+#endif
+// Range mode of GET_ADDR: one [len (1)] [address] entry per key fits in a single response
+#define SS58_ADDR_BATCH_MAX 5u
 
 #define MAX_SIGN_SIZE                 256u
 #define BLAKE2B_DIGEST_SIZE           32u
 
 #define COIN_AMOUNT_DECIMAL_PLACES    6
+#define COIN_AMOUNT_DECIMALS          18
 #define COIN_TICKER                   "PEAQ "
+// token symbol of the runtime metadata
+#define COIN_SYMBOL                   "PEAQ"
 
 #define MENU_MAIN_APP_LINE1           "peaq"
 #define MENU_MAIN_APP_LINE2           "Ready"
@@ -23,8 +23,15 @@
 #include "coin.h"
 #include "crypto.h"
 #include "crypto_evm.h"
+#include "crypto_helper.h"
 #include "evm_eip191.h"
+#include "evm_eip191_batch.h"
+#include "evm_eip712.h"
+#include "evm_multipath.h"
+#include "evm_policy.h"
+#include "evm_sig_cache.h"
 #include "tx.h"
+#include "tx_evm.h"
 #include "zxerror.h"
 
 extern uint16_t action_addrResponseLen;
@@ -39,6 +46,20 @@ __Z_INLINE bool is_review_pending(void) {
     return review_pending;
 }
 
+__Z_INLINE zxerr_t app_fill_address() {
+    // Put data directly in the apdu buffer
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+
+    action_addrResponseLen = 0;
+    zxerr_t err = crypto_fillAddress(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, &action_addrResponseLen);
+
+    if (err != zxerr_ok || action_addrResponseLen == 0) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+
+    return err;
+}
+
 __Z_INLINE zxerr_t app_fill_eth_address() {
     // Put data directly in the apdu buffer
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
@@ -53,16 +74,34 @@ __Z_INLINE zxerr_t app_fill_eth_address() {
     return zxerr_ok;
 }
 
+__Z_INLINE zxerr_t app_fill_eth_xpub() {
+    // Put data directly in the apdu buffer
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+
+    action_addrResponseLen = 0;
+    zxerr_t err = crypto_fillEthXpub(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2, &action_addrResponseLen);
+
+    if (err != zxerr_ok || action_addrResponseLen == 0) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+
+    return zxerr_ok;
+}
+
 __Z_INLINE void app_sign_eip191() {
-    const uint8_t *message = tx_get_buffer();
-    const uint32_t messageLength = tx_get_buffer_length();
     uint16_t replyLen = 0;
     uint8_t hash[32] = {0};
 
+    // the digest was finalized with the last chunk, the message may not be stored in full
+    zxerr_t err = zxerr_unknown;
+    const uint8_t *digest = eip191_get_digest();
+    if (digest != NULL) {
+        MEMCPY(hash, digest, sizeof(hash));
+        err = zxerr_ok;
+    }
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
-    zxerr_t err = eip191_hash_message(message, messageLength, hash);
     if (err == zxerr_ok) {
-        err = crypto_sign_eth(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, hash, 32, &replyLen, false);
+        err = crypto_sign_eth_message(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, hash, &replyLen);
     }
 
     set_review_pending(false);
@@ -76,17 +115,252 @@ __Z_INLINE void app_sign_eip191() {
     }
 }
 
+// Signs the approved digest with the paths [start, start + ETH_BATCH_SIGS_PER_PAGE) as packed v|r|s
+__Z_INLINE zxerr_t app_fill_multipath_signatures(uint8_t start, uint16_t *replyLen) {
+    *replyLen = 0;
+    const uint8_t count = eth_multipath_count();
+    const uint8_t *digest = eth_multipath_digest();
+    if (digest == NULL || start >= count) {
+        return zxerr_out_of_bounds;
+    }
+    const uint8_t end = (uint8_t)MIN(count, start + ETH_BATCH_SIGS_PER_PAGE);
+
+    uint8_t signature[ETH_SIGNATURE_MAX_LEN] = {0};
+    zxerr_t err = zxerr_ok;
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    peaq_sig_format = P2_ETH_SIG_COMPACT;
+
+    for (uint8_t idx = start; idx < end && err == zxerr_ok; idx++) {
+        uint16_t sigLen = 0;
+        err = eth_multipath_path(idx, hdPathEth, &hdPathEth_len) ? zxerr_ok : zxerr_out_of_bounds;
+        if (err == zxerr_ok) {
+            err = eth_multipath_is_message()
+                      ? crypto_sign_eth_message(signature, sizeof(signature), digest, &sigLen)
+                      : crypto_sign_eth(signature, sizeof(signature), digest, ETH_MULTIPATH_HASH_LEN, &sigLen, false);
+        }
+        if (err == zxerr_ok) {
+            MEMCPY(G_io_apdu_buffer + *replyLen, signature, ETH_SIGNATURE_RSV_LEN);
+            *replyLen += ETH_SIGNATURE_RSV_LEN;
+        }
+    }
+    MEMZERO(signature, sizeof(signature));
+
+    if (err != zxerr_ok) {
+        MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+        *replyLen = 0;
+    }
+    return err;
+}
+
+__Z_INLINE void app_sign_multipath(const uint8_t *digest, bool isMessage) {
+    uint16_t replyLen = 0;
+
+    eth_multipath_approve(digest, isMessage);
+    zxerr_t err = app_fill_multipath_signatures(0, &replyLen);
+
+    set_review_pending(false);
+
+    if (err != zxerr_ok || replyLen == 0) {
+        eth_multipath_revoke();
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
+    }
+}
+
+__Z_INLINE void app_sign_multipath_eth() {
+    app_sign_multipath(tx_get_digest_eth(), false);
+}
+
+__Z_INLINE void app_sign_multipath_eip191() {
+    app_sign_multipath(eip191_get_digest(), true);
+}
+
+__Z_INLINE void app_sign_eip712() {
+    uint16_t replyLen = 0;
+
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    zxerr_t err = crypto_sign_eth_message(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, eip712_get_digest(), &replyLen);
+
+    set_review_pending(false);
+    eip712_release();
+
+    if (err != zxerr_ok || replyLen == 0) {
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
+    }
+}
+
+// Replies [signature type (1)] [Ed25519 signature (64)]
+__Z_INLINE void app_sign() {
+    // payloads longer than MAX_SIGN_SIZE are signed through their BLAKE2b-256 hash; the
+    // metadata proof in front of the payload is not signed
+    const uint32_t proofLength = tx_get_proof_length();
+    const uint32_t payloadLength = tx_get_buffer_length() - proofLength;
+    const bool prehashed = payloadLength > MAX_SIGN_SIZE;
+    const uint8_t *message = prehashed ? tx_get_prehash() : tx_get_buffer() + proofLength;
+    const uint16_t messageLength = prehashed ? BLAKE2B_DIGEST_SIZE : (uint16_t)payloadLength;
+
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    G_io_apdu_buffer[0] = 0x00;
+    const zxerr_t err = crypto_sign(G_io_apdu_buffer + 1, IO_APDU_BUFFER_SIZE - 3, message, messageLength);
+
+    set_review_pending(false);
+
+    if (err != zxerr_ok) {
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        set_code(G_io_apdu_buffer, SIG_PLUS_TYPE_LEN, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, SIG_PLUS_TYPE_LEN + 2);
+    }
+}
+
 __Z_INLINE void app_sign_eth() {
-    const uint8_t *message = tx_get_buffer();
-    const uint16_t messageLength = tx_get_buffer_length();
+    uint8_t digest[KECCAK_256_SIZE] = {0};
+    uint16_t replyLen = 0;
+
+    // the digest slot is filled once when the transaction is parsed
+    MEMCPY(digest, tx_get_digest_eth(), sizeof(digest));
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    zxerr_t err = crypto_sign_eth(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, digest, sizeof(digest), &replyLen, false);
+
+    set_review_pending(false);
+
+    if (err != zxerr_ok || replyLen == 0) {
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        sig_cache_store(hdPathEth, (uint8_t)hdPathEth_len, peaq_sig_format, digest, G_io_apdu_buffer, replyLen);
+        set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
+    }
+}
+
+// Signs the parsed transaction under the active policy, leaving the reply in G_io_apdu_buffer
+__Z_INLINE zxerr_t app_sign_eth_policy(uint16_t *replyLen) {
+    uint8_t digest[KECCAK_256_SIZE] = {0};
+    *replyLen = 0;
+
+    MEMCPY(digest, tx_get_digest_eth(), sizeof(digest));
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    zxerr_t err = crypto_sign_eth(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, digest, sizeof(digest), replyLen, false);
+    if (err != zxerr_ok || *replyLen == 0) {
+        MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+        *replyLen = 0;
+        return zxerr_unknown;
+    }
+    eth_policy_consume();
+    sig_cache_store(hdPathEth, (uint8_t)hdPathEth_len, peaq_sig_format, digest, G_io_apdu_buffer, *replyLen);
+    return zxerr_ok;
+}
+
+__Z_INLINE void app_set_policy_eth() {
+    eth_policy_activate();
+    set_review_pending(false);
+    set_code(G_io_apdu_buffer, 0, APDU_CODE_OK);
+    io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+}
+
+// Signs the batch transactions [start, start + ETH_BATCH_SIGS_PER_PAGE) as packed v|r|s
+__Z_INLINE zxerr_t app_fill_batch_signatures_eth(uint8_t start, uint16_t *replyLen) {
+    *replyLen = 0;
+    const uint8_t count = tx_batch_count_eth();
+    if (!tx_batch_approved_eth() || start >= count) {
+        return zxerr_out_of_bounds;
+    }
+    const uint8_t end = (uint8_t)MIN(count, start + ETH_BATCH_SIGS_PER_PAGE);
+
+    uint8_t signature[ETH_SIGNATURE_MAX_LEN] = {0};
+    zxerr_t err = zxerr_ok;
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    // batch replies only carry v|r|s
+    peaq_sig_format = P2_ETH_SIG_COMPACT;
+
+    for (uint8_t idx = start; idx < end && err == zxerr_ok; idx++) {
+        uint16_t sigLen = 0;
+        err = tx_select_batch_eth(idx);
+        if (err == zxerr_ok) {
+            err = crypto_sign_eth(signature, sizeof(signature), tx_get_digest_eth(), KECCAK_256_SIZE, &sigLen, false);
+        }
+        if (err == zxerr_ok) {
+            MEMCPY(G_io_apdu_buffer + *replyLen, signature, ETH_SIGNATURE_RSV_LEN);
+            *replyLen += ETH_SIGNATURE_RSV_LEN;
+        }
+    }
+    MEMZERO(signature, sizeof(signature));
+
+    if (err != zxerr_ok) {
+        MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+        *replyLen = 0;
+    }
+    return err;
+}
+
+__Z_INLINE void app_sign_batch_eth() {
     uint16_t replyLen = 0;
 
+    tx_set_batch_approved_eth(true);
+    zxerr_t err = app_fill_batch_signatures_eth(0, &replyLen);
+
+    set_review_pending(false);
+
+    if (err != zxerr_ok || replyLen == 0) {
+        tx_set_batch_approved_eth(false);
+        set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
+    } else {
+        set_code(G_io_apdu_buffer, replyLen, APDU_CODE_OK);
+        io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, replyLen + 2);
+    }
+}
+
+// Signs the messages [start, start + ETH_BATCH_SIGS_PER_PAGE) of an approved batch as packed v|r|s
+__Z_INLINE zxerr_t app_fill_batch_signatures_eip191(uint8_t start, uint16_t *replyLen) {
+    *replyLen = 0;
+    const uint8_t count = eip191_batch_count();
+    if (!eip191_batch_approved() || start >= count) {
+        return zxerr_out_of_bounds;
+    }
+    const uint8_t end = (uint8_t)MIN(count, start + ETH_BATCH_SIGS_PER_PAGE);
+
+    uint8_t signature[ETH_SIGNATURE_MAX_LEN] = {0};
+    zxerr_t err = zxerr_ok;
     MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
-    zxerr_t err = crypto_sign_eth(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 3, message, messageLength, &replyLen, true);
+    peaq_sig_format = P2_ETH_SIG_COMPACT;
+
+    for (uint8_t idx = start; idx < end && err == zxerr_ok; idx++) {
+        uint16_t sigLen = 0;
+        err = crypto_sign_eth_message(signature, sizeof(signature), eip191_batch_hash(idx), &sigLen);
+        if (err == zxerr_ok) {
+            MEMCPY(G_io_apdu_buffer + *replyLen, signature, ETH_SIGNATURE_RSV_LEN);
+            *replyLen += ETH_SIGNATURE_RSV_LEN;
+        }
+    }
+    MEMZERO(signature, sizeof(signature));
+
+    if (err != zxerr_ok) {
+        MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+        *replyLen = 0;
+    }
+    return err;
+}
+
+__Z_INLINE void app_sign_batch_eip191() {
+    uint16_t replyLen = 0;
+
+    eip191_batch_set_approved(true);
+    zxerr_t err = app_fill_batch_signatures_eip191(0, &replyLen);
 
     set_review_pending(false);
 
     if (err != zxerr_ok || replyLen == 0) {
+        eip191_batch_set_approved(false);
         set_code(G_io_apdu_buffer, 0, APDU_CODE_SIGN_VERIFY_ERROR);
         io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, 2);
     } else {
@@ -0,0 +1,45 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "format_scratch.h"
+
+#include <stdbool.h>
+
+#include "zxmacros.h"
+
+#if !defined(LEDGER_SPECIFIC)
+#include <assert.h>
+#define SCRATCH_ASSERT(cond) assert(cond)
+#else
+#define SCRATCH_ASSERT(cond)
+#endif
+
+static char scratch[FORMAT_SCRATCH_SIZE];
+static bool scratch_borrowed = false;
+
+char *format_scratch_borrow(uint16_t len) {
+    SCRATCH_ASSERT(!scratch_borrowed);
+    if (scratch_borrowed || len > sizeof(scratch)) {
+        return NULL;
+    }
+    scratch_borrowed = true;
+    MEMZERO(scratch, len);
+    return scratch;
+}
+
+void format_scratch_return(void) {
+    scratch_borrowed = false;
+}
@@ -0,0 +1,40 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Review formatters need a few hundred bytes of temporary text each (amounts,
+// paths, hex previews). They run one at a time from the UI callbacks, so they
+// borrow one static buffer instead of each keeping its own on the stack; peak
+// stack no longer depends on which formatter sits deeper in the call chain.
+#define FORMAT_SCRATCH_SIZE 320
+
+/// Borrows len bytes of scratch, zeroed.
+/// \return NULL when len is too large or the scratch is already borrowed:
+/// formatters must not nest, which is also asserted in host builds
+char *format_scratch_borrow(uint16_t len);
+
+/// Gives the scratch back to the next formatter
+void format_scratch_return(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "hex_encode.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// the two digits of every byte value, in order
+static const char HEX_PAIRS[2 * 256 + 1] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+void hex_encode_window(char *out, const uint8_t *data, uint32_t start, uint32_t len) {
+    if (out == NULL || data == NULL || len == 0) {
+        return;
+    }
+    const uint8_t *byte = data + start / 2;
+    // a window starting on a low nibble takes the second digit of its first pair
+    if (start % 2 != 0) {
+        *out++ = HEX_PAIRS[2 * *byte++ + 1];
+        len--;
+    }
+    // a constant 2-byte memcpy compiles to a single halfword store
+    for (; len >= 2; len -= 2) {
+        memcpy(out, &HEX_PAIRS[2 * *byte++], 2);
+        out += 2;
+    }
+    if (len != 0) {
+        *out = HEX_PAIRS[2 * *byte];
+    }
+}
+
+uint32_t hex_encode(char *out, uint32_t outLen, const uint8_t *data, uint32_t dataLen) {
+    if (out == NULL || (data == NULL && dataLen != 0) || outLen < 2 * dataLen + 1) {
+        return 0;
+    }
+    hex_encode_window(out, data, 0, 2 * dataLen);
+    out[2 * dataLen] = '\0';
+    return 2 * dataLen;
+}
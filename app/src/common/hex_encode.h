@@ -0,0 +1,38 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Lowercase hex encoding for the review formatters. Every byte is looked up as
+// a pair of digits and written with one 2-byte store, and the window variant
+// only encodes the digits of the page being shown.
+
+/// Writes digits [start, start + len) of the hex encoding of data, without a NUL.
+/// start may be odd; the caller keeps start + len within twice the length of data
+void hex_encode_window(char *out, const uint8_t *data, uint32_t start, uint32_t len);
+
+/// Writes the 2 * dataLen digits of data followed by a NUL, like array_to_hexstr
+/// \return the number of digits written, 0 when out cannot hold them and the NUL
+uint32_t hex_encode(char *out, uint32_t outLen, const uint8_t *data, uint32_t dataLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -30,9 +30,20 @@ parser_error_t parser_init_context(parser_context_t *ctx, const uint8_t *buffer,
 //// parses a tx buffer
 parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, size_t dataLen, parser_tx_t *tx_obj);
 
+//// parses a tx buffer whose CheckMetadataHash is proven by the metadata proof
+parser_error_t parser_parse_with_proof(parser_context_t *ctx, const uint8_t *data, size_t dataLen, const uint8_t *proof,
+                                      size_t proofLen, parser_tx_t *tx_obj);
+
 //// verifies tx fields
 parser_error_t parser_validate(parser_context_t *ctx);
 
+//// returns the number of items in the current parsing context
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items);
+
+// retrieves a readable output for each field / page
+parser_error_t parser_getItem(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen,
+                              char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
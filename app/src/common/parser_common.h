@@ -62,6 +62,7 @@ typedef enum {
     parser_not_supported_parser,
     parser_not_supported_validation,
     parser_blindsign_mode_required,
+    parser_metadata_mismatch,
 } parser_error_t;
 
 typedef struct {
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "session.h"
+
+#include "zxmacros.h"
+
+session_arena_t session_arena;
+
+static session_evict_cb_t evict_cb[session_flow_count];
+
+void session_claim(session_flow_e flow) {
+    if (session_arena.flow == flow) {
+        return;
+    }
+    const session_flow_e evicted = session_arena.flow;
+    MEMZERO(&session_arena.views, sizeof(session_arena.views));
+    session_arena.flow = flow;
+    if (evicted < session_flow_count && evict_cb[evicted] != NULL) {
+        evict_cb[evicted]();
+    }
+}
+
+void session_release(session_flow_e flow) {
+    if (session_arena.flow != flow) {
+        return;
+    }
+    MEMZERO(&session_arena.views, sizeof(session_arena.views));
+    session_arena.flow = session_flow_none;
+}
+
+void session_on_evict(session_flow_e flow, session_evict_cb_t cb) {
+    if (flow < session_flow_count) {
+        evict_cb[flow] = cb;
+    }
+}
+
+session_flow_e session_current_flow(void) {
+    return session_arena.flow;
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "coin.h"
+#include "evm_batch.h"
+#include "evm_eip191_batch.h"
+#include "evm_eip712.h"
+#include "evm_stream.h"
+#include "parser_common.h"
+#include "parser_txdef.h"
+
+#if defined(LEDGER_SPECIFIC)
+#include "cx.h"
+#endif
+
+// The signing flows never overlap: every APDU of a Substrate signature, an EVM
+// transaction or batch, an EIP-712 message or a batch of personal messages
+// belongs to one of them, and the review keeps other commands out. Their working
+// state therefore shares one arena, and RAM that each flow used to keep for
+// itself goes to the upload buffer.
+typedef enum {
+    session_flow_none = 0,
+    session_flow_substrate,
+    session_flow_evm,
+    session_flow_eip712,
+    session_flow_eip191_batch,
+    session_flow_count,
+} session_flow_e;
+
+typedef struct {
+    parser_tx_t tx;
+    parser_context_t ctx;
+#if defined(LEDGER_SPECIFIC)
+    cx_blake2b_t blake2b;
+#endif
+    uint8_t prehash[BLAKE2B_DIGEST_SIZE];
+} session_substrate_t;
+
+typedef struct {
+    eth_tx_t tx;
+    eth_batch_t batch;
+    parser_context_t ctx;
+#if defined(LEDGER_SPECIFIC)
+    cx_sha3_t keccak;
+#endif
+    evm_stream_t stream;
+} session_evm_t;
+
+typedef struct {
+    session_flow_e flow;
+    union {
+        session_substrate_t substrate;
+        session_evm_t evm;
+        eip712_session_t typed_data;
+        eip191_batch_t eip191_batch;
+    } views;
+} session_arena_t;
+
+extern session_arena_t session_arena;
+
+// shared by the EVM parser, the batch reviewers and the tests
+#define eth_tx_obj       (session_arena.views.evm.tx)
+#define eth_batch_obj    (session_arena.views.evm.batch)
+#define eip191_batch_obj (session_arena.views.eip191_batch)
+
+/// Hands the arena to flow. The views are cleared when it was used by another flow.
+void session_claim(session_flow_e flow);
+
+/// Clears the arena if flow owns it
+void session_release(session_flow_e flow);
+
+typedef void (*session_evict_cb_t)(void);
+
+/// Sets the function called when another flow claims the arena from flow, to drop the
+/// state flow keeps outside of the arena that is only valid together with its views
+void session_on_evict(session_flow_e flow, session_evict_cb_t cb);
+
+session_flow_e session_current_flow(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,10 +20,16 @@
 
 #include "apdu_codes.h"
 #include "buffering.h"
+#include "cx.h"
+#include "crypto_helper.h"
 #include "parser.h"
+#include "session.h"
 #include "zxmacros.h"
 
-#define RAM_BUFFER_SIZE   8192
+// sized per target by the Makefile, with the RAM the session arena saves
+#ifndef RAM_BUFFER_SIZE
+#define RAM_BUFFER_SIZE 8192
+#endif
 #define FLASH_BUFFER_SIZE 16384
 
 // Ram
@@ -34,36 +40,170 @@ typedef struct {
     uint8_t buffer[FLASH_BUFFER_SIZE];
 } storage_t;
 
-storage_t NV_CONST N_appdata_impl __attribute__((aligned(64)));
+#define NVM_PAGE_SIZE 64
+
+storage_t NV_CONST N_appdata_impl __attribute__((aligned(NVM_PAGE_SIZE)));
 #define N_appdata (*(NV_VOLATILE storage_t *)PIC(&N_appdata_impl))
 
-static parser_tx_t tx_obj;
-static parser_context_t ctx_parsed_tx;
+// Once the upload is in flash, chunks are staged here and written as whole
+// aligned pages, so a page is programmed once instead of once per chunk.
+#define NVM_STAGE_SIZE (4 * NVM_PAGE_SIZE)
+static uint8_t nvm_stage[NVM_STAGE_SIZE];
+static uint16_t nvm_stage_len = 0;
+
+// Metadata proof bytes at the start of the buffer, the payload follows them
+static uint32_t tx_proof_len = 0;
+
+#define tx_obj        (session_arena.views.substrate.tx)
+#define ctx_parsed_tx (session_arena.views.substrate.ctx)
+
+// Running BLAKE2b-256 of the payload, finalized together with the last chunk so
+// signing a long payload does not need a second pass over the buffer.
+#define tx_blake2b (session_arena.views.substrate.blake2b)
+#define tx_prehash (session_arena.views.substrate.prehash)
+// Set when another flow took the arena in the middle of an upload, cleared by the next tx_prehash_start
+static bool tx_substrate_evicted = false;
 
 void tx_initialize() {
+    nvm_stage_len = 0;
+    tx_proof_len = 0;
     buffering_init(ram_buffer, sizeof(ram_buffer), (uint8_t *)N_appdata.buffer, sizeof(N_appdata.buffer));
 }
 
 void tx_reset() {
+    nvm_stage_len = 0;
+    tx_proof_len = 0;
     buffering_reset();
 }
 
+// Writes the staged bytes up to the last page boundary, or all of them
+static bool tx_stage_commit(bool all) {
+    const buffer_state_t *flash = buffering_get_flash_buffer();
+    uint16_t commitLen = nvm_stage_len;
+    if (!all) {
+        commitLen -= (uint16_t)((flash->pos + nvm_stage_len) % NVM_PAGE_SIZE);
+    }
+    if (commitLen == 0) {
+        return true;
+    }
+    if (buffering_append(nvm_stage, commitLen) != (int)commitLen) {
+        return false;
+    }
+    nvm_stage_len -= commitLen;
+    memmove(nvm_stage, nvm_stage + commitLen, nvm_stage_len);
+    return true;
+}
+
 uint32_t tx_append(unsigned char *buffer, uint32_t length) {
-    return buffering_append(buffer, length);
+    const buffer_state_t *flash = buffering_get_flash_buffer();
+    if (!flash->in_use) {
+        // still in RAM, or the chunk that moves the upload to flash
+        return buffering_append(buffer, length);
+    }
+    if (flash->pos + nvm_stage_len + length > flash->size) {
+        return 0;
+    }
+
+    uint32_t staged = 0;
+    while (staged < length) {
+        const uint32_t part = MIN(length - staged, (uint32_t)(NVM_STAGE_SIZE - nvm_stage_len));
+        MEMCPY(nvm_stage + nvm_stage_len, buffer + staged, part);
+        nvm_stage_len += (uint16_t)part;
+        staged += part;
+        if (nvm_stage_len == NVM_STAGE_SIZE && !tx_stage_commit(false)) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+uint32_t tx_append_proof(unsigned char *buffer, uint32_t length) {
+    if (tx_get_buffer_length() != tx_proof_len) {
+        return 0;
+    }
+    const uint32_t added = tx_append(buffer, length);
+    tx_proof_len += added;
+    return added;
+}
+
+uint32_t tx_get_proof_length() {
+    return tx_proof_len;
+}
+
+bool tx_flush() {
+    return tx_stage_commit(true);
 }
 
 uint32_t tx_get_buffer_length() {
-    return buffering_get_buffer()->pos;
+    return buffering_get_buffer()->pos + nvm_stage_len;
+}
+
+uint32_t tx_get_buffer_capacity() {
+    // buffering keeps data either in RAM or in flash, never split across both
+    return MAX(sizeof(ram_buffer), sizeof(N_appdata.buffer));
+}
+
+uint32_t tx_get_ram_capacity() {
+    return sizeof(ram_buffer);
+}
+
+uint32_t tx_get_flash_capacity() {
+    return sizeof(N_appdata.buffer);
 }
 
 uint8_t *tx_get_buffer() {
+    // complete only after tx_flush, which the handlers call once the last chunk is in
     return buffering_get_buffer()->data;
 }
 
+// The hash state lives in the arena: an upload cannot go on without it
+static void tx_substrate_evict(void) {
+    tx_substrate_evicted = true;
+    tx_proof_len = 0;
+}
+
+zxerr_t tx_prehash_start() {
+    session_claim(session_flow_substrate);
+    session_on_evict(session_flow_substrate, tx_substrate_evict);
+    tx_substrate_evicted = false;
+    MEMZERO(tx_prehash, sizeof(tx_prehash));
+    CHECK_CX_OK(cx_blake2b_init_no_throw(&tx_blake2b, BLAKE2B_DIGEST_SIZE * 8));
+    return zxerr_ok;
+}
+
+zxerr_t tx_prehash_absorb(const uint8_t *data, uint32_t length) {
+    if (length == 0) {
+        return zxerr_ok;
+    }
+    CHECK_CX_OK(cx_hash_no_throw((cx_hash_t *)&tx_blake2b, 0, data, length, NULL, 0));
+    return zxerr_ok;
+}
+
+zxerr_t tx_prehash_finish() {
+    CHECK_CX_OK(cx_hash_no_throw((cx_hash_t *)&tx_blake2b, CX_LAST, NULL, 0, tx_prehash, sizeof(tx_prehash)));
+    return zxerr_ok;
+}
+
+bool tx_prehash_evicted() {
+    return tx_substrate_evicted;
+}
+
+const uint8_t *tx_get_prehash() {
+    return tx_prehash;
+}
+
 const char *tx_parse() {
+    session_claim(session_flow_substrate);
     MEMZERO(&tx_obj, sizeof(tx_obj));
 
-    uint8_t err = parser_parse(&ctx_parsed_tx, tx_get_buffer(), tx_get_buffer_length(), &tx_obj);
+    const uint8_t *buffer = tx_get_buffer();
+    uint8_t err = parser_ok;
+    if (tx_proof_len == 0) {
+        err = parser_parse(&ctx_parsed_tx, buffer, tx_get_buffer_length(), &tx_obj);
+    } else {
+        err = parser_parse_with_proof(&ctx_parsed_tx, buffer + tx_proof_len, tx_get_buffer_length() - tx_proof_len,
+                                      buffer, tx_proof_len, &tx_obj);
+    }
 
     CHECK_APP_CANARY()
 
@@ -84,3 +224,38 @@ const char *tx_parse() {
 void tx_parse_reset() {
     MEMZERO(&tx_obj, sizeof(tx_obj));
 }
+
+zxerr_t tx_getNumItems(uint8_t *num_items) {
+    parser_error_t err = parser_getNumItems(&ctx_parsed_tx, num_items);
+
+    if (err != parser_ok) {
+        return zxerr_unknown;
+    }
+
+    return zxerr_ok;
+}
+
+zxerr_t tx_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen, uint8_t pageIdx,
+                   uint8_t *pageCount) {
+    uint8_t numItems = 0;
+
+    CHECK_ZXERR(tx_getNumItems(&numItems))
+
+    if (displayIdx > numItems) {
+        return zxerr_no_data;
+    }
+
+    parser_error_t err =
+        parser_getItem(&ctx_parsed_tx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+
+    // Convert error codes
+    if (err == parser_no_data || err == parser_display_idx_out_of_range || err == parser_display_page_out_of_range) {
+        return zxerr_no_data;
+    }
+
+    if (err != parser_ok) {
+        return zxerr_unknown;
+    }
+
+    return zxerr_ok;
+}
@@ -15,6 +15,8 @@
  ********************************************************************************/
 #pragma once
 
+#include <stdbool.h>
+
 #include "coin.h"
 #include "os.h"
 #include "zxerror.h"
@@ -31,15 +33,58 @@ void tx_reset();
 /// \return It returns an error message if the buffer is too small.
 uint32_t tx_append(unsigned char *buffer, uint32_t length);
 
+/// Appends a chunk of the metadata proof, which must come before any payload byte
+/// \return the bytes appended, 0 once the payload has started or the buffer is full
+uint32_t tx_append_proof(unsigned char *buffer, uint32_t length);
+
+/// \return length of the metadata proof at the start of the buffer, 0 without one
+uint32_t tx_get_proof_length();
+
+/// Writes the bytes still staged for flash. Called once on the last chunk, before the
+/// buffer is read back
+/// \return false if the flash buffer could not take them
+bool tx_flush();
+
 /// Returns size of the raw json transaction buffer
 /// \return
 uint32_t tx_get_buffer_length();
 
-/// Returns the raw json transaction buffer
+/// Returns the largest transaction the buffer can hold
+uint32_t tx_get_buffer_capacity();
+
+/// Uploads up to this size stay in RAM; larger ones are written to flash
+uint32_t tx_get_ram_capacity();
+
+/// Size of the flash buffer used for large uploads
+uint32_t tx_get_flash_capacity();
+
+/// Returns the raw json transaction buffer, complete once tx_flush has been called
 /// \return
 uint8_t *tx_get_buffer();
 
+/// Starts the BLAKE2b-256 hash of the payload
+zxerr_t tx_prehash_start();
+
+/// Adds payload bytes to the hash, in upload order
+zxerr_t tx_prehash_absorb(const uint8_t *data, uint32_t length);
+
+/// Finalizes the hash once the last chunk was absorbed
+zxerr_t tx_prehash_finish();
+
+/// \return true when another flow took the session arena since tx_prehash_start, which ends the upload
+bool tx_prehash_evicted();
+
+/// \return BLAKE2b-256 of the payload, signed instead of payloads longer than MAX_SIGN_SIZE
+const uint8_t *tx_get_prehash();
+
 /// Parse message stored in transaction buffer
 /// This function should be called as soon as full buffer data is loaded.
 /// \return It returns NULL if data is valid or error message otherwise.
 const char *tx_parse();
+
+/// Return the number of items in the transaction
+zxerr_t tx_getNumItems(uint8_t *num_items);
+
+/// Gets an specific item from the transaction (including paging)
+zxerr_t tx_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen, uint8_t pageIdx,
+                   uint8_t *pageCount);
@@ -26,7 +26,96 @@
 uint32_t hdPath[HDPATH_LEN_DEFAULT];
 uint32_t hdPath_len;
 
-// For Future use
+zxerr_t crypto_extractPublicKey(uint8_t *pubKey, uint16_t pubKeyLen) {
+    if (pubKey == NULL || pubKeyLen < PK_LEN_25519) {
+        return zxerr_invalid_crypto_settings;
+    }
+    cx_ecfp_public_key_t cx_publicKey;
+    cx_ecfp_private_key_t cx_privateKey;
+    uint8_t privateKeyData[SK_LEN_25519] = {0};
+
+    zxerr_t error = zxerr_unknown;
+    CATCH_CXERROR(os_derive_bip32_no_throw(CX_CURVE_Ed25519, hdPath, HDPATH_LEN_DEFAULT, privateKeyData, NULL));
+    CATCH_CXERROR(cx_ecfp_init_private_key_no_throw(CX_CURVE_Ed25519, privateKeyData, SCALAR_LEN_ED25519, &cx_privateKey));
+    CATCH_CXERROR(cx_ecfp_init_public_key_no_throw(CX_CURVE_Ed25519, NULL, 0, &cx_publicKey));
+    CATCH_CXERROR(cx_ecfp_generate_pair_no_throw(CX_CURVE_Ed25519, &cx_publicKey, &cx_privateKey, 1));
+
+    // compressed point: little-endian y, with the parity of x in the top bit
+    for (uint8_t i = 0; i < PK_LEN_25519; i++) {
+        pubKey[i] = cx_publicKey.W[64 - i];
+    }
+    if ((cx_publicKey.W[PK_LEN_25519] & 1) != 0) {
+        pubKey[31] |= 0x80;
+    }
+    error = zxerr_ok;
+
+catch_cx_error:
+    MEMZERO(&cx_privateKey, sizeof(cx_privateKey));
+    MEMZERO(privateKeyData, sizeof(privateKeyData));
+
+    if (error != zxerr_ok) {
+        MEMZERO(pubKey, pubKeyLen);
+    }
+    return error;
+}
+
+zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t bufferLen, uint16_t *addrResponseLen) {
+    if (buffer == NULL || addrResponseLen == NULL || bufferLen < PK_LEN_25519 + SS58_ADDRESS_MAX_LEN) {
+        return zxerr_buffer_too_small;
+    }
+    MEMZERO(buffer, bufferLen);
+    *addrResponseLen = 0;
+
+    CHECK_ZXERR(crypto_extractPublicKey(buffer, PK_LEN_25519))
+    const uint16_t addrLen =
+        crypto_SS58EncodePubkey(buffer + PK_LEN_25519, bufferLen - PK_LEN_25519, SS58_ADDRESS_TYPE, buffer);
+    if (addrLen == 0) {
+        MEMZERO(buffer, bufferLen);
+        return zxerr_encoding_failed;
+    }
+    *addrResponseLen = PK_LEN_25519 + addrLen;
+    return zxerr_ok;
+}
+
+zxerr_t crypto_fillAddressRange(uint8_t *buffer, uint16_t bufferLen, uint8_t count, uint16_t *responseLen) {
+    if (buffer == NULL || responseLen == NULL || count == 0) {
+        return zxerr_no_data;
+    }
+    MEMZERO(buffer, bufferLen);
+    *responseLen = 0;
+
+    const uint32_t start = hdPath[HDPATH_LEN_DEFAULT - 1];
+    uint8_t pubKey[PK_LEN_25519] = {0};
+    uint8_t address[SS58_ADDRESS_MAX_LEN] = {0};
+    zxerr_t err = zxerr_ok;
+    uint16_t offset = 0;
+
+    for (uint8_t i = 0; i < count && err == zxerr_ok; i++) {
+        hdPath[HDPATH_LEN_DEFAULT - 1] = start + i;
+        err = crypto_extractPublicKey(pubKey, sizeof(pubKey));
+        if (err != zxerr_ok) {
+            break;
+        }
+        const uint16_t addrLen = crypto_SS58EncodePubkey(address, sizeof(address), SS58_ADDRESS_TYPE, pubKey);
+        if (addrLen == 0 || offset + 1 + addrLen > bufferLen) {
+            err = addrLen == 0 ? zxerr_encoding_failed : zxerr_buffer_too_small;
+            break;
+        }
+        buffer[offset] = (uint8_t)addrLen;
+        MEMCPY(buffer + offset + 1, address, addrLen);
+        offset += 1 + addrLen;
+    }
+    hdPath[HDPATH_LEN_DEFAULT - 1] = start;
+    MEMZERO(pubKey, sizeof(pubKey));
+
+    if (err != zxerr_ok) {
+        MEMZERO(buffer, bufferLen);
+        return err;
+    }
+    *responseLen = offset;
+    return zxerr_ok;
+}
+
 zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen) {
     if (signature == NULL || message == NULL || signatureMaxlen < ED25519_SIGNATURE_SIZE || messageLen == 0) {
         return zxerr_invalid_crypto_settings;
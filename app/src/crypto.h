@@ -29,6 +29,15 @@ extern "C" {
 extern uint32_t hdPath[HDPATH_LEN_DEFAULT];
 extern uint32_t hdPath_len;
 
+/// Ed25519 public key of hdPath
+zxerr_t crypto_extractPublicKey(uint8_t *pubKey, uint16_t pubKeyLen);
+
+/// [public key (32)] [SS58 address, zero terminated] for hdPath
+zxerr_t crypto_fillAddress(uint8_t *buffer, uint16_t bufferLen, uint16_t *addrResponseLen);
+
+/// count entries of [address len (1)] [SS58 address], for consecutive indexes from the last element of hdPath
+zxerr_t crypto_fillAddressRange(uint8_t *buffer, uint16_t bufferLen, uint8_t count, uint16_t *responseLen);
+
 zxerr_t crypto_sign(uint8_t *signature, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen);
 
 #ifdef __cplusplus
@@ -16,6 +16,9 @@
  ********************************************************************************/
 #include "crypto_helper.h"
 
+#include "base58.h"
+#include "coin.h"
+#include "zxmacros.h"
 #include "zxmacros_ledger.h"
 #if defined(LEDGER_SPECIFIC)
 #include "cx.h"
@@ -35,3 +38,62 @@ zxerr_t keccak_digest(const unsigned char *in, unsigned int inLen, unsigned char
 #endif
     return zxerr_ok;
 }
+
+uint8_t crypto_SS58CalculatePrefix(uint16_t addressType, uint8_t *prefixBytes) {
+    if (prefixBytes == NULL) {
+        return 0;
+    }
+    if (addressType < 64) {
+        prefixBytes[0] = (uint8_t)addressType;
+        return 1;
+    }
+    if (addressType < 16384) {
+        prefixBytes[0] = (uint8_t)(((addressType & 0x00FC) >> 2) | 0x40);
+        prefixBytes[1] = (uint8_t)((addressType >> 8) | ((addressType & 0x0003) << 6));
+        return 2;
+    }
+    return 0;
+}
+
+// First bytes of blake2b-512("SS58PRE" || prefix || public key)
+static zxerr_t ss58_checksum(const uint8_t *data, uint16_t dataLen, uint8_t *checksum) {
+#if defined(LEDGER_SPECIFIC)
+    uint8_t hash[64] = {0};
+    cx_blake2b_t ctx;
+    CHECK_CX_OK(cx_blake2b_init_no_throw(&ctx, sizeof(hash) * 8));
+    CHECK_CX_OK(cx_hash_no_throw((cx_hash_t *)&ctx, 0, (const uint8_t *)SS58_BLAKE_PREFIX, SS58_BLAKE_PREFIX_LEN, NULL, 0));
+    CHECK_CX_OK(cx_hash_no_throw((cx_hash_t *)&ctx, CX_LAST, data, dataLen, hash, sizeof(hash)));
+    MEMCPY(checksum, hash, SS58_CHECKSUM_LEN);
+#else
+    UNUSED(data);
+    UNUSED(dataLen);
+    MEMZERO(checksum, SS58_CHECKSUM_LEN);
+#endif
+    return zxerr_ok;
+}
+
+uint16_t crypto_SS58EncodePubkey(uint8_t *buffer, uint16_t bufferLen, uint16_t addressType, const uint8_t *pubkey) {
+    if (buffer == NULL || pubkey == NULL || bufferLen < SS58_ADDRESS_MAX_LEN) {
+        return 0;
+    }
+    MEMZERO(buffer, bufferLen);
+
+    // [prefix] [public key] [checksum], hashed and encoded in a single pass
+    uint8_t unencoded[SS58_PREFIX_MAX_LEN + PK_LEN_25519 + SS58_CHECKSUM_LEN] = {0};
+    const uint8_t prefixLen = crypto_SS58CalculatePrefix(addressType, unencoded);
+    if (prefixLen == 0) {
+        return 0;
+    }
+    MEMCPY(unencoded + prefixLen, pubkey, PK_LEN_25519);
+    if (ss58_checksum(unencoded, prefixLen + PK_LEN_25519, unencoded + prefixLen + PK_LEN_25519) != zxerr_ok) {
+        return 0;
+    }
+
+    size_t outLen = bufferLen - 1;
+    if (encode_base58(unencoded, prefixLen + PK_LEN_25519 + SS58_CHECKSUM_LEN, buffer, &outLen) != 0) {
+        MEMZERO(buffer, bufferLen);
+        return 0;
+    }
+    buffer[outLen] = 0;
+    return (uint16_t)outLen;
+}
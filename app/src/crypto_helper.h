@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <string.h>
 
 #include "zxerror.h"
 
@@ -36,6 +37,19 @@ extern "C" {
 
 zxerr_t keccak_digest(const unsigned char *in, unsigned int inLen, unsigned char *out, unsigned int outLen);
 
+#define SS58_BLAKE_PREFIX     "SS58PRE"
+#define SS58_BLAKE_PREFIX_LEN 7
+#define SS58_CHECKSUM_LEN     2
+#define SS58_PREFIX_MAX_LEN   2
+
+/// Writes the SS58 prefix of addressType in prefixBytes
+/// \return the number of prefix bytes, 0 when addressType cannot be encoded
+uint8_t crypto_SS58CalculatePrefix(uint16_t addressType, uint8_t *prefixBytes);
+
+/// Encodes a 32-byte public key as an SS58 address, zero terminated
+/// \return length of the address, 0 on error
+uint16_t crypto_SS58EncodePubkey(uint8_t *buffer, uint16_t bufferLen, uint16_t addressType, const uint8_t *pubkey);
+
 #ifdef __cplusplus
 }
 #endif
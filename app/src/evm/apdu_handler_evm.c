@@ -18,12 +18,26 @@
 
 #include "actions.h"
 #include "app_main.h"
+#include "buffering.h"
 #include "coin_evm.h"
 #include "crypto_evm.h"
 #include "crypto_helper.h"
+#include "cx.h"
 #include "evm_addr.h"
+#include "evm_batch.h"
 #include "evm_eip191.h"
+#include "evm_eip191_batch.h"
+#include "evm_eip712.h"
+#include "evm_multipath.h"
+#include "evm_erc20_cache.h"
+#include "evm_policy.h"
+#include "evm_profile.h"
+#include "evm_sig_cache.h"
+#include "evm_stream.h"
 #include "evm_utils.h"
+#include "parser_evm.h"
+#include "parser_impl_evm.h"
+#include "session.h"
 #include "tx_evm.h"
 #include "view.h"
 #include "view_internal.h"
@@ -32,9 +46,146 @@
 static bool tx_initialized = false;
 static uint32_t bytes_to_read = 0;
 
+// Envelope decoded from the first chunk of a transaction; continuation chunks
+// only have to count bytes against it instead of re-reading the stored buffer.
+static uint8_t tx_envelope_type = 0;
+static uint8_t tx_envelope_header_len = 0;
+static uint64_t tx_envelope_total_len = 0;
+
+// Running Keccak-256 of the transaction bytes accepted so far. The digest is
+// finalized together with the last chunk so signing only has to run ECDSA.
+#define tx_keccak (session_arena.views.evm.keccak)
+
+// Transactions larger than the buffer are streamed: only a calldata prefix is stored
+#define tx_stream (session_arena.views.evm.stream)
+static bool tx_streaming = false;
+
+// Progress of an INS_SIGN_ETH upload, reported to hosts resuming it after an interruption
+static bool tx_upload_eth = false;
+static uint32_t tx_upload_received = 0;
+static uint16_t tx_upload_chunks = 0;
+static uint8_t tx_upload_ttl = 0;
+// Set when another flow took the arena in the middle of an upload, cleared by the next first chunk
+static bool tx_upload_evicted = false;
+
 void reset_evm_chunk_state(void) {
     tx_initialized = false;
     bytes_to_read = 0;
+    tx_envelope_type = 0;
+    tx_envelope_header_len = 0;
+    tx_envelope_total_len = 0;
+    tx_streaming = false;
+    tx_upload_eth = false;
+    tx_upload_received = 0;
+    tx_upload_chunks = 0;
+    tx_upload_ttl = 0;
+}
+
+void evm_upload_error(uint32_t rx, uint16_t sw) {
+    // both are thrown before a chunk is absorbed, or before the command is even dispatched
+    const bool framing = sw == APDU_CODE_WRONG_LENGTH || sw == APDU_CODE_INVALIDP1P2;
+    const bool continuation = rx < OFFSET_DATA || (G_io_apdu_buffer[OFFSET_CLA] == CLA_ETH &&
+                                                   G_io_apdu_buffer[OFFSET_INS] == INS_SIGN_ETH &&
+                                                   G_io_apdu_buffer[OFFSET_P1] != P1_ETH_FIRST);
+    if (framing && continuation) {
+        return;
+    }
+    reset_evm_chunk_state();
+}
+
+void evm_upload_tick(void) {
+    if (!tx_initialized || !tx_upload_eth) {
+        return;
+    }
+    tx_upload_ttl--;
+    if (tx_upload_ttl == 0) {
+        reset_evm_chunk_state();
+    }
+}
+
+static void tx_upload_accept(uint32_t len) {
+    tx_upload_eth = true;
+    tx_upload_received += len;
+    tx_upload_chunks++;
+    tx_upload_ttl = ETH_UPLOAD_TTL_COMMANDS;
+}
+
+// The Keccak and stream state live in the arena: an upload cannot go on without them
+static void tx_upload_evict(void) {
+    tx_upload_evicted = tx_initialized && tx_upload_eth;
+    reset_evm_chunk_state();
+}
+
+static void tx_keccak_start(void) {
+    session_claim(session_flow_evm);
+    session_on_evict(session_flow_evm, tx_upload_evict);
+    tx_upload_evicted = false;
+    tx_reset_upload_eth();
+    if (cx_keccak_init_no_throw(&tx_keccak, KECCAK_256_SIZE * 8) != CX_OK) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+}
+
+static void tx_keccak_absorb(const uint8_t *data, uint32_t len) {
+    if (len == 0) {
+        return;
+    }
+    PROFILE_COUNT_HASH(len);
+    if (cx_hash_no_throw((cx_hash_t *)&tx_keccak, 0, data, len, NULL, 0) != CX_OK) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+}
+
+static void tx_keccak_finish(void) {
+    uint8_t digest[KECCAK_256_SIZE] = {0};
+    if (cx_hash_no_throw((cx_hash_t *)&tx_keccak, CX_LAST, NULL, 0, digest, sizeof(digest)) != CX_OK) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+    tx_set_digest_eth(digest);
+}
+
+// Appends to the upload buffer; testing builds also count the bytes that land in flash
+static uint32_t tx_append_eth(const uint8_t *data, uint32_t len) {
+#if defined(APP_TESTING)
+    const buffer_state_t *flash = buffering_get_flash_buffer();
+    const uint32_t flashBefore = flash->in_use ? flash->pos : 0;
+    const uint32_t added = tx_append((unsigned char *)data, len);
+    if (flash->in_use) {
+        PROFILE_COUNT_NVM((uint32_t)(flash->pos - flashBefore));
+    }
+    return added;
+#else
+    return tx_append((unsigned char *)data, len);
+#endif
+}
+
+static uint32_t tx_stream_sink(const uint8_t *data, uint32_t len) {
+    return tx_append_eth(data, len);
+}
+
+// Writes the bytes still staged for flash once the last chunk is in, so the upload can be read back
+static bool tx_upload_complete(void) {
+    if (!tx_flush()) {
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+    return true;
+}
+
+// Feeds list payload bytes to the streaming decoder; returns true once the transaction is complete
+static bool tx_stream_feed(const uint8_t *data, uint32_t len) {
+    uint32_t consumed = 0;
+    if (evm_stream_feed(&tx_stream, data, len, &consumed) != parser_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    tx_keccak_absorb(data, consumed);
+    tx_upload_received += consumed;
+
+    if (!evm_stream_complete(&tx_stream)) {
+        return false;
+    }
+    tx_keccak_finish();
+    tx_set_streamed_eth(tx_stream.dataLen);
+    return tx_upload_complete();
 }
 
 void extract_eth_path(uint32_t rx, uint32_t offset) {
@@ -71,10 +222,63 @@ void extract_eth_path(uint32_t rx, uint32_t offset) {
     hdPathEth_len = path_len;
 }
 
-bool process_chunk_eip191(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
+// Reads the path, or the path list of a multi path upload, at the start of a first chunk
+// \return the number of bytes it takes
+static uint32_t extract_first_chunk_paths(uint32_t rx) {
+    eth_multipath_reset();
+    if (G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_MULTI) {
+        extract_eth_path(rx, OFFSET_DATA);
+        peaq_sig_format = G_io_apdu_buffer[OFFSET_P2];
+        return 1 + sizeof(uint32_t) * hdPathEth_len;
+    }
+
+    tx_initialized = false;
+    uint32_t consumed = 0;
+    if (eth_multipath_parse(G_io_apdu_buffer + OFFSET_DATA, rx - OFFSET_DATA, &consumed) != parser_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    // the review lists the address of every account
+    uint8_t pubKey[PK_LEN_SECP256K1_UNCOMPRESSED] = {0};
+    uint8_t address[ETH_ADDR_LEN] = {0};
+    uint8_t chainCode[32] = {0};
+    zxerr_t err = zxerr_ok;
+    for (uint8_t i = 0; i < eth_multipath_count() && err == zxerr_ok; i++) {
+        eth_multipath_path(i, hdPathEth, &hdPathEth_len);
+        err = crypto_getEthPublicData(pubKey, address, chainCode);
+        eth_multipath_set_address(i, address);
+    }
+    MEMZERO(pubKey, sizeof(pubKey));
+    MEMZERO(chainCode, sizeof(chainCode));
+    if (err != zxerr_ok) {
+        eth_multipath_reset();
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+    eth_multipath_path(0, hdPathEth, &hdPathEth_len);
+    peaq_sig_format = P2_ETH_SIG_COMPACT;
+    return consumed;
+}
+
+// Hashes a message chunk and stores the part of it that is shown, or all of it with keepAll
+static void eip191_ingest(const uint8_t *data, uint32_t len, bool keepAll) {
+    uint32_t keep = 0;
+    if (eip191_stream_absorb(data, len, &keep) != zxerr_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    if (keepAll) {
+        keep = len;
+    }
+    PROFILE_COUNT_HASH(len);
+    if (tx_append_eth(data, keep) != keep) {
+        THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+    }
+    bytes_to_read -= len;
+}
+
+bool process_chunk_eip191(__Z_UNUSED volatile uint32_t *tx, uint32_t rx, bool keepAll) {
     const uint8_t payloadType = G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE];
 
-    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+    if (G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_DER && G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_COMPACT &&
+        G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_MULTI) {
         THROW(APDU_CODE_INVALIDP1P2);
     }
 
@@ -84,38 +288,33 @@ bool process_chunk_eip191(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
 
     uint8_t *data = &(G_io_apdu_buffer[OFFSET_DATA]);
     uint32_t len = rx - OFFSET_DATA;
-    uint64_t added = 0;
     switch (payloadType) {
         case P1_ETH_FIRST:
             tx_initialize();
             tx_reset();
-            extract_eth_path(rx, OFFSET_DATA);
+            tx_reset_upload_eth();
+            tx_upload_eth = false;
             // there is not warranties that the first chunk
             // contains the serialized path only;
-            // so we need to offset the data to point to the first transaction
-            // byte
-            uint32_t path_len = sizeof(uint32_t) * hdPathEth_len;
-
-            // plus the first offset data containing the path len
-            data += path_len + 1;
+            // so we need to offset the data to point to the first message byte
+            const uint32_t paths_len = extract_first_chunk_paths(rx);
+            data += paths_len;
             // Require the path bytes AND the 4-byte length prefix that U4BE reads next.
-            if (len < path_len + 1 + sizeof(uint32_t)) {
+            if (len < paths_len + sizeof(uint32_t)) {
                 THROW(APDU_CODE_WRONG_LENGTH);
             }
-            len -= path_len + 1;
+            len -= paths_len;
 
             // now process the chunk
             bytes_to_read = U4BE(data, 0);
-            bytes_to_read -= len - sizeof(uint32_t);
-            added = tx_append(data + sizeof(uint32_t), len - sizeof(uint32_t));
-
-            if (added != len - sizeof(uint32_t)) {
-                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
+            if (eip191_stream_start(bytes_to_read) != zxerr_ok) {
+                THROW(APDU_CODE_EXECUTION_ERROR);
             }
+            eip191_ingest(data + sizeof(uint32_t), len - sizeof(uint32_t), keepAll);
             tx_initialized = true;
 
             if (bytes_to_read == 0) {
-                return true;
+                return tx_upload_complete();
             }
 
             return false;
@@ -124,16 +323,11 @@ bool process_chunk_eip191(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
                 THROW(APDU_CODE_TX_NOT_INITIALIZED);
             }
 
-            // either the entire buffer of the remaining bytes we expect
-            bytes_to_read -= len;
-            added = tx_append(data, len);
-            if (added != len) {
-                THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
-            }
+            eip191_ingest(data, len, keepAll);
 
             // check if this chunk was the last one
             if (bytes_to_read == 0) {
-                return true;
+                return tx_upload_complete();
             }
 
             return false;
@@ -142,10 +336,23 @@ bool process_chunk_eip191(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
     return false;
 }
 
-bool process_chunk_eth(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
+// Replies with the parser error message; blind signing errors are also shown on screen
+static void reject_tx_eth(volatile uint32_t *flags, volatile uint32_t *tx, const char *error_msg, uint8_t error_code) {
+    const int error_msg_length = strnlen(error_msg, sizeof(G_io_apdu_buffer));
+    MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
+    *tx += (error_msg_length);
+    if (error_code == parser_blindsign_mode_required) {
+        *flags |= IO_ASYNCH_REPLY;
+        view_blindsign_error_show();
+    }
+    THROW(APDU_CODE_DATA_INVALID);
+}
+
+bool process_chunk_eth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     const uint8_t payloadType = G_io_apdu_buffer[OFFSET_PAYLOAD_TYPE];
 
-    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+    if (G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_DER && G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_COMPACT &&
+        G_io_apdu_buffer[OFFSET_P2] != P2_ETH_SIG_MULTI) {
         THROW(APDU_CODE_INVALIDP1P2);
     }
 
@@ -165,74 +372,102 @@ bool process_chunk_eth(__Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
         case P1_ETH_FIRST:
             tx_initialize();
             tx_reset();
-            extract_eth_path(rx, OFFSET_DATA);
+            tx_keccak_start();
             // there is not warranties that the first chunk
             // contains the serialized path only;
             // so we need to offset the data to point to the first transaction
             // byte
-            uint32_t path_len = sizeof(uint32_t) * hdPathEth_len;
-
-            // plus the first offset data containing the path len
-            data += path_len + 1;
+            const uint32_t paths_len = extract_first_chunk_paths(rx);
+            data += paths_len;
             // The guard must match the subtraction below; len < path_len previously
             // allowed len == path_len through, and the subtraction wrapped to ~UINT32_MAX.
-            if (len < path_len + 1) {
+            if (len < paths_len) {
                 THROW(APDU_CODE_WRONG_LENGTH);
             }
 
             // now process the chunk
-            len -= path_len + 1;
+            len -= paths_len;
+
+            // reject what can already be rejected instead of waiting for the whole upload
+            uint8_t error_code = 0;
+            const char *error_msg = tx_precheck_eth(data, len, &error_code);
+            if (error_msg != NULL) {
+                reject_tx_eth(flags, tx, error_msg, error_code);
+            }
+
             if (get_tx_rlp_len(data, len, &read, &to_read) != rlp_ok) {
                 THROW(APDU_CODE_DATA_INVALID);
             }
 
-            // get remaining data len
-            max_len = saturating_add(read, to_read);
-            max_len = MIN(max_len, len);
+            tx_envelope_type = (read > 1) && data[0] < legacy && eth_tx_schema(data[0]) != NULL ? data[0] : 0;
+            tx_envelope_header_len = (uint8_t)read;
+            tx_envelope_total_len = saturating_add(read, to_read);
+
+            if (tx_envelope_total_len > tx_get_buffer_capacity()) {
+                // too large to buffer: the first chunk must carry the whole envelope
+                if (read > len) {
+                    THROW(APDU_CODE_WRONG_LENGTH);
+                }
+                if (evm_stream_start(&tx_stream, tx_envelope_type, to_read, tx_stream_sink) != parser_ok) {
+                    THROW(APDU_CODE_DATA_INVALID);
+                }
+                tx_streaming = true;
+                tx_initialized = true;
+                tx_upload_received = 0;
+                tx_upload_chunks = 0;
+                tx_upload_accept(tx_envelope_header_len);
+                tx_keccak_absorb(data, tx_envelope_header_len);
+                return tx_stream_feed(data + read, len - tx_envelope_header_len);
+            }
+
+            // bytes past the end of the transaction are ignored
+            max_len = MIN(tx_envelope_total_len, len);
 
-            added = tx_append(data, max_len);
+            added = tx_append_eth(data, max_len);
             if (added != max_len) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            tx_keccak_absorb(data, max_len);
 
             tx_initialized = true;
+            tx_upload_received = 0;
+            tx_upload_chunks = 0;
+            tx_upload_accept((uint32_t)max_len);
+            bytes_to_read = (uint32_t)(tx_envelope_total_len - max_len);
 
-            // if the number of bytes read and the number of bytes to read
-            //  is the same as what we read...
-            if ((saturating_add(read, to_read) - len) == 0) {
-                return true;
+            if (bytes_to_read == 0) {
+                tx_keccak_finish();
+                return tx_upload_complete();
             }
             return false;
         case P1_ETH_MORE:
-            if (!tx_initialized) {
+            if (tx_upload_evicted) {
+                THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+            }
+            if (!tx_initialized || !tx_upload_eth) {
                 THROW(APDU_CODE_TX_NOT_INITIALIZED);
             }
 
-            uint64_t buff_len = tx_get_buffer_length();
-            uint8_t *buff_data = tx_get_buffer();
-
-            if (get_tx_rlp_len(buff_data, buff_len, &read, &to_read) != rlp_ok) {
-                THROW(APDU_CODE_DATA_INVALID);
+            if (tx_streaming) {
+                tx_upload_accept(0);
+                return tx_stream_feed(data, len);
             }
 
-            uint64_t rlp_read = buff_len - read;
-
-            // either the entire buffer of the remaining bytes we expect
-            uint64_t missing = to_read - rlp_read;
-            max_len = len;
-
-            if (missing < len) {
-                max_len = missing;
-            }
-            added = tx_append(data, max_len);
+            // either the entire chunk or the remaining bytes we expect
+            max_len = MIN(bytes_to_read, len);
+            added = tx_append_eth(data, max_len);
 
             if (added != max_len) {
                 THROW(APDU_CODE_OUTPUT_BUFFER_TOO_SMALL);
             }
+            tx_keccak_absorb(data, max_len);
+            tx_upload_accept((uint32_t)max_len);
+            bytes_to_read -= (uint32_t)max_len;
 
             // check if this chunk was the last one
-            if (missing - len == 0) {
-                return true;
+            if (bytes_to_read == 0) {
+                tx_keccak_finish();
+                return tx_upload_complete();
             }
 
             return false;
@@ -270,9 +505,130 @@ void handleGetAddrEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t
     THROW(APDU_CODE_OK);
 }
 
+void handleGetAddrBatchEth(__Z_UNUSED volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log("handleGetAddrBatchEth\n");
+    if (G_io_apdu_buffer[OFFSET_P1] != 0 || G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    // [path] [start index (4, BE)] [count (1)]; start replaces the last path element
+    extract_eth_path(rx, OFFSET_DATA);
+    const uint32_t args_offset = OFFSET_DATA + 1 + sizeof(uint32_t) * hdPathEth_len;
+    if (rx < args_offset + sizeof(uint32_t) + 1) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    const uint32_t start = U4BE(G_io_apdu_buffer, args_offset);
+    uint8_t count = G_io_apdu_buffer[args_offset + sizeof(uint32_t)];
+    if (count == 0) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    count = MIN(count, ETH_ADDR_BATCH_MAX);
+
+    // only non-hardened address indexes can be enumerated
+    if ((start & 0x80000000u) != 0 || ((start + count - 1) & 0x80000000u) != 0) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+    uint8_t pubKey[PK_LEN_SECP256K1_UNCOMPRESSED] = {0};
+    uint8_t chainCode[32] = {0};
+    zxerr_t err = zxerr_ok;
+
+    for (uint8_t i = 0; i < count && err == zxerr_ok; i++) {
+        hdPathEth[hdPathEth_len - 1] = start + i;
+        err = crypto_getEthPublicData(pubKey, G_io_apdu_buffer + (i * ETH_ADDR_LEN), chainCode);
+    }
+    MEMZERO(pubKey, sizeof(pubKey));
+    MEMZERO(chainCode, sizeof(chainCode));
+
+    if (err != zxerr_ok) {
+        MEMZERO(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE);
+        *tx = 0;
+        THROW(APDU_CODE_EXECUTION_ERROR);
+    }
+
+    *tx = count * ETH_ADDR_LEN;
+    THROW(APDU_CODE_OK);
+}
+
+void handleGetXpubEth(volatile uint32_t *flags, __Z_UNUSED volatile uint32_t *tx, uint32_t rx) {
+    zemu_log("handleGetXpubEth\n");
+    if (G_io_apdu_buffer[OFFSET_P1] != 0 || G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    extract_eth_path(rx, OFFSET_DATA);
+
+    // only account level keys (m/44'/60'/account') can be exported
+    if (hdPathEth_len != ETH_XPUB_PATH_LEN || (hdPathEth[ETH_XPUB_PATH_LEN - 1] & 0x80000000u) == 0) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    app_fill_eth_xpub();
+
+    // exporting the chain code reveals every child address: always ask
+    view_review_init(eth_xpub_getItem, eth_xpub_getNumItems, app_reply_address);
+    set_review_pending(true);
+    view_review_show(REVIEW_ADDRESS);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+// [in progress (1)] [transaction bytes received (4)] [chunks accepted (2)], big-endian
+static void handle_upload_status_eth(volatile uint32_t *tx, uint32_t rx) {
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx != OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    const bool inProgress = tx_initialized && tx_upload_eth;
+    const uint32_t received = inProgress ? tx_upload_received : 0;
+    const uint16_t chunks = inProgress ? tx_upload_chunks : 0;
+
+    uint8_t *out = G_io_apdu_buffer;
+    out[0] = inProgress ? 1 : 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        out[1 + i] = (uint8_t)(received >> (24 - 8 * i));
+    }
+    out[5] = (uint8_t)(chunks >> 8);
+    out[6] = (uint8_t)chunks;
+    *tx = 7;
+    THROW(APDU_CODE_OK);
+}
+
+static void handle_path_signatures(volatile uint32_t *tx, uint32_t rx) {
+    // [first path index (1)]
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx != OFFSET_DATA + 1) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    if (eth_multipath_digest() == NULL) {
+        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+    }
+    uint16_t replyLen = 0;
+    if (app_fill_multipath_signatures(G_io_apdu_buffer[OFFSET_DATA], &replyLen) != zxerr_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    *tx = replyLen;
+    THROW(APDU_CODE_OK);
+}
+
 void handleSignEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     zemu_log_stack("handleSignEth");
-    if (!process_chunk_eth(tx, rx)) {
+    if (G_io_apdu_buffer[OFFSET_P1] == P1_ETH_UPLOAD_STATUS) {
+        handle_upload_status_eth(tx, rx);
+    }
+    if (G_io_apdu_buffer[OFFSET_P1] == P1_ETH_PATH_SIGNATURES) {
+        handle_path_signatures(tx, rx);
+    }
+    eth_multipath_revoke();
+    PROFILE_BEGIN(profile_phase_ingest);
+    const bool complete = process_chunk_eth(flags, tx, rx);
+    PROFILE_END(profile_phase_ingest);
+    if (!complete) {
         THROW(APDU_CODE_OK);
     }
     // Full tx assembled; close the chunking session before parse/review.
@@ -284,14 +640,35 @@ void handleSignEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx)
     CHECK_APP_CANARY()
 
     if (error_msg != NULL) {
-        const int error_msg_length = strnlen(error_msg, sizeof(G_io_apdu_buffer));
-        MEMCPY(G_io_apdu_buffer, error_msg, error_msg_length);
-        *tx += (error_msg_length);
-        if (error_code == parser_blindsign_mode_required) {
-            *flags |= IO_ASYNCH_REPLY;
-            view_blindsign_error_show();
+        reject_tx_eth(flags, tx, error_msg, error_code);
+    }
+
+    // several accounts: reviewed once with the accounts listed, neither cached nor covered by a policy
+    if (eth_multipath_count() > 0) {
+        eth_multipath_review(tx_getItemEth, tx_getNumItemsEth);
+        view_review_init(eth_multipath_getItem, eth_multipath_getNumItems, app_sign_multipath_eth);
+        set_review_pending(true);
+        view_review_show(REVIEW_TXN);
+        *flags |= IO_ASYNCH_REPLY;
+        return;
+    }
+
+    // the same transaction again, after its reply was lost: already approved
+    uint16_t replyLen = 0;
+    if (sig_cache_lookup(hdPathEth, (uint8_t)hdPathEth_len, peaq_sig_format, tx_get_digest_eth(), G_io_apdu_buffer,
+                         IO_APDU_BUFFER_SIZE - 2, &replyLen)) {
+        *tx = replyLen;
+        THROW(APDU_CODE_OK);
+    }
+    sig_cache_flush();
+
+    // covered by the policy approved earlier in the session: signed without a review
+    if (tx_policy_match_eth()) {
+        if (app_sign_eth_policy(&replyLen) != zxerr_ok) {
+            THROW(APDU_CODE_SIGN_VERIFY_ERROR);
         }
-        THROW(APDU_CODE_DATA_INVALID);
+        *tx = replyLen;
+        THROW(APDU_CODE_OK);
     }
 
     CHECK_APP_CANARY()
@@ -301,13 +678,81 @@ void handleSignEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx)
     *flags |= IO_ASYNCH_REPLY;
 }
 
+void handleSignBatchEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleSignBatchEth");
+    if (G_io_apdu_buffer[OFFSET_P1] == P1_ETH_BATCH_SIGNATURES) {
+        // [first transaction index (1)]
+        if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+            THROW(APDU_CODE_INVALIDP1P2);
+        }
+        if (rx != OFFSET_DATA + 1) {
+            THROW(APDU_CODE_WRONG_LENGTH);
+        }
+        if (!tx_batch_approved_eth()) {
+            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+        }
+        uint16_t replyLen = 0;
+        if (app_fill_batch_signatures_eth(G_io_apdu_buffer[OFFSET_DATA], &replyLen) != zxerr_ok) {
+            THROW(APDU_CODE_DATA_INVALID);
+        }
+        *tx = replyLen;
+        THROW(APDU_CODE_OK);
+    }
+
+    // transactions are uploaded back to back, with the same framing as EIP-191 messages
+    tx_set_batch_approved_eth(false);
+    if (G_io_apdu_buffer[OFFSET_P2] == P2_ETH_SIG_MULTI) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    PROFILE_BEGIN(profile_phase_ingest);
+    // every transaction is parsed and signed, so the upload is stored in full
+    const bool complete = process_chunk_eip191(tx, rx, true);
+    PROFILE_END(profile_phase_ingest);
+    // refused on the first chunk, before the host uploads the rest
+    if (eip191_msg_info()->length > ETH_BATCH_MAX_BYTES) {
+        reset_evm_chunk_state();
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    if (!complete) {
+        THROW(APDU_CODE_OK);
+    }
+    reset_evm_chunk_state();
+    if (!eip191_stream_complete() || tx_get_buffer_length() != eip191_msg_info()->length) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    CHECK_APP_CANARY()
+    uint8_t error_code = 0;
+    const char *error_msg = tx_parse_batch_eth(&error_code);
+    CHECK_APP_CANARY()
+
+    if (error_msg != NULL) {
+        reject_tx_eth(flags, tx, error_msg, error_code);
+    }
+
+    view_review_init(tx_getItemBatchEth, tx_getNumItemsBatchEth, app_sign_batch_eth);
+    set_review_pending(true);
+    view_review_show(REVIEW_TXN);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
 void handleSignEip191(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
     zemu_log_stack("handleSignEip191");
-    if (!process_chunk_eip191(tx, rx)) {
+    if (G_io_apdu_buffer[OFFSET_P1] == P1_ETH_PATH_SIGNATURES) {
+        handle_path_signatures(tx, rx);
+    }
+    eth_multipath_revoke();
+    PROFILE_BEGIN(profile_phase_ingest);
+    const bool complete = process_chunk_eip191(tx, rx, false);
+    PROFILE_END(profile_phase_ingest);
+    if (!complete) {
         THROW(APDU_CODE_OK);
     }
-    // Full message assembled; close the chunking session before parse/review.
+    // Full message received; close the chunking session before parse/review.
     reset_evm_chunk_state();
+    if (!eip191_stream_complete()) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
 
     CHECK_APP_CANARY()
     if (!eip191_msg_parse()) {
@@ -317,8 +762,239 @@ void handleSignEip191(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t
     }
     CHECK_APP_CANARY()
 
-    view_review_init(eip191_msg_getItem, eip191_msg_getNumItems, app_sign_eip191);
+    if (eth_multipath_count() > 0) {
+        eth_multipath_review(eip191_msg_getItem, eip191_msg_getNumItems);
+        view_review_init(eth_multipath_getItem, eth_multipath_getNumItems, app_sign_multipath_eip191);
+    } else {
+        view_review_init(eip191_msg_getItem, eip191_msg_getNumItems, app_sign_eip191);
+    }
+    set_review_pending(true);
+    view_review_show(REVIEW_TXN);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+void handleSignBatchEip191(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleSignBatchEip191");
+    if (G_io_apdu_buffer[OFFSET_P1] == P1_ETH_BATCH_SIGNATURES) {
+        // [first message index (1)]
+        if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+            THROW(APDU_CODE_INVALIDP1P2);
+        }
+        if (rx != OFFSET_DATA + 1) {
+            THROW(APDU_CODE_WRONG_LENGTH);
+        }
+        if (!eip191_batch_approved()) {
+            THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+        }
+        uint16_t replyLen = 0;
+        if (app_fill_batch_signatures_eip191(G_io_apdu_buffer[OFFSET_DATA], &replyLen) != zxerr_ok) {
+            THROW(APDU_CODE_DATA_INVALID);
+        }
+        *tx = replyLen;
+        THROW(APDU_CODE_OK);
+    }
+
+    // the length-prefixed list travels as one EIP-191 payload
+    eip191_batch_set_approved(false);
+    if (G_io_apdu_buffer[OFFSET_P2] == P2_ETH_SIG_MULTI) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    PROFILE_BEGIN(profile_phase_ingest);
+    const bool complete = process_chunk_eip191(tx, rx, false);
+    PROFILE_END(profile_phase_ingest);
+    if (!complete) {
+        THROW(APDU_CODE_OK);
+    }
+    reset_evm_chunk_state();
+    // every message is shown, so the list has to be kept in full
+    if (!eip191_stream_complete() || eip191_msg_info()->truncated) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+
+    CHECK_APP_CANARY()
+    const parser_error_t err = eip191_batch_parse(tx_get_buffer(), tx_get_buffer_length());
+    CHECK_APP_CANARY()
+
+    if (err != parser_ok) {
+        reject_tx_eth(flags, tx, parser_getErrorDescription(err), err);
+    }
+
+    view_review_init(eip191_batch_getItem, eip191_batch_getNumItems, app_sign_batch_eip191);
+    set_review_pending(true);
+    view_review_show(REVIEW_TXN);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+void handleProvideErc20Info(__Z_UNUSED volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleProvideErc20Info");
+    if (G_io_apdu_buffer[OFFSET_P1] != 0 || G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx <= OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    const uint8_t *data = G_io_apdu_buffer + OFFSET_DATA;
+    const uint16_t dataLen = (uint16_t)(rx - OFFSET_DATA);
+
+    erc20_descriptor_t descriptor = {0};
+    uint16_t signedLen = 0;
+    if (erc20_descriptor_parse(data, dataLen, &descriptor, &signedLen) != parser_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    // the descriptor is only trusted when signed by the token list key
+    if (crypto_verify_erc20_descriptor(data, signedLen, data + signedLen, dataLen - signedLen) != zxerr_ok) {
+        THROW(APDU_CODE_DATA_INVALID);
+    }
+    erc20_cache_insert(&descriptor);
+
+    *tx = 0;
+    THROW(APDU_CODE_OK);
+}
+
+void handleSetPolicyEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleSetPolicyEth");
+    if (G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    switch (G_io_apdu_buffer[OFFSET_P1]) {
+        case P1_ETH_POLICY_SET:
+            break;
+        case P1_ETH_POLICY_CLEAR:
+            if (rx != OFFSET_DATA) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            eth_policy_clear();
+            *tx = 0;
+            THROW(APDU_CODE_OK);
+        case P1_ETH_POLICY_STATUS: {
+            // [signatures left (2)]
+            if (rx != OFFSET_DATA) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            const uint16_t remaining = eth_policy_remaining();
+            G_io_apdu_buffer[0] = (uint8_t)(remaining >> 8);
+            G_io_apdu_buffer[1] = (uint8_t)remaining;
+            *tx = 2;
+            THROW(APDU_CODE_OK);
+        }
+        default:
+            THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    // [path] [policy], a policy replaces the previous one only once approved
+    if (rx <= OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    extract_eth_path(rx, OFFSET_DATA);
+    const uint32_t policyOffset = OFFSET_DATA + 1 + sizeof(uint32_t) * hdPathEth_len;
+    const parser_error_t err = eth_policy_parse(G_io_apdu_buffer + policyOffset, (uint16_t)(rx - policyOffset),
+                                                hdPathEth, (uint8_t)hdPathEth_len);
+    if (err != parser_ok) {
+        reject_tx_eth(flags, tx, parser_getErrorDescription(err), err);
+    }
+
+    view_review_init(eth_policy_getItem, eth_policy_getNumItems, app_set_policy_eth);
+    set_review_pending(true);
+    view_review_show(REVIEW_TXN);
+    *flags |= IO_ASYNCH_REPLY;
+}
+
+static bool eip712_session = false;
+
+void reset_eip712_session(void) {
+    eip712_session = false;
+    eip712_release();
+}
+
+static void eip712_step(volatile uint32_t *flags, volatile uint32_t *tx, parser_error_t err) {
+    if (err != parser_ok) {
+        reset_eip712_session();
+        reject_tx_eth(flags, tx, parser_getErrorDescription(err), err);
+    }
+}
+
+void handleSignEip712Eth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log_stack("handleSignEip712Eth");
+    if (rx < OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+    const uint8_t p1 = G_io_apdu_buffer[OFFSET_P1];
+    const uint8_t *data = G_io_apdu_buffer + OFFSET_DATA;
+    const uint16_t dataLen = (uint16_t)(rx - OFFSET_DATA);
+
+    if (p1 == P1_EIP712_INIT) {
+        const uint8_t sigFormat = G_io_apdu_buffer[OFFSET_P2];
+        if (sigFormat != P2_ETH_SIG_DER && sigFormat != P2_ETH_SIG_COMPACT) {
+            THROW(APDU_CODE_INVALIDP1P2);
+        }
+        reset_eip712_session();
+        extract_eth_path(rx, OFFSET_DATA);
+        peaq_sig_format = sigFormat;
+        eip712_reset();
+        eip712_session = true;
+        THROW(APDU_CODE_OK);
+    }
+    if (!eip712_session) {
+        THROW(APDU_CODE_COMMAND_NOT_ALLOWED);
+    }
+
+    switch (p1) {
+        case P1_EIP712_STRUCT_DEF:
+            eip712_step(flags, tx, eip712_add_struct(data, dataLen));
+            break;
+        case P1_EIP712_START:
+            // [nameLen (1)] [name]
+            if (dataLen == 0 || dataLen != 1 + data[0]) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            eip712_step(flags, tx, eip712_start(data + 1, data[0]));
+            break;
+        case P1_EIP712_ARRAY:
+            if (dataLen != 1) {
+                THROW(APDU_CODE_WRONG_LENGTH);
+            }
+            eip712_step(flags, tx, eip712_set_array_len(data[0]));
+            break;
+        case P1_EIP712_VALUE:
+            if ((G_io_apdu_buffer[OFFSET_P2] & ~P2_EIP712_MORE) != 0) {
+                THROW(APDU_CODE_INVALIDP1P2);
+            }
+            eip712_step(flags, tx,
+                        eip712_feed_value(data, dataLen, (G_io_apdu_buffer[OFFSET_P2] & P2_EIP712_MORE) != 0));
+            break;
+        default:
+            THROW(APDU_CODE_INVALIDP1P2);
+    }
+
+    if (!eip712_is_complete()) {
+        THROW(APDU_CODE_OK);
+    }
+
+    CHECK_APP_CANARY()
+    eip712_session = false;
+    eip712_step(flags, tx, eip712_validate());
+
+    view_review_init(eip712_getItem, eip712_getNumItems, app_sign_eip712);
     set_review_pending(true);
     view_review_show(REVIEW_TXN);
     *flags |= IO_ASYNCH_REPLY;
 }
+
+#if defined(APP_TESTING)
+void handleGetProfileEth(__Z_UNUSED volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx) {
+    zemu_log("handleGetProfileEth\n");
+    const uint8_t p1 = G_io_apdu_buffer[OFFSET_P1];
+    if ((p1 != P1_PROFILE_READ && p1 != P1_PROFILE_READ_RESET) || G_io_apdu_buffer[OFFSET_P2] != 0) {
+        THROW(APDU_CODE_INVALIDP1P2);
+    }
+    if (rx != OFFSET_DATA) {
+        THROW(APDU_CODE_WRONG_LENGTH);
+    }
+
+    *tx = evm_profile_serialize(G_io_apdu_buffer, IO_APDU_BUFFER_SIZE - 2);
+    if (p1 == P1_PROFILE_READ_RESET) {
+        evm_profile_reset();
+    }
+    THROW(APDU_CODE_OK);
+}
+#endif
@@ -21,13 +21,35 @@ extern "C" {
 #include <stdint.h>
 
 void handleGetAddrEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleGetXpubEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleGetAddrBatchEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
 void handleSignEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleSignBatchEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
 void handleSignEip191(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleSignBatchEip191(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleProvideErc20Info(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleSignEip712Eth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+void handleSetPolicyEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+#if defined(APP_TESTING)
+void handleGetProfileEth(volatile uint32_t *flags, volatile uint32_t *tx, uint32_t rx);
+#endif
 
 // Clears the chunk-reassembly state (tx_initialized, bytes_to_read).
-// Called from the APDU dispatcher on any non-OK exit so a partial multi-chunk
-// session can never carry over into the next APDU.
+// Called through evm_upload_error on a failed command so a partial multi-chunk
+// session can never carry over past an error it was affected by.
 void reset_evm_chunk_state(void);
+
+// Called from the APDU dispatcher when a command fails. A truncated APDU, or an
+// INS_SIGN_ETH continuation refused for its length or P1/P2, leaves an unfinished
+// upload alone so the host can send the chunk again; any other error drops it.
+void evm_upload_error(uint32_t rx, uint16_t sw);
+
+// Counts a command other than INS_SIGN_ETH against an unfinished INS_SIGN_ETH
+// upload, which is dropped after ETH_UPLOAD_TTL_COMMANDS of them.
+void evm_upload_tick(void);
+
+// Drops a typed data upload; called when another instruction comes in.
+void reset_eip712_session(void);
 #ifdef __cplusplus
 }
 #endif
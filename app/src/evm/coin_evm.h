@@ -27,18 +27,72 @@ extern "C" {
 // transaction is sent as a blob of rlp encoded bytes,
 #define P1_ETH_FIRST 0x00
 #define P1_ETH_MORE  0x80
+// INS_SIGN_ETH: state of the upload in progress, to resume it after an interruption
+#define P1_ETH_UPLOAD_STATUS 0x01
+// commands other than INS_SIGN_ETH after which an unfinished upload is dropped
+#define ETH_UPLOAD_TTL_COMMANDS 16
 // eth address chain_code allowed valuec
 #define P2_NO_CHAINCODE           0x00
 #define P2_CHAINCODE              0x01
+// signature format of INS_SIGN_ETH, INS_SIGN_PERSONAL_MESSAGE and the EIP-712 init step
+#define P2_ETH_SIG_DER            0x00
+#define P2_ETH_SIG_COMPACT        0x01
+// INS_SIGN_ETH, INS_SIGN_PERSONAL_MESSAGE: the first chunk carries a path list, one v|r|s per path
+#define P2_ETH_SIG_MULTI          0x02
+// P1 to fetch the signatures of an approved multi path upload
+#define P1_ETH_PATH_SIGNATURES    0x02
 
 #define ETH_ADDR_LEN              20u
+#define ETH_XPUB_PATH_LEN         3
+#define ETH_CHAIN_CODE_LEN        32u
 #define SELECTOR_LENGTH           4
 #define BIGINT_LENGTH             32
 #define DATA_BYTES_TO_PRINT       10
+// calldata shown in full in expert mode; longer data keeps the preview
+#define DATA_BYTES_TO_PAGE        2048
 
 #define INS_SIGN_ETH              0x04
 #define INS_GET_ADDR_ETH          0x02
 #define INS_SIGN_PERSONAL_MESSAGE 0x08
+#define INS_PROVIDE_ERC20_INFO    0x0A
+#define INS_GET_ADDR_BATCH_ETH    0x40
+#define INS_GET_XPUB_ETH          0x42
+#define INS_SIGN_BATCH_ETH        0x44
+#define INS_SIGN_EIP712_ETH       0x46
+// only in APP_TESTING builds
+#define INS_GET_PROFILE_ETH       0x48
+
+// length-prefixed personal messages reviewed once, signatures fetched like a transaction batch
+#define INS_SIGN_BATCH_PERSONAL_MESSAGE 0x4C
+
+// signing policy reviewed once, INS_SIGN_ETH then signs the transactions it covers without a review
+#define INS_SET_POLICY_ETH              0x4E
+
+// INS_SET_POLICY_ETH: review a new policy, drop the active one or read how many signatures it has left
+#define P1_ETH_POLICY_SET         0x00
+#define P1_ETH_POLICY_CLEAR       0x01
+#define P1_ETH_POLICY_STATUS      0x02
+
+// INS_SIGN_BATCH_ETH, INS_SIGN_BATCH_PERSONAL_MESSAGE: P1 to fetch signatures of an approved batch
+#define P1_ETH_BATCH_SIGNATURES   0x01
+// packed v|r|s signatures that fit in one response next to the status word
+#define ETH_BATCH_SIGS_PER_PAGE   3
+
+// INS_SIGN_EIP712_ETH: one P1 per step of the typed data upload
+#define P1_EIP712_INIT            0x00
+#define P1_EIP712_STRUCT_DEF      0x01
+#define P1_EIP712_START           0x02
+#define P1_EIP712_ARRAY           0x03
+#define P1_EIP712_VALUE           0x04
+// P2 of P1_EIP712_VALUE: more parts of the same value follow
+#define P2_EIP712_MORE            0x01
+
+// INS_GET_PROFILE_ETH: read the counters, optionally clearing them afterwards
+#define P1_PROFILE_READ           0x00
+#define P1_PROFILE_READ_RESET     0x01
+
+// packed 20-byte addresses that fit in one response next to the status word
+#define ETH_ADDR_BATCH_MAX        12
 
 #define COIN_DECIMALS             18
 #define VIEW_ADDRESS_OFFSET_ETH   (SECP256K1_PK_LEN + 1 + 1)
@@ -19,6 +19,11 @@
 #include "coin_evm.h"
 #include "crypto_helper.h"
 #include "cx.h"
+#include "evm_profile.h"
+#include "evm_pubkey_cache.h"
+#include "hex_encode.h"
+#include "hexutils.h"
+#include "parser_evm.h"
 #include "tx_evm.h"
 #include "zxformat.h"
 #include "zxmacros.h"
@@ -27,6 +32,7 @@ uint32_t hdPathEth[HDPATH_LEN_DEFAULT];
 uint32_t hdPathEth_len;
 
 uint8_t peaq_chain_code;
+uint8_t peaq_sig_format = P2_ETH_SIG_DER;
 
 typedef struct {
     uint8_t r[32];
@@ -82,6 +88,52 @@ catch_cx_error:
     return error;
 }
 
+zxerr_t crypto_getEthPublicData(uint8_t *pubKey, uint8_t *address, uint8_t *chainCode) {
+    if (pubKey == NULL || address == NULL || chainCode == NULL) {
+        return zxerr_no_data;
+    }
+
+    if (pubkey_cache_lookup(hdPathEth, (uint8_t)hdPathEth_len, pubKey, address, chainCode)) {
+        return zxerr_ok;
+    }
+
+    CHECK_ZXERR(crypto_extractUncompressedPublicKey(pubKey, PK_LEN_SECP256K1_UNCOMPRESSED, chainCode))
+
+    // address is the last 20 bytes of the keccak of the public key (without the 0x04 prefix)
+    uint8_t hash[KECCAK_256_SIZE] = {0};
+    PROFILE_COUNT_HASH(PK_LEN_SECP256K1_UNCOMPRESSED - 1);
+    CHECK_ZXERR(keccak_digest(pubKey + 1, PK_LEN_SECP256K1_UNCOMPRESSED - 1, hash, KECCAK_256_SIZE))
+    MEMCPY(address, hash + KECCAK_256_SIZE - ETH_ADDR_LEN, ETH_ADDR_LEN);
+    MEMZERO(hash, sizeof(hash));
+
+    pubkey_cache_insert(hdPathEth, (uint8_t)hdPathEth_len, pubKey, address, chainCode);
+    return zxerr_ok;
+}
+
+// Minimal big endian encoding of a 32-byte integer; a zero byte keeps it positive
+static uint8_t encodeDERInteger(uint8_t *out, const uint8_t *value) {
+    uint8_t skip = 0;
+    while (skip < 31 && value[skip] == 0) {
+        skip++;
+    }
+    const uint8_t pad = (value[skip] & 0x80) ? 1 : 0;
+    out[0] = 0x02;
+    out[1] = (uint8_t)(32 - skip + pad);
+    out[2] = 0x00;
+    MEMCPY(out + 2 + pad, value + skip, 32 - skip);
+    return 2 + out[1];
+}
+
+// SEQUENCE { INTEGER r, INTEGER s }, built from r and s instead of asking the SDK for it
+static uint8_t encodeDER(uint8_t *out, const uint8_t *r, const uint8_t *s) {
+    uint8_t len = 2;
+    len += encodeDERInteger(out + len, r);
+    len += encodeDERInteger(out + len, s);
+    out[0] = 0x30;
+    out[1] = len - 2;
+    return len;
+}
+
 zxerr_t _sign(uint8_t *output, uint16_t outputLen, const uint8_t *message, uint16_t messageLen, uint16_t *sigSize,
               unsigned int *info) {
     if (output == NULL || message == NULL || sigSize == NULL || outputLen < sizeof(signature_t) ||
@@ -91,7 +143,6 @@ zxerr_t _sign(uint8_t *output, uint16_t outputLen, const uint8_t *message, uint1
 
     cx_ecfp_private_key_t cx_privateKey;
     uint8_t privateKeyData[SECP256K1_SK_LEN] = {0};
-    size_t signatureLength = sizeof_field(signature_t, der_signature);
     uint32_t tmpInfo = 0;
     *sigSize = 0;
 
@@ -102,19 +153,19 @@ zxerr_t _sign(uint8_t *output, uint16_t outputLen, const uint8_t *message, uint1
                                                      NULL, NULL, 0));
 
     CATCH_CXERROR(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1, privateKeyData, 32, &cx_privateKey));
-    CATCH_CXERROR(cx_ecdsa_sign_no_throw(&cx_privateKey, CX_RND_RFC6979 | CX_LAST, CX_SHA256, message, messageLen,
-                                         signature->der_signature, &signatureLength, &tmpInfo));
-
-    const err_convert_e err_c =
-        convertDERtoRSV(signature->der_signature, tmpInfo, signature->r, signature->s, &signature->v);
-    if (err_c == no_error) {
-        *sigSize =
-            sizeof_field(signature_t, r) + sizeof_field(signature_t, s) + sizeof_field(signature_t, v) + signatureLength;
-        if (info != NULL) {
-            *info = tmpInfo;
-        }
-        error = zxerr_ok;
+    // r and s come straight from the SDK, there is no DER signature to parse back
+    CATCH_CXERROR(cx_ecdsa_sign_rs_no_throw(&cx_privateKey, CX_RND_RFC6979 | CX_LAST, CX_SHA256, message, messageLen,
+                                            sizeof_field(signature_t, r), signature->r, signature->s, &tmpInfo));
+    signature->v = (tmpInfo & CX_ECCINFO_PARITY_ODD) ? 1 : 0;
+
+    *sigSize = sizeof_field(signature_t, r) + sizeof_field(signature_t, s) + sizeof_field(signature_t, v);
+    if (peaq_sig_format != P2_ETH_SIG_COMPACT) {
+        *sigSize += encodeDER(signature->der_signature, signature->r, signature->s);
+    }
+    if (info != NULL) {
+        *info = tmpInfo;
     }
+    error = zxerr_ok;
 
 catch_cx_error:
     MEMZERO(&cx_privateKey, sizeof(cx_privateKey));
@@ -127,15 +178,16 @@ catch_cx_error:
     return error;
 }
 
-// Sign an ethereum related transaction
-zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen,
-                        uint16_t *sigSize, bool hash) {
+// v|r|s signature of message, v from the parsed transaction or 27 + parity for a message signature
+static zxerr_t signEth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen,
+                       uint16_t *sigSize, bool hash, bool isMessage) {
     if (buffer == NULL || message == NULL || sigSize == NULL || signatureMaxlen < sizeof(signature_t)) {
         return zxerr_invalid_crypto_settings;
     }
 
     uint8_t message_digest[KECCAK_256_SIZE] = {0};
     if (hash) {
+        PROFILE_COUNT_HASH(messageLen);
         if (keccak_digest(message, messageLen, message_digest, KECCAK_256_SIZE) != zxerr_ok) {
             MEMZERO(message_digest, sizeof(message_digest));
             return zxerr_invalid_crypto_settings;
@@ -148,7 +200,9 @@ zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t
     }
 
     unsigned int info = 0;
+    PROFILE_BEGIN(profile_phase_sign);
     zxerr_t error = _sign(buffer, signatureMaxlen, message_digest, KECCAK_256_SIZE, sigSize, &info);
+    PROFILE_END(profile_phase_sign);
     MEMZERO(message_digest, sizeof(message_digest));
     if (error != zxerr_ok) {
         return zxerr_invalid_crypto_settings;
@@ -156,7 +210,11 @@ zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t
 
     // we need to fix V
     uint8_t v = 0;
-    error = tx_compute_eth_v(info, &v);
+    if (isMessage) {
+        v = parser_compute_message_v(info);
+    } else {
+        error = tx_compute_eth_v(info, &v);
+    }
 
     if (error != zxerr_ok) {
         return zxerr_invalid_crypto_settings;
@@ -171,6 +229,35 @@ zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t
     return error;
 }
 
+// Sign an ethereum related transaction
+zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen,
+                        uint16_t *sigSize, bool hash) {
+    return signEth(buffer, signatureMaxlen, message, messageLen, sigSize, hash, false);
+}
+
+zxerr_t crypto_sign_eth_message(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *digest, uint16_t *sigSize) {
+    return signEth(buffer, signatureMaxlen, digest, KECCAK_256_SIZE, sigSize, false, true);
+}
+
+zxerr_t crypto_fillEthXpub(uint8_t *buffer, uint16_t buffer_len, uint16_t *xpubLen) {
+    if (buffer == NULL || xpubLen == NULL || buffer_len < SECP256K1_PK_LEN_COMPRESSED + ETH_CHAIN_CODE_LEN) {
+        return zxerr_no_data;
+    }
+    MEMZERO(buffer, buffer_len);
+    *xpubLen = 0;
+
+    uint8_t pubKey[PK_LEN_SECP256K1_UNCOMPRESSED] = {0};
+    uint8_t address[ETH_ADDR_LEN] = {0};
+    CHECK_ZXERR(crypto_getEthPublicData(pubKey, address, buffer + SECP256K1_PK_LEN_COMPRESSED))
+
+    // SEC1 compression: parity of Y selects the prefix
+    buffer[0] = (pubKey[PK_LEN_SECP256K1_UNCOMPRESSED - 1] & 1) ? 0x03 : 0x02;
+    MEMCPY(buffer + 1, pubKey + 1, SECP256K1_PK_LEN_COMPRESSED - 1);
+
+    *xpubLen = SECP256K1_PK_LEN_COMPRESSED + ETH_CHAIN_CODE_LEN;
+    return zxerr_ok;
+}
+
 zxerr_t crypto_fillEthAddress(uint8_t *buffer, uint16_t buffer_len, uint16_t *addrLen) {
     if (buffer == NULL || buffer_len < sizeof(answer_eth_t) || addrLen == NULL) {
         return zxerr_no_data;
@@ -178,31 +265,58 @@ zxerr_t crypto_fillEthAddress(uint8_t *buffer, uint16_t buffer_len, uint16_t *ad
     MEMZERO(buffer, buffer_len);
     answer_eth_t *const answer = (answer_eth_t *)buffer;
 
-    // SDK writes 32 bytes when chain_code != NULL; skip with NULL otherwise.
-    uint8_t *const chain_code_out = (peaq_chain_code == P2_CHAINCODE) ? answer->chainCode : NULL;
-    CHECK_ZXERR(crypto_extractUncompressedPublicKey(&answer->publicKey[1], sizeof_field(answer_eth_t, publicKey) - 1,
-                                                    chain_code_out))
+    uint8_t address[ETH_ADDR_LEN] = {0};
+    uint8_t chainCode[sizeof_field(answer_eth_t, chainCode)] = {0};
+    CHECK_ZXERR(crypto_getEthPublicData(&answer->publicKey[1], address, chainCode))
 
     answer->publicKey[0] = SECP256K1_PK_LEN;
 
-    uint8_t hash[KECCAK_256_SIZE] = {0};
-
-    CHECK_ZXERR(keccak_digest(&answer->publicKey[2], SECP256K1_PK_LEN - 1, hash, KECCAK_256_SIZE))
-
     answer->address[0] = ETH_ADDR_LEN * 2;
 
     // get hex of the eth address(last 20 bytes of pubkey hash)
-    char str[41] = {0};
-
-    array_to_hexstr(str, 41, hash + 12, ETH_ADDR_LEN);
-
-    MEMCPY(answer->address + 1, str, 40);
+    hex_encode_window((char *)answer->address + 1, address, 0, ETH_ADDR_LEN * 2);
 
     *addrLen = sizeof_field(answer_eth_t, publicKey) + sizeof_field(answer_eth_t, address);
     if (peaq_chain_code == P2_CHAINCODE) {
+        MEMCPY(answer->chainCode, chainCode, sizeof(chainCode));
         *addrLen += sizeof_field(answer_eth_t, chainCode);
     }
 
-    MEMZERO(hash, sizeof(hash));
     return zxerr_ok;
 }
+
+// Set from the Makefile. Only testing builds fall back to the test key, whose private part is public;
+// other builds without a key reject every descriptor
+#if !defined(ERC20_SIGNER_PUBKEY) && defined(APP_TESTING)
+#define ERC20_SIGNER_PUBKEY                                                  \
+    "0429c59188eb57a6c8e8b17d0c5c2755efa9e90addf91972fb7f552d5891ddb7a3" \
+    "8ebf19d64fff5d54c432824c34d9949aefb74644e5c9ea4eed0c1ea08567e782"
+#endif
+
+zxerr_t crypto_verify_erc20_descriptor(const uint8_t *message, uint16_t messageLen, const uint8_t *signature,
+                                       uint16_t signatureLen) {
+    if (message == NULL || signature == NULL || messageLen == 0 || signatureLen == 0) {
+        return zxerr_no_data;
+    }
+
+#if defined(ERC20_SIGNER_PUBKEY)
+    uint8_t rawKey[PK_LEN_SECP256K1_UNCOMPRESSED] = {0};
+    if (parseHexString(rawKey, sizeof(rawKey), ERC20_SIGNER_PUBKEY) != sizeof(rawKey)) {
+        return zxerr_invalid_crypto_settings;
+    }
+
+    uint8_t digest[CX_SHA256_SIZE] = {0};
+    cx_hash_sha256(message, messageLen, digest, sizeof(digest));
+
+    cx_ecfp_public_key_t publicKey = {0};
+    if (cx_ecfp_init_public_key_no_throw(CX_CURVE_256K1, rawKey, sizeof(rawKey), &publicKey) != CX_OK) {
+        return zxerr_invalid_crypto_settings;
+    }
+    if (!cx_ecdsa_verify_no_throw(&publicKey, digest, sizeof(digest), signature, signatureLen)) {
+        return zxerr_unknown;
+    }
+    return zxerr_ok;
+#else
+    return zxerr_invalid_crypto_settings;
+#endif
+}
@@ -33,9 +33,32 @@ extern uint32_t hdPathEth_len;
 // the 32-byte BIP32 chain code to the address/pubkey payload.
 extern uint8_t peaq_chain_code;
 
+// P2 byte from the first chunk of a signing command: P2_ETH_SIG_COMPACT replies
+// with v|r|s only, P2_ETH_SIG_DER appends the DER encoding of r and s as well.
+extern uint8_t peaq_sig_format;
+
+// Public key (uncompressed, 65 bytes), address (20 bytes) and chain code (32 bytes)
+// for hdPathEth. Results are cached for the session.
+zxerr_t crypto_getEthPublicData(uint8_t *pubKey, uint8_t *address, uint8_t *chainCode);
+
+// Compressed public key (33 bytes) followed by the chain code (32 bytes) for hdPathEth
+zxerr_t crypto_fillEthXpub(uint8_t *buffer, uint16_t buffer_len, uint16_t *xpubLen);
+
+// Room needed by crypto_sign_eth: v|r|s (65 bytes) followed by the DER signature
+// unless peaq_sig_format is P2_ETH_SIG_COMPACT
+#define ETH_SIGNATURE_RSV_LEN 65u
+#define ETH_SIGNATURE_MAX_LEN (ETH_SIGNATURE_RSV_LEN + 73u)
+
+// Checks a DER signature of the token list key over sha256(message)
+zxerr_t crypto_verify_erc20_descriptor(const uint8_t *message, uint16_t messageLen, const uint8_t *signature,
+                                       uint16_t signatureLen);
+
 zxerr_t crypto_fillEthAddress(uint8_t *buffer, uint16_t buffer_len, uint16_t *addrLen);
 zxerr_t crypto_sign_eth(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *message, uint16_t messageLen,
                         uint16_t *sigSize, bool hash);
+// Signs the 32-byte digest of a personal message or typed data; v is 27 + parity and does not
+// depend on the last parsed transaction
+zxerr_t crypto_sign_eth_message(uint8_t *buffer, uint16_t signatureMaxlen, const uint8_t *digest, uint16_t *sigSize);
 #ifdef __cplusplus
 }
 #endif
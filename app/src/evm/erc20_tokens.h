@@ -0,0 +1,27 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+// Generated by app/tokens/gen_erc20_tokens.py from app/tokens/erc20.json, do not edit.
+// Sorted by contract address.
+#pragma once
+
+#include "evm_erc20.h"
+
+static const erc20_tokens_t supportedTokens[] = {
+    {{0xa8, 0x10, 0xac, 0xb7, 0xcc, 0xdc, 0x4e, 0xd8, 0x24, 0xb9,
+      0x52, 0xbe, 0x94, 0x0d, 0x63, 0x92, 0x43, 0x46, 0x72, 0xcf},
+     18,
+     "AGUS"},
+};
@@ -0,0 +1,262 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_abi.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zxmacros.h>
+
+#include "evm_erc20.h"
+#include "evm_utils.h"
+
+#define ABI_ADDRESS_PADDING 12
+#define ABI_UINT32_PADDING  28
+
+#define PEAQ_PRECOMPILE_DID     0x0800
+#define PEAQ_PRECOMPILE_STORAGE 0x0801
+
+// Selectors are the first 4 bytes of keccak256 of the method signature
+static const abi_method_t abi_methods[] = {
+    // approve(address,uint256)
+    {{0x09, 0x5e, 0xa7, 0xb3}, "Approve", 0, 2, {abi_arg_address, abi_arg_token_amount}, {"Spender", "Amount"}},
+    // transferFrom(address,address,uint256)
+    {{0x23, 0xb8, 0x72, 0xdd},
+     "Transfer from",
+     0,
+     3,
+     {abi_arg_address, abi_arg_address, abi_arg_token_amount},
+     {"From", "Receiver", "Amount"}},
+    // addAttribute(address,bytes,bytes,uint32)
+    {{0xcc, 0x4a, 0x70, 0xca},
+     "Add DID attribute",
+     PEAQ_PRECOMPILE_DID,
+     4,
+     {abi_arg_address, abi_arg_bytes, abi_arg_bytes, abi_arg_uint32},
+     {"DID account", "Name", "Value", "Valid for"}},
+    // updateAttribute(address,bytes,bytes,uint32)
+    {{0x68, 0xb4, 0xb2, 0xc1},
+     "Update DID attribute",
+     PEAQ_PRECOMPILE_DID,
+     4,
+     {abi_arg_address, abi_arg_bytes, abi_arg_bytes, abi_arg_uint32},
+     {"DID account", "Name", "Value", "Valid for"}},
+    // removeAttribute(address,bytes)
+    {{0xe8, 0xa8, 0x16, 0x90},
+     "Remove DID attribute",
+     PEAQ_PRECOMPILE_DID,
+     2,
+     {abi_arg_address, abi_arg_bytes},
+     {"DID account", "Name"}},
+    // addItem(bytes,bytes)
+    {{0x25, 0x7c, 0x3c, 0x03},
+     "Add storage item",
+     PEAQ_PRECOMPILE_STORAGE,
+     2,
+     {abi_arg_bytes, abi_arg_bytes},
+     {"Item type", "Item"}},
+    // updateItem(bytes,bytes)
+    {{0x1c, 0xd4, 0xbf, 0x09},
+     "Update storage item",
+     PEAQ_PRECOMPILE_STORAGE,
+     2,
+     {abi_arg_bytes, abi_arg_bytes},
+     {"Item type", "Item"}},
+};
+
+#define ABI_NUM_METHODS (sizeof(abi_methods) / sizeof(abi_methods[0]))
+
+static bool isZero(const uint8_t *ptr, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        if (ptr[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isPrecompile(const rlp_t *to, uint16_t precompile) {
+    return isZero(to->ptr, ETH_ADDRESS_LEN - 2) && to->ptr[ETH_ADDRESS_LEN - 2] == (uint8_t)(precompile >> 8) &&
+           to->ptr[ETH_ADDRESS_LEN - 1] == (uint8_t)precompile;
+}
+
+// Head words and tail values, read in place past the selector
+static const uint8_t *argWord(const rlp_t *data, uint16_t offset) { return data->ptr + ABI_SELECTOR_LEN + offset; }
+
+// Reads a word that holds a value of at most 16 bits
+static parser_error_t readSmallWord(const uint8_t *word, uint16_t *value) {
+    if (!isZero(word, ABI_WORD_LEN - 2)) {
+        return parser_value_out_of_range;
+    }
+    *value = (uint16_t)((word[ABI_WORD_LEN - 2] << 8) | word[ABI_WORD_LEN - 1]);
+    return parser_ok;
+}
+
+// Locates a dynamic value from its head word. Encoders place them in order
+// right after the head, each padded to a whole word; anything else is rejected
+// so that every byte of the calldata is part of what is shown.
+static parser_error_t readDynamic(const rlp_t *data, uint16_t headOffset, uint16_t *tailOffset, const uint8_t **value,
+                                  uint16_t *valueLen) {
+    const uint16_t argsLen = (uint16_t)(data->rlpLen - ABI_SELECTOR_LEN);
+    uint16_t offset = 0;
+    CHECK_ERROR(readSmallWord(argWord(data, headOffset), &offset))
+    if (offset != *tailOffset || argsLen - offset < ABI_WORD_LEN) {
+        return parser_unexpected_value;
+    }
+
+    uint16_t len = 0;
+    CHECK_ERROR(readSmallWord(argWord(data, offset), &len))
+    const uint16_t start = offset + ABI_WORD_LEN;
+    const uint32_t padded = ((uint32_t)len + ABI_WORD_LEN - 1) / ABI_WORD_LEN * ABI_WORD_LEN;
+    if ((uint32_t)(argsLen - start) < padded) {
+        return parser_unexpected_buffer_end;
+    }
+    if (!isZero(argWord(data, start + len), (uint16_t)(padded - len))) {
+        return parser_unexpected_value;
+    }
+
+    *value = argWord(data, start);
+    *valueLen = len;
+    *tailOffset = (uint16_t)(start + padded);
+    return parser_ok;
+}
+
+static parser_error_t checkArgs(const abi_method_t *method, const rlp_t *data) {
+    if (data->rlpLen < ABI_SELECTOR_LEN || data->rlpLen > UINT16_MAX) {
+        return parser_unexpected_buffer_end;
+    }
+    const uint16_t argsLen = (uint16_t)(data->rlpLen - ABI_SELECTOR_LEN);
+    uint16_t tailOffset = method->numArgs * ABI_WORD_LEN;
+    if (argsLen < tailOffset) {
+        return parser_unexpected_buffer_end;
+    }
+
+    for (uint8_t i = 0; i < method->numArgs; i++) {
+        const uint8_t *word = argWord(data, i * ABI_WORD_LEN);
+        switch (method->argTypes[i]) {
+            case abi_arg_address:
+                if (!isZero(word, ABI_ADDRESS_PADDING)) {
+                    return parser_invalid_address;
+                }
+                break;
+            case abi_arg_uint32:
+                if (!isZero(word, ABI_UINT32_PADDING)) {
+                    return parser_value_out_of_range;
+                }
+                break;
+            case abi_arg_uint256:
+            case abi_arg_token_amount:
+                break;
+            case abi_arg_bytes: {
+                const uint8_t *value = NULL;
+                uint16_t valueLen = 0;
+                CHECK_ERROR(readDynamic(data, i * ABI_WORD_LEN, &tailOffset, &value, &valueLen))
+                break;
+            }
+            default:
+                return parser_unexpected_type;
+        }
+    }
+
+    // no trailing bytes
+    return tailOffset == argsLen ? parser_ok : parser_unexpected_characters;
+}
+
+uint8_t abi_decode(const rlp_t *to, const rlp_t *data) {
+    if (to == NULL || data == NULL || to->rlpLen != ETH_ADDRESS_LEN || data->rlpLen < ABI_SELECTOR_LEN) {
+        return ABI_NO_METHOD;
+    }
+    for (uint8_t i = 0; i < ABI_NUM_METHODS; i++) {
+        const abi_method_t *method = abi_get_method(i);
+        if (memcmp(data->ptr, method->selector, ABI_SELECTOR_LEN) != 0) {
+            continue;
+        }
+        if (method->precompile != 0 && !isPrecompile(to, method->precompile)) {
+            return ABI_NO_METHOD;
+        }
+        return checkArgs(method, data) == parser_ok ? i : ABI_NO_METHOD;
+    }
+    return ABI_NO_METHOD;
+}
+
+const abi_method_t *abi_get_method(uint8_t methodIdx) {
+    if (methodIdx >= ABI_NUM_METHODS) {
+        return NULL;
+    }
+    const abi_method_t *methods = (const abi_method_t *)PIC(abi_methods);
+    return &methods[methodIdx];
+}
+
+static bool isText(const uint8_t *value, uint16_t len) {
+    if (len == 0) {
+        return false;
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        if (!IS_PRINTABLE(value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+parser_error_t abi_print_arg(const eth_tx_t *tx_obj, uint8_t methodIdx, uint8_t argIdx, char *outKey, uint16_t outKeyLen,
+                             char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    const abi_method_t *method = abi_get_method(methodIdx);
+    if (tx_obj == NULL || method == NULL || argIdx >= method->numArgs) {
+        return parser_display_idx_out_of_range;
+    }
+    rlp_t data = {0};
+    eth_tx_view(tx_obj, &tx_obj->tx.data, &data);
+    snprintf(outKey, outKeyLen, "%s", method->argNames[argIdx]);
+
+    const uint8_t *word = argWord(&data, argIdx * ABI_WORD_LEN);
+    switch (method->argTypes[argIdx]) {
+        case abi_arg_address:
+            pageHex(outVal, outValLen, "0x", word + ABI_ADDRESS_PADDING, ETH_ADDRESS_LEN, pageIdx, pageCount);
+            return parser_ok;
+
+        case abi_arg_uint32:
+        case abi_arg_uint256: {
+            const rlp_t number = {.kind = RLP_KIND_STRING, .ptr = word, .rlpLen = ABI_WORD_LEN};
+            return printRLPNumber(&number, outVal, outValLen, pageIdx, pageCount);
+        }
+
+        case abi_arg_token_amount:
+            return printERC20Amount(tx_obj, word, outVal, outValLen, pageIdx, pageCount);
+
+        case abi_arg_bytes: {
+            // the layout was checked by abi_decode, walk it again up to this argument
+            uint16_t tailOffset = method->numArgs * ABI_WORD_LEN;
+            const uint8_t *value = NULL;
+            uint16_t valueLen = 0;
+            for (uint8_t i = 0; i <= argIdx; i++) {
+                if (method->argTypes[i] == abi_arg_bytes) {
+                    CHECK_ERROR(readDynamic(&data, i * ABI_WORD_LEN, &tailOffset, &value, &valueLen))
+                }
+            }
+            if (isText(value, valueLen)) {
+                pageText(outVal, outValLen, (const char *)value, valueLen, pageIdx, pageCount);
+            } else {
+                pageHex(outVal, outValLen, "0x", value, valueLen, pageIdx, pageCount);
+            }
+            return parser_ok;
+        }
+
+        default:
+            break;
+    }
+    return parser_unexpected_type;
+}
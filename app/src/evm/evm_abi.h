@@ -0,0 +1,69 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "parser_common.h"
+#include "parser_impl_evm.h"
+#include "rlp.h"
+
+// Calldata of the methods in the selector table is decoded in place:
+// [selector (4)] [head: one 32-byte word per argument] [tail: dynamic values]
+#define ABI_SELECTOR_LEN      4
+#define ABI_WORD_LEN          32
+#define ABI_MAX_ARGS          ETH_MAX_ABI_ARGS
+#define ABI_METHOD_NAME_LEN   24
+#define ABI_ARG_NAME_LEN      16
+#define ABI_NO_METHOD         0xFF
+
+typedef enum {
+    abi_arg_address = 0,
+    abi_arg_uint32,
+    abi_arg_uint256,
+    // uint256 shown with the symbol and decimals of the called token
+    abi_arg_token_amount,
+    abi_arg_bytes,
+} abi_arg_type_e;
+
+typedef struct {
+    uint8_t selector[ABI_SELECTOR_LEN];
+    char name[ABI_METHOD_NAME_LEN];
+    // peaq precompile the method lives at, 0 for methods of any contract
+    uint16_t precompile;
+    uint8_t numArgs;
+    uint8_t argTypes[ABI_MAX_ARGS];
+    char argNames[ABI_MAX_ARGS][ABI_ARG_NAME_LEN];
+} abi_method_t;
+
+/// Matches the call against the selector table and checks its arguments
+/// \return index of the method in the table, ABI_NO_METHOD when it cannot be decoded
+uint8_t abi_decode(const rlp_t *to, const rlp_t *data);
+
+/// \return the table entry returned by abi_decode
+const abi_method_t *abi_get_method(uint8_t methodIdx);
+
+/// Formats argument argIdx of the call decoded into methodIdx
+parser_error_t abi_print_arg(const eth_tx_t *tx_obj, uint8_t methodIdx, uint8_t argIdx, char *outKey, uint16_t outKeyLen,
+                             char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
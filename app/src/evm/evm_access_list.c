@@ -0,0 +1,133 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_access_list.h"
+
+#include <zxmacros.h>
+
+static parser_error_t initContext(parser_context_t *ctx, const rlp_t *list) {
+    if (list->kind != RLP_KIND_LIST) {
+        return parser_unexpected_type;
+    }
+    if (list->rlpLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
+    ctx->buffer = list->ptr;
+    ctx->bufferLen = (uint16_t)list->rlpLen;
+    ctx->offset = 0;
+    ctx->tx_obj = NULL;
+    return parser_ok;
+}
+
+static parser_error_t readKey(parser_context_t *ctx, rlp_t *key) {
+    CHECK_ERROR(rlp_read(ctx, key))
+    if (key->kind != RLP_KIND_STRING || key->rlpLen != ACCESS_LIST_STORAGE_KEY_LEN) {
+        return parser_unexpected_value;
+    }
+    return parser_ok;
+}
+
+parser_error_t access_list_iter_init(access_list_iter_t *iter, const rlp_t *accessList) {
+    if (iter == NULL || accessList == NULL) {
+        return parser_unexpected_error;
+    }
+    iter->index = 0;
+    return initContext(&iter->ctx, accessList);
+}
+
+parser_error_t access_list_iter_next(access_list_iter_t *iter, access_list_entry_t *entry) {
+    if (iter == NULL || entry == NULL) {
+        return parser_unexpected_error;
+    }
+    if (iter->ctx.offset >= iter->ctx.bufferLen) {
+        return parser_no_data;
+    }
+
+    rlp_t item = {0};
+    CHECK_ERROR(rlp_read(&iter->ctx, &item))
+
+    // exactly [address, storageKeys]; a third field means a malformed entry
+    rlp_field_t fields[3] = {0};
+    uint16_t numFields = 0;
+    if (item.kind != RLP_KIND_LIST) {
+        return parser_unexpected_type;
+    }
+    CHECK_ERROR(rlp_readList(&item, fields, &numFields, 3))
+    if (numFields != 2) {
+        return parser_unexpected_number_items;
+    }
+    rlp_fieldView(item.ptr, &fields[0], &entry->address);
+    rlp_fieldView(item.ptr, &fields[1], &entry->keys);
+    if (entry->address.kind != RLP_KIND_STRING || entry->address.rlpLen != ACCESS_LIST_ADDRESS_LEN) {
+        return parser_invalid_address;
+    }
+
+    parser_context_t keysCtx = {0};
+    CHECK_ERROR(initContext(&keysCtx, &entry->keys))
+    uint16_t numKeys = 0;
+    while (keysCtx.offset < keysCtx.bufferLen) {
+        rlp_t key = {0};
+        CHECK_ERROR(readKey(&keysCtx, &key))
+        numKeys++;
+    }
+
+    entry->numKeys = numKeys;
+    iter->index++;
+    return parser_ok;
+}
+
+parser_error_t access_list_entry_key(const access_list_entry_t *entry, uint16_t keyIdx, rlp_t *key) {
+    if (entry == NULL || key == NULL) {
+        return parser_unexpected_error;
+    }
+    if (keyIdx >= entry->numKeys) {
+        return parser_display_idx_out_of_range;
+    }
+
+    parser_context_t keysCtx = {0};
+    CHECK_ERROR(initContext(&keysCtx, &entry->keys))
+    for (uint16_t i = 0; i <= keyIdx; i++) {
+        CHECK_ERROR(readKey(&keysCtx, key))
+    }
+    return parser_ok;
+}
+
+parser_error_t access_list_count(const rlp_t *accessList, uint16_t *numAddresses, uint16_t *numKeys) {
+    if (numAddresses == NULL || numKeys == NULL) {
+        return parser_unexpected_error;
+    }
+    *numAddresses = 0;
+    *numKeys = 0;
+
+    access_list_iter_t iter = {0};
+    CHECK_ERROR(access_list_iter_init(&iter, accessList))
+
+    access_list_entry_t entry = {0};
+    parser_error_t err = access_list_iter_next(&iter, &entry);
+    while (err == parser_ok) {
+        // a 16-bit buffer cannot hold more entries, so this only guards the sums
+        if (*numKeys > UINT16_MAX - entry.numKeys) {
+            return parser_value_out_of_range;
+        }
+        *numKeys += entry.numKeys;
+        err = access_list_iter_next(&iter, &entry);
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+    *numAddresses = iter.index;
+    return parser_ok;
+}
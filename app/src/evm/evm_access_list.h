@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "parser_common.h"
+#include "rlp.h"
+
+// EIP-2930 access list: [[address, [storageKey, ...]], ...]
+// Entries are read in place from the transaction buffer, nothing is copied.
+#define ACCESS_LIST_ADDRESS_LEN     20
+#define ACCESS_LIST_STORAGE_KEY_LEN 32
+
+typedef struct {
+    parser_context_t ctx;
+    uint16_t index;
+} access_list_iter_t;
+
+typedef struct {
+    rlp_t address;
+    // storage key list, still encoded
+    rlp_t keys;
+    uint16_t numKeys;
+} access_list_entry_t;
+
+/// Positions the iterator on the first entry of the access list
+parser_error_t access_list_iter_init(access_list_iter_t *iter, const rlp_t *accessList);
+
+/// Reads and checks the next entry
+/// \return parser_no_data once every entry was read
+parser_error_t access_list_iter_next(access_list_iter_t *iter, access_list_entry_t *entry);
+
+/// Reads storage key keyIdx of an entry returned by access_list_iter_next
+parser_error_t access_list_entry_key(const access_list_entry_t *entry, uint16_t keyIdx, rlp_t *key);
+
+/// Walks the whole access list once, checking every entry
+parser_error_t access_list_count(const rlp_t *accessList, uint16_t *numAddresses, uint16_t *numKeys);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,10 +21,14 @@
 #include "app_mode.h"
 #include "coin_evm.h"
 #include "crypto_evm.h"
+#include "evm_utils.h"
+#include "format_scratch.h"
 #include "zxerror.h"
 #include "zxformat.h"
 #include "zxmacros.h"
 
+#define ADDR_TEXT_LEN 300
+
 zxerr_t eth_addr_getNumItems(uint8_t *num_items) {
     zemu_log_stack("eth_addr_getNumItems");
     *num_items = 1;
@@ -36,26 +40,56 @@ zxerr_t eth_addr_getNumItems(uint8_t *num_items) {
 
 zxerr_t eth_addr_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
                          uint8_t pageIdx, uint8_t *pageCount) {
-    char buffer[300] = {0};
-    uint8_t *addr = G_io_apdu_buffer + VIEW_ADDRESS_OFFSET_ETH;
+    if (displayIdx != 0 && (displayIdx != 1 || !app_mode_expert())) {
+        return zxerr_no_data;
+    }
+    char *buffer = format_scratch_borrow(ADDR_TEXT_LEN);
+    if (buffer == NULL) {
+        return zxerr_unknown;
+    }
 
-    MEMCPY(buffer, addr, ETH_ADDR_LEN * 2);
+    if (displayIdx == 0) {
+        snprintf(outKey, outKeyLen, "Eth Address");
+        MEMCPY(buffer, G_io_apdu_buffer + VIEW_ADDRESS_OFFSET_ETH, ETH_ADDR_LEN * 2);
+#if EVM_ADDRESS_CHECKSUM
+        // the reply keeps the lowercase digits, only the review is checksummed
+        const uint8_t *hash = eip55_hash(buffer);
+        if (hash == NULL) {
+            format_scratch_return();
+            return zxerr_unknown;
+        }
+        eip55_checksum_window(buffer, 0, ETH_ADDR_LEN * 2, hash);
+#endif
+    } else {
+        snprintf(outKey, outKeyLen, "Path");
+        bip32_to_str(buffer, ADDR_TEXT_LEN, hdPathEth, hdPathEth_len);
+    }
+    pageString(outVal, outValLen, buffer, pageIdx, pageCount);
+    format_scratch_return();
+    return zxerr_ok;
+}
+
+zxerr_t eth_xpub_getNumItems(uint8_t *num_items) {
+    zemu_log_stack("eth_xpub_getNumItems");
+    *num_items = 2;
+    return zxerr_ok;
+}
+
+zxerr_t eth_xpub_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                         uint8_t pageIdx, uint8_t *pageCount) {
+    char buffer[100] = {0};
 
     switch (displayIdx) {
         case 0:
-            snprintf(outKey, outKeyLen, "Eth Address");
-            pageString(outVal, outValLen, buffer, pageIdx, pageCount);
+            snprintf(outKey, outKeyLen, "Export xpub");
+            snprintf(outVal, outValLen, "All account addresses");
+            *pageCount = 1;
             return zxerr_ok;
-        case 1: {
-            if (!app_mode_expert()) {
-                return zxerr_no_data;
-            }
-
+        case 1:
             snprintf(outKey, outKeyLen, "Path");
             bip32_to_str(buffer, sizeof(buffer), hdPathEth, hdPathEth_len);
             pageString(outVal, outValLen, buffer, pageIdx, pageCount);
             return zxerr_ok;
-        }
         default:
             return zxerr_no_data;
     }
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_authorization.h"
+
+#include <zxmacros.h>
+
+#include "uint256.h"
+
+#define AUTHORIZATION_NONCE_LEN 8
+
+static parser_error_t checkNumber(const rlp_field_t *field, uint16_t maxLen) {
+    if (field->kind == RLP_KIND_LIST) {
+        return parser_unexpected_type;
+    }
+    if (field->valueLen > maxLen) {
+        return parser_value_out_of_range;
+    }
+    return parser_ok;
+}
+
+parser_error_t authorization_iter_init(authorization_iter_t *iter, const rlp_t *authorizationList) {
+    if (iter == NULL || authorizationList == NULL) {
+        return parser_unexpected_error;
+    }
+    if (authorizationList->kind != RLP_KIND_LIST) {
+        return parser_unexpected_type;
+    }
+    if (authorizationList->rlpLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
+    iter->ctx.buffer = authorizationList->ptr;
+    iter->ctx.bufferLen = (uint16_t)authorizationList->rlpLen;
+    iter->ctx.offset = 0;
+    iter->ctx.tx_obj = NULL;
+    iter->index = 0;
+    return parser_ok;
+}
+
+parser_error_t authorization_iter_next(authorization_iter_t *iter, authorization_t *authorization) {
+    if (iter == NULL || authorization == NULL) {
+        return parser_unexpected_error;
+    }
+    if (iter->ctx.offset >= iter->ctx.bufferLen) {
+        return parser_no_data;
+    }
+
+    rlp_t item = {0};
+    CHECK_ERROR(rlp_read(&iter->ctx, &item))
+    if (item.kind != RLP_KIND_LIST) {
+        return parser_unexpected_type;
+    }
+
+    // exactly six fields; one more means a malformed tuple
+    rlp_field_t fields[AUTHORIZATION_FIELDS + 1] = {0};
+    uint16_t numFields = 0;
+    CHECK_ERROR(rlp_readList(&item, fields, &numFields, AUTHORIZATION_FIELDS + 1))
+    if (numFields != AUTHORIZATION_FIELDS) {
+        return parser_unexpected_number_items;
+    }
+
+    CHECK_ERROR(checkNumber(&fields[0], UINT256_BYTES))
+    CHECK_ERROR(checkNumber(&fields[2], AUTHORIZATION_NONCE_LEN))
+    CHECK_ERROR(checkNumber(&fields[3], 1))
+    CHECK_ERROR(checkNumber(&fields[4], UINT256_BYTES))
+    CHECK_ERROR(checkNumber(&fields[5], UINT256_BYTES))
+    if (fields[1].kind != RLP_KIND_STRING || fields[1].valueLen != AUTHORIZATION_ADDRESS_LEN) {
+        return parser_invalid_address;
+    }
+    // y parity is 0 or 1
+    if (fields[3].valueLen == 1 && item.ptr[fields[3].valueOffset] > 1) {
+        return parser_unexpected_value;
+    }
+
+    rlp_fieldView(item.ptr, &fields[0], &authorization->chainId);
+    rlp_fieldView(item.ptr, &fields[1], &authorization->address);
+    rlp_fieldView(item.ptr, &fields[2], &authorization->nonce);
+    iter->index++;
+    return parser_ok;
+}
+
+parser_error_t authorization_get(const rlp_t *authorizationList, uint16_t idx, authorization_t *authorization) {
+    authorization_iter_t iter = {0};
+    CHECK_ERROR(authorization_iter_init(&iter, authorizationList))
+    for (uint16_t i = 0; i <= idx; i++) {
+        const parser_error_t err = authorization_iter_next(&iter, authorization);
+        if (err == parser_no_data) {
+            return parser_display_idx_out_of_range;
+        }
+        CHECK_ERROR(err)
+    }
+    return parser_ok;
+}
+
+parser_error_t authorization_count(const rlp_t *authorizationList, uint16_t *count) {
+    if (count == NULL) {
+        return parser_unexpected_error;
+    }
+    *count = 0;
+
+    authorization_iter_t iter = {0};
+    CHECK_ERROR(authorization_iter_init(&iter, authorizationList))
+
+    authorization_t authorization = {0};
+    parser_error_t err = authorization_iter_next(&iter, &authorization);
+    while (err == parser_ok) {
+        err = authorization_iter_next(&iter, &authorization);
+    }
+    if (err != parser_no_data) {
+        return err;
+    }
+    *count = iter.index;
+    return parser_ok;
+}
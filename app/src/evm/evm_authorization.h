@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "parser_common.h"
+#include "rlp.h"
+
+// EIP-7702 authorization list: [[chainId, address, nonce, yParity, r, s], ...]
+// Tuples are read in place from the transaction buffer, nothing is copied.
+#define AUTHORIZATION_ADDRESS_LEN 20
+#define AUTHORIZATION_FIELDS      6
+
+typedef struct {
+    parser_context_t ctx;
+    uint16_t index;
+} authorization_iter_t;
+
+// the signature of the authority is checked but not kept
+typedef struct {
+    rlp_t chainId;
+    rlp_t address;
+    rlp_t nonce;
+} authorization_t;
+
+/// Positions the iterator on the first tuple of the authorization list
+parser_error_t authorization_iter_init(authorization_iter_t *iter, const rlp_t *authorizationList);
+
+/// Reads and checks the next tuple
+/// \return parser_no_data once every tuple was read
+parser_error_t authorization_iter_next(authorization_iter_t *iter, authorization_t *authorization);
+
+/// Reads tuple idx, walking the list again from the start
+parser_error_t authorization_get(const rlp_t *authorizationList, uint16_t idx, authorization_t *authorization);
+
+/// Walks the whole authorization list once, checking every tuple
+parser_error_t authorization_count(const rlp_t *authorizationList, uint16_t *count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_batch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app_mode.h"
+#include "coin_evm.h"
+#include "evm_utils.h"
+#include "parser.h"
+#include "session.h"
+#include "zxformat.h"
+#include "zxmacros.h"
+
+#define BATCH_U256_LEN 32
+
+static parser_error_t fieldToU256(const eth_tx_t *tx_obj, const rlp_field_t *field, uint256_t *out) {
+    if (field->valueLen > BATCH_U256_LEN) {
+        return parser_value_out_of_range;
+    }
+    rlp_t num = {0};
+    eth_tx_view(tx_obj, field, &num);
+    return readu256BEBytes(num.ptr, (uint16_t)num.rlpLen, out);
+}
+
+static void u256ToBytes(const uint256_t *num, uint8_t out[BATCH_U256_LEN]) {
+    const uint64_t limbs[4] = {UPPER(UPPER_P(num)), LOWER(UPPER_P(num)), UPPER(LOWER_P(num)), LOWER(LOWER_P(num))};
+    for (uint8_t i = 0; i < BATCH_U256_LEN; i++) {
+        out[i] = (uint8_t)(limbs[i / 8] >> (8 * (7 - (i % 8))));
+    }
+}
+
+static parser_error_t accumulate(uint256_t *total, uint256_t *amount) {
+    uint256_t sum = {0};
+    add256(total, amount, &sum);
+    if (gt256(amount, &sum)) {
+        return parser_value_out_of_range;
+    }
+    copy256(total, &sum);
+    return parser_ok;
+}
+
+static parser_error_t readNonce(const eth_tx_t *tx_obj, uint64_t *value) {
+    *value = 0;
+    if (tx_obj->tx.nonce.valueLen == 0) {
+        return parser_ok;
+    }
+    rlp_t nonce = {0};
+    eth_tx_view(tx_obj, &tx_obj->tx.nonce, &nonce);
+    return be_bytes_to_u64(nonce.ptr, nonce.rlpLen, value);
+}
+
+static parser_error_t addRecipient(const uint8_t *to) {
+    for (uint8_t i = 0; i < eth_batch_obj.numRecipients; i++) {
+        if (memcmp(eth_batch_obj.recipients[i], to, ETH_ADDRESS_LEN) == 0) {
+            return parser_ok;
+        }
+    }
+    // every recipient is shown, so their number is bounded
+    if (eth_batch_obj.numRecipients >= ETH_BATCH_MAX_RECIPIENTS) {
+        return parser_unexpected_number_items;
+    }
+    MEMCPY(eth_batch_obj.recipients[eth_batch_obj.numRecipients++], to, ETH_ADDRESS_LEN);
+    return parser_ok;
+}
+
+// Checks one parsed transaction against the batch rules and adds it to the totals
+static parser_error_t aggregate(const eth_tx_t *tx_obj, const rlp_t *chainId, uint8_t idx) {
+    // only plain value transfers: the aggregate review has no room for calldata, access lists or delegations
+    if (tx_obj->tx.to.valueLen != ETH_ADDRESS_LEN || tx_obj->tx.data.valueLen != 0 || tx_obj->accessListAddresses != 0 ||
+        tx_obj->authorizations != 0) {
+        return parser_unexpected_value;
+    }
+    // pre-EIP-155 transactions are replayable across chains
+    rlp_t txChainId = {0};
+    eth_tx_view(tx_obj, &tx_obj->chainId, &txChainId);
+    if (txChainId.rlpLen == 0) {
+        return parser_invalid_chain_id;
+    }
+    if (idx > 0 && (txChainId.rlpLen != chainId->rlpLen || memcmp(txChainId.ptr, chainId->ptr, chainId->rlpLen) != 0)) {
+        return parser_unexpected_chain;
+    }
+
+    uint64_t nonce = 0;
+    CHECK_ERROR(readNonce(tx_obj, &nonce))
+    if (idx == 0) {
+        eth_batch_obj.firstNonce = nonce;
+    } else if (nonce != eth_batch_obj.firstNonce + idx) {
+        return parser_unexpected_value;
+    }
+
+    rlp_t to = {0};
+    eth_tx_view(tx_obj, &tx_obj->tx.to, &to);
+    CHECK_ERROR(addRecipient(to.ptr))
+
+    uint256_t value = {0};
+    CHECK_ERROR(fieldToU256(tx_obj, &tx_obj->tx.value, &value))
+    CHECK_ERROR(accumulate(&eth_batch_obj.totalValue, &value))
+
+    uint256_t gasLimit = {0};
+    uint256_t feeCap = {0};
+    uint256_t maxFee = {0};
+    CHECK_ERROR(fieldToU256(tx_obj, &tx_obj->tx.gasLimit, &gasLimit))
+    CHECK_ERROR(
+        fieldToU256(tx_obj, tx_obj->tx_type == eip1559 ? &tx_obj->tx.max_fee_per_gas : &tx_obj->tx.gasPrice, &feeCap))
+    if (bits256(&gasLimit) + bits256(&feeCap) > 256) {
+        return parser_value_out_of_range;
+    }
+    mul256(&gasLimit, &feeCap, &maxFee);
+    return accumulate(&eth_batch_obj.totalMaxFee, &maxFee);
+}
+
+parser_error_t eth_batch_parse(const uint8_t *buffer, uint32_t bufferLen) {
+    MEMZERO(&eth_batch_obj, sizeof(eth_batch_obj));
+    if (buffer == NULL || bufferLen == 0) {
+        return parser_no_data;
+    }
+    if (bufferLen > ETH_BATCH_MAX_BYTES) {
+        return parser_value_out_of_range;
+    }
+
+    uint8_t chainIdBytes[sizeof(uint64_t)] = {0};
+    rlp_t chainId = {.kind = RLP_KIND_STRING, .ptr = chainIdBytes, .rlpLen = 0};
+
+    uint32_t offset = 0;
+    while (offset < bufferLen) {
+        if (eth_batch_obj.count >= ETH_BATCH_MAX_TXS) {
+            return parser_unexpected_number_items;
+        }
+
+        uint64_t read = 0;
+        uint64_t to_read = 0;
+        if (get_tx_rlp_len(buffer + offset, bufferLen - offset, &read, &to_read) != rlp_ok) {
+            return parser_unexpected_value;
+        }
+        const uint64_t txLen = saturating_add(read, to_read);
+        if (txLen > bufferLen - offset || txLen > UINT16_MAX) {
+            return parser_unexpected_buffer_end;
+        }
+
+        parser_context_t ctx = {0};
+        CHECK_ERROR(parser_init_context(&ctx, buffer + offset, (uint16_t)txLen))
+        CHECK_ERROR(_readEth(&ctx, &eth_tx_obj))
+        CHECK_ERROR(aggregate(&eth_tx_obj, &chainId, eth_batch_obj.count))
+
+        if (eth_batch_obj.count == 0) {
+            rlp_t txChainId = {0};
+            eth_tx_view(&eth_tx_obj, &eth_tx_obj.chainId, &txChainId);
+            if (txChainId.rlpLen > sizeof(chainIdBytes)) {
+                return parser_invalid_chain_id;
+            }
+            MEMCPY(chainIdBytes, txChainId.ptr, txChainId.rlpLen);
+            chainId.rlpLen = txChainId.rlpLen;
+        }
+
+        eth_batch_obj.offsets[eth_batch_obj.count] = (uint16_t)offset;
+        eth_batch_obj.lengths[eth_batch_obj.count] = (uint16_t)txLen;
+        eth_batch_obj.count++;
+        offset += (uint32_t)txLen;
+    }
+
+    // same rule as single transactions: plain transfers are not clear signed
+    if (!app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
+    }
+    return parser_ok;
+}
+
+parser_error_t eth_batch_select(parser_context_t *ctx, const uint8_t *buffer, uint32_t bufferLen, uint8_t idx) {
+    if (ctx == NULL || buffer == NULL || idx >= eth_batch_obj.count) {
+        return parser_unexpected_error;
+    }
+    const uint32_t end = (uint32_t)eth_batch_obj.offsets[idx] + eth_batch_obj.lengths[idx];
+    if (end > bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
+    CHECK_ERROR(parser_init_context(ctx, buffer + eth_batch_obj.offsets[idx], eth_batch_obj.lengths[idx]))
+    return _readEth(ctx, &eth_tx_obj);
+}
+
+// Review: count, coin, total value, recipients, nonces, fee bound
+#define BATCH_ITEMS_BEFORE_RECIPIENTS 3
+#define BATCH_ITEMS_AFTER_RECIPIENTS  2
+
+parser_error_t eth_batch_getNumItems(uint8_t *numItems) {
+    if (numItems == NULL) {
+        return parser_unexpected_error;
+    }
+    *numItems = BATCH_ITEMS_BEFORE_RECIPIENTS + eth_batch_obj.numRecipients + BATCH_ITEMS_AFTER_RECIPIENTS;
+    return parser_ok;
+}
+
+parser_error_t eth_batch_getItem(uint8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount) {
+    if (outKey == NULL || outVal == NULL || pageCount == NULL) {
+        return parser_unexpected_error;
+    }
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+
+    uint8_t amount[BATCH_U256_LEN] = {0};
+    const uint8_t firstAfter = BATCH_ITEMS_BEFORE_RECIPIENTS + eth_batch_obj.numRecipients;
+
+    switch (displayIdx) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Batch");
+            snprintf(outVal, outValLen, "%d transactions", eth_batch_obj.count);
+            return parser_ok;
+        case 1:
+            snprintf(outKey, outKeyLen, "Coin asset");
+            snprintf(outVal, outValLen, "peaq");
+            return parser_ok;
+        case 2:
+            snprintf(outKey, outKeyLen, "Total value");
+            u256ToBytes(&eth_batch_obj.totalValue, amount);
+            return printBigIntFixedPoint(amount, sizeof(amount), outVal, outValLen, pageIdx, pageCount, COIN_DECIMALS);
+        default:
+            break;
+    }
+
+    if (displayIdx < firstAfter) {
+        const uint8_t recipientIdx = displayIdx - BATCH_ITEMS_BEFORE_RECIPIENTS;
+        const rlp_t address = {.kind = RLP_KIND_STRING, .ptr = eth_batch_obj.recipients[recipientIdx],
+                               .rlpLen = ETH_ADDRESS_LEN};
+        snprintf(outKey, outKeyLen, "Recipient %d", recipientIdx + 1);
+        return printEVMAddress(&address, outVal, outValLen, pageIdx, pageCount);
+    }
+
+    if (displayIdx == firstAfter) {
+        char first[21] = {0};
+        char last[21] = {0};
+        snprintf(outKey, outKeyLen, "Nonces");
+        if (uint64_to_str(first, sizeof(first), eth_batch_obj.firstNonce) != NULL ||
+            uint64_to_str(last, sizeof(last), eth_batch_obj.firstNonce + eth_batch_obj.count - 1) != NULL) {
+            return parser_unexpected_error;
+        }
+        snprintf(outVal, outValLen, "%s - %s", first, last);
+        return parser_ok;
+    }
+
+    if (displayIdx == firstAfter + 1) {
+        snprintf(outKey, outKeyLen, "Max fees");
+        u256ToBytes(&eth_batch_obj.totalMaxFee, amount);
+        return printBigIntFixedPoint(amount, sizeof(amount), outVal, outValLen, pageIdx, pageCount, COIN_DECIMALS);
+    }
+
+    return parser_display_idx_out_of_range;
+}
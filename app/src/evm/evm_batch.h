@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "parser_impl_evm.h"
+#include "uint256.h"
+
+// A batch is a run of plain value transfers with consecutive nonces, reviewed once.
+// It is stored and parsed in full, and ETH_BATCH_MAX_BYTES keeps it within the RAM
+// buffer of every target so a batch is never written to flash.
+#define ETH_BATCH_MAX_TXS        50
+#define ETH_BATCH_MAX_BYTES      8192
+#define ETH_BATCH_MAX_RECIPIENTS 4
+
+typedef struct {
+    uint8_t count;
+    // position of every serialized transaction in the upload buffer
+    uint16_t offsets[ETH_BATCH_MAX_TXS];
+    uint16_t lengths[ETH_BATCH_MAX_TXS];
+
+    uint8_t recipients[ETH_BATCH_MAX_RECIPIENTS][ETH_ADDRESS_LEN];
+    uint8_t numRecipients;
+
+    uint64_t firstNonce;
+    // sum of values and of gasLimit * fee cap, in wei
+    uint256_t totalValue;
+    uint256_t totalMaxFee;
+} eth_batch_t;
+
+/// Splits the buffer into transactions, parses each one and aggregates the review data
+parser_error_t eth_batch_parse(const uint8_t *buffer, uint32_t bufferLen);
+
+/// Parses transaction idx of the batch into ctx so it can be hashed and signed
+parser_error_t eth_batch_select(parser_context_t *ctx, const uint8_t *buffer, uint32_t bufferLen, uint8_t idx);
+
+parser_error_t eth_batch_getNumItems(uint8_t *numItems);
+
+parser_error_t eth_batch_getItem(uint8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,6 +20,8 @@
 #include "app_main.h"
 #include "app_mode.h"
 #include "coin_evm.h"
+#include "crypto_helper.h"
+#include "evm_utils.h"
 #include "zxformat.h"
 #include "zxmacros.h"
 
@@ -30,13 +32,82 @@
 #define CX_RIPEMD160_SIZE 20
 #endif
 
+// filled while the message is uploaded and settled once when it is parsed, so paging does not rescan it
+static eip191_msg_info_t msg_info;
+static uint8_t msg_digest[KECCAK_256_SIZE];
+static bool msg_digest_valid = false;
+
+#if defined(LEDGER_SPECIFIC)
+static cx_sha3_t msg_keccak;
+#endif
+
 static const char SIGN_MAGIC[] =
     "\x19"
     "Ethereum Signed Message:\n";
 
+static zxerr_t msg_keccak_absorb(const uint8_t *data, uint32_t dataLen, bool last) {
+#if defined(LEDGER_SPECIFIC)
+    uint8_t *out = last ? msg_digest : NULL;
+    const size_t outLen = last ? sizeof(msg_digest) : 0;
+    CHECK_CX_OK(cx_hash_no_throw((cx_hash_t *)&msg_keccak, last ? CX_LAST : 0, data, dataLen, out, outLen));
+#else
+    UNUSED(data);
+    UNUSED(dataLen);
+    UNUSED(last);
+#endif
+    return zxerr_ok;
+}
+
+zxerr_t eip191_stream_start(uint32_t messageLen) {
+    MEMZERO(&msg_info, sizeof(msg_info));
+    MEMZERO(msg_digest, sizeof(msg_digest));
+    msg_digest_valid = false;
+    msg_info.length = messageLen;
+
+#if defined(LEDGER_SPECIFIC)
+    CHECK_CX_OK(cx_keccak_init_no_throw(&msg_keccak, KECCAK_256_SIZE * 8));
+#endif
+    char len_str[12] = {0};
+    uint32_to_str(len_str, sizeof(len_str), messageLen);
+    CHECK_ZXERR(msg_keccak_absorb((const uint8_t *)SIGN_MAGIC, sizeof(SIGN_MAGIC) - 1, false))
+    // empty messages are not signed, so the digest is only finalized with message bytes
+    return msg_keccak_absorb((const uint8_t *)len_str, strlen(len_str), false);
+}
+
+zxerr_t eip191_stream_absorb(const uint8_t *data, uint32_t dataLen, uint32_t *keepLen) {
+    if (keepLen == NULL || (data == NULL && dataLen > 0) || dataLen > msg_info.length - msg_info.received) {
+        return zxerr_out_of_bounds;
+    }
+
+    const uint32_t kept = MIN(msg_info.received, EIP191_DISPLAY_MAX_LEN);
+    *keepLen = MIN(dataLen, EIP191_DISPLAY_MAX_LEN - kept);
+    for (uint32_t i = 0; i < dataLen; i++) {
+        msg_info.nonPrintable += IS_PRINTABLE(data[i]) ? 0 : 1;
+    }
+    msg_info.received += dataLen;
+    msg_info.truncated = msg_info.received > EIP191_DISPLAY_MAX_LEN;
+
+    const bool last = msg_info.length > 0 && msg_info.received == msg_info.length;
+    CHECK_ZXERR(msg_keccak_absorb(data, dataLen, last))
+    msg_digest_valid = last;
+    return zxerr_ok;
+}
+
+bool eip191_stream_complete(void) {
+    return msg_digest_valid;
+}
+
+const uint8_t *eip191_get_digest(void) {
+    return msg_digest_valid ? msg_digest : NULL;
+}
+
+const eip191_msg_info_t *eip191_msg_info(void) {
+    return &msg_info;
+}
+
 zxerr_t eip191_msg_getNumItems(uint8_t *num_items) {
     zemu_log_stack("msg_getNumItems");
-    *num_items = 2;
+    *num_items = msg_info.truncated ? 3 : 2;
     return zxerr_ok;
 }
 
@@ -60,23 +131,22 @@ zxerr_t eip191_msg_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen,
             return zxerr_ok;
         }
         case 1: {
-            snprintf(outKey, outKeyLen, "Msg hex");
-            uint16_t npc = 0;  // Non Printable Chars Counter
-
-            for (uint16_t i = 0; i < messageLength; i++) {
-                npc += IS_PRINTABLE(message[i]) ? 0 /* Printable Char */ : 1 /* Non Printable Char */;
-            }
-
-            // msg in hex in case >= than 40% is non printable
-            // or first char is not printable.
-            if (messageLength > 0 && (npc * 100) / messageLength >= 40) {
-                pageStringHex(outVal, outValLen, (const char *)message, messageLength, pageIdx, pageCount);
+            if (msg_info.display == eip191_display_hex) {
+                snprintf(outKey, outKeyLen, "Msg hex");
+                pageHex(outVal, outValLen, NULL, message, messageLength, pageIdx, pageCount);
                 return zxerr_ok;
             }
 
-            // print message
             snprintf(outKey, outKeyLen, "Msg");
-            pageString(outVal, outValLen, (const char *)message, pageIdx, pageCount);
+            pageText(outVal, outValLen, (const char *)message, messageLength, pageIdx, pageCount);
+            return zxerr_ok;
+        }
+        case 2: {
+            if (!msg_info.truncated) {
+                return zxerr_no_data;
+            }
+            snprintf(outKey, outKeyLen, "Msg length");
+            snprintf(outVal, outValLen, "%u bytes, first %u shown", (unsigned)msg_info.length, (unsigned)messageLength);
             return zxerr_ok;
         }
         default:
@@ -87,6 +157,11 @@ zxerr_t eip191_msg_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen,
 }
 
 bool eip191_msg_parse() {
+    // the ratio is taken over the whole message, not only the part that is shown
+    msg_info.nonPrintablePercent = (uint8_t)(((uint64_t)msg_info.nonPrintable * 100) / msg_info.length);
+    // msg in hex in case >= than 40% is non printable
+    msg_info.display = msg_info.nonPrintablePercent >= 40 ? eip191_display_hex : eip191_display_text;
+
     if (!app_mode_blindsign()) {
         return false;
     }
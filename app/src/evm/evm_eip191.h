@@ -26,6 +26,42 @@
 extern "C" {
 #endif
 
+// Messages are hashed while they are uploaded, so their size is not bounded by the
+// upload buffer; only the first EIP191_DISPLAY_MAX_LEN bytes are kept for the review.
+#define EIP191_DISPLAY_MAX_LEN 4096
+
+typedef enum {
+    eip191_display_text = 0,
+    eip191_display_hex,
+} eip191_display_e;
+
+typedef struct {
+    // declared length and bytes received so far
+    uint32_t length;
+    uint32_t received;
+    uint32_t nonPrintable;
+    uint8_t nonPrintablePercent;
+    eip191_display_e display;
+    // set when only a prefix of the message is kept
+    bool truncated;
+} eip191_msg_info_t;
+
+/// Starts keccak256(SIGN_MAGIC || decimal length || message) for a message of messageLen bytes
+zxerr_t eip191_stream_start(uint32_t messageLen);
+
+/// Hashes and classifies the next message bytes
+/// \param keepLen how many of them must be stored for the review
+zxerr_t eip191_stream_absorb(const uint8_t *data, uint32_t dataLen, uint32_t *keepLen);
+
+/// \return true once the declared length was received and the digest finalized
+bool eip191_stream_complete(void);
+
+/// \return the digest of the last complete message
+const uint8_t *eip191_get_digest(void);
+
+const eip191_msg_info_t *eip191_msg_info(void);
+
+/// Settles the display mode from the counts taken during the upload
 bool eip191_msg_parse();
 zxerr_t eip191_msg_getNumItems(uint8_t *num_items);
 zxerr_t eip191_msg_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_eip191_batch.h"
+
+#include <stdio.h>
+
+#include "app_mode.h"
+#include "crypto_helper.h"
+#include "evm_eip191.h"
+#include "evm_utils.h"
+#include "session.h"
+#include "zxmacros.h"
+
+// same rule as single messages: hex once 40% or more of the bytes are not printable
+#define BATCH_HEX_PERCENT 40
+
+static eip191_display_e classify(const uint8_t *message, uint16_t messageLen) {
+    uint32_t nonPrintable = 0;
+    for (uint16_t i = 0; i < messageLen; i++) {
+        nonPrintable += IS_PRINTABLE(message[i]) ? 0 : 1;
+    }
+    return nonPrintable * 100 >= (uint32_t)messageLen * BATCH_HEX_PERCENT ? eip191_display_hex : eip191_display_text;
+}
+
+static parser_error_t hash_messages(void) {
+#if defined(LEDGER_SPECIFIC)
+    for (uint8_t i = 0; i < eip191_batch_obj.count; i++) {
+        if (eip191_hash_message(eip191_batch_obj.buffer + eip191_batch_obj.offsets[i], eip191_batch_obj.lengths[i],
+                                eip191_batch_obj.hashes[i]) != zxerr_ok) {
+            return parser_unexpected_error;
+        }
+    }
+#endif
+    if (keccak_digest((const unsigned char *)eip191_batch_obj.hashes, eip191_batch_obj.count * EIP191_BATCH_HASH_LEN,
+                      eip191_batch_obj.digest, sizeof(eip191_batch_obj.digest)) != zxerr_ok) {
+        return parser_unexpected_error;
+    }
+    return parser_ok;
+}
+
+parser_error_t eip191_batch_parse(const uint8_t *buffer, uint32_t bufferLen) {
+    session_claim(session_flow_eip191_batch);
+    MEMZERO(&eip191_batch_obj, sizeof(eip191_batch_obj));
+    if (buffer == NULL || bufferLen == 0) {
+        return parser_no_data;
+    }
+    eip191_batch_obj.buffer = buffer;
+
+    uint32_t offset = 0;
+    while (offset < bufferLen) {
+        if (eip191_batch_obj.count >= EIP191_BATCH_MAX_MSGS) {
+            return parser_unexpected_number_items;
+        }
+        if (bufferLen - offset < EIP191_BATCH_LEN_PREFIX) {
+            return parser_unexpected_buffer_end;
+        }
+        const uint16_t messageLen = (uint16_t)((buffer[offset] << 8) | buffer[offset + 1]);
+        offset += EIP191_BATCH_LEN_PREFIX;
+        // empty messages are not signed, as with single messages
+        if (messageLen == 0) {
+            return parser_unexpected_value;
+        }
+        if (messageLen > bufferLen - offset) {
+            return parser_unexpected_buffer_end;
+        }
+
+        const uint8_t idx = eip191_batch_obj.count++;
+        eip191_batch_obj.offsets[idx] = (uint16_t)offset;
+        eip191_batch_obj.lengths[idx] = messageLen;
+        eip191_batch_obj.display[idx] = (uint8_t)classify(buffer + offset, messageLen);
+        offset += messageLen;
+    }
+
+    if (!app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
+    }
+    return hash_messages();
+}
+
+uint8_t eip191_batch_count(void) {
+    return session_current_flow() == session_flow_eip191_batch ? eip191_batch_obj.count : 0;
+}
+
+const uint8_t *eip191_batch_hash(uint8_t idx) {
+    if (idx >= eip191_batch_count()) {
+        return NULL;
+    }
+    return eip191_batch_obj.hashes[idx];
+}
+
+void eip191_batch_set_approved(bool approved) {
+    if (session_current_flow() == session_flow_eip191_batch) {
+        eip191_batch_obj.approved = approved;
+    }
+}
+
+bool eip191_batch_approved(void) {
+    return session_current_flow() == session_flow_eip191_batch && eip191_batch_obj.approved;
+}
+
+// Review: title, count, every message, combined digest
+#define BATCH_ITEMS_BEFORE_MSGS 2
+
+zxerr_t eip191_batch_getNumItems(uint8_t *num_items) {
+    if (num_items == NULL) {
+        return zxerr_no_data;
+    }
+    *num_items = BATCH_ITEMS_BEFORE_MSGS + eip191_batch_count() + 1;
+    return zxerr_ok;
+}
+
+zxerr_t eip191_batch_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                             uint8_t pageIdx, uint8_t *pageCount) {
+    if (outKey == NULL || outVal == NULL || pageCount == NULL || displayIdx < 0) {
+        return zxerr_no_data;
+    }
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+
+    const uint8_t count = eip191_batch_count();
+    switch (displayIdx) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Sign");
+            snprintf(outVal, outValLen, "Personal Messages");
+            return zxerr_ok;
+        case 1:
+            snprintf(outKey, outKeyLen, "Messages");
+            snprintf(outVal, outValLen, "%d", count);
+            return zxerr_ok;
+        default:
+            break;
+    }
+
+    const uint8_t msgIdx = (uint8_t)(displayIdx - BATCH_ITEMS_BEFORE_MSGS);
+    if (msgIdx < count) {
+        const char *message = (const char *)eip191_batch_obj.buffer + eip191_batch_obj.offsets[msgIdx];
+        const uint16_t messageLen = eip191_batch_obj.lengths[msgIdx];
+        if (eip191_batch_obj.display[msgIdx] == eip191_display_hex) {
+            snprintf(outKey, outKeyLen, "Msg %d hex", msgIdx + 1);
+            pageHex(outVal, outValLen, NULL, (const uint8_t *)message, messageLen, pageIdx, pageCount);
+            return zxerr_ok;
+        }
+        snprintf(outKey, outKeyLen, "Msg %d", msgIdx + 1);
+        pageText(outVal, outValLen, message, messageLen, pageIdx, pageCount);
+        return zxerr_ok;
+    }
+
+    if (msgIdx == count) {
+        snprintf(outKey, outKeyLen, "Digest");
+        pageHex(outVal, outValLen, "0x", eip191_batch_obj.digest, sizeof(eip191_batch_obj.digest), pageIdx, pageCount);
+        return zxerr_ok;
+    }
+
+    return zxerr_no_data;
+}
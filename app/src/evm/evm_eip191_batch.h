@@ -0,0 +1,67 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "parser_common.h"
+#include "zxerror.h"
+
+// A batch of personal messages is uploaded as one EIP-191 payload holding
+// { [length (2, BE)] [message] }, reviewed once and signed message by message.
+#define EIP191_BATCH_MAX_MSGS   16
+#define EIP191_BATCH_LEN_PREFIX 2
+#define EIP191_BATCH_HASH_LEN   32
+
+typedef struct {
+    // messages point into the upload buffer, which stays untouched until the review ends
+    const uint8_t *buffer;
+    uint8_t count;
+    uint16_t offsets[EIP191_BATCH_MAX_MSGS];
+    uint16_t lengths[EIP191_BATCH_MAX_MSGS];
+    uint8_t display[EIP191_BATCH_MAX_MSGS];
+
+    // EIP-191 hash of every message, and keccak256 of their concatenation for the review
+    uint8_t hashes[EIP191_BATCH_MAX_MSGS][EIP191_BATCH_HASH_LEN];
+    uint8_t digest[EIP191_BATCH_HASH_LEN];
+
+    // set once the review is approved; signatures are produced on request
+    bool approved;
+} eip191_batch_t;
+
+/// Splits the buffer into messages, hashes each one and takes the session arena for the review
+parser_error_t eip191_batch_parse(const uint8_t *buffer, uint32_t bufferLen);
+
+uint8_t eip191_batch_count(void);
+
+/// \return the hash to sign for message idx, NULL when there is none
+const uint8_t *eip191_batch_hash(uint8_t idx);
+
+void eip191_batch_set_approved(bool approved);
+bool eip191_batch_approved(void);
+
+zxerr_t eip191_batch_getNumItems(uint8_t *num_items);
+zxerr_t eip191_batch_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                             uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,778 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_eip712.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app_mode.h"
+#include "crypto_helper.h"
+#include "evm_utils.h"
+#include "hex_encode.h"
+#include "rlp.h"
+#include "session.h"
+#include "zxformat.h"
+#include "zxmacros.h"
+
+#define EIP712_ADDR_LEN 20
+#define AUX_SLOT        EIP712_MAX_DEPTH
+
+static const char DOMAIN_TYPE[] = "EIP712Domain";
+
+typedef enum {
+    eip712_phase_types = 0,
+    eip712_phase_domain,
+    eip712_phase_between,
+    eip712_phase_message,
+    eip712_phase_done,
+} eip712_phase_e;
+
+typedef enum {
+    eip712_address = 0,
+    eip712_bool,
+    eip712_string,
+    eip712_bytes,
+    eip712_bytes_fixed,
+    eip712_uint,
+    eip712_int,
+    eip712_struct,
+} eip712_kind_e;
+
+// the state lives in the session arena while a message is being signed
+#define eip712      (session_arena.views.typed_data.state)
+#define eip712_hash (session_arena.views.typed_data.hash)
+
+static parser_error_t hash_init(uint8_t slot) {
+#if defined(LEDGER_SPECIFIC)
+    if (cx_keccak_init_no_throw(&eip712_hash[slot], 256) != CX_OK) {
+        return parser_unexpected_error;
+    }
+#else
+    UNUSED(slot);
+#endif
+    return parser_ok;
+}
+
+static parser_error_t hash_update(uint8_t slot, const uint8_t *data, uint16_t dataLen) {
+#if defined(LEDGER_SPECIFIC)
+    if (cx_hash_no_throw((cx_hash_t *)&eip712_hash[slot], 0, data, dataLen, NULL, 0) != CX_OK) {
+        return parser_unexpected_error;
+    }
+#else
+    UNUSED(slot);
+    UNUSED(data);
+    UNUSED(dataLen);
+#endif
+    return parser_ok;
+}
+
+static parser_error_t hash_final(uint8_t slot, uint8_t *out) {
+    MEMZERO(out, EIP712_WORD_LEN);
+#if defined(LEDGER_SPECIFIC)
+    if (cx_hash_no_throw((cx_hash_t *)&eip712_hash[slot], CX_LAST, NULL, 0, out, EIP712_WORD_LEN) != CX_OK) {
+        return parser_unexpected_error;
+    }
+#else
+    UNUSED(slot);
+#endif
+    return parser_ok;
+}
+
+// Arena layout per struct: [nameLen] [name] [numFields] { [typeLen] [type] [nameLen] [name] }
+static const uint8_t *struct_name(uint8_t idx, uint8_t *nameLen) {
+    const uint8_t *p = eip712.arena + eip712.structs[idx];
+    *nameLen = p[0];
+    return p + 1;
+}
+
+static uint8_t struct_num_fields(uint8_t idx) {
+    const uint8_t *p = eip712.arena + eip712.structs[idx];
+    return p[1 + p[0]];
+}
+
+static const uint8_t *struct_field(uint8_t idx, uint8_t fieldIdx) {
+    const uint8_t *p = eip712.arena + eip712.structs[idx];
+    p += 1 + p[0] + 1;
+    for (uint8_t i = 0; i < fieldIdx; i++) {
+        p += 1 + p[0];
+        p += 1 + p[0];
+    }
+    return p;
+}
+
+static bool find_struct(const uint8_t *name, uint8_t nameLen, uint8_t *idx) {
+    for (uint8_t i = 0; i < eip712.numStructs; i++) {
+        uint8_t len = 0;
+        const uint8_t *candidate = struct_name(i, &len);
+        if (len == nameLen && memcmp(candidate, name, len) == 0) {
+            *idx = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_decimal(const uint8_t *digits, uint8_t len, uint16_t *value) {
+    if (len == 0 || len > 3) {
+        return false;
+    }
+    *value = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        if (digits[i] < '0' || digits[i] > '9') {
+            return false;
+        }
+        *value = (uint16_t)(*value * 10 + (digits[i] - '0'));
+    }
+    return true;
+}
+
+static bool has_prefix(const uint8_t *type, uint8_t len, const char *prefix) {
+    const size_t prefixLen = strlen(prefix);
+    return len >= prefixLen && memcmp(type, prefix, prefixLen) == 0;
+}
+
+static bool is_type(const uint8_t *type, uint8_t len, const char *name) {
+    return len == strlen(name) && memcmp(type, name, len) == 0;
+}
+
+static parser_error_t decode_type(const uint8_t *type, uint8_t len, eip712_type_t *out) {
+    MEMZERO(out, sizeof(*out));
+
+    if (len > 0 && type[len - 1] == ']') {
+        uint8_t open = len - 1;
+        while (open > 0 && type[open] != '[') {
+            open--;
+        }
+        if (type[open] != '[' || open == 0) {
+            return parser_unexpected_type;
+        }
+        const uint8_t digitsLen = len - 1 - open - 1;
+        if (digitsLen > 0) {
+            uint16_t arrayLen = 0;
+            if (!parse_decimal(type + open + 1, digitsLen, &arrayLen) || arrayLen == 0 || arrayLen > UINT8_MAX) {
+                return parser_unexpected_type;
+            }
+            out->arrayLen = (uint8_t)arrayLen;
+        }
+        // only one array dimension
+        if (type[open - 1] == ']') {
+            return parser_unexpected_type;
+        }
+        out->isArray = true;
+        len = open;
+    }
+
+    uint16_t bits = 0;
+    if (is_type(type, len, "address")) {
+        out->kind = eip712_address;
+    } else if (is_type(type, len, "bool")) {
+        out->kind = eip712_bool;
+    } else if (is_type(type, len, "string")) {
+        out->kind = eip712_string;
+    } else if (is_type(type, len, "bytes")) {
+        out->kind = eip712_bytes;
+    } else if (has_prefix(type, len, "bytes")) {
+        if (!parse_decimal(type + 5, len - 5, &bits) || bits == 0 || bits > EIP712_WORD_LEN) {
+            return parser_unexpected_type;
+        }
+        out->kind = eip712_bytes_fixed;
+        out->size = (uint8_t)bits;
+    } else if (has_prefix(type, len, "uint") || has_prefix(type, len, "int")) {
+        const uint8_t prefixLen = (type[0] == 'u') ? 4 : 3;
+        if (!parse_decimal(type + prefixLen, len - prefixLen, &bits) || bits == 0 || bits > 256 || bits % 8 != 0) {
+            return parser_unexpected_type;
+        }
+        out->kind = (type[0] == 'u') ? eip712_uint : eip712_int;
+        out->size = (uint8_t)(bits / 8);
+    } else if (find_struct(type, len, &out->structIdx)) {
+        out->kind = eip712_struct;
+    } else {
+        return parser_unexpected_type;
+    }
+    return parser_ok;
+}
+
+// Absorbs "Name(type1 name1,type2 name2)" into the aux slot
+static parser_error_t encode_struct_type(uint8_t idx) {
+    uint8_t nameLen = 0;
+    const uint8_t *name = struct_name(idx, &nameLen);
+    CHECK_ERROR(hash_update(AUX_SLOT, name, nameLen))
+    CHECK_ERROR(hash_update(AUX_SLOT, (const uint8_t *)"(", 1))
+    const uint8_t numFields = struct_num_fields(idx);
+    for (uint8_t i = 0; i < numFields; i++) {
+        const uint8_t *field = struct_field(idx, i);
+        if (i > 0) {
+            CHECK_ERROR(hash_update(AUX_SLOT, (const uint8_t *)",", 1))
+        }
+        CHECK_ERROR(hash_update(AUX_SLOT, field + 1, field[0]))
+        CHECK_ERROR(hash_update(AUX_SLOT, (const uint8_t *)" ", 1))
+        CHECK_ERROR(hash_update(AUX_SLOT, field + 2 + field[0], field[1 + field[0]]))
+    }
+    return hash_update(AUX_SLOT, (const uint8_t *)")", 1);
+}
+
+static bool name_less(uint8_t a, uint8_t b) {
+    uint8_t lenA = 0;
+    uint8_t lenB = 0;
+    const uint8_t *nameA = struct_name(a, &lenA);
+    const uint8_t *nameB = struct_name(b, &lenB);
+    const int cmp = memcmp(nameA, nameB, MIN(lenA, lenB));
+    return cmp < 0 || (cmp == 0 && lenA < lenB);
+}
+
+// typeHash = keccak256(encodeType): the struct followed by every referenced struct sorted by name
+static parser_error_t type_hash(uint8_t idx, uint8_t *out) {
+    uint16_t deps = (uint16_t)(1u << idx);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint8_t s = 0; s < eip712.numStructs; s++) {
+            if ((deps & (1u << s)) == 0) {
+                continue;
+            }
+            const uint8_t numFields = struct_num_fields(s);
+            for (uint8_t f = 0; f < numFields; f++) {
+                const uint8_t *field = struct_field(s, f);
+                eip712_type_t type = {0};
+                CHECK_ERROR(decode_type(field + 1, field[0], &type))
+                if (type.kind == eip712_struct && (deps & (1u << type.structIdx)) == 0) {
+                    deps |= (uint16_t)(1u << type.structIdx);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    CHECK_ERROR(hash_init(AUX_SLOT))
+    CHECK_ERROR(encode_struct_type(idx))
+    deps &= (uint16_t) ~(1u << idx);
+    while (deps != 0) {
+        uint8_t next = EIP712_MAX_STRUCTS;
+        for (uint8_t s = 0; s < eip712.numStructs; s++) {
+            if ((deps & (1u << s)) != 0 && (next == EIP712_MAX_STRUCTS || name_less(s, next))) {
+                next = s;
+            }
+        }
+        CHECK_ERROR(encode_struct_type(next))
+        deps &= (uint16_t) ~(1u << next);
+    }
+    return hash_final(AUX_SLOT, out);
+}
+
+static parser_error_t push_struct(uint8_t structIdx, uint16_t nameOffset, uint8_t nameLen) {
+    if (eip712.depth >= EIP712_MAX_DEPTH) {
+        return parser_value_out_of_range;
+    }
+    uint8_t typeHash[EIP712_WORD_LEN] = {0};
+    CHECK_ERROR(type_hash(structIdx, typeHash))
+
+    eip712_frame_t *frame = &eip712.frames[eip712.depth];
+    MEMZERO(frame, sizeof(*frame));
+    frame->structIdx = structIdx;
+    frame->nameOffset = nameOffset;
+    frame->nameLen = nameLen;
+    CHECK_ERROR(hash_init(eip712.depth))
+    CHECK_ERROR(hash_update(eip712.depth, typeHash, sizeof(typeHash)))
+    eip712.depth++;
+    return parser_ok;
+}
+
+static parser_error_t push_array(const eip712_type_t *type, uint8_t count, uint16_t nameOffset, uint8_t nameLen) {
+    if (eip712.depth >= EIP712_MAX_DEPTH) {
+        return parser_value_out_of_range;
+    }
+    eip712_frame_t *frame = &eip712.frames[eip712.depth];
+    MEMZERO(frame, sizeof(*frame));
+    frame->isArray = true;
+    frame->elemType = *type;
+    frame->elemType.isArray = false;
+    frame->remaining = count;
+    frame->nameOffset = nameOffset;
+    frame->nameLen = nameLen;
+    CHECK_ERROR(hash_init(eip712.depth))
+    eip712.depth++;
+    return parser_ok;
+}
+
+// Type and name of what the innermost open level expects next
+static parser_error_t next_slot(eip712_type_t *type, uint16_t *nameOffset, uint8_t *nameLen) {
+    const eip712_frame_t *frame = &eip712.frames[eip712.depth - 1];
+    if (frame->isArray) {
+        *type = frame->elemType;
+        *nameOffset = frame->nameOffset;
+        *nameLen = frame->nameLen;
+        return parser_ok;
+    }
+    const uint8_t *field = struct_field(frame->structIdx, frame->fieldIdx);
+    *nameOffset = (uint16_t)(field + 2 + field[0] - eip712.arena);
+    *nameLen = field[1 + field[0]];
+    return decode_type(field + 1, field[0], type);
+}
+
+static bool frame_complete(const eip712_frame_t *frame) {
+    return frame->isArray ? frame->remaining == 0 : frame->fieldIdx >= struct_num_fields(frame->structIdx);
+}
+
+static parser_error_t absorb_word(const uint8_t *word) {
+    eip712_frame_t *frame = &eip712.frames[eip712.depth - 1];
+    CHECK_ERROR(hash_update(eip712.depth - 1, word, EIP712_WORD_LEN))
+    if (frame->isArray) {
+        frame->remaining--;
+    } else {
+        frame->fieldIdx++;
+    }
+    return parser_ok;
+}
+
+static parser_error_t compute_digest(void) {
+    static const uint8_t prefix[] = {0x19, 0x01};
+    CHECK_ERROR(hash_init(AUX_SLOT))
+    CHECK_ERROR(hash_update(AUX_SLOT, prefix, sizeof(prefix)))
+    CHECK_ERROR(hash_update(AUX_SLOT, eip712.domainHash, sizeof(eip712.domainHash)))
+    CHECK_ERROR(hash_update(AUX_SLOT, eip712.messageHash, sizeof(eip712.messageHash)))
+    return hash_final(AUX_SLOT, eip712.digest);
+}
+
+// Closes completed levels and opens nested structs until a value or an array length is needed
+static parser_error_t settle(void) {
+    while (eip712.depth > 0) {
+        const eip712_frame_t *frame = &eip712.frames[eip712.depth - 1];
+        if (frame_complete(frame)) {
+            uint8_t hash[EIP712_WORD_LEN] = {0};
+            CHECK_ERROR(hash_final(eip712.depth - 1, hash))
+            eip712.depth--;
+            if (eip712.depth > 0) {
+                CHECK_ERROR(absorb_word(hash))
+                continue;
+            }
+            if (eip712.phase == eip712_phase_domain) {
+                MEMCPY(eip712.domainHash, hash, sizeof(hash));
+                eip712.phase = eip712_phase_between;
+                return parser_ok;
+            }
+            MEMCPY(eip712.messageHash, hash, sizeof(hash));
+            eip712.phase = eip712_phase_done;
+            return compute_digest();
+        }
+
+        eip712_type_t type = {0};
+        uint16_t nameOffset = 0;
+        uint8_t nameLen = 0;
+        CHECK_ERROR(next_slot(&type, &nameOffset, &nameLen))
+        if (type.isArray || type.kind != eip712_struct) {
+            return parser_ok;
+        }
+        CHECK_ERROR(push_struct(type.structIdx, nameOffset, nameLen))
+    }
+    return parser_ok;
+}
+
+// Prepends name to the key being built right to left in key[0, *pos)
+static bool key_prepend(char *key, uint16_t *pos, uint16_t nameOffset, uint8_t nameLen, bool separator) {
+    if (separator) {
+        if (*pos == 0) {
+            return false;
+        }
+        key[--(*pos)] = '.';
+    }
+    const uint16_t len = MIN(nameLen, *pos);
+    *pos -= len;
+    MEMCPY(key + *pos, eip712.arena + nameOffset + nameLen - len, len);
+    return len == nameLen;
+}
+
+// Review key: the path of the field below the primary type, e.g. "from.name", cut on the left when it
+// does not fit. Array elements take the name of their array instead of repeating it.
+static void format_key(char *key, uint16_t keyLen, uint16_t nameOffset, uint8_t nameLen) {
+    char path[EIP712_DISPLAY_KEY_LEN] = {0};
+    const uint16_t room = MIN(keyLen, sizeof(path)) - 1;
+    uint16_t pos = room;
+    bool complete = true;
+    bool separator = false;
+
+    if (!eip712.frames[eip712.depth - 1].isArray) {
+        complete = key_prepend(path, &pos, nameOffset, nameLen, false);
+        separator = true;
+    }
+    for (uint8_t level = eip712.depth - 1; level > 0 && complete; level--) {
+        const eip712_frame_t *frame = &eip712.frames[level];
+        if (eip712.frames[level - 1].isArray) {
+            continue;
+        }
+        complete = key_prepend(path, &pos, frame->nameOffset, frame->nameLen, separator);
+        separator = true;
+    }
+    if (!complete && room >= 2) {
+        path[pos] = '.';
+        path[pos + 1] = '.';
+    }
+    MEMZERO(key, keyLen);
+    MEMCPY(key, path + pos, room - pos);
+}
+
+// Review items are kept only while there is room; the rest are counted
+static eip712_item_t *item_reserve(uint16_t nameOffset, uint8_t nameLen) {
+    if (eip712.numItems >= EIP712_MAX_DISPLAY_ITEMS) {
+        eip712.hiddenItems++;
+        return NULL;
+    }
+    eip712_item_t *item = &eip712.items[eip712.numItems++];
+    MEMZERO(item, sizeof(*item));
+    format_key(item->key, sizeof(item->key), nameOffset, nameLen);
+    return item;
+}
+
+static void item_release(void) {
+    eip712.numItems--;
+    eip712.hiddenItems++;
+}
+
+static void format_hex(char *out, uint16_t outLen, const uint8_t *data, uint8_t dataLen) {
+    if (outLen < 3) {
+        return;
+    }
+    out[0] = '0';
+    out[1] = 'x';
+    hex_encode(out + 2, outLen - 2, data, dataLen);
+}
+
+static parser_error_t show_atomic(const eip712_type_t *type, const uint8_t *word, uint16_t nameOffset, uint8_t nameLen) {
+    eip712_item_t *item = item_reserve(nameOffset, nameLen);
+    if (item == NULL) {
+        return parser_ok;
+    }
+
+    uint8_t magnitude[EIP712_WORD_LEN] = {0};
+    uint8_t pageCount = 0;
+    rlp_t number = {.kind = RLP_KIND_STRING, .ptr = word, .rlpLen = EIP712_WORD_LEN};
+    switch (type->kind) {
+        case eip712_address:
+            format_hex(item->value, sizeof(item->value), word + EIP712_WORD_LEN - EIP712_ADDR_LEN, EIP712_ADDR_LEN);
+            return parser_ok;
+        case eip712_bool:
+            snprintf(item->value, sizeof(item->value), "%s", word[EIP712_WORD_LEN - 1] ? "true" : "false");
+            return parser_ok;
+        case eip712_bytes_fixed:
+            format_hex(item->value, sizeof(item->value), word, type->size);
+            return parser_ok;
+        case eip712_int:
+            if ((word[0] & 0x80) != 0) {
+                // two's complement magnitude of a negative value
+                uint8_t carry = 1;
+                for (int8_t i = EIP712_WORD_LEN - 1; i >= 0; i--) {
+                    const uint16_t sum = (uint16_t)((uint8_t)~word[i]) + carry;
+                    magnitude[i] = (uint8_t)sum;
+                    carry = (uint8_t)(sum >> 8);
+                }
+                number.ptr = magnitude;
+                item->value[0] = '-';
+                return printRLPNumber(&number, item->value + 1, sizeof(item->value) - 1, 0, &pageCount);
+            }
+            return printRLPNumber(&number, item->value, sizeof(item->value), 0, &pageCount);
+        case eip712_uint:
+            return printRLPNumber(&number, item->value, sizeof(item->value), 0, &pageCount);
+        default:
+            return parser_unexpected_type;
+    }
+}
+
+// Dynamic values are shown only when they fit in one review item
+static void show_dynamic(uint8_t kind, const uint8_t *data, uint16_t dataLen) {
+    if (!eip712.valueShown) {
+        return;
+    }
+    eip712_item_t *item = &eip712.items[eip712.numItems - 1];
+    const uint16_t room = sizeof(item->value) - 1;
+
+    for (uint16_t i = 0; i < dataLen; i++) {
+        const uint16_t used = (kind == eip712_string) ? eip712.valueLen : (uint16_t)(2 + 2 * eip712.valueLen);
+        const uint16_t needed = (kind == eip712_string) ? 1 : 2;
+        if (used + needed > room || (kind == eip712_string && !IS_PRINTABLE(data[i]))) {
+            eip712.valueShown = false;
+            item_release();
+            return;
+        }
+        if (kind == eip712_string) {
+            item->value[used] = (char)data[i];
+        } else {
+            if (eip712.valueLen == 0) {
+                item->value[0] = '0';
+                item->value[1] = 'x';
+            }
+            hex_encode(item->value + used, sizeof(item->value) - used, data + i, 1);
+        }
+        eip712.valueLen++;
+    }
+}
+
+static parser_error_t encode_atomic(const eip712_type_t *type, const uint8_t *data, uint16_t dataLen, uint8_t *word) {
+    MEMZERO(word, EIP712_WORD_LEN);
+    switch (type->kind) {
+        case eip712_address:
+            if (dataLen != EIP712_ADDR_LEN) {
+                return parser_unexpected_value;
+            }
+            MEMCPY(word + EIP712_WORD_LEN - EIP712_ADDR_LEN, data, EIP712_ADDR_LEN);
+            return parser_ok;
+        case eip712_bool:
+            if (dataLen != 1 || data[0] > 1) {
+                return parser_unexpected_value;
+            }
+            word[EIP712_WORD_LEN - 1] = data[0];
+            return parser_ok;
+        case eip712_bytes_fixed:
+            if (dataLen != type->size) {
+                return parser_unexpected_value;
+            }
+            MEMCPY(word, data, dataLen);
+            return parser_ok;
+        case eip712_uint:
+        case eip712_int:
+            if (dataLen > type->size) {
+                return parser_value_out_of_range;
+            }
+            // intN values are sign extended to 256 bits
+            if (type->kind == eip712_int && dataLen > 0 && (data[0] & 0x80) != 0) {
+                memset(word, 0xFF, EIP712_WORD_LEN);
+            }
+            if (dataLen > 0) {
+                MEMCPY(word + EIP712_WORD_LEN - dataLen, data, dataLen);
+            }
+            return parser_ok;
+        default:
+            return parser_unexpected_type;
+    }
+}
+
+static bool hashing(void) {
+    return (eip712.phase == eip712_phase_domain || eip712.phase == eip712_phase_message) && eip712.depth > 0;
+}
+
+void eip712_reset(void) {
+    session_claim(session_flow_eip712);
+    MEMZERO(&eip712, sizeof(eip712));
+}
+
+void eip712_release(void) {
+    session_release(session_flow_eip712);
+}
+
+parser_error_t eip712_add_struct(const uint8_t *data, uint16_t dataLen) {
+    if (data == NULL || dataLen == 0) {
+        return parser_no_data;
+    }
+    if (eip712.phase != eip712_phase_types) {
+        return parser_unexpected_method;
+    }
+    if (eip712.numStructs >= EIP712_MAX_STRUCTS) {
+        return parser_unexpected_number_items;
+    }
+    if (dataLen > sizeof(eip712.arena) - eip712.arenaLen) {
+        return parser_value_out_of_range;
+    }
+
+    // validate the layout once so the arena can be walked without checks
+    uint16_t offset = 0;
+    const uint8_t nameLen = data[offset++];
+    if (nameLen == 0 || dataLen < offset + nameLen + 1) {
+        return parser_unexpected_buffer_end;
+    }
+    const uint8_t *name = data + offset;
+    offset += nameLen;
+    const uint8_t numFields = data[offset++];
+    for (uint8_t i = 0; i < numFields; i++) {
+        for (uint8_t part = 0; part < 2; part++) {
+            if (offset >= dataLen) {
+                return parser_unexpected_buffer_end;
+            }
+            const uint8_t partLen = data[offset++];
+            if (partLen == 0 || dataLen - offset < partLen) {
+                return parser_unexpected_buffer_end;
+            }
+            offset += partLen;
+        }
+    }
+    if (offset != dataLen) {
+        return parser_unexpected_characters;
+    }
+
+    uint8_t existing = 0;
+    if (find_struct(name, nameLen, &existing)) {
+        return parser_duplicated_field;
+    }
+
+    MEMCPY(eip712.arena + eip712.arenaLen, data, dataLen);
+    eip712.structs[eip712.numStructs++] = eip712.arenaLen;
+    eip712.arenaLen += dataLen;
+    return parser_ok;
+}
+
+parser_error_t eip712_start(const uint8_t *name, uint8_t nameLen) {
+    if (name == NULL || nameLen == 0) {
+        return parser_no_data;
+    }
+    if (eip712.phase == eip712_phase_types) {
+        // the domain separator comes first
+        if (!is_type(name, nameLen, DOMAIN_TYPE)) {
+            return parser_unexpected_type;
+        }
+        eip712.phase = eip712_phase_domain;
+    } else if (eip712.phase == eip712_phase_between) {
+        eip712.phase = eip712_phase_message;
+    } else {
+        return parser_unexpected_method;
+    }
+
+    uint8_t idx = 0;
+    if (!find_struct(name, nameLen, &idx)) {
+        return parser_unexpected_type;
+    }
+    CHECK_ERROR(push_struct(idx, eip712.structs[idx] + 1, nameLen))
+    return settle();
+}
+
+parser_error_t eip712_set_array_len(uint8_t count) {
+    if (!hashing() || eip712.valueOpen) {
+        return parser_unexpected_method;
+    }
+    eip712_type_t type = {0};
+    uint16_t nameOffset = 0;
+    uint8_t nameLen = 0;
+    CHECK_ERROR(next_slot(&type, &nameOffset, &nameLen))
+    if (!type.isArray) {
+        return parser_unexpected_type;
+    }
+    if (type.arrayLen != 0 && type.arrayLen != count) {
+        return parser_unexpected_value;
+    }
+    CHECK_ERROR(push_array(&type, count, nameOffset, nameLen))
+    return settle();
+}
+
+parser_error_t eip712_feed_value(const uint8_t *data, uint16_t dataLen, bool more) {
+    if (!hashing()) {
+        return parser_unexpected_method;
+    }
+    if (data == NULL && dataLen > 0) {
+        return parser_no_data;
+    }
+    eip712_type_t type = {0};
+    uint16_t nameOffset = 0;
+    uint8_t nameLen = 0;
+    CHECK_ERROR(next_slot(&type, &nameOffset, &nameLen))
+    if (type.isArray || type.kind == eip712_struct) {
+        return parser_unexpected_type;
+    }
+
+    uint8_t word[EIP712_WORD_LEN] = {0};
+    if (type.kind == eip712_string || type.kind == eip712_bytes) {
+        // dynamic values are encoded as their keccak256
+        if (!eip712.valueOpen) {
+            CHECK_ERROR(hash_init(AUX_SLOT))
+            eip712.valueOpen = true;
+            eip712.valueLen = 0;
+            eip712.valueShown = item_reserve(nameOffset, nameLen) != NULL;
+        }
+        if (dataLen > 0) {
+            CHECK_ERROR(hash_update(AUX_SLOT, data, dataLen))
+            show_dynamic(type.kind, data, dataLen);
+        }
+        if (more) {
+            return parser_ok;
+        }
+        eip712.valueOpen = false;
+        CHECK_ERROR(hash_final(AUX_SLOT, word))
+    } else {
+        if (more) {
+            return parser_unexpected_value;
+        }
+        CHECK_ERROR(encode_atomic(&type, data, dataLen, word))
+        CHECK_ERROR(show_atomic(&type, word, nameOffset, nameLen))
+    }
+
+    CHECK_ERROR(absorb_word(word))
+    return settle();
+}
+
+bool eip712_is_complete(void) {
+    return eip712.phase == eip712_phase_done;
+}
+
+parser_error_t eip712_validate(void) {
+    if (!eip712_is_complete()) {
+        return parser_unexpected_method;
+    }
+    // what is not on screen can only be signed blindly
+    if (eip712.hiddenItems > 0 && !app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
+    }
+    return parser_ok;
+}
+
+const uint8_t *eip712_get_digest(void) {
+    return eip712.digest;
+}
+
+// Review: title, kept values, hidden count, domain and message hashes
+zxerr_t eip712_getNumItems(uint8_t *num_items) {
+    if (num_items == NULL) {
+        return zxerr_no_data;
+    }
+    *num_items = 1 + eip712.numItems + (eip712.hiddenItems > 0 ? 1 : 0) + 2;
+    return zxerr_ok;
+}
+
+zxerr_t eip712_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                       uint8_t pageIdx, uint8_t *pageCount) {
+    if (outKey == NULL || outVal == NULL || pageCount == NULL || displayIdx < 0) {
+        return zxerr_no_data;
+    }
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+
+    if (displayIdx == 0) {
+        snprintf(outKey, outKeyLen, "Sign");
+        snprintf(outVal, outValLen, "Typed data");
+        return zxerr_ok;
+    }
+    uint8_t idx = (uint8_t)displayIdx - 1;
+
+    if (idx < eip712.numItems) {
+        snprintf(outKey, outKeyLen, "%s", eip712.items[idx].key);
+        pageString(outVal, outValLen, eip712.items[idx].value, pageIdx, pageCount);
+        return zxerr_ok;
+    }
+    idx -= eip712.numItems;
+
+    if (eip712.hiddenItems > 0) {
+        if (idx == 0) {
+            snprintf(outKey, outKeyLen, "Hidden fields");
+            snprintf(outVal, outValLen, "%d", eip712.hiddenItems);
+            return zxerr_ok;
+        }
+        idx--;
+    }
+
+    if (idx > 1) {
+        return zxerr_no_data;
+    }
+    snprintf(outKey, outKeyLen, "%s", idx == 0 ? "Domain hash" : "Message hash");
+    pageHex(outVal, outValLen, NULL, idx == 0 ? eip712.domainHash : eip712.messageHash, EIP712_WORD_LEN, pageIdx,
+            pageCount);
+    return zxerr_ok;
+}
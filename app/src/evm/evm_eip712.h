@@ -0,0 +1,141 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "parser_common.h"
+#include "zxerror.h"
+
+#if defined(LEDGER_SPECIFIC)
+#include "cx.h"
+#endif
+
+// EIP-712 typed data. Struct definitions are kept in a small arena; the domain
+// and the message are then received field by field and hashed on the fly, one
+// Keccak context per nesting level. Only the values selected for the review are
+// kept, so RAM use does not depend on the size of the message.
+#define EIP712_TYPES_ARENA_SIZE   768
+#define EIP712_MAX_STRUCTS        12
+// struct and array levels that can be open at the same time
+#define EIP712_MAX_DEPTH          4
+#define EIP712_MAX_DISPLAY_ITEMS  8
+#define EIP712_DISPLAY_KEY_LEN    21
+#define EIP712_DISPLAY_VALUE_LEN  80
+#define EIP712_WORD_LEN           32
+
+typedef struct {
+    uint8_t kind;
+    // byte size of uintN, intN and bytesN
+    uint8_t size;
+    uint8_t structIdx;
+    bool isArray;
+    // 0 for dynamic arrays
+    uint8_t arrayLen;
+} eip712_type_t;
+
+typedef struct {
+    bool isArray;
+    // struct frames
+    uint8_t structIdx;
+    uint8_t fieldIdx;
+    // array frames
+    eip712_type_t elemType;
+    uint8_t remaining;
+    // field that opened the frame, used as review key of array elements
+    uint16_t nameOffset;
+    uint8_t nameLen;
+} eip712_frame_t;
+
+typedef struct {
+    char key[EIP712_DISPLAY_KEY_LEN];
+    char value[EIP712_DISPLAY_VALUE_LEN];
+} eip712_item_t;
+
+typedef struct {
+    uint8_t arena[EIP712_TYPES_ARENA_SIZE];
+    uint16_t arenaLen;
+    uint16_t structs[EIP712_MAX_STRUCTS];
+    uint8_t numStructs;
+
+    uint8_t phase;
+    eip712_frame_t frames[EIP712_MAX_DEPTH];
+    uint8_t depth;
+
+    // dynamic value being hashed in the aux slot
+    bool valueOpen;
+    bool valueShown;
+    uint16_t valueLen;
+
+    uint8_t domainHash[EIP712_WORD_LEN];
+    uint8_t messageHash[EIP712_WORD_LEN];
+    uint8_t digest[EIP712_WORD_LEN];
+
+    eip712_item_t items[EIP712_MAX_DISPLAY_ITEMS];
+    uint8_t numItems;
+    uint16_t hiddenItems;
+} eip712_state_t;
+
+typedef struct {
+    eip712_state_t state;
+#if defined(LEDGER_SPECIFIC)
+    // one context per open level plus one for type hashes and dynamic values
+    cx_sha3_t hash[EIP712_MAX_DEPTH + 1];
+#endif
+} eip712_session_t;
+
+/// Drops the definitions and the hashing state of the previous session and
+/// takes the session arena for a new one
+void eip712_reset(void);
+
+/// Gives the session arena back, if it holds an EIP-712 session
+void eip712_release(void);
+
+/// Adds a struct definition:
+/// [nameLen (1)] [name] [numFields (1)] { [typeLen (1)] [type] [nameLen (1)] [name] }
+parser_error_t eip712_add_struct(const uint8_t *data, uint16_t dataLen);
+
+/// Starts hashing a root struct: first EIP712Domain, then the primary type
+parser_error_t eip712_start(const uint8_t *name, uint8_t nameLen);
+
+/// Number of elements of the array expected next
+parser_error_t eip712_set_array_len(uint8_t count);
+
+/// Value of the atomic field expected next. Dynamic values (string, bytes) can be
+/// split over several calls, more is set on every part but the last one.
+parser_error_t eip712_feed_value(const uint8_t *data, uint16_t dataLen, bool more);
+
+/// \return true once the domain and the message were hashed
+bool eip712_is_complete(void);
+
+/// Checks that the completed data can be reviewed with the current settings
+parser_error_t eip712_validate(void);
+
+/// \return keccak256(0x19 0x01 || domainSeparator || hashStruct(message))
+const uint8_t *eip712_get_digest(void);
+
+zxerr_t eip712_getNumItems(uint8_t *num_items);
+zxerr_t eip712_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                       uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
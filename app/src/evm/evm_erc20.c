@@ -16,6 +16,10 @@
 
 #include "evm_erc20.h"
 
+#include "erc20_tokens.h"
+#include "evm_erc20_cache.h"
+#include "evm_utils.h"
+#include "format_scratch.h"
 #include "zxformat.h"
 
 #define EVM_SELECTOR_LENGTH          4
@@ -24,42 +28,113 @@
 // Prefix is calculated as: keccak256("transfer(address,uint256)") = 0xa9059cbb
 const uint8_t ERC20_TRANSFER_PREFIX[] = {0xa9, 0x05, 0x9c, 0xbb};
 
-#define DECIMAL_BASE 10
-const erc20_tokens_t supportedTokens[] = {{{0xa8, 0x10, 0xac, 0xb7, 0xcc, 0xdc, 0x4e, 0xd8, 0x24, 0xb9,
-                                            0x52, 0xbe, 0x94, 0x0d, 0x63, 0x92, 0x43, 0x46, 0x72, 0xcf},
-                                           "AGUS ",
-                                           18}
+#define DECIMAL_BASE    10
+#define AMOUNT_TEXT_LEN 100
 
-};
+const erc20_tokens_t *findERC20Token(const uint8_t *address) {
+    if (address == NULL) {
+        return NULL;
+    }
+    const erc20_tokens_t *tokens = (const erc20_tokens_t *)PIC(supportedTokens);
+    uint16_t low = 0;
+    uint16_t high = sizeof(supportedTokens) / sizeof(supportedTokens[0]);
+    while (low < high) {
+        const uint16_t mid = low + (high - low) / 2;
+        const int cmp = memcmp(address, tokens[mid].address, ETH_ADDRESS_LEN);
+        if (cmp == 0) {
+            return &tokens[mid];
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+const erc20_tokens_t *lookupERC20Token(const eth_tx_t *ethObj) {
+    if (ethObj == NULL || ethObj->tx.to.valueLen != ETH_ADDRESS_LEN) {
+        return NULL;
+    }
+    rlp_t to = {0};
+    eth_tx_view(ethObj, &ethObj->tx.to, &to);
+
+    // descriptors sent by the host take precedence over the compiled table
+    const erc20_tokens_t *token = NULL;
+    rlp_t chainIdView = {0};
+    uint64_t chainId = 0;
+    eth_tx_view(ethObj, &ethObj->chainId, &chainIdView);
+    if (chainIdView.rlpLen > 0 && be_bytes_to_u64(chainIdView.ptr, chainIdView.rlpLen, &chainId) == parser_ok) {
+        token = erc20_cache_lookup(to.ptr, chainId);
+    }
+    if (token == NULL) {
+        token = findERC20Token(to.ptr);
+    }
+    return token;
+}
+
+static void getTokenInfo(const eth_tx_t *ethObj, char tokenSymbol[MAX_SYMBOL_LEN], uint8_t *decimals) {
+    const erc20_tokens_t *token = lookupERC20Token(ethObj);
+    if (token != NULL) {
+        snprintf(tokenSymbol, MAX_SYMBOL_LEN, "%.*s ", ERC20_SYMBOL_STORED_LEN, token->symbol);
+        *decimals = token->decimals;
+        return;
+    }
+    snprintf(tokenSymbol, MAX_SYMBOL_LEN, "?? ");
+    *decimals = 0;
+}
 
 parser_error_t getERC20Token(const eth_tx_t *ethObj, char tokenSymbol[MAX_SYMBOL_LEN], uint8_t *decimals) {
-    if (ethObj == NULL || tokenSymbol == NULL || decimals == NULL || ethObj->tx.data.rlpLen != ERC20_DATA_LENGTH ||
-        memcmp(ethObj->tx.data.ptr, ERC20_TRANSFER_PREFIX, EVM_SELECTOR_LENGTH) != 0) {
+    if (ethObj == NULL || tokenSymbol == NULL || decimals == NULL) {
+        return parser_unexpected_value;
+    }
+    rlp_t to = {0};
+    rlp_t data = {0};
+    eth_tx_view(ethObj, &ethObj->tx.to, &to);
+    eth_tx_view(ethObj, &ethObj->tx.data, &data);
+    if (to.rlpLen != ETH_ADDRESS_LEN || data.rlpLen != ERC20_DATA_LENGTH ||
+        memcmp(data.ptr, ERC20_TRANSFER_PREFIX, EVM_SELECTOR_LENGTH) != 0) {
         return parser_unexpected_value;
     }
 
     // Verify address contract: first 12 bytes must be 0
-    const uint8_t *addressPtr = ethObj->tx.data.ptr + EVM_SELECTOR_LENGTH;
+    const uint8_t *addressPtr = data.ptr + EVM_SELECTOR_LENGTH;
     for (uint8_t i = 0; i < ERC20_ADDRESS_PADDING_LENGTH; i++) {
         if (*(addressPtr++) != 0) {
             return parser_unexpected_value;
         }
     }
 
-    // Check if token is in the list
-    const uint8_t supportedTokensSize = sizeof(supportedTokens) / sizeof(supportedTokens[0]);
-    for (uint8_t i = 0; i < supportedTokensSize; i++) {
-        if (memcmp(ethObj->tx.to.ptr, supportedTokens[i].address, ETH_ADDRESS_LEN) == 0) {
-            // Set symbol and decimals
-            snprintf(tokenSymbol, 10, "%s", (char *)PIC(supportedTokens[i].symbol));
-            *decimals = supportedTokens[i].decimals;
-            return parser_ok;
-        }
+    getTokenInfo(ethObj, tokenSymbol, decimals);
+    return parser_ok;
+}
+
+static parser_error_t formatAmount(const uint8_t *amount, const char *tokenSymbol, uint8_t decimals, char *outVal,
+                                   uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    uint256_t value = {0};
+    parser_context_t tmpCtx = {.buffer = amount, .bufferLen = BIGINT_LENGTH, .offset = 0};
+    CHECK_ERROR(readu256BE(&tmpCtx, &value));
+
+    char *bufferUI = format_scratch_borrow(AMOUNT_TEXT_LEN);
+    if (bufferUI == NULL) {
+        return parser_unexpected_error;
     }
 
-    snprintf(tokenSymbol, 10, "?? ");
-    *decimals = 0;
-    return parser_ok;
+    parser_error_t err = parser_ok;
+    if (!tostring256(&value, DECIMAL_BASE, bufferUI, AMOUNT_TEXT_LEN)) {
+        err = parser_unexpected_error;
+    } else if (intstr_to_fpstr_inplace(bufferUI, AMOUNT_TEXT_LEN, decimals) == 0) {
+        // Add symbol, add decimals, page number
+        err = parser_unexpected_value;
+    } else if (z_str3join(bufferUI, AMOUNT_TEXT_LEN, tokenSymbol, NULL) != zxerr_ok) {
+        err = parser_unexpected_buffer_end;
+    } else {
+        number_inplace_trimming(bufferUI, 1);
+        pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+    }
+    format_scratch_return();
+    return err;
 }
 
 parser_error_t printERC20Value(const eth_tx_t *ethObj, char *outVal, uint16_t outValLen, uint8_t pageIdx,
@@ -69,55 +144,55 @@ parser_error_t printERC20Value(const eth_tx_t *ethObj, char *outVal, uint16_t ou
     }
 
     // [identifier (4) | token contract (12 + 20) | value (32)]
-    char tokenSymbol[10] = {0};
+    char tokenSymbol[MAX_SYMBOL_LEN] = {0};
     uint8_t decimals = 0;
     CHECK_ERROR(getERC20Token(ethObj, tokenSymbol, &decimals))
 
-    uint256_t value = {0};
-    const uint8_t *valuePtr = ethObj->tx.data.ptr + SELECTOR_LENGTH + BIGINT_LENGTH;
-    parser_context_t tmpCtx = {.buffer = valuePtr, .bufferLen = BIGINT_LENGTH, .offset = 0};
-    CHECK_ERROR(readu256BE(&tmpCtx, &value));
+    rlp_t data = {0};
+    eth_tx_view(ethObj, &ethObj->tx.data, &data);
+    return formatAmount(data.ptr + SELECTOR_LENGTH + BIGINT_LENGTH, tokenSymbol, decimals, outVal, outValLen, pageIdx,
+                        pageCount);
+}
 
-    char bufferUI[100] = {0};
-    if (!tostring256(&value, DECIMAL_BASE, bufferUI, sizeof(bufferUI))) {
+parser_error_t printERC20Amount(const eth_tx_t *ethObj, const uint8_t *amount, char *outVal, uint16_t outValLen,
+                                uint8_t pageIdx, uint8_t *pageCount) {
+    if (ethObj == NULL || amount == NULL || outVal == NULL || pageCount == NULL) {
         return parser_unexpected_error;
     }
-
-    // Add symbol, add decimals, page number
-    if (intstr_to_fpstr_inplace(bufferUI, sizeof(bufferUI), decimals) == 0) {
-        return parser_unexpected_value;
-    }
-
-    if (z_str3join(bufferUI, sizeof(bufferUI), tokenSymbol, NULL) != zxerr_ok) {
-        return parser_unexpected_buffer_end;
-    }
-
-    number_inplace_trimming(bufferUI, 1);
-    pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
-
-    return parser_ok;
+    char tokenSymbol[MAX_SYMBOL_LEN] = {0};
+    uint8_t decimals = 0;
+    getTokenInfo(ethObj, tokenSymbol, &decimals);
+    return formatAmount(amount, tokenSymbol, decimals, outVal, outValLen, pageIdx, pageCount);
 }
 
-bool validateERC20(eth_tx_t *ethObj) {
-    if (ethObj == NULL) {
+bool isERC20TransferData(const rlp_t *to, const rlp_t *data) {
+    if (to == NULL || data == NULL) {
         return false;
     }
     // Check that data start with ERC20 prefix
-    if (ethObj->tx.to.rlpLen != ETH_ADDRESS_LEN || ethObj->tx.data.ptr == NULL ||
-        ethObj->tx.data.rlpLen != ERC20_DATA_LENGTH ||
-        memcmp(ethObj->tx.data.ptr, ERC20_TRANSFER_PREFIX, sizeof(ERC20_TRANSFER_PREFIX)) != 0) {
-        ethObj->is_erc20_transfer = false;
+    if (to->rlpLen != ETH_ADDRESS_LEN || data->ptr == NULL || data->rlpLen != ERC20_DATA_LENGTH ||
+        memcmp(data->ptr, ERC20_TRANSFER_PREFIX, sizeof(ERC20_TRANSFER_PREFIX)) != 0) {
         return false;
     }
     // ABI-encode pads the 20-byte address with 12 leading zero bytes; enforce the
     // padding so the displayed recipient matches the signed calldata bit-for-bit.
-    const uint8_t *addressPtr = ethObj->tx.data.ptr + EVM_SELECTOR_LENGTH;
+    const uint8_t *addressPtr = data->ptr + EVM_SELECTOR_LENGTH;
     for (uint8_t i = 0; i < ERC20_ADDRESS_PADDING_LENGTH; i++) {
         if (*(addressPtr++) != 0) {
-            ethObj->is_erc20_transfer = false;
             return false;
         }
     }
-    ethObj->is_erc20_transfer = true;
     return true;
 }
+
+bool validateERC20(eth_tx_t *ethObj) {
+    if (ethObj == NULL) {
+        return false;
+    }
+    rlp_t to = {0};
+    rlp_t data = {0};
+    eth_tx_view(ethObj, &ethObj->tx.to, &to);
+    eth_tx_view(ethObj, &ethObj->tx.data, &data);
+    ethObj->is_erc20_transfer = isERC20TransferData(&to, &data);
+    return ethObj->is_erc20_transfer;
+}
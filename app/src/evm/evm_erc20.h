@@ -30,17 +30,30 @@ extern "C" {
 #define ERC20_DATA_LENGTH       68  // 4 + 32 + 32
 #define ADDRESS_CONTRACT_LENGTH 20
 #define MAX_SYMBOL_LEN          10
+// symbols are stored without the separator added for display, NUL padded
+#define ERC20_SYMBOL_STORED_LEN 8
+
+// Records are generated by app/tokens/gen_erc20_tokens.py, sorted by address
 typedef struct {
     uint8_t address[ETH_ADDR_LEN];
-    char symbol[MAX_SYMBOL_LEN];
     uint8_t decimals;
+    char symbol[ERC20_SYMBOL_STORED_LEN];
 } erc20_tokens_t;
 
+/// \return the supported token deployed at address, NULL when unknown
+const erc20_tokens_t *findERC20Token(const uint8_t *address);
+bool isERC20TransferData(const rlp_t *to, const rlp_t *data);
 bool validateERC20(eth_tx_t *ethObj);
 parser_error_t getERC20Token(const eth_tx_t *ethObj, char tokenSymbol[MAX_SYMBOL_LEN], uint8_t *decimals);
 parser_error_t printERC20Value(const eth_tx_t *ethObj, char *outVal, uint16_t outValLen, uint8_t pageIdx,
                                uint8_t *pageCount);
 
+/// \return the token deployed at the called contract, NULL when unknown
+const erc20_tokens_t *lookupERC20Token(const eth_tx_t *ethObj);
+/// Formats a 32-byte big-endian amount with the symbol and decimals of the called contract
+parser_error_t printERC20Amount(const eth_tx_t *ethObj, const uint8_t *amount, char *outVal, uint16_t outValLen,
+                                uint8_t pageIdx, uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
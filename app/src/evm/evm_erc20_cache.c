@@ -0,0 +1,115 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_erc20_cache.h"
+
+#include <string.h>
+
+#include "zxmacros.h"
+
+// same bound as the printable amounts of the compiled token table
+#define ERC20_DESCRIPTOR_MAX_DECIMALS 36
+
+static erc20_descriptor_t erc20_cache[ERC20_CACHE_ENTRIES];
+static uint8_t erc20_cache_used = 0;
+// slot overwritten next once the cache is full
+static uint8_t erc20_cache_next = 0;
+
+parser_error_t erc20_descriptor_parse(const uint8_t *data, uint16_t dataLen, erc20_descriptor_t *descriptor,
+                                      uint16_t *signedLen) {
+    if (data == NULL || descriptor == NULL || signedLen == NULL || dataLen == 0) {
+        return parser_no_data;
+    }
+    MEMZERO(descriptor, sizeof(*descriptor));
+
+    const uint8_t symbolLen = data[0];
+    if (symbolLen == 0 || symbolLen > ERC20_SYMBOL_STORED_LEN) {
+        return parser_unexpected_value;
+    }
+    const uint16_t signedPartLen = 1 + symbolLen + ETH_ADDR_LEN + sizeof(uint32_t) + sizeof(uint32_t);
+    if (dataLen < signedPartLen + ERC20_DESCRIPTOR_MIN_SIG_LEN) {
+        return parser_unexpected_buffer_end;
+    }
+    if (dataLen > signedPartLen + ERC20_DESCRIPTOR_MAX_SIG_LEN) {
+        return parser_unexpected_characters;
+    }
+
+    const uint8_t *ptr = data + 1;
+    for (uint8_t i = 0; i < symbolLen; i++) {
+        if (!IS_PRINTABLE(ptr[i])) {
+            return parser_unexpected_characters;
+        }
+    }
+    MEMCPY(descriptor->token.symbol, ptr, symbolLen);
+    ptr += symbolLen;
+
+    MEMCPY(descriptor->token.address, ptr, ETH_ADDR_LEN);
+    ptr += ETH_ADDR_LEN;
+
+    const uint32_t decimals = U4BE(ptr, 0);
+    if (decimals > ERC20_DESCRIPTOR_MAX_DECIMALS) {
+        return parser_value_out_of_range;
+    }
+    descriptor->token.decimals = (uint8_t)decimals;
+    ptr += sizeof(uint32_t);
+
+    descriptor->chainId = U4BE(ptr, 0);
+    if (descriptor->chainId == 0) {
+        return parser_invalid_chain_id;
+    }
+
+    *signedLen = signedPartLen;
+    return parser_ok;
+}
+
+void erc20_cache_flush(void) {
+    MEMZERO(erc20_cache, sizeof(erc20_cache));
+    erc20_cache_used = 0;
+    erc20_cache_next = 0;
+}
+
+static erc20_descriptor_t *erc20_cache_find(const uint8_t *address, uint64_t chainId) {
+    for (uint8_t i = 0; i < erc20_cache_used; i++) {
+        if (erc20_cache[i].chainId == chainId && memcmp(erc20_cache[i].token.address, address, ETH_ADDR_LEN) == 0) {
+            return &erc20_cache[i];
+        }
+    }
+    return NULL;
+}
+
+void erc20_cache_insert(const erc20_descriptor_t *descriptor) {
+    if (descriptor == NULL) {
+        return;
+    }
+    erc20_descriptor_t *entry = erc20_cache_find(descriptor->token.address, descriptor->chainId);
+    if (entry == NULL) {
+        if (erc20_cache_used < ERC20_CACHE_ENTRIES) {
+            entry = &erc20_cache[erc20_cache_used++];
+        } else {
+            entry = &erc20_cache[erc20_cache_next];
+            erc20_cache_next = (erc20_cache_next + 1) % ERC20_CACHE_ENTRIES;
+        }
+    }
+    MEMCPY(entry, descriptor, sizeof(*entry));
+}
+
+const erc20_tokens_t *erc20_cache_lookup(const uint8_t *address, uint64_t chainId) {
+    if (address == NULL) {
+        return NULL;
+    }
+    const erc20_descriptor_t *entry = erc20_cache_find(address, chainId);
+    return entry != NULL ? &entry->token : NULL;
+}
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "evm_erc20.h"
+#include "parser_common.h"
+
+// Session cache of token descriptors signed by the token list key and sent by the host.
+#define ERC20_CACHE_ENTRIES          8
+#define ERC20_DESCRIPTOR_MIN_SIG_LEN 8
+#define ERC20_DESCRIPTOR_MAX_SIG_LEN 72
+
+typedef struct {
+    erc20_tokens_t token;
+    uint64_t chainId;
+} erc20_descriptor_t;
+
+/// Parses [symbolLen (1)] [symbol] [address (20)] [decimals (4 BE)] [chainId (4 BE)] [DER signature].
+/// signedLen is set to the length of the signed part, the signature follows it.
+parser_error_t erc20_descriptor_parse(const uint8_t *data, uint16_t dataLen, erc20_descriptor_t *descriptor,
+                                      uint16_t *signedLen);
+
+/// Drops every cached descriptor
+void erc20_cache_flush(void);
+
+/// Stores a verified descriptor, replacing the one for the same token or the oldest one
+void erc20_cache_insert(const erc20_descriptor_t *descriptor);
+
+/// \return the cached token deployed at address on chainId, NULL when unknown
+const erc20_tokens_t *erc20_cache_lookup(const uint8_t *address, uint64_t chainId);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_multipath.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "coin_evm.h"
+#include "evm_utils.h"
+#include "zxmacros.h"
+
+typedef struct {
+    uint32_t paths[ETH_MULTIPATH_MAX][HDPATH_LEN_DEFAULT];
+    uint8_t pathLens[ETH_MULTIPATH_MAX];
+    uint8_t count;
+    uint8_t addresses[ETH_MULTIPATH_MAX][ETH_ADDRESS_LEN];
+
+    eth_multipath_getItem_t getItem;
+    eth_multipath_getNumItems_t getNumItems;
+
+    // set once the review is approved; signatures are produced on request
+    uint8_t digest[ETH_MULTIPATH_HASH_LEN];
+    bool approved;
+    bool isMessage;
+} eth_multipath_t;
+
+static eth_multipath_t multipath;
+
+void eth_multipath_reset(void) {
+    MEMZERO(&multipath, sizeof(multipath));
+}
+
+parser_error_t eth_multipath_parse(const uint8_t *data, uint32_t dataLen, uint32_t *consumed) {
+    eth_multipath_reset();
+    if (data == NULL || consumed == NULL || dataLen == 0) {
+        return parser_no_data;
+    }
+    *consumed = 0;
+
+    const uint8_t count = data[0];
+    if (count < ETH_MULTIPATH_MIN || count > ETH_MULTIPATH_MAX) {
+        return parser_unexpected_number_items;
+    }
+    uint32_t offset = 1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (offset >= dataLen) {
+            return parser_unexpected_buffer_end;
+        }
+        const uint8_t pathLen = data[offset++];
+        if (pathLen < 3 || pathLen > HDPATH_LEN_DEFAULT) {
+            return parser_unexpected_value;
+        }
+        if (dataLen - offset < sizeof(uint32_t) * pathLen) {
+            return parser_unexpected_buffer_end;
+        }
+        for (uint8_t j = 0; j < pathLen; j++) {
+            multipath.paths[i][j] = U4BE(data, offset);
+            offset += sizeof(uint32_t);
+        }
+        multipath.pathLens[i] = pathLen;
+
+        // same accounts as single path signing
+        if (multipath.paths[i][0] != HDPATH_ETH_0_DEFAULT || multipath.paths[i][1] != HDPATH_ETH_1_DEFAULT) {
+            return parser_unexpected_value;
+        }
+        // every account signs once
+        for (uint8_t prev = 0; prev < i; prev++) {
+            if (multipath.pathLens[prev] == pathLen &&
+                memcmp(multipath.paths[prev], multipath.paths[i], sizeof(uint32_t) * pathLen) == 0) {
+                return parser_unexpected_value;
+            }
+        }
+    }
+
+    multipath.count = count;
+    *consumed = offset;
+    return parser_ok;
+}
+
+uint8_t eth_multipath_count(void) {
+    return multipath.count;
+}
+
+bool eth_multipath_path(uint8_t idx, uint32_t *path, uint32_t *pathLen) {
+    if (idx >= multipath.count || path == NULL || pathLen == NULL) {
+        return false;
+    }
+    MEMCPY(path, multipath.paths[idx], sizeof(uint32_t) * multipath.pathLens[idx]);
+    *pathLen = multipath.pathLens[idx];
+    return true;
+}
+
+void eth_multipath_set_address(uint8_t idx, const uint8_t *address) {
+    if (idx >= multipath.count || address == NULL) {
+        return;
+    }
+    MEMCPY(multipath.addresses[idx], address, ETH_ADDRESS_LEN);
+}
+
+void eth_multipath_review(eth_multipath_getItem_t getItem, eth_multipath_getNumItems_t getNumItems) {
+    multipath.getItem = getItem;
+    multipath.getNumItems = getNumItems;
+}
+
+zxerr_t eth_multipath_getNumItems(uint8_t *num_items) {
+    if (num_items == NULL || multipath.getNumItems == NULL) {
+        return zxerr_no_data;
+    }
+    uint8_t payloadItems = 0;
+    CHECK_ZXERR(multipath.getNumItems(&payloadItems))
+    *num_items = multipath.count + payloadItems;
+    return zxerr_ok;
+}
+
+zxerr_t eth_multipath_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                              uint8_t pageIdx, uint8_t *pageCount) {
+    if (outKey == NULL || outVal == NULL || pageCount == NULL || displayIdx < 0 || multipath.getItem == NULL) {
+        return zxerr_no_data;
+    }
+    if (displayIdx >= multipath.count) {
+        return multipath.getItem((int8_t)(displayIdx - multipath.count), outKey, outKeyLen, outVal, outValLen, pageIdx,
+                                 pageCount);
+    }
+
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+    const rlp_t address = {.kind = RLP_KIND_STRING, .ptr = multipath.addresses[displayIdx], .rlpLen = ETH_ADDRESS_LEN};
+    snprintf(outKey, outKeyLen, "Account %d/%d", displayIdx + 1, multipath.count);
+    if (printEVMAddress(&address, outVal, outValLen, pageIdx, pageCount) != parser_ok) {
+        return zxerr_no_data;
+    }
+    return zxerr_ok;
+}
+
+void eth_multipath_approve(const uint8_t *digest, bool isMessage) {
+    if (digest == NULL || multipath.count == 0) {
+        eth_multipath_revoke();
+        return;
+    }
+    MEMCPY(multipath.digest, digest, sizeof(multipath.digest));
+    multipath.approved = true;
+    multipath.isMessage = isMessage;
+}
+
+void eth_multipath_revoke(void) {
+    MEMZERO(multipath.digest, sizeof(multipath.digest));
+    multipath.approved = false;
+    multipath.isMessage = false;
+}
+
+const uint8_t *eth_multipath_digest(void) {
+    return multipath.approved ? multipath.digest : NULL;
+}
+
+bool eth_multipath_is_message(void) {
+    return multipath.approved && multipath.isMessage;
+}
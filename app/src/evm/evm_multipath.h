@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "coin.h"
+#include "parser_common.h"
+#include "parser_impl_evm.h"
+#include "zxerror.h"
+
+// One transaction or personal message signed by several accounts: the first chunk carries
+// [count (1)] { [path len (1)] [path (4 x len, BE)] } instead of a single path, the review
+// lists the accounts once and every path gets a v|r|s signature of the same digest.
+#define ETH_MULTIPATH_MIN      2
+#define ETH_MULTIPATH_MAX      5
+#define ETH_MULTIPATH_HASH_LEN 32
+
+typedef zxerr_t (*eth_multipath_getNumItems_t)(uint8_t *num_items);
+typedef zxerr_t (*eth_multipath_getItem_t)(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal,
+                                           uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
+
+/// Reads the path list at the start of a first chunk, consumed is set to its length
+parser_error_t eth_multipath_parse(const uint8_t *data, uint32_t dataLen, uint32_t *consumed);
+
+/// Forgets the path list and any approval, back to single path signing
+void eth_multipath_reset(void);
+
+/// \return the number of paths of the upload, 0 for a single path one
+uint8_t eth_multipath_count(void);
+
+/// Copies path idx
+/// \return false when there is no such path
+bool eth_multipath_path(uint8_t idx, uint32_t *path, uint32_t *pathLen);
+
+/// Keeps the address of path idx for the review
+void eth_multipath_set_address(uint8_t idx, const uint8_t *address);
+
+/// Review of the payload the accounts are listed before
+void eth_multipath_review(eth_multipath_getItem_t getItem, eth_multipath_getNumItems_t getNumItems);
+
+zxerr_t eth_multipath_getNumItems(uint8_t *num_items);
+zxerr_t eth_multipath_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                              uint8_t pageIdx, uint8_t *pageCount);
+
+/// Approval of the review; signatures can only be requested while it is set. isMessage is set
+/// for a personal message, whose signatures take v from the parity alone
+void eth_multipath_approve(const uint8_t *digest, bool isMessage);
+void eth_multipath_revoke(void);
+
+/// \return the approved digest, NULL when there is none
+const uint8_t *eth_multipath_digest(void);
+
+/// \return true when the approved digest is the one of a personal message
+bool eth_multipath_is_message(void);
+
+#ifdef __cplusplus
+}
+#endif
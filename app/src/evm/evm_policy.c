@@ -0,0 +1,320 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_policy.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "coin_evm.h"
+#include "evm_erc20_cache.h"
+#include "evm_utils.h"
+#include "uint256.h"
+#include "zxformat.h"
+#include "zxmacros.h"
+
+// policy under review, and the one approved last
+static eth_policy_t policy_pending;
+static eth_policy_t policy_active;
+
+static bool isZero(const uint8_t *buffer, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        if (buffer[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+parser_error_t eth_policy_parse(const uint8_t *data, uint16_t dataLen, const uint32_t *path, uint8_t pathLen) {
+    MEMZERO(&policy_pending, sizeof(policy_pending));
+    if (data == NULL || path == NULL || dataLen == 0) {
+        return parser_no_data;
+    }
+    if (pathLen == 0 || pathLen > HDPATH_LEN_DEFAULT) {
+        return parser_unexpected_value;
+    }
+    const uint16_t fixedLen = sizeof(uint64_t) + sizeof(uint16_t) + ETH_ADDRESS_LEN + 2 * ETH_POLICY_AMOUNT_LEN + 1;
+    if (dataLen < fixedLen) {
+        return parser_unexpected_buffer_end;
+    }
+    const uint8_t count = data[fixedLen - 1];
+    if (count == 0 || count > ETH_POLICY_MAX_RECIPIENTS) {
+        return parser_unexpected_number_items;
+    }
+    if (dataLen != fixedLen + count * ETH_ADDRESS_LEN) {
+        return parser_unexpected_characters;
+    }
+
+    eth_policy_t *policy = &policy_pending;
+    const uint8_t *ptr = data;
+    policy->chainId = ((uint64_t)U4BE(ptr, 0) << 32) | U4BE(ptr, 4);
+    ptr += sizeof(uint64_t);
+    bool supported = false;
+    for (uint8_t i = 0; i < SUPPORTED_NETWORKS_EVM_LEN; i++) {
+        supported |= policy->chainId == supported_networks_evm[i];
+    }
+    if (!supported) {
+        return parser_invalid_chain_id;
+    }
+
+    policy->uses = (uint16_t)((ptr[0] << 8) | ptr[1]);
+    ptr += sizeof(uint16_t);
+    if (policy->uses == 0) {
+        return parser_value_out_of_range;
+    }
+
+    // only tokens the app can show, from the compiled table or a verified descriptor
+    if (!isZero(ptr, ETH_ADDRESS_LEN)) {
+        const erc20_tokens_t *token = erc20_cache_lookup(ptr, policy->chainId);
+        if (token == NULL) {
+            token = findERC20Token(ptr);
+        }
+        if (token == NULL) {
+            return parser_unexpected_value;
+        }
+        MEMCPY(&policy->token, token, sizeof(policy->token));
+        policy->hasToken = true;
+    }
+    ptr += ETH_ADDRESS_LEN;
+
+    MEMCPY(policy->valueCap, ptr, ETH_POLICY_AMOUNT_LEN);
+    ptr += ETH_POLICY_AMOUNT_LEN;
+    MEMCPY(policy->feeCap, ptr, ETH_POLICY_AMOUNT_LEN);
+    ptr += ETH_POLICY_AMOUNT_LEN + 1;
+
+    for (uint8_t i = 0; i < count; i++) {
+        MEMCPY(policy->recipients[i], ptr, ETH_ADDRESS_LEN);
+        ptr += ETH_ADDRESS_LEN;
+    }
+    policy->numRecipients = count;
+
+    MEMCPY(policy->path, path, pathLen * sizeof(uint32_t));
+    policy->pathLen = pathLen;
+    return parser_ok;
+}
+
+void eth_policy_activate(void) {
+    MEMCPY(&policy_active, &policy_pending, sizeof(policy_active));
+    MEMZERO(&policy_pending, sizeof(policy_pending));
+}
+
+void eth_policy_clear(void) {
+    MEMZERO(&policy_pending, sizeof(policy_pending));
+    MEMZERO(&policy_active, sizeof(policy_active));
+}
+
+uint16_t eth_policy_remaining(void) {
+    return policy_active.uses;
+}
+
+void eth_policy_consume(void) {
+    if (policy_active.uses == 0) {
+        return;
+    }
+    policy_active.uses--;
+    if (policy_active.uses == 0) {
+        eth_policy_clear();
+    }
+}
+
+static bool isRecipient(const eth_policy_t *policy, const uint8_t *address) {
+    for (uint8_t i = 0; i < policy->numRecipients; i++) {
+        if (memcmp(policy->recipients[i], address, ETH_ADDRESS_LEN) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// false when the number is longer than 256 bits or above cap
+static bool withinCap(const uint8_t *number, uint16_t numberLen, const uint8_t cap[ETH_POLICY_AMOUNT_LEN]) {
+    uint256_t value = {0};
+    uint256_t limit = {0};
+    if (numberLen > ETH_POLICY_AMOUNT_LEN || readu256BEBytes(number, numberLen, &value) != parser_ok ||
+        readu256BEBytes(cap, ETH_POLICY_AMOUNT_LEN, &limit) != parser_ok) {
+        return false;
+    }
+    return !gt256(&value, &limit);
+}
+
+static bool fieldToU256(const eth_tx_t *tx_obj, const rlp_field_t *field, uint256_t *out) {
+    if (field->valueLen > ETH_POLICY_AMOUNT_LEN) {
+        return false;
+    }
+    rlp_t num = {0};
+    eth_tx_view(tx_obj, field, &num);
+    return readu256BEBytes(num.ptr, (uint16_t)num.rlpLen, out) == parser_ok;
+}
+
+// gasLimit * fee cap, the most the transaction can pay
+static bool feeWithinCap(const eth_tx_t *tx_obj, const uint8_t cap[ETH_POLICY_AMOUNT_LEN]) {
+    uint256_t gasLimit = {0};
+    uint256_t feeCap = {0};
+    uint256_t maxFee = {0};
+    uint256_t limit = {0};
+    const rlp_field_t *feeField = tx_obj->tx_type == eip1559 ? &tx_obj->tx.max_fee_per_gas : &tx_obj->tx.gasPrice;
+    if (!fieldToU256(tx_obj, &tx_obj->tx.gasLimit, &gasLimit) || !fieldToU256(tx_obj, feeField, &feeCap) ||
+        bits256(&gasLimit) + bits256(&feeCap) > 256 || readu256BEBytes(cap, ETH_POLICY_AMOUNT_LEN, &limit) != parser_ok) {
+        return false;
+    }
+    mul256(&gasLimit, &feeCap, &maxFee);
+    return !gt256(&maxFee, &limit);
+}
+
+bool eth_policy_match(const eth_tx_t *tx_obj, const uint32_t *path, uint8_t pathLen) {
+    const eth_policy_t *policy = &policy_active;
+    if (policy->uses == 0 || tx_obj == NULL || path == NULL) {
+        return false;
+    }
+    if (pathLen != policy->pathLen || memcmp(path, policy->path, pathLen * sizeof(uint32_t)) != 0) {
+        return false;
+    }
+    // nothing the review would have shown beyond what the policy covers
+    if (tx_obj->accessListAddresses != 0 || tx_obj->accessListKeys != 0 || tx_obj->authorizations != 0 ||
+        tx_obj->dataTruncated) {
+        return false;
+    }
+
+    rlp_t chainIdView = {0};
+    uint64_t chainId = 0;
+    eth_tx_view(tx_obj, &tx_obj->chainId, &chainIdView);
+    if (chainIdView.rlpLen == 0 || be_bytes_to_u64(chainIdView.ptr, chainIdView.rlpLen, &chainId) != parser_ok ||
+        chainId != policy->chainId) {
+        return false;
+    }
+
+    rlp_t to = {0};
+    rlp_t value = {0};
+    rlp_t data = {0};
+    eth_tx_view(tx_obj, &tx_obj->tx.to, &to);
+    eth_tx_view(tx_obj, &tx_obj->tx.value, &value);
+    eth_tx_view(tx_obj, &tx_obj->tx.data, &data);
+    if (to.rlpLen != ETH_ADDRESS_LEN) {
+        return false;
+    }
+
+    if (policy->hasToken) {
+        // [selector (4)] [recipient (12 + 20)] [amount (32)], and no native value on the side
+        if (memcmp(to.ptr, policy->token.address, ETH_ADDRESS_LEN) != 0 || !isERC20TransferData(&to, &data) ||
+            !isZero(value.ptr, (uint16_t)value.rlpLen) || !isRecipient(policy, data.ptr + ERC20_TRANSFER_OFFSET) ||
+            !withinCap(data.ptr + SELECTOR_LENGTH + BIGINT_LENGTH, BIGINT_LENGTH, policy->valueCap)) {
+            return false;
+        }
+    } else {
+        if (data.rlpLen != 0 || !isRecipient(policy, to.ptr) ||
+            !withinCap(value.ptr, (uint16_t)value.rlpLen, policy->valueCap)) {
+            return false;
+        }
+    }
+
+    return feeWithinCap(tx_obj, policy->feeCap);
+}
+
+// Review: policy, asset, contract for tokens, amount cap, recipients, fee cap, chain id, signatures
+#define POLICY_ITEMS_BEFORE_RECIPIENTS 3
+#define POLICY_ITEMS_AFTER_RECIPIENTS  3
+
+zxerr_t eth_policy_getNumItems(uint8_t *num_items) {
+    if (num_items == NULL) {
+        return zxerr_no_data;
+    }
+    *num_items = POLICY_ITEMS_BEFORE_RECIPIENTS + (policy_pending.hasToken ? 1 : 0) + policy_pending.numRecipients +
+                 POLICY_ITEMS_AFTER_RECIPIENTS;
+    return zxerr_ok;
+}
+
+static parser_error_t policyItem(uint8_t idx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                                 uint8_t pageIdx, uint8_t *pageCount) {
+    const eth_policy_t *policy = &policy_pending;
+    switch (idx) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Policy");
+            snprintf(outVal, outValLen, "Sign without review");
+            return parser_ok;
+        case 1:
+            snprintf(outKey, outKeyLen, "Asset");
+            if (policy->hasToken) {
+                snprintf(outVal, outValLen, "%.*s", ERC20_SYMBOL_STORED_LEN, policy->token.symbol);
+            } else {
+                snprintf(outVal, outValLen, "peaq");
+            }
+            return parser_ok;
+        default:
+            break;
+    }
+
+    if (policy->hasToken) {
+        if (idx == 2) {
+            const rlp_t address = {.kind = RLP_KIND_STRING, .ptr = policy->token.address, .rlpLen = ETH_ADDRESS_LEN};
+            snprintf(outKey, outKeyLen, "Contract");
+            return printEVMAddress(&address, outVal, outValLen, pageIdx, pageCount);
+        }
+        idx--;
+    }
+
+    if (idx == 2) {
+        const uint8_t decimals = policy->hasToken ? policy->token.decimals : COIN_DECIMALS;
+        snprintf(outKey, outKeyLen, "Max amount");
+        return printBigIntFixedPoint(policy->valueCap, sizeof(policy->valueCap), outVal, outValLen, pageIdx, pageCount,
+                                     decimals);
+    }
+
+    const uint8_t firstAfter = POLICY_ITEMS_BEFORE_RECIPIENTS + policy->numRecipients;
+    if (idx < firstAfter) {
+        const uint8_t recipientIdx = idx - POLICY_ITEMS_BEFORE_RECIPIENTS;
+        const rlp_t address = {.kind = RLP_KIND_STRING, .ptr = policy->recipients[recipientIdx],
+                               .rlpLen = ETH_ADDRESS_LEN};
+        snprintf(outKey, outKeyLen, "Recipient %d", recipientIdx + 1);
+        return printEVMAddress(&address, outVal, outValLen, pageIdx, pageCount);
+    }
+
+    char number[21] = {0};
+    switch (idx - firstAfter) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Max fee");
+            return printBigIntFixedPoint(policy->feeCap, sizeof(policy->feeCap), outVal, outValLen, pageIdx, pageCount,
+                                         COIN_DECIMALS);
+        case 1:
+            snprintf(outKey, outKeyLen, "Chain ID");
+            if (uint64_to_str(number, sizeof(number), policy->chainId) != NULL) {
+                return parser_unexpected_error;
+            }
+            snprintf(outVal, outValLen, "%s", number);
+            return parser_ok;
+        case 2:
+            snprintf(outKey, outKeyLen, "Signatures");
+            snprintf(outVal, outValLen, "%d", policy->uses);
+            return parser_ok;
+        default:
+            break;
+    }
+    return parser_display_idx_out_of_range;
+}
+
+zxerr_t eth_policy_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                           uint8_t pageIdx, uint8_t *pageCount) {
+    if (outKey == NULL || outVal == NULL || pageCount == NULL || displayIdx < 0) {
+        return zxerr_no_data;
+    }
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+    if (policyItem((uint8_t)displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount) != parser_ok) {
+        return zxerr_no_data;
+    }
+    return zxerr_ok;
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "coin.h"
+#include "evm_erc20.h"
+#include "parser_impl_evm.h"
+#include "zxerror.h"
+
+// A signing policy is reviewed once and then lets INS_SIGN_ETH sign matching transactions
+// without a review: transfers of one asset to a few recipients, below a value and fee cap.
+// It expires after a number of signatures, there is no clock to count time with.
+#define ETH_POLICY_MAX_RECIPIENTS 4
+#define ETH_POLICY_AMOUNT_LEN     32
+
+typedef struct {
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint8_t pathLen;
+    uint64_t chainId;
+    // signatures left, 0 means there is no policy
+    uint16_t uses;
+
+    // ERC20 transfers of token when set, native transfers otherwise
+    bool hasToken;
+    erc20_tokens_t token;
+
+    uint8_t recipients[ETH_POLICY_MAX_RECIPIENTS][ETH_ADDRESS_LEN];
+    uint8_t numRecipients;
+
+    // per transaction bounds, in units of the asset and in wei of gasLimit * fee cap
+    uint8_t valueCap[ETH_POLICY_AMOUNT_LEN];
+    uint8_t feeCap[ETH_POLICY_AMOUNT_LEN];
+} eth_policy_t;
+
+/// Parses [chainId (8)] [signatures (2)] [token (20), zero for native transfers] [value cap (32)] [fee cap (32)]
+/// [count (1)] [recipients (20 x count)] as the policy to review, all numbers big endian
+parser_error_t eth_policy_parse(const uint8_t *data, uint16_t dataLen, const uint32_t *path, uint8_t pathLen);
+
+/// Makes the reviewed policy the active one, replacing the previous one
+void eth_policy_activate(void);
+
+/// Drops both the reviewed and the active policy
+void eth_policy_clear(void);
+
+/// \return the signatures the active policy still allows, 0 when there is none
+uint16_t eth_policy_remaining(void);
+
+/// \return true when the parsed transaction, signed with path, is covered by the active policy
+bool eth_policy_match(const eth_tx_t *tx_obj, const uint32_t *path, uint8_t pathLen);
+
+/// Counts one signature against the active policy, dropping it after the last one
+void eth_policy_consume(void);
+
+zxerr_t eth_policy_getNumItems(uint8_t *num_items);
+zxerr_t eth_policy_getItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                           uint8_t pageIdx, uint8_t *pageCount);
+
+#ifdef __cplusplus
+}
+#endif
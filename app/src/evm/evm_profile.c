@@ -0,0 +1,144 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zxmacros.h"
+
+static evm_profile_t profile;
+static stack_probe_e open_probe = STACK_PROBE_NONE;
+
+#if defined(LEDGER_SPECIFIC)
+// bounds from the link script: the first word above the canary and the top of the stack
+extern uint32_t _stack_validation;
+extern uint32_t _estack;
+
+#define STACK_PAINT_PATTERN 0xA5A5A5A5u
+// left untouched below the current frame so painting never clobbers live data
+#define STACK_PAINT_MARGIN 64u
+
+static void stack_paint(void) {
+    volatile uint32_t marker = 0;
+    uint32_t *p = &_stack_validation;
+    uint32_t *const end = (uint32_t *)(((uintptr_t)&marker - STACK_PAINT_MARGIN) & ~(uintptr_t)3);
+    while (p < end) {
+        *p++ = STACK_PAINT_PATTERN;
+    }
+}
+
+static uint32_t stack_measure(void) {
+    const uint32_t *p = &_stack_validation;
+    while (p < &_estack && *p == STACK_PAINT_PATTERN) {
+        p++;
+    }
+    return (uint32_t)((uintptr_t)&_estack - (uintptr_t)p);
+}
+#else
+static void stack_paint(void) {}
+
+static uint32_t stack_measure(void) {
+    return 0;
+}
+#endif
+
+void evm_profile_reset(void) {
+    memset(&profile, 0, sizeof(profile));
+    open_probe = STACK_PROBE_NONE;
+}
+
+const evm_profile_t *evm_profile_get(void) {
+    return &profile;
+}
+
+void evm_profile_add_phase(profile_phase_e phase, uint32_t startTicks) {
+    if (phase >= PROFILE_PHASE_COUNT) {
+        return;
+    }
+    // unsigned subtraction keeps the delta right across a counter wrap
+    profile.phases[phase].ticks += (uint32_t)(EVM_PROFILE_TICKS() - startTicks);
+    profile.phases[phase].calls++;
+}
+
+void evm_profile_count_hash(uint32_t len) {
+    profile.hashCalls++;
+    profile.hashedBytes += len;
+}
+
+void evm_profile_count_nvm(uint32_t len) {
+    profile.nvmBytes += len;
+}
+
+void evm_profile_count_item(void) {
+    profile.itemsRendered++;
+}
+
+void evm_profile_record_stack(stack_probe_e probe, uint32_t bytes) {
+    if (probe >= STACK_PROBE_COUNT) {
+        return;
+    }
+    profile.stackUsed[probe] = MAX(profile.stackUsed[probe], bytes);
+}
+
+void evm_profile_stack_begin(stack_probe_e probe) {
+    evm_profile_stack_end();
+    stack_paint();
+    open_probe = probe;
+}
+
+void evm_profile_stack_end(void) {
+    if (open_probe == STACK_PROBE_NONE) {
+        return;
+    }
+    const uint32_t used = stack_measure();
+    evm_profile_record_stack(open_probe, used);
+
+    char msg[48] = {0};
+    snprintf(msg, sizeof(msg), "stack probe %d: %u bytes\n", open_probe, (unsigned int)used);
+    zemu_log(msg);
+    open_probe = STACK_PROBE_NONE;
+}
+
+static uint8_t *writeU32BE(uint8_t *out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return out + sizeof(uint32_t);
+}
+
+uint16_t evm_profile_serialize(uint8_t *out, uint16_t outLen) {
+    if (out == NULL || outLen < PROFILE_SERIALIZED_LEN) {
+        return 0;
+    }
+    uint8_t *p = out;
+    *p++ = PROFILE_PHASE_COUNT;
+    for (uint8_t i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        p = writeU32BE(p, profile.phases[i].ticks);
+        p = writeU32BE(p, profile.phases[i].calls);
+    }
+    p = writeU32BE(p, profile.hashCalls);
+    p = writeU32BE(p, profile.hashedBytes);
+    p = writeU32BE(p, profile.nvmBytes);
+    p = writeU32BE(p, profile.itemsRendered);
+    *p++ = STACK_PROBE_COUNT;
+    for (uint8_t i = 0; i < STACK_PROBE_COUNT; i++) {
+        p = writeU32BE(p, profile.stackUsed[i]);
+    }
+    return (uint16_t)(p - out);
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Per-phase counters for profiling signing flows on hardware. The hooks only
+// exist in APP_TESTING builds; release builds compile them out entirely.
+typedef enum {
+    profile_phase_ingest = 0,
+    profile_phase_parse,
+    profile_phase_validate,
+    profile_phase_digest,
+    profile_phase_sign,
+    PROFILE_PHASE_COUNT,
+} profile_phase_e;
+
+typedef struct {
+    uint32_t ticks;
+    uint32_t calls;
+} profile_phase_t;
+
+// Top-level handlers whose deepest stack use is tracked. A probe stays open from
+// its first APDU until another instruction comes in, so review rendering and
+// signing count towards the handler that started the flow.
+typedef enum {
+    stack_probe_sign_eth = 0,
+    stack_probe_sign_eip191,
+    stack_probe_get_addr_eth,
+    STACK_PROBE_COUNT,
+    STACK_PROBE_NONE = STACK_PROBE_COUNT,
+} stack_probe_e;
+
+typedef struct {
+    profile_phase_t phases[PROFILE_PHASE_COUNT];
+    uint32_t hashCalls;
+    uint32_t hashedBytes;
+    uint32_t nvmBytes;
+    uint32_t itemsRendered;
+    // deepest stack use seen per probe, in bytes
+    uint32_t stackUsed[STACK_PROBE_COUNT];
+} evm_profile_t;
+
+// [numPhases (1)] { [ticks (4)] [calls (4)] } [hash calls (4)] [bytes hashed (4)] [nvm bytes (4)] [items (4)]
+// [numProbes (1)] { [stack bytes (4)] }
+#define PROFILE_SERIALIZED_LEN (1 + PROFILE_PHASE_COUNT * 8 + 4 * 4 + 1 + STACK_PROBE_COUNT * 4)
+
+// Free-running tick source read at the start and end of every phase. Targets
+// without a counter readable from userland leave it at 0 and only report calls;
+// lab builds can provide one with DEFINES += EVM_PROFILE_TICKS=...
+#ifndef EVM_PROFILE_TICKS
+#define EVM_PROFILE_TICKS() 0u
+#endif
+
+void evm_profile_reset(void);
+const evm_profile_t *evm_profile_get(void);
+
+void evm_profile_add_phase(profile_phase_e phase, uint32_t startTicks);
+void evm_profile_count_hash(uint32_t len);
+void evm_profile_count_nvm(uint32_t len);
+void evm_profile_count_item(void);
+
+/// Keeps the deepest stack use seen for a probe
+void evm_profile_record_stack(stack_probe_e probe, uint32_t bytes);
+
+/// Closes the open probe, then paints the free stack and opens the given one.
+/// Painting is only done on device; host builds just track the open probe.
+void evm_profile_stack_begin(stack_probe_e probe);
+
+/// Measures the painted stack and records it for the open probe, then closes it
+void evm_profile_stack_end(void);
+
+/// Writes the counters big-endian in the PROFILE_SERIALIZED_LEN layout
+/// \return number of bytes written, 0 if out is too small
+uint16_t evm_profile_serialize(uint8_t *out, uint16_t outLen);
+
+#if defined(APP_TESTING)
+#define PROFILE_BEGIN(phase)    const uint32_t profile_start_##phase = EVM_PROFILE_TICKS()
+#define PROFILE_END(phase)      evm_profile_add_phase(phase, profile_start_##phase)
+#define PROFILE_COUNT_HASH(len) evm_profile_count_hash(len)
+#define PROFILE_COUNT_NVM(len)  evm_profile_count_nvm(len)
+#define PROFILE_COUNT_ITEM()    evm_profile_count_item()
+#define PROFILE_STACK_BEGIN(p)  evm_profile_stack_begin(p)
+#define PROFILE_STACK_END()     evm_profile_stack_end()
+#else
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_COUNT_HASH(len)
+#define PROFILE_COUNT_NVM(len)
+#define PROFILE_COUNT_ITEM()
+#define PROFILE_STACK_BEGIN(p)
+#define PROFILE_STACK_END()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
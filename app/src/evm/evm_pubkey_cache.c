@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include "evm_pubkey_cache.h"
+
+#include <string.h>
+
+#include "zxmacros.h"
+
+typedef struct {
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint8_t pathLen;
+    uint8_t pubKey[PK_LEN_SECP256K1_UNCOMPRESSED];
+    uint8_t address[ETH_ADDR_LEN];
+    uint8_t chainCode[PUBKEY_CACHE_CHAIN_CODE_LEN];
+    // 0 means the slot is empty
+    uint32_t lastUse;
+} pubkey_cache_entry_t;
+
+static pubkey_cache_entry_t pubkey_cache[PUBKEY_CACHE_ENTRIES];
+static uint32_t pubkey_cache_clock = 0;
+
+void pubkey_cache_flush(void) {
+    MEMZERO(pubkey_cache, sizeof(pubkey_cache));
+    pubkey_cache_clock = 0;
+}
+
+static pubkey_cache_entry_t *pubkey_cache_find(const uint32_t *path, uint8_t pathLen) {
+    if (path == NULL || pathLen == 0 || pathLen > HDPATH_LEN_DEFAULT) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < PUBKEY_CACHE_ENTRIES; i++) {
+        pubkey_cache_entry_t *entry = &pubkey_cache[i];
+        if (entry->lastUse != 0 && entry->pathLen == pathLen &&
+            memcmp(entry->path, path, pathLen * sizeof(uint32_t)) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t pubkey_cache_tick(void) {
+    pubkey_cache_clock++;
+    if (pubkey_cache_clock == 0) {
+        // counter wrapped; start over rather than confuse the LRU order
+        pubkey_cache_flush();
+        pubkey_cache_clock = 1;
+    }
+    return pubkey_cache_clock;
+}
+
+bool pubkey_cache_lookup(const uint32_t *path, uint8_t pathLen, uint8_t *pubKey, uint8_t *address, uint8_t *chainCode) {
+    pubkey_cache_entry_t *entry = pubkey_cache_find(path, pathLen);
+    if (entry == NULL) {
+        return false;
+    }
+
+    entry->lastUse = pubkey_cache_tick();
+    if (pubKey != NULL) {
+        MEMCPY(pubKey, entry->pubKey, sizeof(entry->pubKey));
+    }
+    if (address != NULL) {
+        MEMCPY(address, entry->address, sizeof(entry->address));
+    }
+    if (chainCode != NULL) {
+        MEMCPY(chainCode, entry->chainCode, sizeof(entry->chainCode));
+    }
+    return true;
+}
+
+void pubkey_cache_insert(const uint32_t *path, uint8_t pathLen, const uint8_t *pubKey, const uint8_t *address,
+                         const uint8_t *chainCode) {
+    if (path == NULL || pathLen == 0 || pathLen > HDPATH_LEN_DEFAULT || pubKey == NULL || address == NULL ||
+        chainCode == NULL) {
+        return;
+    }
+
+    pubkey_cache_entry_t *entry = pubkey_cache_find(path, pathLen);
+    if (entry == NULL) {
+        // pick an empty slot or the least recently used one
+        entry = &pubkey_cache[0];
+        for (uint8_t i = 1; i < PUBKEY_CACHE_ENTRIES; i++) {
+            if (pubkey_cache[i].lastUse < entry->lastUse) {
+                entry = &pubkey_cache[i];
+            }
+        }
+    }
+
+    const uint32_t now = pubkey_cache_tick();
+    MEMZERO(entry, sizeof(*entry));
+    MEMCPY(entry->path, path, pathLen * sizeof(uint32_t));
+    entry->pathLen = pathLen;
+    MEMCPY(entry->pubKey, pubKey, sizeof(entry->pubKey));
+    MEMCPY(entry->address, address, sizeof(entry->address));
+    MEMCPY(entry->chainCode, chainCode, sizeof(entry->chainCode));
+    entry->lastUse = now;
+}
@@ -0,0 +1,46 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "coin.h"
+#include "coin_evm.h"
+
+// Session cache of derived public data (never private keys), keyed by HD path.
+#define PUBKEY_CACHE_ENTRIES 4
+#define PUBKEY_CACHE_CHAIN_CODE_LEN 32
+
+/// Drops every cached entry
+void pubkey_cache_flush(void);
+
+/// Looks up a path and copies the cached public key (uncompressed, 65 bytes),
+/// address (20 bytes) and chain code (32 bytes). Any output may be NULL.
+/// \return true on a cache hit
+bool pubkey_cache_lookup(const uint32_t *path, uint8_t pathLen, uint8_t *pubKey, uint8_t *address, uint8_t *chainCode);
+
+/// Stores the public data for a path, evicting the least recently used entry
+void pubkey_cache_insert(const uint32_t *path, uint8_t pathLen, const uint8_t *pubKey, const uint8_t *address,
+                         const uint8_t *chainCode);
+
+#ifdef __cplusplus
+}
+#endif
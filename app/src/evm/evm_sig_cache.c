@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include "evm_sig_cache.h"
+
+#include <string.h>
+
+#include "zxmacros.h"
+
+typedef struct {
+    uint32_t path[HDPATH_LEN_DEFAULT];
+    uint8_t pathLen;
+    uint8_t format;
+    uint8_t digest[SIG_CACHE_DIGEST_LEN];
+    uint8_t sig[ETH_SIGNATURE_MAX_LEN];
+    uint16_t sigLen;
+    // commands left before the entry expires, 0 means the cache is empty
+    uint8_t ttl;
+} sig_cache_entry_t;
+
+static sig_cache_entry_t sig_cache;
+
+void sig_cache_flush(void) {
+    MEMZERO(&sig_cache, sizeof(sig_cache));
+}
+
+void sig_cache_tick(void) {
+    if (sig_cache.ttl == 0) {
+        return;
+    }
+    sig_cache.ttl--;
+    if (sig_cache.ttl == 0) {
+        sig_cache_flush();
+    }
+}
+
+void sig_cache_store(const uint32_t *path, uint8_t pathLen, uint8_t format, const uint8_t *digest, const uint8_t *sig,
+                     uint16_t sigLen) {
+    sig_cache_flush();
+    if (path == NULL || pathLen == 0 || pathLen > HDPATH_LEN_DEFAULT || digest == NULL || sig == NULL || sigLen == 0 ||
+        sigLen > sizeof(sig_cache.sig)) {
+        return;
+    }
+    MEMCPY(sig_cache.path, path, pathLen * sizeof(uint32_t));
+    sig_cache.pathLen = pathLen;
+    sig_cache.format = format;
+    MEMCPY(sig_cache.digest, digest, sizeof(sig_cache.digest));
+    MEMCPY(sig_cache.sig, sig, sigLen);
+    sig_cache.sigLen = sigLen;
+    sig_cache.ttl = SIG_CACHE_TTL_COMMANDS;
+}
+
+bool sig_cache_lookup(const uint32_t *path, uint8_t pathLen, uint8_t format, const uint8_t *digest, uint8_t *sig,
+                      uint16_t sigMaxLen, uint16_t *sigLen) {
+    if (sig_cache.ttl == 0 || path == NULL || digest == NULL || sig == NULL || sigLen == NULL ||
+        sigMaxLen < sig_cache.sigLen) {
+        return false;
+    }
+    if (pathLen != sig_cache.pathLen || format != sig_cache.format ||
+        memcmp(path, sig_cache.path, pathLen * sizeof(uint32_t)) != 0 ||
+        memcmp(digest, sig_cache.digest, sizeof(sig_cache.digest)) != 0) {
+        return false;
+    }
+    MEMCPY(sig, sig_cache.sig, sig_cache.sigLen);
+    *sigLen = sig_cache.sigLen;
+    return true;
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "coin.h"
+#include "crypto_evm.h"
+
+// Last signature of an approved INS_SIGN_ETH, kept so a host that lost the reply
+// (a BLE link dropping right after the approval) can upload the same transaction
+// again and get it back without a second review. Only the same path, signature
+// format and transaction digest match. The window is counted in commands.
+#define SIG_CACHE_DIGEST_LEN   32
+#define SIG_CACHE_TTL_COMMANDS 8
+
+/// Drops the cached signature
+void sig_cache_flush(void);
+
+/// Counts one command against the window, the entry expires after SIG_CACHE_TTL_COMMANDS
+void sig_cache_tick(void);
+
+/// Keeps the reply given for an approved transaction, replacing the previous one
+void sig_cache_store(const uint32_t *path, uint8_t pathLen, uint8_t format, const uint8_t *digest, const uint8_t *sig,
+                     uint16_t sigLen);
+
+/// Copies the cached reply if path, format and digest are those of the cached entry
+/// \return true on a cache hit
+bool sig_cache_lookup(const uint32_t *path, uint8_t pathLen, uint8_t format, const uint8_t *digest, uint8_t *sig,
+                      uint16_t sigMaxLen, uint16_t *sigLen);
+
+#ifdef __cplusplus
+}
+#endif
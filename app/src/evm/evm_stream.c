@@ -0,0 +1,260 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include "evm_stream.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "parser_impl_evm.h"
+#include "rlp_def.h"
+#include "zxmacros.h"
+
+// lengths above this can never be streamed through a 32-bit chunk counter
+#define EVM_STREAM_MAX_LENGTH_BYTES 4
+
+static uint8_t encodeHeader(uint8_t shortMin, uint64_t len, uint8_t *out) {
+    if (len <= 55) {
+        out[0] = shortMin + (uint8_t)len;
+        return 1;
+    }
+    uint8_t bytes = 0;
+    for (uint64_t tmp = len; tmp != 0; tmp >>= 8) {
+        bytes++;
+    }
+    out[0] = shortMin + 55 + bytes;
+    for (uint8_t i = 0; i < bytes; i++) {
+        out[bytes - i] = (uint8_t)(len >> (8 * i));
+    }
+    return bytes + 1;
+}
+
+static parser_error_t emit(const evm_stream_t *stream, const uint8_t *data, uint32_t len) {
+    if (len == 0) {
+        return parser_ok;
+    }
+    if (stream->sink(data, len) != len) {
+        return parser_unexpected_buffer_end;
+    }
+    return parser_ok;
+}
+
+static parser_error_t stage(evm_stream_t *stream, const uint8_t *data, uint32_t len) {
+    if (len > sizeof(stream->staging) - stream->stagingLen) {
+        return parser_unexpected_buffer_end;
+    }
+    MEMCPY(stream->staging + stream->stagingLen, data, len);
+    stream->stagingLen += len;
+    return parser_ok;
+}
+
+// Fields before the calldata go to staging, fields after it straight to the sink
+static parser_error_t forward(evm_stream_t *stream, const uint8_t *data, uint32_t len) {
+    if (stream->dataSeen) {
+        return emit(stream, data, len);
+    }
+    return stage(stream, data, len);
+}
+
+// The data header is known: write the envelope with the shortened lengths,
+// then the staged fields and the header of the calldata prefix.
+// A single byte calldata (below 0x80) is its own header and is kept as is.
+static parser_error_t emitHead(evm_stream_t *stream, bool singleByte) {
+    const uint32_t kept = (uint32_t)MIN(stream->dataLen, (uint64_t)EVM_STREAM_DATA_PREFIX_LEN);
+
+    uint8_t dataHeader[EVM_STREAM_MAX_HEADER_LEN] = {0};
+    const uint8_t dataHeaderLen = singleByte ? 0 : encodeHeader(RLP_KIND_STRING_SHORT_MIN, kept, dataHeader);
+
+    // remaining list bytes after the calldata
+    const uint64_t tail = stream->listLeft - (singleByte ? 0 : stream->dataLen);
+    const uint64_t listLen = stream->stagingLen + dataHeaderLen + kept + tail;
+
+    uint8_t envelope[1 + EVM_STREAM_MAX_HEADER_LEN] = {0};
+    uint8_t envelopeLen = 0;
+    if (stream->txType != 0) {
+        envelope[envelopeLen++] = stream->txType;
+    }
+    envelopeLen += encodeHeader(RLP_KIND_LIST_SHORT_MIN, listLen, envelope + envelopeLen);
+
+    CHECK_ERROR(emit(stream, envelope, envelopeLen))
+    CHECK_ERROR(emit(stream, stream->staging, stream->stagingLen))
+    CHECK_ERROR(emit(stream, dataHeader, dataHeaderLen))
+    stream->dataSeen = true;
+    return parser_ok;
+}
+
+static parser_error_t headerDone(evm_stream_t *stream, bool isList) {
+    if (stream->payloadLeft > stream->listLeft) {
+        return parser_unexpected_buffer_end;
+    }
+
+    if (stream->itemIdx != stream->dataIdx) {
+        return forward(stream, stream->header, stream->headerLen);
+    }
+
+    // calldata: the header is re-encoded for the kept prefix
+    if (isList) {
+        return parser_unexpected_type;
+    }
+    if (stream->header[0] <= RLP_KIND_BYTE_PREFIX) {
+        stream->dataLen = 1;
+        stream->dataKept = 1;
+        CHECK_ERROR(emitHead(stream, true))
+        return emit(stream, stream->header, 1);
+    }
+    stream->dataLen = stream->payloadLeft;
+    return emitHead(stream, false);
+}
+
+static void nextItem(evm_stream_t *stream) {
+    stream->itemIdx++;
+    stream->stage = evm_stream_item_prefix;
+    stream->headerLen = 0;
+    stream->lengthBytes = 0;
+    stream->payloadLeft = 0;
+}
+
+static parser_error_t readPrefix(evm_stream_t *stream, uint8_t prefix) {
+    stream->header[0] = prefix;
+    stream->headerLen = 1;
+
+    if (prefix <= RLP_KIND_BYTE_PREFIX) {
+        CHECK_ERROR(headerDone(stream, false))
+        nextItem(stream);
+        return parser_ok;
+    }
+
+    const bool isList = prefix >= RLP_KIND_LIST_SHORT_MIN;
+    const uint8_t shortMax = isList ? RLP_KIND_LIST_SHORT_MAX : RLP_KIND_STRING_SHORT_MAX;
+    const uint8_t shortMin = isList ? RLP_KIND_LIST_SHORT_MIN : RLP_KIND_STRING_SHORT_MIN;
+
+    if (prefix <= shortMax) {
+        stream->payloadLeft = prefix - shortMin;
+        CHECK_ERROR(headerDone(stream, isList))
+        stream->stage = evm_stream_item_payload;
+        if (stream->payloadLeft == 0) {
+            nextItem(stream);
+        }
+        return parser_ok;
+    }
+
+    stream->lengthBytes = prefix - shortMax;
+    if (stream->lengthBytes > EVM_STREAM_MAX_LENGTH_BYTES) {
+        return parser_value_out_of_range;
+    }
+    stream->stage = evm_stream_item_length;
+    return parser_ok;
+}
+
+static parser_error_t readLength(evm_stream_t *stream, uint8_t byte) {
+    stream->header[stream->headerLen++] = byte;
+    stream->payloadLeft = (stream->payloadLeft << 8) | byte;
+    if (stream->headerLen <= stream->lengthBytes) {
+        return parser_ok;
+    }
+
+    const bool isList = stream->header[0] >= RLP_KIND_LIST_SHORT_MIN;
+    CHECK_ERROR(headerDone(stream, isList))
+    stream->stage = evm_stream_item_payload;
+    if (stream->payloadLeft == 0) {
+        nextItem(stream);
+    }
+    return parser_ok;
+}
+
+static parser_error_t readPayload(evm_stream_t *stream, const uint8_t *data, uint32_t len, uint32_t *used) {
+    const uint32_t chunk = (uint32_t)MIN((uint64_t)len, stream->payloadLeft);
+
+    if (stream->itemIdx == stream->dataIdx) {
+        // keep the prefix only; the rest is covered by the running digest
+        const uint64_t room = MIN(stream->dataLen, (uint64_t)EVM_STREAM_DATA_PREFIX_LEN) - stream->dataKept;
+        const uint32_t keep = (uint32_t)MIN((uint64_t)chunk, room);
+        CHECK_ERROR(emit(stream, data, keep))
+        stream->dataKept += keep;
+    } else {
+        CHECK_ERROR(forward(stream, data, chunk))
+    }
+
+    stream->payloadLeft -= chunk;
+    *used = chunk;
+    if (stream->payloadLeft == 0) {
+        nextItem(stream);
+    }
+    return parser_ok;
+}
+
+parser_error_t evm_stream_start(evm_stream_t *stream, uint8_t txType, uint64_t listLen, evm_stream_sink_t sink) {
+    if (stream == NULL || sink == NULL) {
+        return parser_unexpected_error;
+    }
+    MEMZERO(stream, sizeof(*stream));
+
+    // legacy transactions have no type byte
+    const eth_tx_schema_t *schema = eth_tx_schema(txType == 0 ? legacy : txType);
+    if (schema == NULL || (txType != 0 && txType >= legacy)) {
+        return parser_unsupported_tx;
+    }
+    stream->dataIdx = eth_tx_schema_index(schema, offsetof(eth_tx_t, tx.data));
+
+    stream->sink = sink;
+    stream->txType = txType;
+    stream->listLeft = listLen;
+    return parser_ok;
+}
+
+parser_error_t evm_stream_feed(evm_stream_t *stream, const uint8_t *data, uint32_t len, uint32_t *consumed) {
+    if (stream == NULL || stream->sink == NULL || consumed == NULL || (data == NULL && len != 0)) {
+        return parser_unexpected_error;
+    }
+    *consumed = 0;
+
+    while (*consumed < len && stream->listLeft > 0) {
+        const uint8_t *ptr = data + *consumed;
+        uint32_t used = 1;
+
+        switch (stream->stage) {
+            case evm_stream_item_prefix:
+                stream->listLeft--;
+                CHECK_ERROR(readPrefix(stream, *ptr))
+                break;
+            case evm_stream_item_length:
+                stream->listLeft--;
+                CHECK_ERROR(readLength(stream, *ptr))
+                break;
+            case evm_stream_item_payload: {
+                const uint32_t available = (uint32_t)MIN((uint64_t)(len - *consumed), stream->listLeft);
+                CHECK_ERROR(readPayload(stream, ptr, available, &used))
+                stream->listLeft -= used;
+                break;
+            }
+            default:
+                return parser_unexpected_error;
+        }
+        *consumed += used;
+    }
+
+    if (stream->listLeft == 0) {
+        // the list must end on an item boundary and contain the calldata
+        if (stream->stage != evm_stream_item_prefix || !stream->dataSeen) {
+            return parser_unexpected_buffer_end;
+        }
+    }
+    return parser_ok;
+}
+
+bool evm_stream_complete(const evm_stream_t *stream) {
+    return stream != NULL && stream->sink != NULL && stream->listLeft == 0 && stream->dataSeen &&
+           stream->stage == evm_stream_item_prefix;
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "parser_common.h"
+
+// Streaming mode for transactions that do not fit in the transaction buffer.
+// The top-level RLP list is walked as bytes arrive; every field is forwarded
+// to the sink except the calldata, of which only a bounded prefix is kept.
+// The sink receives a valid transaction whose data field is that prefix.
+#define EVM_STREAM_DATA_PREFIX_LEN 256
+// fields preceding the calldata are held back until the data header is known
+#define EVM_STREAM_STAGING_SIZE    192
+#define EVM_STREAM_MAX_HEADER_LEN  9
+
+typedef uint32_t (*evm_stream_sink_t)(const uint8_t *data, uint32_t len);
+
+typedef enum {
+    evm_stream_item_prefix = 0,
+    evm_stream_item_length,
+    evm_stream_item_payload,
+} evm_stream_stage_e;
+
+typedef struct {
+    evm_stream_sink_t sink;
+    uint8_t txType;
+    uint8_t dataIdx;
+
+    // current top-level item
+    uint8_t stage;
+    uint8_t itemIdx;
+    uint8_t header[EVM_STREAM_MAX_HEADER_LEN];
+    uint8_t headerLen;
+    uint8_t lengthBytes;
+    uint64_t payloadLeft;
+
+    // bytes of the top-level list payload not received yet
+    uint64_t listLeft;
+
+    uint64_t dataLen;
+    uint32_t dataKept;
+    bool dataSeen;
+
+    uint8_t staging[EVM_STREAM_STAGING_SIZE];
+    uint16_t stagingLen;
+} evm_stream_t;
+
+/// Starts a streaming session once the envelope is known.
+/// \param txType EIP-2718 type byte, or 0 for legacy transactions
+/// \param listLen length of the top-level list payload
+parser_error_t evm_stream_start(evm_stream_t *stream, uint8_t txType, uint64_t listLen, evm_stream_sink_t sink);
+
+/// Feeds bytes of the top-level list payload. Bytes past the end of the list are not consumed.
+parser_error_t evm_stream_feed(evm_stream_t *stream, const uint8_t *data, uint32_t len, uint32_t *consumed);
+
+/// \return true once the whole list payload went through the stream
+bool evm_stream_complete(const evm_stream_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
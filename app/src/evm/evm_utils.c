@@ -16,10 +16,15 @@
 #include "evm_utils.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <zxmacros.h>
 
 #include "bignum.h"
 #include "coin_evm.h"
+#include "crypto_helper.h"
+#include "format_scratch.h"
+#include "hex_encode.h"
+#include "parser_impl_evm.h"
 #include "rlp.h"
 #include "zxerror.h"
 #include "zxformat.h"
@@ -27,6 +32,11 @@
 #define RLP_MARKER_VAL_1 0xC0
 #define RLP_MARKER_VAL_2 0xF7
 
+// text lengths of the number formatters, borrowed from the format scratch
+#define RLP_NUMBER_TEXT_LEN 100
+#define BIGINT_TEXT_LEN     160
+#define BIGINT_BCD_LEN      80
+
 #define CHECK_RLP_LEN(BUFF_LEN, RLP_LEN)            \
     {                                               \
         uint64_t buff_len = BUFF_LEN;               \
@@ -94,7 +104,7 @@ rlp_error_t get_tx_rlp_len(const uint8_t *buffer, uint32_t len, uint64_t *read,
     // skip version if present/recognized
     //  otherwise tx is probably legacy so no version, just rlp data
     uint8_t version = data[offset];
-    if (version == 1 || version == 2) {
+    if (version < legacy && eth_tx_schema(version) != NULL) {
         offset += 1;
         *read += 1;
     }
@@ -141,15 +151,19 @@ parser_error_t printRLPNumber(const rlp_t *num, char *outVal, uint16_t outValLen
     }
 
     uint256_t tmpUint256 = {0};
-    char tmpBuffer[100] = {0};
-
     CHECK_ERROR(rlp_readUInt256(num, &tmpUint256));
-    if (!tostring256(&tmpUint256, 10, tmpBuffer, sizeof(tmpBuffer))) {
+
+    char *tmpBuffer = format_scratch_borrow(RLP_NUMBER_TEXT_LEN);
+    if (tmpBuffer == NULL) {
         return parser_unexpected_error;
     }
-    pageString(outVal, outValLen, tmpBuffer, pageIdx, pageCount);
-
-    return parser_ok;
+    parser_error_t err = parser_unexpected_error;
+    if (tostring256(&tmpUint256, 10, tmpBuffer, RLP_NUMBER_TEXT_LEN)) {
+        pageString(outVal, outValLen, tmpBuffer, pageIdx, pageCount);
+        err = parser_ok;
+    }
+    format_scratch_return();
+    return err;
 }
 
 #define LESS_THAN_64_DIGIT(num_digit) \
@@ -165,23 +179,23 @@ parser_error_t printBigIntFixedPoint(const uint8_t *number, uint16_t number_len,
                                      uint8_t pageIdx, uint8_t *pageCount, uint16_t decimals) {
     LESS_THAN_64_DIGIT(number_len);
 
-    char bignum[160] = {0};
-    union {
-        // overlapping arrays to avoid excessive stack usage. Do not use at the same time
-        uint8_t bcd[80];
-        char output[160];
-    } overlapped;
-
-    MEMZERO(&overlapped, sizeof(overlapped));
-
-    if (!format_quantity(number, number_len, overlapped.bcd, sizeof(overlapped.bcd), bignum, sizeof(bignum))) {
-        return parser_unexpected_value;
+    // [bignum (160)] [bcd (80), then output (160)]: bcd is done with before output is written
+    char *bignum = format_scratch_borrow(2 * BIGINT_TEXT_LEN);
+    if (bignum == NULL) {
+        return parser_unexpected_error;
     }
-
-    fpstr_to_str(overlapped.output, sizeof(overlapped.output), bignum, decimals);
-    number_inplace_trimming(overlapped.output, 1);
-    pageString(outVal, outValLen, overlapped.output, pageIdx, pageCount);
-    return parser_ok;
+    char *output = bignum + BIGINT_TEXT_LEN;
+    uint8_t *bcd = (uint8_t *)output;
+
+    parser_error_t err = parser_unexpected_value;
+    if (format_quantity(number, number_len, bcd, BIGINT_BCD_LEN, bignum, BIGINT_TEXT_LEN)) {
+        fpstr_to_str(output, BIGINT_TEXT_LEN, bignum, decimals);
+        number_inplace_trimming(output, 1);
+        pageString(outVal, outValLen, output, pageIdx, pageCount);
+        err = parser_ok;
+    }
+    format_scratch_return();
+    return err;
 }
 
 parser_error_t printEVMAddress(const rlp_t *address, char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
@@ -189,13 +203,117 @@ parser_error_t printEVMAddress(const rlp_t *address, char *outVal, uint16_t outV
         return parser_unexpected_error;
     }
 
-    char tmpBuffer[67] = {0};
-    tmpBuffer[0] = '0';
-    tmpBuffer[1] = 'x';
-    if (!array_to_hexstr(tmpBuffer + 2, sizeof(tmpBuffer) - 2, address->ptr, address->rlpLen)) {
+    return pageEVMAddress(outVal, outValLen, address->ptr, EVM_ADDRESS_CHECKSUM, pageIdx, pageCount);
+}
+
+uint8_t pageCountForLength(uint32_t len, uint16_t outValLen) {
+    if (outValLen <= 1 || len == 0) {
+        return 0;
+    }
+    const uint32_t pageLen = outValLen - 1u;
+    const uint32_t pages = len / pageLen + (len % pageLen != 0 ? 1 : 0);
+    return (uint8_t)MIN(pages, UINT8_MAX);
+}
+
+void pageText(char *outVal, uint16_t outValLen, const char *text, uint32_t textLen, uint8_t pageIdx, uint8_t *pageCount) {
+    if (outVal == NULL || pageCount == NULL || outValLen == 0) {
+        return;
+    }
+    MEMZERO(outVal, outValLen);
+    *pageCount = pageCountForLength(text != NULL ? textLen : 0, outValLen);
+    if (pageIdx >= *pageCount) {
+        return;
+    }
+    const uint32_t pageLen = outValLen - 1u;
+    const uint32_t start = (uint32_t)pageIdx * pageLen;
+    MEMCPY(outVal, text + start, MIN(pageLen, textLen - start));
+}
+
+void pageHex(char *outVal, uint16_t outValLen, const char *prefix, const uint8_t *data, uint32_t dataLen, uint8_t pageIdx,
+             uint8_t *pageCount) {
+    if (outVal == NULL || pageCount == NULL || outValLen == 0) {
+        return;
+    }
+    MEMZERO(outVal, outValLen);
+    const uint32_t prefixLen = prefix != NULL ? (uint32_t)strlen(prefix) : 0;
+    if (data == NULL) {
+        dataLen = 0;
+    }
+    const uint32_t totalLen = prefixLen + 2 * dataLen;
+    *pageCount = pageCountForLength(totalLen, outValLen);
+    if (pageIdx >= *pageCount) {
+        return;
+    }
+
+    const uint32_t pageLen = outValLen - 1u;
+    uint32_t start = (uint32_t)pageIdx * pageLen;
+    const uint32_t end = MIN(start + pageLen, totalLen);
+    char *out = outVal;
+    if (start < prefixLen) {
+        const uint32_t shown = MIN(prefixLen, end) - start;
+        MEMCPY(out, prefix + start, shown);
+        out += shown;
+        start += shown;
+    }
+    if (start < end) {
+        hex_encode_window(out, data, start - prefixLen, end - start);
+    }
+}
+
+void eip55_checksum_window(char *hex, uint32_t first, uint32_t len, const uint8_t *hash) {
+    if (hex == NULL || hash == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < len && first + i < 2 * ETH_ADDR_LEN; i++) {
+        const uint32_t digit = first + i;
+        const uint8_t nibble = (digit % 2 == 0) ? (hash[digit / 2] >> 4) : (hash[digit / 2] & 0x0F);
+        if (nibble >= 8 && hex[i] >= 'a' && hex[i] <= 'f') {
+            hex[i] = (char)(hex[i] - 'a' + 'A');
+        }
+    }
+}
+
+// keccak256 of the lowercase digits of the last checksummed address: every page
+// of an address, and the same address shown again, reuse it instead of rehashing
+static struct {
+    char digits[2 * ETH_ADDR_LEN];
+    uint8_t hash[KECCAK_256_SIZE];
+    bool valid;
+} eip55_cache;
+
+const uint8_t *eip55_hash(const char *digits) {
+    if (digits == NULL) {
+        return NULL;
+    }
+    if (!eip55_cache.valid || memcmp(eip55_cache.digits, digits, sizeof(eip55_cache.digits)) != 0) {
+        eip55_cache.valid = false;
+        if (keccak_digest((const unsigned char *)digits, sizeof(eip55_cache.digits), eip55_cache.hash,
+                          sizeof(eip55_cache.hash)) != zxerr_ok) {
+            return NULL;
+        }
+        MEMCPY(eip55_cache.digits, digits, sizeof(eip55_cache.digits));
+        eip55_cache.valid = true;
+    }
+    return eip55_cache.hash;
+}
+
+parser_error_t pageEVMAddress(char *outVal, uint16_t outValLen, const uint8_t *address, bool checksum, uint8_t pageIdx,
+                              uint8_t *pageCount) {
+    if (outVal == NULL || address == NULL || pageCount == NULL) {
         return parser_unexpected_error;
     }
-    pageString(outVal, outValLen, tmpBuffer, pageIdx, pageCount);
+    if (!checksum) {
+        pageHex(outVal, outValLen, "0x", address, ETH_ADDR_LEN, pageIdx, pageCount);
+        return parser_ok;
+    }
 
+    char text[2 + 2 * ETH_ADDR_LEN] = {'0', 'x'};
+    hex_encode_window(text + 2, address, 0, 2 * ETH_ADDR_LEN);
+    const uint8_t *hash = eip55_hash(text + 2);
+    if (hash == NULL) {
+        return parser_unexpected_error;
+    }
+    eip55_checksum_window(text + 2, 0, 2 * ETH_ADDR_LEN, hash);
+    pageText(outVal, outValLen, text, sizeof(text), pageIdx, pageCount);
     return parser_ok;
 }
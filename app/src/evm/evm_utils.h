@@ -61,6 +61,39 @@ parser_error_t printEVMAddress(const rlp_t *address, char *outVal, uint16_t outV
 
 parser_error_t printBigIntFixedPoint(const uint8_t *number, uint16_t number_len, char *outVal, uint16_t outValLen,
                                      uint8_t pageIdx, uint8_t *pageCount, uint16_t decimals);
+
+// Paging that only renders the visible window. Pages split like pageString over
+// the full string, but the page count comes from the length alone and each page
+// costs O(outValLen) whatever the size of the value.
+
+/// Pages of outValLen - 1 characters needed for len characters, saturated at UINT8_MAX
+uint8_t pageCountForLength(uint32_t len, uint16_t outValLen);
+
+/// Same as pageString for a text of known length that does not need to be NUL terminated
+void pageText(char *outVal, uint16_t outValLen, const char *text, uint32_t textLen, uint8_t pageIdx, uint8_t *pageCount);
+
+/// Same as pageString over prefix followed by the hex encoding of data, without building it
+void pageHex(char *outVal, uint16_t outValLen, const char *prefix, const uint8_t *data, uint32_t dataLen, uint8_t pageIdx,
+             uint8_t *pageCount);
+
+// EIP-55 mixed-case addresses. Off by default so reviews keep showing lowercase
+// addresses; build with EVM_ADDRESS_CHECKSUM=1 to checksum the reviewed ones.
+#ifndef EVM_ADDRESS_CHECKSUM
+#define EVM_ADDRESS_CHECKSUM 0
+#endif
+
+/// Upper-cases the letters among len address digits, hex[0] being digit first of 40, where the matching
+/// nibble of hash (keccak256 of the 40 lowercase digits) is 8 or more
+void eip55_checksum_window(char *hex, uint32_t first, uint32_t len, const uint8_t *hash);
+
+/// keccak256 of the 40 lowercase digits of an address, computed once and reused while the address repeats
+/// \return NULL if hashing failed
+const uint8_t *eip55_hash(const char *digits);
+
+/// Pages "0x" followed by the 40 digits of address, in EIP-55 mixed case when checksum is set
+parser_error_t pageEVMAddress(char *outVal, uint16_t outValLen, const uint8_t *address, bool checksum, uint8_t pageIdx,
+                              uint8_t *pageCount);
+
 #ifdef __cplusplus
 }
 #endif
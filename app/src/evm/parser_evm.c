@@ -21,15 +21,110 @@
 #include <zxmacros.h>
 #include <zxtypes.h>
 
+#include "app_mode.h"
+#include "crypto_helper.h"
 #include "parser.h"
 #include "parser_common.h"
 #include "parser_impl_evm.h"
+#include "session.h"
+
+// Review items formatted by parser_validate_eth are kept here and paged from
+// memory afterwards. Items that do not fit are formatted on demand.
+#define RENDER_CACHE_POOL_SIZE 704
+#define RENDER_CACHE_MAX_VALUE 100
+
+typedef struct {
+    uint16_t keyOffset;
+    uint16_t valOffset;
+    bool valid;
+} render_cache_entry_t;
+
+static struct {
+    render_cache_entry_t entries[ETH_MAX_DISPLAY_FIELDS];
+    char pool[RENDER_CACHE_POOL_SIZE];
+    uint16_t used;
+} render_cache;
+
+static void render_cache_reset(void) {
+    MEMZERO(&render_cache, sizeof(render_cache));
+}
+
+static void render_cache_store(uint8_t displayIdx, const char *key, const char *val) {
+    if (displayIdx >= ETH_MAX_DISPLAY_FIELDS) {
+        return;
+    }
+    const uint16_t keyLen = (uint16_t)strlen(key) + 1;
+    const uint16_t valLen = (uint16_t)strlen(val) + 1;
+    if (render_cache.used + keyLen + valLen > sizeof(render_cache.pool)) {
+        return;
+    }
+
+    render_cache_entry_t *entry = &render_cache.entries[displayIdx];
+    entry->keyOffset = render_cache.used;
+    MEMCPY(render_cache.pool + render_cache.used, key, keyLen);
+    render_cache.used += keyLen;
+    entry->valOffset = render_cache.used;
+    MEMCPY(render_cache.pool + render_cache.used, val, valLen);
+    render_cache.used += valLen;
+    entry->valid = true;
+}
+
+static bool render_cache_get(uint8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                             uint8_t pageIdx, uint8_t *pageCount) {
+    if (displayIdx >= ETH_MAX_DISPLAY_FIELDS || !render_cache.entries[displayIdx].valid) {
+        return false;
+    }
+    const render_cache_entry_t *entry = &render_cache.entries[displayIdx];
+    snprintf(outKey, outKeyLen, "%s", render_cache.pool + entry->keyOffset);
+    pageString(outVal, outValLen, render_cache.pool + entry->valOffset, pageIdx, pageCount);
+    return true;
+}
 
 parser_error_t parser_parse_eth(parser_context_t *ctx, const uint8_t *data, size_t dataLen) {
+    render_cache_reset();
     CHECK_ERROR(parser_init_context(ctx, data, dataLen))
     return _readEth(ctx, &eth_tx_obj);
 }
 
+parser_error_t parser_precheck_eth(const uint8_t *data, size_t dataLen, uint64_t maxTxLen) {
+    parser_context_t ctx = {0};
+    CHECK_ERROR(parser_init_context(&ctx, data, (uint16_t)MIN(dataLen, UINT16_MAX)))
+    return _precheckEth(&ctx, maxTxLen);
+}
+
+parser_error_t parser_set_truncated_data_eth(uint64_t fullDataLen) {
+    if (fullDataLen < eth_tx_obj.tx.data.valueLen) {
+        return parser_unexpected_value;
+    }
+    eth_tx_obj.dataTruncated = fullDataLen > eth_tx_obj.tx.data.valueLen;
+    eth_tx_obj.dataFullLen = fullDataLen;
+    // classification depends on the full calldata
+    _buildDisplayFieldsEth(&eth_tx_obj);
+    return parser_ok;
+}
+
+parser_error_t parser_set_digest_eth(const uint8_t *digest) {
+    if (digest == NULL) {
+        return parser_no_data;
+    }
+    MEMCPY(eth_tx_obj.digest, digest, sizeof(eth_tx_obj.digest));
+    return parser_ok;
+}
+
+parser_error_t parser_compute_digest_eth(const parser_context_t *ctx) {
+    if (ctx == NULL || ctx->buffer == NULL) {
+        return parser_no_data;
+    }
+    if (keccak_digest(ctx->buffer, ctx->bufferLen, eth_tx_obj.digest, sizeof(eth_tx_obj.digest)) != zxerr_ok) {
+        return parser_unexpected_error;
+    }
+    return parser_ok;
+}
+
+const uint8_t *parser_get_digest_eth(void) {
+    return eth_tx_obj.digest;
+}
+
 parser_error_t parser_validate_eth(parser_context_t *ctx) {
     CHECK_ERROR(_validateTxEth())
 
@@ -38,11 +133,16 @@ parser_error_t parser_validate_eth(parser_context_t *ctx) {
     CHECK_ERROR(_getNumItemsEth(&numItems));
 
     char tmpKey[40] = {0};
-    char tmpVal[40] = {0};
+    char tmpVal[RENDER_CACHE_MAX_VALUE] = {0};
 
+    render_cache_reset();
     for (uint8_t idx = 0; idx < numItems; idx++) {
         uint8_t pageCount = 0;
         CHECK_ERROR(parser_getItemEth(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
+        // keep only values that were rendered in full
+        if (pageCount == 1) {
+            render_cache_store(idx, tmpKey, tmpVal);
+        }
     }
     return parser_ok;
 }
@@ -85,9 +185,18 @@ parser_error_t parser_getItemEth(const parser_context_t *ctx, uint8_t displayIdx
     CHECK_ERROR(checkSanity(numItems, displayIdx))
     CHECK_ERROR(cleanOutput(outKey, outKeyLen, outVal, outValLen));
 
+    if ((_isClearSignableEth() || app_mode_blindsign()) &&
+        render_cache_get(displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount)) {
+        return parser_ok;
+    }
+
     return _getItemEth(ctx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
 }
 
 parser_error_t parser_compute_eth_v(parser_context_t *ctx, unsigned int info, uint8_t *v) {
     return _computeV(ctx, &eth_tx_obj, info, v);
 }
+
+uint8_t parser_compute_message_v(unsigned int info) {
+    return (uint8_t)(27 + ((info & CX_ECCINFO_PARITY_ODD) ? 1 : 0));
+}
@@ -28,6 +28,21 @@ const char *parser_getMsgPackTypeDescription(uint8_t type);
 //// parses a tx buffer
 parser_error_t parser_parse_eth(parser_context_t *ctx, const uint8_t *data, size_t dataLen);
 
+//// checks the leading bytes of a tx before the rest is uploaded
+parser_error_t parser_precheck_eth(const uint8_t *data, size_t dataLen, uint64_t maxTxLen);
+
+//// marks the parsed calldata as a prefix of a longer streamed calldata
+parser_error_t parser_set_truncated_data_eth(uint64_t fullDataLen);
+
+//// stores the transaction digest already computed by the caller
+parser_error_t parser_set_digest_eth(const uint8_t *digest);
+
+//// hashes the parsed transaction buffer into the digest slot
+parser_error_t parser_compute_digest_eth(const parser_context_t *ctx);
+
+//// returns the digest of the parsed transaction
+const uint8_t *parser_get_digest_eth(void);
+
 //// verifies tx fields
 parser_error_t parser_validate_eth(parser_context_t *ctx);
 
@@ -39,6 +54,9 @@ parser_error_t parser_getItemEth(const parser_context_t *ctx, uint8_t displayIdx
                                  char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
 
 parser_error_t parser_compute_eth_v(parser_context_t *ctx, unsigned int info, uint8_t *v);
+
+/// v of a personal message or typed data signature: 27 + parity, whatever transaction was parsed before
+uint8_t parser_compute_message_v(unsigned int info);
 #ifdef __cplusplus
 }
 #endif
@@ -16,39 +16,45 @@
 
 #include "parser_impl_evm.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <zxmacros.h>
 
 #include "app_mode.h"
 #include "crypto_helper.h"
+#include "evm_abi.h"
+#include "evm_access_list.h"
+#include "evm_authorization.h"
 #include "evm_erc20.h"
 #include "evm_utils.h"
+#include "format_scratch.h"
+#include "hex_encode.h"
 #include "parser_common.h"
 #include "parser_txdef.h"
 #include "rlp.h"
+#include "session.h"
 #include "uint256.h"
 #include "zxformat.h"
 
-eth_tx_t eth_tx_obj;
-#define SUPPORTED_NETWORKS_EVM_LEN 3
-#define PEAQ_MAINNET_CHAINID       3338
-#define PEAQ_TESTNET_CHAINID       9990
-#define PEAQ_CANARY_CHAINID        2241
+#define PEAQ_MAINNET_CHAINID 3338
+#define PEAQ_TESTNET_CHAINID 9990
+#define PEAQ_CANARY_CHAINID  2241
 
-const uint64_t supported_networks_evm[3] = {PEAQ_MAINNET_CHAINID, PEAQ_TESTNET_CHAINID, PEAQ_CANARY_CHAINID};
+const uint64_t supported_networks_evm[SUPPORTED_NETWORKS_EVM_LEN] = {PEAQ_MAINNET_CHAINID, PEAQ_TESTNET_CHAINID, PEAQ_CANARY_CHAINID};
 
-static parser_error_t readChainID(parser_context_t *ctx, rlp_t *chainId) {
+static parser_error_t readChainID(parser_context_t *ctx, rlp_field_t *chainId) {
     if (ctx == NULL || chainId == NULL) {
         return parser_unexpected_error;
     }
 
-    CHECK_ERROR(rlp_read(ctx, chainId));
+    CHECK_ERROR(rlp_readField(ctx, chainId));
+    const uint8_t *value = ctx->buffer + chainId->valueOffset;
     uint64_t tmpChainId = 0;
-    if (chainId->rlpLen > 1) {
-        CHECK_ERROR(be_bytes_to_u64(chainId->ptr, chainId->rlpLen, &tmpChainId))
+    if (chainId->valueLen > 1) {
+        CHECK_ERROR(be_bytes_to_u64(value, chainId->valueLen, &tmpChainId))
     } else if (chainId->kind == RLP_KIND_BYTE) {
         // case were the prefix is the byte itself
-        tmpChainId = chainId->ptr[0];
+        tmpChainId = value[0];
     } else {
         return parser_unexpected_error;
     }
@@ -63,91 +69,131 @@ static parser_error_t readChainID(parser_context_t *ctx, rlp_t *chainId) {
     return parser_invalid_chain_id;
 }
 
-static parser_error_t parse_legacy_tx(parser_context_t *ctx, eth_tx_t *tx_obj) {
-    if (ctx == NULL || tx_obj == NULL) {
-        return parser_unexpected_error;
+static parser_error_t readAmount(parser_context_t *ctx, rlp_field_t *amount) {
+    CHECK_ERROR(rlp_readField(ctx, amount))
+    if (amount->valueLen > UINT256_BYTES) {
+        return parser_value_out_of_range;
     }
+    return parser_ok;
+}
 
-    CHECK_ERROR(rlp_read(ctx, &tx_obj->tx.nonce));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.gasPrice)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.gasLimit)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.to)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.value)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.data)));
+#define ETH_ITEM(member, decoder) {(uint16_t)offsetof(eth_tx_t, member), decoder}
+
+static const eth_tx_schema_t ETH_SCHEMAS[] = {
+    {legacy,
+     7,
+     {ETH_ITEM(tx.nonce, eth_decode_field), ETH_ITEM(tx.gasPrice, eth_decode_field), ETH_ITEM(tx.gasLimit, eth_decode_field),
+      ETH_ITEM(tx.to, eth_decode_field), ETH_ITEM(tx.value, eth_decode_amount), ETH_ITEM(tx.data, eth_decode_field),
+      ETH_ITEM(chainId, eth_decode_eip155)},
+     2,
+     {eth_field_gas_limit, eth_field_gas_price}},
+    {eip2930,
+     8,
+     {ETH_ITEM(chainId, eth_decode_chain_id), ETH_ITEM(tx.nonce, eth_decode_field), ETH_ITEM(tx.gasPrice, eth_decode_field),
+      ETH_ITEM(tx.gasLimit, eth_decode_field), ETH_ITEM(tx.to, eth_decode_field), ETH_ITEM(tx.value, eth_decode_amount),
+      ETH_ITEM(tx.data, eth_decode_field), ETH_ITEM(tx.access_list, eth_decode_access_list)},
+     2,
+     {eth_field_gas_limit, eth_field_gas_price}},
+    {eip1559,
+     9,
+     {ETH_ITEM(chainId, eth_decode_chain_id), ETH_ITEM(tx.nonce, eth_decode_field),
+      ETH_ITEM(tx.max_priority_fee_per_gas, eth_decode_field), ETH_ITEM(tx.max_fee_per_gas, eth_decode_field),
+      ETH_ITEM(tx.gasLimit, eth_decode_field), ETH_ITEM(tx.to, eth_decode_field), ETH_ITEM(tx.value, eth_decode_amount),
+      ETH_ITEM(tx.data, eth_decode_field), ETH_ITEM(tx.access_list, eth_decode_access_list)},
+     3,
+     {eth_field_max_priority_fee, eth_field_max_fee, eth_field_gas_limit}},
+    {eip7702,
+     10,
+     {ETH_ITEM(chainId, eth_decode_chain_id), ETH_ITEM(tx.nonce, eth_decode_field),
+      ETH_ITEM(tx.max_priority_fee_per_gas, eth_decode_field), ETH_ITEM(tx.max_fee_per_gas, eth_decode_field),
+      ETH_ITEM(tx.gasLimit, eth_decode_field), ETH_ITEM(tx.to, eth_decode_field), ETH_ITEM(tx.value, eth_decode_amount),
+      ETH_ITEM(tx.data, eth_decode_field), ETH_ITEM(tx.access_list, eth_decode_access_list),
+      ETH_ITEM(tx.authorization_list, eth_decode_authorization_list)},
+     3,
+     {eth_field_max_priority_fee, eth_field_max_fee, eth_field_gas_limit}},
+};
+
+const eth_tx_schema_t *eth_tx_schema(uint8_t type) {
+    for (uint8_t i = 0; i < sizeof(ETH_SCHEMAS) / sizeof(ETH_SCHEMAS[0]); i++) {
+        const eth_tx_schema_t *schema = (const eth_tx_schema_t *)PIC(&ETH_SCHEMAS[i]);
+        if (schema->type == type) {
+            return schema;
+        }
+    }
+    return NULL;
+}
 
-    // Check for legacy no EIP155 which means no chain_id
-    // There is not more data no eip155 compliant tx
+uint8_t eth_tx_schema_index(const eth_tx_schema_t *schema, uint16_t offset) {
+    uint8_t idx = 0;
+    while (idx < schema->numItems && schema->items[idx].offset != offset) {
+        idx++;
+    }
+    return idx;
+}
+
+// Legacy transactions end after the data (pre EIP-155), or carry the chain id with empty r and s
+static parser_error_t readEip155(parser_context_t *ctx, eth_tx_t *tx_obj) {
     if (ctx->offset == ctx->bufferLen) {
         tx_obj->chainId.kind = RLP_KIND_BYTE;
-        tx_obj->chainId.ptr = NULL;
-        tx_obj->chainId.rlpLen = 0;
+        tx_obj->chainId.valueLen = 0;
         return parser_ok;
     }
-
-    // Otherwise legacy EIP155 in which case should come with empty r and s values
-    // Transaction comes with a chainID so it is EIP155 compliant
     CHECK_ERROR(readChainID(ctx, &tx_obj->chainId));
 
-    // Check R and S fields
     rlp_t sig_r = {0};
     CHECK_ERROR(rlp_read(ctx, &sig_r));
-
     rlp_t sig_s = {0};
     CHECK_ERROR(rlp_read(ctx, &sig_s));
 
     // R and S values should be either 0 or 0x80
     if ((sig_r.rlpLen == 0 && sig_s.rlpLen == 0) ||
         ((sig_r.rlpLen == 1 && sig_s.rlpLen == 1) && !(*sig_r.ptr | *sig_s.ptr))) {
-        // Reject any trailing bytes inside the signed RLP list.
-        if (ctx->offset < ctx->bufferLen) {
-            return parser_unexpected_characters;
-        }
         return parser_ok;
     }
     return parser_invalid_rs_values;
 }
 
-static parser_error_t parse_2930(parser_context_t *ctx, eth_tx_t *tx_obj) {
-    if (ctx == NULL || tx_obj == NULL) {
-        return parser_unexpected_error;
-    }
-    CHECK_ERROR(readChainID(ctx, &tx_obj->chainId));
-    CHECK_ERROR(rlp_read(ctx, &tx_obj->tx.nonce));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.gasPrice)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.gasLimit)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.to)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.value)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.data)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.access_list)));
-
-    // R and S fields should be empty
-    if (ctx->offset < ctx->bufferLen) {
-        return parser_unexpected_characters;
+static parser_error_t decodeItem(parser_context_t *ctx, eth_tx_t *tx_obj, const eth_schema_item_t *item) {
+    rlp_field_t *field = (rlp_field_t *)((uint8_t *)tx_obj + item->offset);
+    switch (item->decoder) {
+        case eth_decode_field:
+            return rlp_readField(ctx, field);
+        case eth_decode_chain_id:
+            return readChainID(ctx, field);
+        case eth_decode_amount:
+            return readAmount(ctx, field);
+        case eth_decode_access_list: {
+            CHECK_ERROR(rlp_readField(ctx, field));
+            rlp_t accessList = {0};
+            rlp_fieldView(ctx->buffer, field, &accessList);
+            return access_list_count(&accessList, &tx_obj->accessListAddresses, &tx_obj->accessListKeys);
+        }
+        case eth_decode_authorization_list: {
+            CHECK_ERROR(rlp_readField(ctx, field));
+            rlp_t authorizationList = {0};
+            rlp_fieldView(ctx->buffer, field, &authorizationList);
+            CHECK_ERROR(authorization_count(&authorizationList, &tx_obj->authorizations))
+            // an empty list makes the transaction invalid
+            if (tx_obj->authorizations == 0 || tx_obj->authorizations > ETH_MAX_AUTHORIZATIONS) {
+                return parser_unexpected_number_items;
+            }
+            return parser_ok;
+        }
+        case eth_decode_eip155:
+            return readEip155(ctx, tx_obj);
+        default:
+            return parser_unexpected_error;
     }
-
-    return parser_ok;
 }
 
-static parser_error_t parse_1559(parser_context_t *ctx, eth_tx_t *tx_obj) {
-    if (ctx == NULL || tx_obj == NULL) {
-        return parser_unexpected_error;
+static parser_error_t decodeTx(parser_context_t *ctx, eth_tx_t *tx_obj, const eth_tx_schema_t *schema) {
+    for (uint8_t i = 0; i < schema->numItems; i++) {
+        CHECK_ERROR(decodeItem(ctx, tx_obj, &schema->items[i]))
     }
-
-    CHECK_ERROR(readChainID(ctx, &tx_obj->chainId));
-    CHECK_ERROR(rlp_read(ctx, &tx_obj->tx.nonce));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.max_priority_fee_per_gas)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.max_fee_per_gas)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.gasLimit)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.to)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.value)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.data)));
-    CHECK_ERROR(rlp_read(ctx, &(tx_obj->tx.access_list)));
-
-    // R and S fields should be empty
+    // R and S fields should be empty, and nothing may follow them
     if (ctx->offset < ctx->bufferLen) {
         return parser_unexpected_characters;
     }
-
     return parser_ok;
 }
 
@@ -156,12 +202,11 @@ static parser_error_t readTxnType(parser_context_t *ctx, eth_tx_type_e *type) {
         return parser_unexpected_error;
     }
     // Check first byte:
-    //    0x01 --> EIP2930
-    //    0x02 --> EIP1559
+    //  < 0x80 --> EIP-2718 type, supported if it has a schema
     // >= 0xC0 --> Legacy
     uint8_t marker = *(ctx->buffer + ctx->offset);
 
-    if (marker == eip2930 || marker == eip1559) {
+    if (marker < legacy && eth_tx_schema(marker) != NULL) {
         *type = (eth_tx_type_e)marker;
         ctx->offset++;
         return parser_ok;
@@ -193,148 +238,261 @@ parser_error_t _readEth(parser_context_t *ctx, eth_tx_t *tx_obj) {
         return parser_unexpected_characters;
     }
 
-    parser_context_t txCtx = {.buffer = list.ptr, .bufferLen = list.rlpLen, .offset = 0};
-    switch (tx_obj->tx_type) {
-        case eip1559: {
-            return parse_1559(&txCtx, tx_obj);
-        }
-
-        case eip2930: {
-            return parse_2930(&txCtx, tx_obj);
-        }
+    // fields are read in place, relative to the start of the transaction
+    tx_obj->buffer = ctx->buffer;
+    parser_context_t txCtx = {.buffer = ctx->buffer, .bufferLen = ctx->bufferLen, .offset = (uint16_t)(list.ptr - ctx->buffer)};
+    const eth_tx_schema_t *schema = eth_tx_schema(tx_obj->tx_type);
+    if (schema == NULL) {
+        return parser_unexpected_error;
+    }
+    CHECK_ERROR(decodeTx(&txCtx, tx_obj, schema))
 
-        case legacy: {
-            return parse_legacy_tx(&txCtx, tx_obj);
-        }
+    // set-code transactions cannot create contracts
+    if (tx_obj->tx_type == eip7702 && tx_obj->tx.to.valueLen != ETH_ADDRESS_LEN) {
+        return parser_invalid_address;
     }
-    return parser_unexpected_error;
+
+    _buildDisplayFieldsEth(tx_obj);
+    return parser_ok;
 }
 
-parser_error_t _validateTxEth() {
-    if (!validateERC20(&eth_tx_obj) && !app_mode_blindsign()) {
-        return parser_blindsign_mode_required;
+void eth_tx_view(const eth_tx_t *tx_obj, const rlp_field_t *field, rlp_t *view) {
+    rlp_fieldView(tx_obj->buffer, field, view);
+}
+
+// Header-only read of the top-level list; its payload may not be there yet
+static parser_error_t readListHeader(parser_context_t *ctx, uint64_t *listLen) {
+    if (ctx->offset >= ctx->bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
+    const uint8_t marker = ctx->buffer[ctx->offset];
+    if (marker < RLP_KIND_LIST_SHORT_MIN) {
+        return parser_unexpected_value;
+    }
+    if (marker <= RLP_KIND_LIST_SHORT_MAX) {
+        *listLen = marker - RLP_KIND_LIST_SHORT_MIN;
+        ctx->offset++;
+        return parser_ok;
     }
 
+    const uint8_t bytesLen = marker - RLP_KIND_LIST_SHORT_MAX;
+    if (ctx->bufferLen - ctx->offset < 1 + bytesLen) {
+        return parser_unexpected_buffer_end;
+    }
+    CHECK_ERROR(be_bytes_to_u64(ctx->buffer + ctx->offset + 1, bytesLen, listLen))
+    ctx->offset += 1 + bytesLen;
     return parser_ok;
 }
 
-static parser_error_t printEthHash(const parser_context_t *ctx, char *outKey, uint16_t outKeyLen, char *outVal,
-                                   uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
-    // we need to get keccak hash of the transaction data
-    uint8_t hash[32] = {0};
-#if defined(LEDGER_SPECIFIC)
-    keccak_digest(ctx->buffer, ctx->bufferLen, hash, 32);
-#endif
-
-    // now get the hex string of the hash
-    char hex[65] = {0};
-    array_to_hexstr(hex, 65, hash, 32);
+parser_error_t _precheckEth(parser_context_t *ctx, uint64_t maxTxLen) {
+    if (ctx == NULL) {
+        return parser_unexpected_error;
+    }
+    eth_tx_type_e type = legacy;
+    CHECK_ERROR(readTxnType(ctx, &type))
 
-    snprintf(outKey, outKeyLen, "Eth-Hash");
+    uint64_t listLen = 0;
+    parser_error_t err = readListHeader(ctx, &listLen);
+    if (err == parser_unexpected_buffer_end) {
+        return parser_ok;
+    }
+    CHECK_ERROR(err)
 
-    pageString(outVal, outValLen, hex, pageIdx, pageCount);
+    const bool blindsign = app_mode_blindsign();
+    // transactions that do not fit in the buffer are streamed and can never be clear signed
+    if (!blindsign && saturating_add(ctx->offset, listLen) > maxTxLen) {
+        return parser_blindsign_mode_required;
+    }
 
-    MEMZERO(hash, sizeof(hash));
-    return parser_ok;
-}
+    const uint64_t available = MIN(listLen, (uint64_t)(ctx->bufferLen - ctx->offset));
+    parser_context_t txCtx = {.buffer = ctx->buffer + ctx->offset, .bufferLen = (uint16_t)available, .offset = 0};
 
-static parser_error_t printERC20Transfer(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen,
-                                         char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
-    if (outKey == NULL || outVal == NULL || pageCount == NULL) {
+    // position of the fields we need in this transaction layout
+    const eth_tx_schema_t *schema = eth_tx_schema(type);
+    if (schema == NULL) {
         return parser_unexpected_error;
     }
-    MEMZERO(outKey, outKeyLen);
-    MEMZERO(outVal, outValLen);
-    *pageCount = 1;
+    const uint8_t toIdx = eth_tx_schema_index(schema, offsetof(eth_tx_t, tx.to));
+    const uint8_t dataIdx = eth_tx_schema_index(schema, offsetof(eth_tx_t, tx.data));
+    if (dataIdx >= schema->numItems) {
+        return parser_unexpected_error;
+    }
+
+    rlp_t to = {0};
+    rlp_t data = {0};
+    for (uint8_t i = 0; i <= dataIdx; i++) {
+        rlp_field_t field = {0};
+        if (schema->items[i].decoder == eth_decode_chain_id) {
+            err = readChainID(&txCtx, &field);
+        } else if (schema->items[i].decoder == eth_decode_amount) {
+            err = readAmount(&txCtx, &field);
+        } else {
+            err = rlp_readField(&txCtx, &field);
+        }
+        // fields not received yet are checked once the upload completes
+        if (err == parser_unexpected_buffer_end) {
+            return parser_ok;
+        }
+        CHECK_ERROR(err)
 
-    if (eth_tx_obj.tx_type == eip1559 && displayIdx >= 8) {
-        displayIdx++;
+        if (i == toIdx) {
+            rlp_fieldView(txCtx.buffer, &field, &to);
+        } else if (i == dataIdx) {
+            rlp_fieldView(txCtx.buffer, &field, &data);
+        }
     }
 
-    if ((eth_tx_obj.tx_type == legacy || eth_tx_obj.tx_type == eip2930) && displayIdx >= 5) {
-        displayIdx += 2;
+    if (!blindsign && !isERC20TransferData(&to, &data) && abi_decode(&to, &data) == ABI_NO_METHOD) {
+        return parser_blindsign_mode_required;
     }
 
-    char data_array[TMP_DATA_ARRAY_SIZE] = {0};
-    switch (displayIdx) {
-        case 0:
-            snprintf(outKey, outKeyLen, "Receiver");
-            rlp_t to = {
-                .kind = RLP_KIND_STRING, .ptr = (eth_tx_obj.tx.data.ptr + ERC20_TRANSFER_OFFSET), .rlpLen = ETH_ADDRESS_LEN};
-            CHECK_ERROR(printEVMAddress(&to, outVal, outValLen, pageIdx, pageCount));
-            break;
+    // legacy EIP-155 transactions carry the chain id right after the data
+    if (dataIdx + 1 < schema->numItems && schema->items[dataIdx + 1].decoder == eth_decode_eip155 &&
+        txCtx.offset < listLen) {
+        rlp_field_t chainId = {0};
+        err = readChainID(&txCtx, &chainId);
+        if (err == parser_unexpected_buffer_end) {
+            return parser_ok;
+        }
+        CHECK_ERROR(err)
+    }
 
-        case 1:
-            snprintf(outKey, outKeyLen, "Contract");
-            rlp_t contractAddress = {.kind = RLP_KIND_STRING, .ptr = eth_tx_obj.tx.to.ptr, .rlpLen = ETH_ADDRESS_LEN};
-            CHECK_ERROR(printEVMAddress(&contractAddress, outVal, outValLen, pageIdx, pageCount));
-            break;
-        case 2:
-            snprintf(outKey, outKeyLen, "Coin asset");
-            snprintf(outVal, outValLen, "peaq");
-            break;
+    return parser_ok;
+}
 
-        case 3:
-            snprintf(outKey, outKeyLen, "Amount");
-            CHECK_ERROR(printERC20Value(&eth_tx_obj, outVal, outValLen, pageIdx, pageCount));
-            break;
+bool _isClearSignableEth(void) {
+    return eth_tx_obj.is_erc20_transfer || eth_tx_obj.abiMethod != ABI_NO_METHOD;
+}
 
-        case 4:
-            snprintf(outKey, outKeyLen, "Nonce");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.nonce, outVal, outValLen, pageIdx, pageCount));
-            break;
+parser_error_t _validateTxEth() {
+    if (!_isClearSignableEth() && !app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
+    }
+    // an access list too long to be listed cannot be clear signed
+    if (eth_tx_obj.accessListHidden && !app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
+    }
 
-        case 5:
-            snprintf(outKey, outKeyLen, "Max Priority Fee");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.max_priority_fee_per_gas, outVal, outValLen, pageIdx, pageCount));
-            break;
+    return parser_ok;
+}
 
-        case 6:
-            snprintf(outKey, outKeyLen, "Max Fee");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.max_fee_per_gas, outVal, outValLen, pageIdx, pageCount));
-            break;
+static parser_error_t printEthHash(const parser_context_t *ctx, char *outKey, uint16_t outKeyLen, char *outVal,
+                                   uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    UNUSED(ctx);
+    // digest was computed once after parsing
+    snprintf(outKey, outKeyLen, "Eth-Hash");
+    pageHex(outVal, outValLen, NULL, eth_tx_obj.digest, KECCAK_256_SIZE, pageIdx, pageCount);
 
-        case 7:
-            snprintf(outKey, outKeyLen, "Gas limit");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.gasLimit, outVal, outValLen, pageIdx, pageCount));
-            break;
+    return parser_ok;
+}
 
-        case 8:
-            snprintf(outKey, outKeyLen, "Gas price");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.gasPrice, outVal, outValLen, pageIdx, pageCount));
-            break;
+// Expert mode pages through the whole calldata. Only the bytes of the requested
+// page are hex encoded, straight from the upload buffer (RAM or flash), so the
+// cost of a page does not depend on the calldata length.
+static bool showFullData(const rlp_t *data) {
+    return app_mode_expert() && !eth_tx_obj.dataTruncated && data->rlpLen <= DATA_BYTES_TO_PAGE;
+}
 
-        case 9:
-            snprintf(outKey, outKeyLen, "Value");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.value, outVal, outValLen, pageIdx, pageCount));
-            break;
+static parser_error_t printDataPreview(char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    rlp_t data = {0};
+    eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.data, &data);
+    if (showFullData(&data)) {
+        pageHex(outVal, outValLen, "0x", data.ptr, data.rlpLen, pageIdx, pageCount);
+        return parser_ok;
+    }
 
-        case 10:
-            snprintf(outKey, outKeyLen, "Data");
-            array_to_hexstr(
-                data_array, sizeof(data_array), eth_tx_obj.tx.data.ptr,
-                eth_tx_obj.tx.data.rlpLen > DATA_BYTES_TO_PRINT ? DATA_BYTES_TO_PRINT : eth_tx_obj.tx.data.rlpLen);
+    char *data_array = format_scratch_borrow(TMP_DATA_ARRAY_SIZE);
+    if (data_array == NULL) {
+        return parser_unexpected_error;
+    }
+    hex_encode(data_array, TMP_DATA_ARRAY_SIZE, data.ptr,
+               data.rlpLen > DATA_BYTES_TO_PRINT ? DATA_BYTES_TO_PRINT : data.rlpLen);
 
-            if (eth_tx_obj.tx.data.rlpLen > DATA_BYTES_TO_PRINT) {
-                snprintf(data_array + (2 * DATA_BYTES_TO_PRINT), 4, "...");
-            }
+    if (data.rlpLen > DATA_BYTES_TO_PRINT) {
+        snprintf(data_array + (2 * DATA_BYTES_TO_PRINT), 4, "...");
+    }
 
-            pageString(outVal, outValLen, data_array, pageIdx, pageCount);
-            break;
+    pageString(outVal, outValLen, data_array, pageIdx, pageCount);
+    format_scratch_return();
+    return parser_ok;
+}
 
-        case 11:
-            CHECK_ERROR(printEthHash(ctx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount));
-            break;
+static parser_error_t printAccessListSummary(char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    char tmp[40] = {0};
+    snprintf(tmp, sizeof(tmp), "%d %s / %d %s", eth_tx_obj.accessListAddresses,
+             eth_tx_obj.accessListAddresses == 1 ? "address" : "addresses", eth_tx_obj.accessListKeys,
+             eth_tx_obj.accessListKeys == 1 ? "key" : "keys");
+    pageString(outVal, outValLen, tmp, pageIdx, pageCount);
+    return parser_ok;
+}
+
+// Access list items are each address followed by its storage keys. The entry
+// holding itemIdx is found by walking the list again from the start.
+static parser_error_t printAccessListItem(uint8_t itemIdx, char *outKey, uint16_t outKeyLen, char *outVal,
+                                          uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    access_list_iter_t iter = {0};
+    access_list_entry_t entry = {0};
+    rlp_t accessList = {0};
+    eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.access_list, &accessList);
+    CHECK_ERROR(access_list_iter_init(&iter, &accessList))
+
+    uint16_t remaining = itemIdx;
+    while (true) {
+        CHECK_ERROR(access_list_iter_next(&iter, &entry))
+        if (remaining == 0) {
+            snprintf(outKey, outKeyLen, "Access %d", iter.index);
+            pageHex(outVal, outValLen, "0x", entry.address.ptr, ACCESS_LIST_ADDRESS_LEN, pageIdx, pageCount);
+            return parser_ok;
+        }
+        remaining--;
+        if (remaining < entry.numKeys) {
+            rlp_t key = {0};
+            CHECK_ERROR(access_list_entry_key(&entry, remaining, &key))
+            snprintf(outKey, outKeyLen, "Access %d key %d", iter.index, remaining + 1);
+            pageHex(outVal, outValLen, "0x", key.ptr, ACCESS_LIST_STORAGE_KEY_LEN, pageIdx, pageCount);
+            return parser_ok;
+        }
+        remaining -= entry.numKeys;
+    }
+}
 
+// Three items per tuple: chain id, delegated address and nonce. The tuple is
+// found by walking the authorization list again from the start.
+static parser_error_t printAuthorizationItem(uint8_t itemIdx, char *outKey, uint16_t outKeyLen, char *outVal,
+                                             uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    rlp_t authorizationList = {0};
+    authorization_t authorization = {0};
+    eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.authorization_list, &authorizationList);
+    const uint8_t tupleIdx = itemIdx / ETH_AUTHORIZATION_ITEMS;
+    CHECK_ERROR(authorization_get(&authorizationList, tupleIdx, &authorization))
+
+    switch (itemIdx % ETH_AUTHORIZATION_ITEMS) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Delegation %d chain", tupleIdx + 1);
+            // chain id 0 makes the delegation valid on every chain
+            if (authorization.chainId.rlpLen == 0) {
+                pageString(outVal, outValLen, "Any chain", pageIdx, pageCount);
+                return parser_ok;
+            }
+            return printRLPNumber(&authorization.chainId, outVal, outValLen, pageIdx, pageCount);
+        case 1:
+            snprintf(outKey, outKeyLen, "Delegation %d to", tupleIdx + 1);
+            return printEVMAddress(&authorization.address, outVal, outValLen, pageIdx, pageCount);
         default:
-            return parser_display_page_out_of_range;
+            snprintf(outKey, outKeyLen, "Delegation %d nonce", tupleIdx + 1);
+            return printRLPNumber(&authorization.nonce, outVal, outValLen, pageIdx, pageCount);
     }
+}
 
-    return parser_ok;
+static parser_error_t printNumberField(const rlp_field_t *field, char *outVal, uint16_t outValLen, uint8_t pageIdx,
+                                       uint8_t *pageCount) {
+    rlp_t num = {0};
+    eth_tx_view(&eth_tx_obj, field, &num);
+    return printRLPNumber(&num, outVal, outValLen, pageIdx, pageCount);
 }
 
-static parser_error_t printGeneric(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen,
-                                   char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+static parser_error_t printField(const parser_context_t *ctx, eth_field_e field, char *outKey, uint16_t outKeyLen,
+                                 char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
     if (outKey == NULL || outVal == NULL || pageCount == NULL) {
         return parser_unexpected_error;
     }
@@ -342,116 +500,270 @@ static parser_error_t printGeneric(const parser_context_t *ctx, uint8_t displayI
     MEMZERO(outVal, outValLen);
     *pageCount = 1;
 
-    char data_array[TMP_DATA_ARRAY_SIZE] = {0};
-
-    if ((displayIdx >= 3 && eth_tx_obj.tx.data.rlpLen == 0) || eth_tx_obj.tx.to.rlpLen == 0) {
-        displayIdx += 1;
-    }
-
-    if (eth_tx_obj.tx_type == eip1559 && displayIdx >= 7) {
-        displayIdx++;
-    }
+    rlp_t view = {0};
+    switch (field) {
+        case eth_field_receiver: {
+            snprintf(outKey, outKeyLen, "Receiver");
+            eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.data, &view);
+            view.ptr += ERC20_TRANSFER_OFFSET;
+            view.rlpLen = ETH_ADDRESS_LEN;
+            return printEVMAddress(&view, outVal, outValLen, pageIdx, pageCount);
+        }
 
-    if ((eth_tx_obj.tx_type == legacy || eth_tx_obj.tx_type == eip2930) && displayIdx >= 4) {
-        displayIdx += 2;
-    }
+        case eth_field_contract:
+        case eth_field_to: {
+            snprintf(outKey, outKeyLen, field == eth_field_contract ? "Contract" : "To");
+            eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.to, &view);
+            return printEVMAddress(&view, outVal, outValLen, pageIdx, pageCount);
+        }
 
-    switch (displayIdx) {
-        case 0:
-            snprintf(outKey, outKeyLen, "To");
-            rlp_t contractAddress = {.kind = RLP_KIND_STRING, .ptr = eth_tx_obj.tx.to.ptr, .rlpLen = ETH_ADDRESS_LEN};
-            CHECK_ERROR(printEVMAddress(&contractAddress, outVal, outValLen, pageIdx, pageCount));
-            break;
-        case 1:
+        case eth_field_coin_asset:
             snprintf(outKey, outKeyLen, "Coin asset");
             snprintf(outVal, outValLen, "peaq");
-            break;
-        case 2:
+            return parser_ok;
+
+        case eth_field_amount:
+            snprintf(outKey, outKeyLen, "Amount");
+            return printERC20Value(&eth_tx_obj, outVal, outValLen, pageIdx, pageCount);
+
+        case eth_field_value:
             snprintf(outKey, outKeyLen, "Value");
-            printBigIntFixedPoint(eth_tx_obj.tx.value.ptr, eth_tx_obj.tx.value.rlpLen, outVal, outValLen, pageIdx, pageCount,
-                                  COIN_DECIMALS);
-            break;
+            eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.value, &view);
+            return printBigIntFixedPoint(view.ptr, view.rlpLen, outVal, outValLen, pageIdx, pageCount, COIN_DECIMALS);
+
+        case eth_field_value_raw:
+            snprintf(outKey, outKeyLen, "Value");
+            return printNumberField(&eth_tx_obj.tx.value, outVal, outValLen, pageIdx, pageCount);
 
-        case 3:
+        case eth_field_data:
             snprintf(outKey, outKeyLen, "Data");
-            array_to_hexstr(
-                data_array, sizeof(data_array), eth_tx_obj.tx.data.ptr,
-                eth_tx_obj.tx.data.rlpLen > DATA_BYTES_TO_PRINT ? DATA_BYTES_TO_PRINT : eth_tx_obj.tx.data.rlpLen);
+            return printDataPreview(outVal, outValLen, pageIdx, pageCount);
 
-            if (eth_tx_obj.tx.data.rlpLen > DATA_BYTES_TO_PRINT) {
-                snprintf(data_array + (2 * DATA_BYTES_TO_PRINT), 4, "...");
+        case eth_field_data_size: {
+            snprintf(outKey, outKeyLen, "Data size");
+            char tmp[30] = {0};
+            if (uint64_to_str(tmp, sizeof(tmp), eth_tx_obj.dataFullLen) != NULL) {
+                return parser_unexpected_value;
             }
+            if (z_str3join(tmp, sizeof(tmp), NULL, " bytes") != zxerr_ok) {
+                return parser_unexpected_buffer_end;
+            }
+            pageString(outVal, outValLen, tmp, pageIdx, pageCount);
+            return parser_ok;
+        }
 
-            pageString(outVal, outValLen, data_array, pageIdx, pageCount);
-            break;
+        case eth_field_nonce:
+            snprintf(outKey, outKeyLen, "Nonce");
+            return printNumberField(&eth_tx_obj.tx.nonce, outVal, outValLen, pageIdx, pageCount);
 
-        case 4:
+        case eth_field_max_priority_fee:
             snprintf(outKey, outKeyLen, "Max Priority Fee");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.max_priority_fee_per_gas, outVal, outValLen, pageIdx, pageCount));
-            break;
+            return printNumberField(&eth_tx_obj.tx.max_priority_fee_per_gas, outVal, outValLen, pageIdx, pageCount);
 
-        case 5:
+        case eth_field_max_fee:
             snprintf(outKey, outKeyLen, "Max Fee");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.max_fee_per_gas, outVal, outValLen, pageIdx, pageCount));
-            break;
+            return printNumberField(&eth_tx_obj.tx.max_fee_per_gas, outVal, outValLen, pageIdx, pageCount);
 
-        case 6:
+        case eth_field_gas_limit:
             snprintf(outKey, outKeyLen, "Gas limit");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.gasLimit, outVal, outValLen, pageIdx, pageCount));
-            break;
+            return printNumberField(&eth_tx_obj.tx.gasLimit, outVal, outValLen, pageIdx, pageCount);
 
-        case 7:
+        case eth_field_gas_price:
             snprintf(outKey, outKeyLen, "Gas price");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.gasPrice, outVal, outValLen, pageIdx, pageCount));
-            break;
+            return printNumberField(&eth_tx_obj.tx.gasPrice, outVal, outValLen, pageIdx, pageCount);
 
-        case 8:
-            snprintf(outKey, outKeyLen, "Nonce");
-            CHECK_ERROR(printRLPNumber(&eth_tx_obj.tx.nonce, outVal, outValLen, pageIdx, pageCount));
-            break;
+        case eth_field_access_list:
+            snprintf(outKey, outKeyLen, "Access list");
+            return printAccessListSummary(outVal, outValLen, pageIdx, pageCount);
 
-        case 9:
-            CHECK_ERROR(printEthHash(ctx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount));
-            break;
+        case eth_field_authorization_list: {
+            snprintf(outKey, outKeyLen, "Delegations");
+            char tmp[10] = {0};
+            snprintf(tmp, sizeof(tmp), "%d", eth_tx_obj.authorizations);
+            pageString(outVal, outValLen, tmp, pageIdx, pageCount);
+            return parser_ok;
+        }
+
+        case eth_field_hash:
+            return printEthHash(ctx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+
+        case eth_field_method: {
+            const abi_method_t *method = abi_get_method(eth_tx_obj.abiMethod);
+            if (method == NULL) {
+                return parser_unexpected_value;
+            }
+            snprintf(outKey, outKeyLen, "Method");
+            pageString(outVal, outValLen, method->name, pageIdx, pageCount);
+            return parser_ok;
+        }
 
         default:
-            return parser_display_page_out_of_range;
+            if (field >= eth_field_abi_arg && field <= eth_field_abi_arg_last) {
+                return abi_print_arg(&eth_tx_obj, eth_tx_obj.abiMethod, (uint8_t)(field - eth_field_abi_arg), outKey,
+                                     outKeyLen, outVal, outValLen, pageIdx, pageCount);
+            }
+            break;
     }
 
-    return parser_ok;
+    return parser_display_page_out_of_range;
+}
+
+static void addField(eth_tx_t *tx_obj, eth_field_e field) {
+    if (tx_obj->numFields < ETH_MAX_DISPLAY_FIELDS) {
+        tx_obj->fields[tx_obj->numFields++] = (uint8_t)field;
+    }
+}
+
+static void addFeeFields(eth_tx_t *tx_obj) {
+    const eth_tx_schema_t *schema = eth_tx_schema(tx_obj->tx_type);
+    if (schema == NULL) {
+        return;
+    }
+    for (uint8_t i = 0; i < schema->numFees; i++) {
+        addField(tx_obj, (eth_field_e)schema->fees[i]);
+    }
+}
+
+// the tuples of a full authorization list must leave room for the access list items
+_Static_assert(ETH_MAX_AUTHORIZATIONS * ETH_AUTHORIZATION_ITEMS < ETH_MAX_ACCESS_LIST_ITEMS,
+               "authorization items exceed the review budget");
+
+// Summary first, then the addresses and storage keys right after it
+static void addAccessListFields(eth_tx_t *tx_obj) {
+    if (tx_obj->accessListAddresses == 0) {
+        return;
+    }
+    addField(tx_obj, eth_field_access_list);
+
+    const uint32_t items = (uint32_t)tx_obj->accessListAddresses + tx_obj->accessListKeys;
+    const uint32_t delegationItems = (uint32_t)tx_obj->authorizations * ETH_AUTHORIZATION_ITEMS;
+    if (items + delegationItems > ETH_MAX_ACCESS_LIST_ITEMS) {
+        tx_obj->accessListHidden = true;
+        return;
+    }
+    tx_obj->accessListFirstItem = tx_obj->numFields;
+    tx_obj->accessListItems = (uint8_t)items;
+}
+
+// Summary first, then every tuple; always after the access list items
+static void addAuthorizationFields(eth_tx_t *tx_obj) {
+    if (tx_obj->authorizations == 0) {
+        return;
+    }
+    addField(tx_obj, eth_field_authorization_list);
+    tx_obj->authorizationFirstItem = tx_obj->numFields;
+    tx_obj->authorizationItems = (uint8_t)(tx_obj->authorizations * ETH_AUTHORIZATION_ITEMS);
+}
+
+// Builds the ordered list of review items once per parsed transaction
+void _buildDisplayFieldsEth(eth_tx_t *tx_obj) {
+    tx_obj->numFields = 0;
+    tx_obj->accessListFirstItem = 0;
+    tx_obj->accessListItems = 0;
+    tx_obj->accessListHidden = false;
+    tx_obj->authorizationFirstItem = 0;
+    tx_obj->authorizationItems = 0;
+    tx_obj->abiMethod = ABI_NO_METHOD;
+
+    // Clear signing is available for ERC20 transfers and the calls of the ABI table
+    if (tx_obj->dataTruncated) {
+        tx_obj->is_erc20_transfer = false;
+    } else if (validateERC20(tx_obj)) {
+        addField(tx_obj, eth_field_receiver);
+        addField(tx_obj, eth_field_contract);
+        addField(tx_obj, eth_field_coin_asset);
+        addField(tx_obj, eth_field_amount);
+        addField(tx_obj, eth_field_nonce);
+        addFeeFields(tx_obj);
+        addField(tx_obj, eth_field_value_raw);
+        addField(tx_obj, eth_field_data);
+        addAccessListFields(tx_obj);
+        addAuthorizationFields(tx_obj);
+        addField(tx_obj, eth_field_hash);
+        return;
+    }
+
+    if (!tx_obj->dataTruncated) {
+        rlp_t to = {0};
+        rlp_t data = {0};
+        eth_tx_view(tx_obj, &tx_obj->tx.to, &to);
+        eth_tx_view(tx_obj, &tx_obj->tx.data, &data);
+        tx_obj->abiMethod = abi_decode(&to, &data);
+    }
+    const abi_method_t *method = abi_get_method(tx_obj->abiMethod);
+    if (method != NULL) {
+        addField(tx_obj, eth_field_contract);
+        addField(tx_obj, eth_field_method);
+        for (uint8_t i = 0; i < method->numArgs; i++) {
+            addField(tx_obj, (eth_field_e)(eth_field_abi_arg + i));
+        }
+        addField(tx_obj, eth_field_coin_asset);
+        addField(tx_obj, eth_field_value);
+        addFeeFields(tx_obj);
+        addField(tx_obj, eth_field_nonce);
+        addAccessListFields(tx_obj);
+        addAuthorizationFields(tx_obj);
+        addField(tx_obj, eth_field_hash);
+        return;
+    }
+
+    if (tx_obj->tx.to.valueLen != 0) {
+        addField(tx_obj, eth_field_to);
+    }
+    addField(tx_obj, eth_field_coin_asset);
+    addField(tx_obj, eth_field_value);
+    if (tx_obj->tx.data.valueLen != 0) {
+        addField(tx_obj, eth_field_data);
+    }
+    if (tx_obj->dataTruncated) {
+        addField(tx_obj, eth_field_data_size);
+    }
+    addFeeFields(tx_obj);
+    addField(tx_obj, eth_field_nonce);
+    addAccessListFields(tx_obj);
+    addAuthorizationFields(tx_obj);
+    // the generic review of EIP-1559 transactions has never listed the hash
+    if (tx_obj->tx_type != eip1559) {
+        addField(tx_obj, eth_field_hash);
+    }
 }
 
 parser_error_t _getItemEth(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal,
                            uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
-    // At the moment, clear signing is available only for ERC20 transfer
-    if (eth_tx_obj.is_erc20_transfer) {
-        return printERC20Transfer(ctx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    if (!_isClearSignableEth() && !app_mode_blindsign()) {
+        return parser_blindsign_mode_required;
     }
-    if (app_mode_blindsign()) {
-        return printGeneric(ctx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    // access list and then authorization items sit between the fields of the table
+    uint8_t fieldIdx = displayIdx;
+    if (eth_tx_obj.accessListItems > 0 && fieldIdx >= eth_tx_obj.accessListFirstItem) {
+        const uint8_t itemIdx = fieldIdx - eth_tx_obj.accessListFirstItem;
+        if (itemIdx < eth_tx_obj.accessListItems) {
+            return printAccessListItem(itemIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+        }
+        fieldIdx -= eth_tx_obj.accessListItems;
+    }
+    if (eth_tx_obj.authorizationItems > 0 && fieldIdx >= eth_tx_obj.authorizationFirstItem) {
+        const uint8_t itemIdx = fieldIdx - eth_tx_obj.authorizationFirstItem;
+        if (itemIdx < eth_tx_obj.authorizationItems) {
+            return printAuthorizationItem(itemIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+        }
+        fieldIdx -= eth_tx_obj.authorizationItems;
+    }
+    if (fieldIdx >= eth_tx_obj.numFields) {
+        return parser_display_idx_out_of_range;
     }
 
-    return parser_blindsign_mode_required;
+    return printField(ctx, (eth_field_e)eth_tx_obj.fields[fieldIdx], outKey, outKeyLen, outVal, outValLen, pageIdx,
+                      pageCount);
 }
 
 // returns the number of items to display on the screen.
-// Note: we might need to add a transaction state object,
-// Defined with one parameter for now.
+// The list of items is built once when the transaction is parsed.
 parser_error_t _getNumItemsEth(uint8_t *numItems) {
     if (numItems == NULL) {
         return parser_unexpected_error;
     }
-    // Verify that tx is ERC20
-    if (validateERC20(&eth_tx_obj)) {
-        if (eth_tx_obj.tx_type == legacy || eth_tx_obj.tx_type == eip2930) {
-            *numItems = 10;
-        } else {
-            *numItems = 11;
-        }
-        return parser_ok;
-    }
-
-    *numItems = 6 + ((eth_tx_obj.tx.data.rlpLen != 0) ? 1 : 0) + ((eth_tx_obj.tx.to.rlpLen != 0) ? 1 : 0);
+    *numItems = eth_tx_obj.numFields + eth_tx_obj.accessListItems + eth_tx_obj.authorizationItems;
     return parser_ok;
 }
 
@@ -463,13 +775,13 @@ parser_error_t _computeV(parser_context_t *ctx, eth_tx_t *tx_obj, unsigned int i
     uint8_t type = eth_tx_obj.tx_type;
     uint8_t parity = (info & CX_ECCINFO_PARITY_ODD) == 1;
 
-    if (type == eip2930 || type == eip1559) {
+    if (type == eip2930 || type == eip1559 || type == eip7702) {
         *v = parity;
         return parser_ok;
     }
 
     // we need chainID info
-    if (tx_obj->chainId.rlpLen == 0) {
+    if (tx_obj->chainId.valueLen == 0) {
         // according to app-ethereum this is the legacy non eip155 conformant
         // so V should be made before EIP155 which had
         // 27 + {0, 1}
@@ -481,7 +793,9 @@ parser_error_t _computeV(parser_context_t *ctx, eth_tx_t *tx_obj, unsigned int i
 
     } else {
         uint64_t id = 0;
-        CHECK_ERROR(be_bytes_to_u64(tx_obj->chainId.ptr, tx_obj->chainId.rlpLen, &id));
+        rlp_t chainId = {0};
+        eth_tx_view(tx_obj, &tx_obj->chainId, &chainId);
+        CHECK_ERROR(be_bytes_to_u64(chainId.ptr, chainId.rlpLen, &id));
 
         uint32_t cv = 35 + parity;
         cv = saturating_add_u32(cv, (uint32_t)id * 2);
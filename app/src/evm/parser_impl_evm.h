@@ -19,31 +19,41 @@
 extern "C" {
 #endif
 
+#include "crypto_helper.h"
 #include "parser_common.h"
 #include "rlp.h"
 
 #define ETH_ADDRESS_LEN 20
+
+// chain ids accepted by the parser
+#define SUPPORTED_NETWORKS_EVM_LEN 3
+extern const uint64_t supported_networks_evm[SUPPORTED_NETWORKS_EVM_LEN];
+
 typedef struct {
     uint8_t addr[ETH_ADDRESS_LEN];
 } eth_addr_t;
 
+// Fields are kept as offsets into the transaction buffer, see eth_tx_view
 typedef struct {
     // Commom fields
-    rlp_t nonce;
-    rlp_t gasLimit;
-    rlp_t to;
-    rlp_t value;
-    rlp_t data;
+    rlp_field_t nonce;
+    rlp_field_t gasLimit;
+    rlp_field_t to;
+    rlp_field_t value;
+    rlp_field_t data;
 
     // legacy & eip2930
-    rlp_t gasPrice;
+    rlp_field_t gasPrice;
 
     // eip1559
-    rlp_t max_priority_fee_per_gas;
-    rlp_t max_fee_per_gas;
+    rlp_field_t max_priority_fee_per_gas;
+    rlp_field_t max_fee_per_gas;
+
+    // eip2930, eip1559 & eip7702
+    rlp_field_t access_list;
 
-    // eip2930 & eip1559
-    rlp_t access_list;
+    // eip7702
+    rlp_field_t authorization_list;
 } eth_base_t;
 
 // EIP 2718 TransactionType
@@ -51,32 +61,149 @@ typedef struct {
 typedef enum {
     eip2930 = 0x01,
     eip1559 = 0x02,
+    // set-code transaction, EIP-1559 fields plus an authorization list
+    eip7702 = 0x04,
     // Legacy tx type is greater than or equal to 0xc0.
     legacy = 0xc0
 } eth_tx_type_e;
 
+#define ETH_MAX_ABI_ARGS 4
+
+// Review items, resolved once per transaction into eth_tx_t.fields
+typedef enum {
+    eth_field_receiver = 0,
+    eth_field_contract,
+    eth_field_to,
+    eth_field_coin_asset,
+    eth_field_amount,
+    eth_field_value,
+    eth_field_value_raw,
+    eth_field_data,
+    eth_field_data_size,
+    eth_field_nonce,
+    eth_field_max_priority_fee,
+    eth_field_max_fee,
+    eth_field_gas_limit,
+    eth_field_gas_price,
+    eth_field_access_list,
+    eth_field_authorization_list,
+    eth_field_hash,
+    eth_field_method,
+    // one id per decoded calldata argument
+    eth_field_abi_arg,
+    eth_field_abi_arg_last = eth_field_abi_arg + ETH_MAX_ABI_ARGS - 1,
+} eth_field_e;
+
+#define ETH_MAX_DISPLAY_FIELDS 16
+// access list addresses and storage keys listed one per review item;
+// longer lists are only summarized and need blind signing
+#define ETH_MAX_ACCESS_LIST_ITEMS 200
+// delegations are always listed, chain id, address and nonce each; they take
+// from the access list budget, and longer authorization lists are rejected
+#define ETH_MAX_AUTHORIZATIONS  16
+#define ETH_AUTHORIZATION_ITEMS 3
+
 typedef struct {
     eth_tx_type_e tx_type;
-    rlp_t chainId;
+    // transaction the field descriptors are relative to
+    const uint8_t *buffer;
+    rlp_field_t chainId;
     eth_base_t tx;
     bool is_erc20_transfer;
+    // entry of the ABI selector table the calldata was decoded with
+    uint8_t abiMethod;
+    // keccak256 of the serialized transaction, filled once after parsing
+    uint8_t digest[KECCAK_256_SIZE];
+
+    // streamed transactions keep only a prefix of the calldata
+    bool dataTruncated;
+    uint64_t dataFullLen;
+
+    // display table: field id per review item
+    uint8_t fields[ETH_MAX_DISPLAY_FIELDS];
+    uint8_t numFields;
+
+    // access list entries are read back from the buffer when displayed
+    uint16_t accessListAddresses;
+    uint16_t accessListKeys;
+    uint8_t accessListFirstItem;
+    uint8_t accessListItems;
+    bool accessListHidden;
+
+    // authorization tuples are read back from the buffer when displayed
+    uint16_t authorizations;
+    uint8_t authorizationFirstItem;
+    uint8_t authorizationItems;
 
 } eth_tx_t;
 
-extern eth_tx_t eth_tx_obj;
+// How one item of the transaction list is decoded
+typedef enum {
+    // kept as an offset, see eth_tx_view
+    eth_decode_field = 0,
+    // checked against the supported networks
+    eth_decode_chain_id,
+    // a uint256 amount, at most 32 bytes long
+    eth_decode_amount,
+    // counted so that the review can list it
+    eth_decode_access_list,
+    // counted and bounded, every tuple is listed in the review
+    eth_decode_authorization_list,
+    // legacy tail: nothing, or an EIP-155 chain id followed by empty r and s
+    eth_decode_eip155,
+} eth_decoder_e;
+
+typedef struct {
+    // rlp_field_t of eth_tx_t the item is read into
+    uint16_t offset;
+    uint8_t decoder;
+} eth_schema_item_t;
+
+#define ETH_SCHEMA_MAX_ITEMS 10
+#define ETH_SCHEMA_MAX_FEES  3
+
+// Layout of one transaction type. The decoder, the upload precheck, the stream
+// decoder and the review all walk the same table.
+typedef struct {
+    uint8_t type;
+    uint8_t numItems;
+    eth_schema_item_t items[ETH_SCHEMA_MAX_ITEMS];
+    // fee review items, in display order
+    uint8_t numFees;
+    uint8_t fees[ETH_SCHEMA_MAX_FEES];
+} eth_tx_schema_t;
+
+/// \return the layout of an EIP-2718 type, or of legacy transactions; NULL if unsupported
+const eth_tx_schema_t *eth_tx_schema(uint8_t type);
+
+/// \return position in the list of the item read into the eth_tx_t field at offset,
+/// or the number of items if the type has no such field
+uint8_t eth_tx_schema_index(const eth_tx_schema_t *schema, uint16_t offset);
 
-parser_error_t _readEth(parser_context_t *ctx, eth_tx_t *eth_tx_obj);
+parser_error_t _readEth(parser_context_t *ctx, eth_tx_t *tx_obj);
+
+// pointer view of one of the fields of a parsed transaction
+void eth_tx_view(const eth_tx_t *tx_obj, const rlp_field_t *field, rlp_t *view);
 
 parser_error_t _getItemEth(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal,
                            uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount);
 
 // returns the number of items to display on the screen.
-// Note: we might need to add a transaction state object,
-// Defined with one parameter for now.
 parser_error_t _getNumItemsEth(uint8_t *numItems);
 
 parser_error_t _validateTxEth();
 
+// true for transactions fully shown without blind signing:
+// token transfers and calls decoded with the ABI selector table
+bool _isClearSignableEth(void);
+
+// Checks the envelope and leading fields available in a partial upload.
+// Fields that are not complete yet are left to the full parser.
+parser_error_t _precheckEth(parser_context_t *ctx, uint64_t maxTxLen);
+
+// (re)builds the review item table of the parsed transaction
+void _buildDisplayFieldsEth(eth_tx_t *tx_obj);
+
 parser_error_t _computeV(parser_context_t *ctx, eth_tx_t *tx_obj, unsigned int info, uint8_t *v);
 
 #ifdef __cplusplus
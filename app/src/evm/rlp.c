@@ -18,104 +18,105 @@
 #include "zxformat.h"
 #include "zxmacros.h"
 
-parser_error_t rlp_parseStream(parser_context_t *ctx, rlp_t *rlp, uint16_t *fields, uint16_t maxFields) {
-    if (ctx == NULL || rlp == NULL || fields == NULL) {
+parser_error_t rlp_parseStream(parser_context_t *ctx, rlp_field_t *fields, uint16_t *numFields, uint16_t maxFields) {
+    if (ctx == NULL || fields == NULL || numFields == NULL) {
         return parser_unexpected_error;
     }
-    *fields = 0;
-    while (ctx->offset < ctx->bufferLen && (*fields) < maxFields) {
-        CHECK_ERROR(rlp_read(ctx, rlp))
-        (*fields)++;
-        rlp++;
+    *numFields = 0;
+    while (ctx->offset < ctx->bufferLen && (*numFields) < maxFields) {
+        CHECK_ERROR(rlp_readField(ctx, fields))
+        (*numFields)++;
+        fields++;
     }
 
     return parser_ok;
 }
 
-static parser_error_t readBytes(parser_context_t *ctx, uint8_t const **buff, uint64_t buffLen) {
-    if (ctx->bufferLen - ctx->offset < buffLen) {
+static parser_error_t readLength(parser_context_t *ctx, uint8_t bytesLen, uint64_t *len) {
+    if (ctx->bufferLen - ctx->offset < bytesLen) {
         return parser_unexpected_buffer_end;
     }
-    *buff = ctx->buffer + ctx->offset;
-    ctx->offset += buffLen;
+    *len = 0;
+    for (uint8_t i = 0; i < bytesLen; i++) {
+        if (*len > (UINT64_MAX >> 8)) {
+            return parser_value_out_of_range;
+        }
+        *len = (*len << 8U) | ctx->buffer[ctx->offset + i];
+    }
+    ctx->offset += bytesLen;
     return parser_ok;
 }
 
-parser_error_t rlp_read(parser_context_t *ctx, rlp_t *rlp) {
-    if (ctx == NULL || rlp == NULL) {
+parser_error_t rlp_readField(parser_context_t *ctx, rlp_field_t *field) {
+    if (ctx == NULL || field == NULL) {
         return parser_unexpected_error;
     }
+    if (ctx->offset >= ctx->bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
 
-    const uint8_t *prefixPtr = NULL;
-    CHECK_ERROR(readBytes(ctx, &prefixPtr, 1))
-    const uint8_t prefix = *prefixPtr;
+    field->fieldOffset = ctx->offset;
+    const uint8_t prefix = ctx->buffer[ctx->offset++];
+    uint64_t len = 0;
 
     if (prefix <= RLP_KIND_BYTE_PREFIX) {
-        rlp->kind = RLP_KIND_BYTE;
-        rlp->ptr = prefixPtr;
-        rlp->rlpLen = 1;
-
-    } else if (prefix <= RLP_KIND_STRING_SHORT_MAX) {
-        rlp->kind = RLP_KIND_STRING;
-        rlp->rlpLen = prefix - RLP_KIND_STRING_SHORT_MIN;
-        if (rlp->rlpLen == 0) {
-            rlp->ptr = prefixPtr;
-        } else {
-            CHECK_ERROR(readBytes(ctx, &rlp->ptr, rlp->rlpLen))
-        }
+        // the byte is its own encoding
+        field->kind = RLP_KIND_BYTE;
+        field->valueOffset = field->fieldOffset;
+        field->valueLen = 1;
+        return parser_ok;
+    }
 
+    if (prefix <= RLP_KIND_STRING_SHORT_MAX) {
+        field->kind = RLP_KIND_STRING;
+        len = prefix - RLP_KIND_STRING_SHORT_MIN;
     } else if (prefix <= RLP_KIND_STRING_LONG_MAX) {
-        rlp->kind = RLP_KIND_STRING;
-        const uint8_t bytesLen = prefix - RLP_KIND_STRING_SHORT_MAX;
-        const uint8_t *rlpLenPtr = NULL;
-        CHECK_ERROR(readBytes(ctx, &rlpLenPtr, bytesLen))
-        rlp->rlpLen = 0;
-        for (uint8_t i = 0; i < bytesLen; i++) {
-            if (rlp->rlpLen > (UINT64_MAX >> 8)) {
-                return parser_value_out_of_range;
-            }
-            rlp->rlpLen <<= 8U;
-            if (rlp->rlpLen > UINT64_MAX - *(rlpLenPtr + i)) {
-                return parser_value_out_of_range;
-            }
-            rlp->rlpLen += *(rlpLenPtr + i);
-        }
-        CHECK_ERROR(readBytes(ctx, &rlp->ptr, rlp->rlpLen))
-
+        field->kind = RLP_KIND_STRING;
+        CHECK_ERROR(readLength(ctx, prefix - RLP_KIND_STRING_SHORT_MAX, &len))
     } else if (prefix <= RLP_KIND_LIST_SHORT_MAX) {
-        rlp->kind = RLP_KIND_LIST;
-        rlp->rlpLen = prefix - RLP_KIND_LIST_SHORT_MIN;
-        CHECK_ERROR(readBytes(ctx, &rlp->ptr, rlp->rlpLen))
-
+        field->kind = RLP_KIND_LIST;
+        len = prefix - RLP_KIND_LIST_SHORT_MIN;
     } else {
-        rlp->kind = RLP_KIND_LIST;
-        const uint8_t bytesLen = prefix - RLP_KIND_LIST_SHORT_MAX;
-        const uint8_t *rlpLenPtr = NULL;
-        CHECK_ERROR(readBytes(ctx, &rlpLenPtr, bytesLen))
-        rlp->rlpLen = 0;
-        for (uint8_t i = 0; i < bytesLen; i++) {
-            if (rlp->rlpLen > (UINT64_MAX >> 8)) {
-                return parser_value_out_of_range;
-            }
-            rlp->rlpLen <<= 8U;
-            if (rlp->rlpLen > UINT64_MAX - *(rlpLenPtr + i)) {
-                return parser_value_out_of_range;
-            }
-            rlp->rlpLen += *(rlpLenPtr + i);
-        }
-        CHECK_ERROR(readBytes(ctx, &rlp->ptr, rlp->rlpLen))
+        field->kind = RLP_KIND_LIST;
+        CHECK_ERROR(readLength(ctx, prefix - RLP_KIND_LIST_SHORT_MAX, &len))
     }
 
+    // the payload must be in the buffer, which also keeps it within 16 bits
+    if (ctx->bufferLen - ctx->offset < len) {
+        return parser_unexpected_buffer_end;
+    }
+    field->valueOffset = ctx->offset;
+    field->valueLen = (uint16_t)len;
+    ctx->offset += (uint16_t)len;
     return parser_ok;
 }
 
-parser_error_t rlp_readList(const rlp_t *list, rlp_t *fields, uint16_t *listFields, uint16_t maxFields) {
-    if (list == NULL || list->kind != RLP_KIND_LIST || fields == NULL || listFields == NULL) {
+void rlp_fieldView(const uint8_t *base, const rlp_field_t *field, rlp_t *rlp) {
+    rlp->kind = (rlp_kind_e)field->kind;
+    rlp->ptr = base + field->valueOffset;
+    rlp->rlpLen = field->valueLen;
+}
+
+parser_error_t rlp_read(parser_context_t *ctx, rlp_t *rlp) {
+    if (ctx == NULL || rlp == NULL) {
         return parser_unexpected_error;
     }
+    rlp_field_t field = {0};
+    CHECK_ERROR(rlp_readField(ctx, &field))
+    rlp_fieldView(ctx->buffer, &field, rlp);
+    return parser_ok;
+}
+
+parser_error_t rlp_readList(const rlp_t *list, rlp_field_t *fields, uint16_t *numFields, uint16_t maxFields) {
+    if (list == NULL || list->kind != RLP_KIND_LIST || fields == NULL || numFields == NULL) {
+        return parser_unexpected_error;
+    }
+    if (list->rlpLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
 
-    parser_context_t ctx = {.buffer = list->ptr, .bufferLen = list->rlpLen, .offset = 0};
-    return rlp_parseStream(&ctx, fields, listFields, maxFields);
+    parser_context_t ctx = {.buffer = list->ptr, .bufferLen = (uint16_t)list->rlpLen, .offset = 0};
+    return rlp_parseStream(&ctx, fields, numFields, maxFields);
 }
 
 parser_error_t rlp_readUInt256(const rlp_t *rlp, uint256_t *value) {
@@ -123,24 +124,17 @@ parser_error_t rlp_readUInt256(const rlp_t *rlp, uint256_t *value) {
         return parser_unexpected_error;
     }
 
-    uint8_t tmpBuffer[32] = {0};
     switch (rlp->kind) {
         case RLP_KIND_STRING:
-            if (rlp->rlpLen > sizeof(tmpBuffer)) {
+            if (rlp->rlpLen > UINT256_BYTES) {
                 return parser_value_out_of_range;
             }
-            MEMCPY(tmpBuffer + (sizeof(tmpBuffer) - rlp->rlpLen), rlp->ptr, rlp->rlpLen);
-            break;
+            return readu256BEBytes(rlp->ptr, (uint16_t)rlp->rlpLen, value);
 
         case RLP_KIND_BYTE:
-            tmpBuffer[31] = *rlp->ptr;
-            break;
+            return readu256BEBytes(rlp->ptr, 1, value);
 
         default:
             return parser_unexpected_type;
     }
-
-    parser_context_t ctx = {.buffer = tmpBuffer, .bufferLen = sizeof(tmpBuffer), .offset = 0};
-    CHECK_ERROR(readu256BE(&ctx, value));
-    return parser_ok;
 }
@@ -25,9 +25,15 @@ extern "C" {
 #include "rlp_def.h"
 #include "uint256.h"
 
-parser_error_t rlp_parseStream(parser_context_t *ctx, rlp_t *rlp, uint16_t *fields, uint16_t maxFields);
+/// Decodes the item at ctx->offset into a descriptor relative to ctx->buffer
+parser_error_t rlp_readField(parser_context_t *ctx, rlp_field_t *field);
+/// Resolves a descriptor against the buffer it was read from
+void rlp_fieldView(const uint8_t *base, const rlp_field_t *field, rlp_t *rlp);
+
+parser_error_t rlp_parseStream(parser_context_t *ctx, rlp_field_t *fields, uint16_t *numFields, uint16_t maxFields);
 parser_error_t rlp_read(parser_context_t *ctx, rlp_t *rlp);
-parser_error_t rlp_readList(const rlp_t *list, rlp_t *fields, uint16_t *listFields, uint16_t maxFields);
+/// Descriptors of the items of list, relative to list->ptr
+parser_error_t rlp_readList(const rlp_t *list, rlp_field_t *fields, uint16_t *numFields, uint16_t maxFields);
 parser_error_t rlp_readUInt256(const rlp_t *rlp, uint256_t *value);
 
 parser_error_t rlpNumberToString(rlp_t *num, char *symbol, uint8_t decimals, char *outVal, uint16_t outValLen,
@@ -43,6 +43,8 @@ typedef enum {
 #define RLP_KIND_LIST_LONG_MIN    0xF8
 #define RLP_KIND_LIST_LONG_MAX    0xFF
 
+// Compact descriptor of an item, as offsets into the buffer it was read from.
+// This is what parsed transactions keep; rlp_t is the pointer view of one item.
 typedef struct {
     uint8_t kind;
     uint16_t fieldOffset;
@@ -20,14 +20,55 @@
 
 #include "apdu_codes.h"
 #include "buffering.h"
+#include "crypto_helper.h"
+#include "crypto_evm.h"
+#include "evm_batch.h"
+#include "evm_policy.h"
+#include "evm_profile.h"
 #include "parser_evm.h"
+#include "session.h"
 #include "tx.h"
 #include "zxmacros.h"
 
-static parser_context_t ctx_parsed_tx;
+#define ctx_parsed_tx (session_arena.views.evm.ctx)
+
+// digest accumulated by the chunk handler while the transaction was uploaded
+static uint8_t upload_digest[KECCAK_256_SIZE];
+static bool upload_digest_valid = false;
+// full calldata length when the upload was streamed
+static uint64_t upload_data_len = 0;
+static bool upload_streamed = false;
+
+void tx_set_digest_eth(const uint8_t *digest) {
+    MEMCPY(upload_digest, digest, sizeof(upload_digest));
+    upload_digest_valid = true;
+}
+
+void tx_set_streamed_eth(uint64_t fullDataLen) {
+    upload_data_len = fullDataLen;
+    upload_streamed = true;
+}
+
+void tx_reset_upload_eth(void) {
+    MEMZERO(upload_digest, sizeof(upload_digest));
+    upload_digest_valid = false;
+    upload_data_len = 0;
+    upload_streamed = false;
+}
+
+const uint8_t *tx_get_digest_eth(void) {
+    return parser_get_digest_eth();
+}
+
+bool tx_policy_match_eth(void) {
+    return eth_policy_match(&eth_tx_obj, hdPathEth, (uint8_t)hdPathEth_len);
+}
 
 const char *tx_parse_eth(uint8_t *error_code) {
+    session_claim(session_flow_evm);
+    PROFILE_BEGIN(profile_phase_parse);
     uint8_t err = parser_parse_eth(&ctx_parsed_tx, tx_get_buffer(), tx_get_buffer_length());
+    PROFILE_END(profile_phase_parse);
 
     CHECK_APP_CANARY()
 
@@ -35,7 +76,32 @@ const char *tx_parse_eth(uint8_t *error_code) {
         return parser_getErrorDescription(err);
     }
 
+    if (upload_streamed) {
+        err = parser_set_truncated_data_eth(upload_data_len);
+        if (err != parser_ok) {
+            return parser_getErrorDescription(err);
+        }
+    }
+
+    // fill the digest slot once; display and signing read it from there
+    PROFILE_BEGIN(profile_phase_digest);
+    if (upload_digest_valid) {
+        err = parser_set_digest_eth(upload_digest);
+    } else if (!upload_streamed) {
+        PROFILE_COUNT_HASH(tx_get_buffer_length());
+        err = parser_compute_digest_eth(&ctx_parsed_tx);
+    } else {
+        // the stored buffer is not the signed payload
+        err = parser_unexpected_error;
+    }
+    PROFILE_END(profile_phase_digest);
+    if (err != parser_ok) {
+        return parser_getErrorDescription(err);
+    }
+
+    PROFILE_BEGIN(profile_phase_validate);
     err = parser_validate_eth(&ctx_parsed_tx);
+    PROFILE_END(profile_phase_validate);
     CHECK_APP_CANARY()
     *error_code = err;
     if (err != parser_ok) {
@@ -45,6 +111,15 @@ const char *tx_parse_eth(uint8_t *error_code) {
     return NULL;
 }
 
+const char *tx_precheck_eth(const uint8_t *data, uint32_t dataLen, uint8_t *error_code) {
+    const parser_error_t err = parser_precheck_eth(data, dataLen, tx_get_buffer_capacity());
+    *error_code = err;
+    if (err != parser_ok) {
+        return parser_getErrorDescription(err);
+    }
+    return NULL;
+}
+
 zxerr_t tx_compute_eth_v(unsigned int info, uint8_t *v) {
     parser_error_t err = parser_compute_eth_v(&ctx_parsed_tx, info, v);
 
@@ -77,6 +152,7 @@ zxerr_t tx_getItemEth(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char
 
     parser_error_t err =
         parser_getItemEth(&ctx_parsed_tx, displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    PROFILE_COUNT_ITEM();
 
     // Convert error codes
     if (err == parser_no_data || err == parser_display_idx_out_of_range || err == parser_display_page_out_of_range) {
@@ -89,3 +165,74 @@ zxerr_t tx_getItemEth(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char
 
     return zxerr_ok;
 }
+
+// set once the batch review is approved; signatures are produced on request
+static bool batch_approved = false;
+
+const char *tx_parse_batch_eth(uint8_t *error_code) {
+    batch_approved = false;
+    session_claim(session_flow_evm);
+    PROFILE_BEGIN(profile_phase_parse);
+    const parser_error_t err = eth_batch_parse(tx_get_buffer(), tx_get_buffer_length());
+    PROFILE_END(profile_phase_parse);
+    CHECK_APP_CANARY()
+    *error_code = err;
+    if (err != parser_ok) {
+        return parser_getErrorDescription(err);
+    }
+    return NULL;
+}
+
+zxerr_t tx_getNumItemsBatchEth(uint8_t *num_items) {
+    if (eth_batch_getNumItems(num_items) != parser_ok) {
+        return zxerr_unknown;
+    }
+    return zxerr_ok;
+}
+
+zxerr_t tx_getItemBatchEth(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                           uint8_t pageIdx, uint8_t *pageCount) {
+    uint8_t numItems = 0;
+
+    CHECK_ZXERR(tx_getNumItemsBatchEth(&numItems))
+
+    if (displayIdx < 0 || displayIdx >= numItems) {
+        return zxerr_no_data;
+    }
+
+    parser_error_t err = eth_batch_getItem(displayIdx, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    PROFILE_COUNT_ITEM();
+
+    // Convert error codes
+    if (err == parser_no_data || err == parser_display_idx_out_of_range || err == parser_display_page_out_of_range) {
+        return zxerr_no_data;
+    }
+
+    if (err != parser_ok) {
+        return zxerr_unknown;
+    }
+
+    return zxerr_ok;
+}
+
+uint8_t tx_batch_count_eth(void) {
+    return eth_batch_obj.count;
+}
+
+zxerr_t tx_select_batch_eth(uint8_t idx) {
+    if (eth_batch_select(&ctx_parsed_tx, tx_get_buffer(), tx_get_buffer_length(), idx) != parser_ok) {
+        return zxerr_unknown;
+    }
+    if (parser_compute_digest_eth(&ctx_parsed_tx) != parser_ok) {
+        return zxerr_unknown;
+    }
+    return zxerr_ok;
+}
+
+void tx_set_batch_approved_eth(bool approved) {
+    batch_approved = approved;
+}
+
+bool tx_batch_approved_eth(void) {
+    return batch_approved;
+}
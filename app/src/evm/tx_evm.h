@@ -15,6 +15,8 @@
  ********************************************************************************/
 #pragma once
 
+#include <stdbool.h>
+
 #include "coin.h"
 #include "os.h"
 #include "zxerror.h"
@@ -24,6 +26,10 @@
 /// \return It returns NULL if data is valid or error message otherwise.
 const char *tx_parse_eth(uint8_t *error_code);
 
+/// Checks the first bytes of a transaction so unsupported ones fail before the full upload
+/// \return It returns NULL if nothing is wrong so far or error message otherwise.
+const char *tx_precheck_eth(const uint8_t *data, uint32_t dataLen, uint8_t *error_code);
+
 /// Return the number of items in the transaction
 zxerr_t tx_getNumItemsEth(uint8_t *num_items);
 
@@ -32,3 +38,39 @@ zxerr_t tx_getItemEth(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char
                       uint8_t pageIdx, uint8_t *pageCount);
 
 zxerr_t tx_compute_eth_v(unsigned int info, uint8_t *v);
+
+/// Stores the Keccak-256 digest computed while the transaction chunks arrived
+void tx_set_digest_eth(const uint8_t *digest);
+
+/// Records that the upload was streamed and keeps only a calldata prefix
+void tx_set_streamed_eth(uint64_t fullDataLen);
+
+/// Drops the digest and streaming info of the previous upload
+void tx_reset_upload_eth(void);
+
+/// \return the digest of the parsed transaction
+const uint8_t *tx_get_digest_eth(void);
+
+/// \return true when the parsed transaction is covered by the active signing policy
+bool tx_policy_match_eth(void);
+
+/// Parses the uploaded batch of transactions
+/// \return It returns NULL if data is valid or error message otherwise.
+const char *tx_parse_batch_eth(uint8_t *error_code);
+
+/// Return the number of items in the batch review
+zxerr_t tx_getNumItemsBatchEth(uint8_t *num_items);
+
+/// Gets an specific item from the batch review (including paging)
+zxerr_t tx_getItemBatchEth(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outValue, uint16_t outValueLen,
+                           uint8_t pageIdx, uint8_t *pageCount);
+
+/// \return the number of transactions in the parsed batch
+uint8_t tx_batch_count_eth(void);
+
+/// Makes transaction idx of the batch the current one, so its digest and V can be computed
+zxerr_t tx_select_batch_eth(uint8_t idx);
+
+/// Approval of the batch review; signatures can only be requested while it is set
+void tx_set_batch_approved_eth(bool approved);
+bool tx_batch_approved_eth(void);
@@ -334,104 +334,179 @@ void mul128(uint128_t *number1, uint128_t *number2, uint128_t *target) {
     add128(&tmp, &tmp2, target);
 }
 
-void mul256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
-    uint128_t top[4];
-    uint128_t bottom[4];
-    uint128_t products[4][4];
-    uint128_t tmp;
-    uint128_t tmp2;
-    uint128_t fourth64;
-    uint128_t third64;
-    uint128_t second64;
-    uint128_t first64;
-    uint256_t target1;
-    uint256_t target2;
-    UPPER(top[0]) = 0;
-    LOWER(top[0]) = UPPER(UPPER_P(number1));
-    UPPER(top[1]) = 0;
-    LOWER(top[1]) = LOWER(UPPER_P(number1));
-    UPPER(top[2]) = 0;
-    LOWER(top[2]) = UPPER(LOWER_P(number1));
-    UPPER(top[3]) = 0;
-    LOWER(top[3]) = LOWER(LOWER_P(number1));
-    UPPER(bottom[0]) = 0;
-    LOWER(bottom[0]) = UPPER(UPPER_P(number2));
-    UPPER(bottom[1]) = 0;
-    LOWER(bottom[1]) = LOWER(UPPER_P(number2));
-    UPPER(bottom[2]) = 0;
-    LOWER(bottom[2]) = UPPER(LOWER_P(number2));
-    UPPER(bottom[3]) = 0;
-    LOWER(bottom[3]) = LOWER(LOWER_P(number2));
+// 32-bit limbs, least significant first: products and quotients map to UMULL
+// and native 64/32 divisions on Cortex-M
+void limbs256_from_u256(const uint256_t *number, uint256_limbs_t *target) {
+    const uint64_t words[4] = {LOWER(LOWER_P(number)), UPPER(LOWER_P(number)), LOWER(UPPER_P(number)),
+                               UPPER(UPPER_P(number))};
+    for (uint8_t i = 0; i < 4; i++) {
+        target->limbs[2 * i] = (uint32_t)words[i];
+        target->limbs[2 * i + 1] = (uint32_t)(words[i] >> 32);
+    }
+}
 
-    for (int y = 3; y > -1; y--) {
-        for (int x = 3; x > -1; x--) {
-            mul128(&top[x], &bottom[y], &products[3 - x][y]);
+void limbs256_to_u256(const uint256_limbs_t *number, uint256_t *target) {
+    uint64_t words[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        words[i] = ((uint64_t)number->limbs[2 * i + 1] << 32) | number->limbs[2 * i];
+    }
+    LOWER(LOWER_P(target)) = words[0];
+    UPPER(LOWER_P(target)) = words[1];
+    LOWER(UPPER_P(target)) = words[2];
+    UPPER(UPPER_P(target)) = words[3];
+}
+
+parser_error_t limbs256_from_be(const uint8_t *bytes, uint16_t len, uint256_limbs_t *target) {
+    if (target == NULL || (bytes == NULL && len > 0)) {
+        return parser_unexpected_error;
+    }
+    if (len > UINT256_BYTES) {
+        return parser_value_out_of_range;
+    }
+    MEMZERO(target, sizeof(*target));
+    for (uint16_t i = 0; i < len; i++) {
+        const uint16_t pos = len - 1 - i;
+        target->limbs[pos / 4] |= (uint32_t)bytes[i] << (8 * (pos % 4));
+    }
+    return parser_ok;
+}
+
+parser_error_t readu256BEBytes(const uint8_t *bytes, uint16_t len, uint256_t *target) {
+    if (target == NULL) {
+        return parser_unexpected_error;
+    }
+    uint256_limbs_t limbs;
+    CHECK_ERROR(limbs256_from_be(bytes, len, &limbs))
+    limbs256_to_u256(&limbs, target);
+    return parser_ok;
+}
+
+static uint8_t limbs256_len(const uint32_t *limbs, uint8_t count) {
+    while (count > 0 && limbs[count - 1] == 0) {
+        count--;
+    }
+    return count;
+}
+
+void mul256_limbs(const uint256_limbs_t *number1, const uint256_limbs_t *number2, uint256_limbs_t *target) {
+    uint32_t product[UINT256_LIMBS] = {0};
+    const uint8_t len1 = limbs256_len(number1->limbs, UINT256_LIMBS);
+    const uint8_t len2 = limbs256_len(number2->limbs, UINT256_LIMBS);
+    // schoolbook, truncated to 256 bits
+    for (uint8_t i = 0; i < len1; i++) {
+        uint32_t carry = 0;
+        for (uint8_t j = 0; j < len2 && i + j < UINT256_LIMBS; j++) {
+            const uint64_t t = (uint64_t)number1->limbs[i] * number2->limbs[j] + product[i + j] + carry;
+            product[i + j] = (uint32_t)t;
+            carry = (uint32_t)(t >> 32);
+        }
+        if (i + len2 < UINT256_LIMBS) {
+            product[i + len2] = carry;
         }
     }
+    MEMCPY(target->limbs, product, sizeof(product));
+}
 
-    UPPER(fourth64) = 0;
-    LOWER(fourth64) = LOWER(products[0][3]);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][2]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][3]);
-    add128(&tmp, &tmp2, &third64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][1]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][2]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[0][0]);
-    UPPER(tmp2) = 0;
-    LOWER(tmp2) = UPPER(products[0][1]);
-    add128(&tmp, &tmp2, &first64);
+uint32_t divmod256_small(uint256_limbs_t *number, uint32_t divisor) {
+    if (divisor == 0) {
+        return 0;
+    }
+    uint64_t rem = 0;
+    for (int8_t i = UINT256_LIMBS - 1; i >= 0; i--) {
+        const uint64_t current = (rem << 32) | number->limbs[i];
+        number->limbs[i] = (uint32_t)(current / divisor);
+        rem = current % divisor;
+    }
+    return (uint32_t)rem;
+}
+
+// Knuth, TAOCP vol. 2, 4.3.1 algorithm D, as in Hacker's Delight divmnu
+void divmod256_limbs(const uint256_limbs_t *l, const uint256_limbs_t *r, uint256_limbs_t *div, uint256_limbs_t *mod) {
+    uint256_limbs_t quotient = {0};
+    uint256_limbs_t remainder = {0};
+    const uint8_t m = limbs256_len(l->limbs, UINT256_LIMBS);
+    const uint8_t n = limbs256_len(r->limbs, UINT256_LIMBS);
+
+    if (n == 0 || m < n) {
+        // division by zero leaves the dividend as remainder
+        remainder = *l;
+    } else if (n == 1) {
+        quotient = *l;
+        remainder.limbs[0] = divmod256_small(&quotient, r->limbs[0]);
+    } else {
+        const uint8_t s = (uint8_t)__builtin_clz(r->limbs[n - 1]);
+        uint32_t vn[UINT256_LIMBS] = {0};
+        uint32_t un[UINT256_LIMBS + 1] = {0};
+        for (uint8_t i = n - 1; i > 0; i--) {
+            vn[i] = (r->limbs[i] << s) | (s != 0 ? r->limbs[i - 1] >> (32 - s) : 0);
+        }
+        vn[0] = r->limbs[0] << s;
+        un[m] = s != 0 ? l->limbs[m - 1] >> (32 - s) : 0;
+        for (uint8_t i = m - 1; i > 0; i--) {
+            un[i] = (l->limbs[i] << s) | (s != 0 ? l->limbs[i - 1] >> (32 - s) : 0);
+        }
+        un[0] = l->limbs[0] << s;
+
+        for (int8_t j = (int8_t)(m - n); j >= 0; j--) {
+            // estimate the quotient digit from the top two limbs, it is at most 2 too large
+            const uint64_t numerator = ((uint64_t)un[j + n] << 32) | un[j + n - 1];
+            uint64_t qhat = numerator / vn[n - 1];
+            uint64_t rhat = numerator % vn[n - 1];
+            while (qhat > UINT32_MAX || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if (rhat > UINT32_MAX) {
+                    break;
+                }
+            }
 
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][3]);
-    add128(&tmp, &third64, &tmp2);
-    copy128(&third64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][2]);
-    add128(&tmp, &second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][3]);
-    add128(&tmp, &tmp2, &second64);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[1][1]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[1][2]);
-    add128(&tmp, &tmp2, &first64);
+            // multiply and subtract
+            int64_t borrow = 0;
+            int64_t t = 0;
+            for (uint8_t i = 0; i < n; i++) {
+                const uint64_t p = qhat * vn[i];
+                t = (int64_t)un[i + j] - borrow - (int64_t)(p & UINT32_MAX);
+                un[i + j] = (uint32_t)t;
+                borrow = (int64_t)(p >> 32) - (t >> 32);
+            }
+            t = (int64_t)un[j + n] - borrow;
+            un[j + n] = (uint32_t)t;
+
+            quotient.limbs[j] = (uint32_t)qhat;
+            if (t < 0) {
+                // the estimate was one too large, add the divisor back
+                quotient.limbs[j]--;
+                uint64_t carry = 0;
+                for (uint8_t i = 0; i < n; i++) {
+                    const uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                    un[i + j] = (uint32_t)sum;
+                    carry = sum >> 32;
+                }
+                un[j + n] += (uint32_t)carry;
+            }
+        }
 
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][3]);
-    add128(&tmp, &second64, &tmp2);
-    copy128(&second64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[2][2]);
-    add128(&tmp, &first64, &tmp2);
-    UPPER(tmp) = 0;
-    LOWER(tmp) = UPPER(products[2][3]);
-    add128(&tmp, &tmp2, &first64);
+        for (uint8_t i = 0; i < n - 1; i++) {
+            remainder.limbs[i] = (un[i] >> s) | (s != 0 ? un[i + 1] << (32 - s) : 0);
+        }
+        remainder.limbs[n - 1] = un[n - 1] >> s;
+    }
 
-    UPPER(tmp) = 0;
-    LOWER(tmp) = LOWER(products[3][3]);
-    add128(&tmp, &first64, &tmp2);
-    copy128(&first64, &tmp2);
-
-    clear256(&target1);
-    shiftl128(&first64, 64, &UPPER(target1));
-    clear256(&target2);
-    UPPER(UPPER(target2)) = UPPER(third64);
-    shiftl128(&third64, 64, &LOWER(target2));
-    add256(&target1, &target2, target);
-    clear256(&target1);
-    copy128(&UPPER(target1), &second64);
-    add256(&target1, target, &target2);
-    clear256(&target1);
-    copy128(&LOWER(target1), &fourth64);
-    add256(&target1, &target2, target);
+    if (div != NULL) {
+        *div = quotient;
+    }
+    if (mod != NULL) {
+        *mod = remainder;
+    }
+}
+
+void mul256(uint256_t *number1, uint256_t *number2, uint256_t *target) {
+    uint256_limbs_t a;
+    uint256_limbs_t b;
+    limbs256_from_u256(number1, &a);
+    limbs256_from_u256(number2, &b);
+    mul256_limbs(&a, &b, &a);
+    limbs256_to_u256(&a, target);
 }
 
 void divmod128(uint128_t *l, uint128_t *r, uint128_t *retDiv, uint128_t *retMod) {
@@ -469,38 +544,15 @@ void divmod128(uint128_t *l, uint128_t *r, uint128_t *retDiv, uint128_t *retMod)
 }
 
 void divmod256(uint256_t *l, uint256_t *r, uint256_t *retDiv, uint256_t *retMod) {
-    uint256_t copyd;
-    uint256_t adder;
-    uint256_t resDiv;
-    uint256_t resMod;
-    uint256_t one;
-    clear256(&one);
-    UPPER(LOWER(one)) = 0;
-    LOWER(LOWER(one)) = 1;
-    uint32_t diffBits = bits256(l) - bits256(r);
-    clear256(&resDiv);
-    copy256(&resMod, l);
-    if (gt256(r, l)) {
-        copy256(retMod, l);
-        clear256(retDiv);
-    } else {
-        shiftl256(r, diffBits, &copyd);
-        shiftl256(&one, diffBits, &adder);
-        if (gt256(&copyd, &resMod)) {
-            shiftr256(&copyd, 1, &copyd);
-            shiftr256(&adder, 1, &adder);
-        }
-        while (gte256(&resMod, r)) {
-            if (gte256(&resMod, &copyd)) {
-                minus256(&resMod, &copyd, &resMod);
-                or256(&resDiv, &adder, &resDiv);
-            }
-            shiftr256(&copyd, 1, &copyd);
-            shiftr256(&adder, 1, &adder);
-        }
-        copy256(retDiv, &resDiv);
-        copy256(retMod, &resMod);
-    }
+    uint256_limbs_t dividend;
+    uint256_limbs_t divisor;
+    uint256_limbs_t quotient;
+    uint256_limbs_t remainder;
+    limbs256_from_u256(l, &dividend);
+    limbs256_from_u256(r, &divisor);
+    divmod256_limbs(&dividend, &divisor, &quotient, &remainder);
+    limbs256_to_u256(&quotient, retDiv);
+    limbs256_to_u256(&remainder, retMod);
 }
 
 static void reverseString(char *str, uint32_t length) {
@@ -545,10 +597,55 @@ bool tostring128(uint128_t *number, uint32_t baseParam, char *out, uint32_t outL
     return true;
 }
 
+#define DECIMAL_CHUNK        1000000000u
+#define DECIMAL_CHUNK_DIGITS 9
+// digits of 2^256 - 1
+#define UINT256_MAX_DIGITS   78
+
+// Base 10 conversion dividing by 10^9 per step, so that each step is a short
+// division over 32-bit limbs instead of a bit-serial divmod256 per digit
+static bool tostring256_dec(const uint256_t *number, char *out, uint32_t outLength) {
+    char digits[UINT256_MAX_DIGITS];
+    uint32_t start = sizeof(digits);
+
+    if (UPPER(UPPER_P(number)) == 0 && LOWER(UPPER_P(number)) == 0 && UPPER(LOWER_P(number)) == 0) {
+        // nonces, gas and most fees fit in 64 bits
+        uint64_t value = LOWER(LOWER_P(number));
+        do {
+            digits[--start] = (char)('0' + (value % 10));
+            value /= 10;
+        } while (value != 0);
+    } else {
+        uint256_limbs_t limbs;
+        limbs256_from_u256(number, &limbs);
+        bool more = true;
+        while (more) {
+            uint32_t chunk = divmod256_small(&limbs, DECIMAL_CHUNK);
+            more = limbs256_len(limbs.limbs, UINT256_LIMBS) != 0;
+            // every chunk but the most significant one is zero padded
+            for (uint8_t d = 0; d < DECIMAL_CHUNK_DIGITS && (more || chunk != 0); d++) {
+                digits[--start] = (char)('0' + (chunk % 10));
+                chunk /= 10;
+            }
+        }
+    }
+
+    const uint32_t len = sizeof(digits) - start;
+    if (len >= outLength) {
+        return false;
+    }
+    MEMCPY(out, digits + start, len);
+    out[len] = '\0';
+    return true;
+}
+
 bool tostring256(uint256_t *number, uint32_t baseParam, char *out, uint32_t outLength) {
     if (number == NULL || out == NULL || outLength <= 1) {
         return false;
     }
+    if (baseParam == 10) {
+        return tostring256_dec(number, out, outLength);
+    }
 
     uint256_t rDiv;
     uint256_t rMod;
@@ -38,6 +38,13 @@ typedef struct uint256_t {
     uint128_t elements[2];
 } uint256_t;
 
+// Little-endian 32-bit limbs used by the multiplication and the division
+#define UINT256_LIMBS 8
+#define UINT256_BYTES 32
+typedef struct {
+    uint32_t limbs[UINT256_LIMBS];
+} uint256_limbs_t;
+
 #define UPPER_P(x) x->elements[0]
 #define LOWER_P(x) x->elements[1]
 #define UPPER(x)   x.elements[0]
@@ -45,6 +52,18 @@ typedef struct uint256_t {
 
 parser_error_t readu256BE(parser_context_t *ctx, uint256_t *bigInt);
 parser_error_t readu128BE(parser_context_t *ctx, uint128_t *value);
+/// Decodes a big-endian number of up to 32 bytes in place, without padding it first
+parser_error_t readu256BEBytes(const uint8_t *bytes, uint16_t len, uint256_t *target);
+
+void limbs256_from_u256(const uint256_t *number, uint256_limbs_t *target);
+void limbs256_to_u256(const uint256_limbs_t *number, uint256_t *target);
+parser_error_t limbs256_from_be(const uint8_t *bytes, uint16_t len, uint256_limbs_t *target);
+/// Product truncated to 256 bits
+void mul256_limbs(const uint256_limbs_t *number1, const uint256_limbs_t *number2, uint256_limbs_t *target);
+/// Divides number in place and returns the remainder
+uint32_t divmod256_small(uint256_limbs_t *number, uint32_t divisor);
+/// Division by zero returns a zero quotient and the dividend as remainder; div and mod may be NULL
+void divmod256_limbs(const uint256_limbs_t *l, const uint256_limbs_t *r, uint256_limbs_t *div, uint256_limbs_t *mod);
 
 bool zero128(uint128_t *number);
 bool zero256(uint256_t *number);
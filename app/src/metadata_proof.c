@@ -0,0 +1,395 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#include "metadata_proof.h"
+
+#include <string.h>
+
+#include "blake3.h"
+#include "coin.h"
+#include "parser_impl.h"
+#include "zxmacros.h"
+
+#define METADATA_DIGEST_V1 0x01
+#define HASH_LEN           BLAKE3_OUT_LEN
+// the tree of METADATA_PROOF_MAX_TYPES leaves is 17 levels deep
+#define MAX_DEPTH 17
+
+// TypeInformation: path, type definition, type id
+#define TYPE_DEF_ENUMERATION 1
+// TypeRef variants: primitives and compacts carry nothing, the last one is a type id
+#define TYPE_REF_PER_ID 22
+
+#define RUNTIME_CALL_PATH "RuntimeCall"
+
+typedef struct {
+    const uint8_t *proof;
+    uint32_t numTypes;
+    uint16_t leavesOffset;
+    uint16_t numLeaves;
+    uint16_t nodesOffset;
+    uint16_t numNodes;
+    uint16_t nodesUsed;
+} proof_t;
+
+// One variant of an enumeration, as RFC-78 splits enumerations into one leaf per variant
+typedef struct {
+    const uint8_t *pathLast;
+    uint16_t pathLastLen;
+    const uint8_t *name;
+    uint16_t nameLen;
+    uint32_t index;
+    uint32_t typeId;
+    uint8_t numFields;
+    // type id of the first field, when it is a reference
+    uint8_t fieldById;
+    uint32_t fieldTypeId;
+} variant_t;
+
+static parser_error_t readByte(parser_context_t *c, uint8_t *value) {
+    if (c->offset >= c->bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
+    *value = c->buffer[c->offset++];
+    return parser_ok;
+}
+
+static parser_error_t skip(parser_context_t *c, uint32_t len) {
+    if (len > (uint32_t)(c->bufferLen - c->offset)) {
+        return parser_unexpected_buffer_end;
+    }
+    c->offset += (uint16_t)len;
+    return parser_ok;
+}
+
+static parser_error_t readU32(parser_context_t *c, uint32_t *value) {
+    const uint16_t start = c->offset;
+    CHECK_ERROR(skip(c, sizeof(uint32_t)))
+    const uint8_t *p = c->buffer + start;
+    *value = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    return parser_ok;
+}
+
+static parser_error_t readCompactU32(parser_context_t *c, uint32_t *value) {
+    scale_span_t span = {0};
+    uint256_t decoded = {0};
+    CHECK_ERROR(_readCompactInt(c, sizeof(uint32_t), &span))
+    CHECK_ERROR(_decodeCompact(c->buffer + span.offset, span.len, &decoded))
+    *value = (uint32_t)decoded.elements[1].elements[1];
+    return parser_ok;
+}
+
+// SCALE String: compact length, then the bytes
+static parser_error_t readString(parser_context_t *c, const uint8_t **str, uint16_t *len) {
+    uint32_t strLen = 0;
+    CHECK_ERROR(readCompactU32(c, &strLen))
+    *str = c->buffer + c->offset;
+    CHECK_ERROR(skip(c, strLen))
+    *len = (uint16_t)strLen;
+    return parser_ok;
+}
+
+static parser_error_t readOptionalString(parser_context_t *c) {
+    uint8_t some = 0;
+    CHECK_ERROR(readByte(c, &some))
+    if (some > 1) {
+        return parser_unexpected_value;
+    }
+    const uint8_t *str = NULL;
+    uint16_t len = 0;
+    return some ? readString(c, &str, &len) : parser_ok;
+}
+
+static parser_error_t readTypeRef(parser_context_t *c, uint8_t *byId, uint32_t *typeId) {
+    uint8_t tag = 0;
+    CHECK_ERROR(readByte(c, &tag))
+    if (tag > TYPE_REF_PER_ID) {
+        return parser_unexpected_type;
+    }
+    *byId = tag == TYPE_REF_PER_ID;
+    return *byId ? readCompactU32(c, typeId) : parser_ok;
+}
+
+// Decodes a leaf that is an enumeration variant; other type definitions are not needed
+static parser_error_t readVariant(const uint8_t *leaf, uint16_t leafLen, variant_t *v) {
+    MEMZERO(v, sizeof(*v));
+    parser_context_t c = {.buffer = leaf, .bufferLen = leafLen, .offset = 0, .tx_obj = NULL};
+
+    uint32_t pathLen = 0;
+    CHECK_ERROR(readCompactU32(&c, &pathLen))
+    for (uint32_t i = 0; i < pathLen; i++) {
+        CHECK_ERROR(readString(&c, &v->pathLast, &v->pathLastLen))
+    }
+
+    uint8_t typeDef = 0;
+    CHECK_ERROR(readByte(&c, &typeDef))
+    if (typeDef != TYPE_DEF_ENUMERATION) {
+        return parser_unexpected_type;
+    }
+    CHECK_ERROR(readString(&c, &v->name, &v->nameLen))
+
+    // fields: optional name, type, optional type name
+    uint32_t numFields = 0;
+    CHECK_ERROR(readCompactU32(&c, &numFields))
+    if (numFields > UINT8_MAX) {
+        return parser_unexpected_number_items;
+    }
+    v->numFields = (uint8_t)numFields;
+    for (uint8_t i = 0; i < v->numFields; i++) {
+        uint8_t byId = 0;
+        uint32_t typeId = 0;
+        CHECK_ERROR(readOptionalString(&c))
+        CHECK_ERROR(readTypeRef(&c, &byId, &typeId))
+        CHECK_ERROR(readOptionalString(&c))
+        if (i == 0) {
+            v->fieldById = byId;
+            v->fieldTypeId = typeId;
+        }
+    }
+    CHECK_ERROR(readCompactU32(&c, &v->index))
+    CHECK_ERROR(readCompactU32(&c, &v->typeId))
+    return c.offset == leafLen ? parser_ok : parser_unexpected_characters;
+}
+
+// Leaf k of the proof: its index in the tree and its encoding
+static parser_error_t leafAt(const proof_t *p, uint16_t k, uint32_t *leafIdx, const uint8_t **leaf, uint16_t *leafLen) {
+    parser_context_t c = {.buffer = p->proof, .bufferLen = p->nodesOffset, .offset = p->leavesOffset, .tx_obj = NULL};
+    for (uint16_t i = 0; i <= k; i++) {
+        CHECK_ERROR(readU32(&c, leafIdx))
+        CHECK_ERROR(readString(&c, leaf, leafLen))
+    }
+    return parser_ok;
+}
+
+// The tree is stored as a heap: node i has children 2i + 1 and 2i + 2, leaf j is node numTypes - 1 + j
+static parser_error_t subtreeHasLeaf(const proof_t *p, uint32_t node, bool *found, uint16_t *k) {
+    *found = false;
+    for (uint16_t i = 0; i < p->numLeaves; i++) {
+        uint32_t leafIdx = 0;
+        const uint8_t *leaf = NULL;
+        uint16_t leafLen = 0;
+        CHECK_ERROR(leafAt(p, i, &leafIdx, &leaf, &leafLen))
+        uint32_t heap = p->numTypes - 1 + leafIdx;
+        while (heap > node) {
+            heap = (heap - 1) / 2;
+        }
+        if (heap == node) {
+            *found = true;
+            *k = i;
+            return parser_ok;
+        }
+    }
+    return parser_ok;
+}
+
+static parser_error_t nodeHash(proof_t *p, uint32_t node, uint8_t depth, uint8_t out[HASH_LEN]) {
+    if (depth > MAX_DEPTH) {
+        return parser_value_out_of_range;
+    }
+    bool found = false;
+    uint16_t k = 0;
+    CHECK_ERROR(subtreeHasLeaf(p, node, &found, &k))
+    if (!found) {
+        // nothing proven below: the hash comes with the proof
+        if (p->nodesUsed >= p->numNodes) {
+            return parser_unexpected_buffer_end;
+        }
+        MEMCPY(out, p->proof + p->nodesOffset + (uint32_t)HASH_LEN * p->nodesUsed, HASH_LEN);
+        p->nodesUsed++;
+        return parser_ok;
+    }
+    if (node >= p->numTypes - 1) {
+        uint32_t leafIdx = 0;
+        const uint8_t *leaf = NULL;
+        uint16_t leafLen = 0;
+        CHECK_ERROR(leafAt(p, k, &leafIdx, &leaf, &leafLen))
+        return blake3_hash(leaf, leafLen, out) ? parser_ok : parser_value_out_of_range;
+    }
+    uint8_t pair[2 * HASH_LEN];
+    CHECK_ERROR(nodeHash(p, 2 * node + 1, depth + 1, pair))
+    CHECK_ERROR(nodeHash(p, 2 * node + 2, depth + 1, pair + HASH_LEN))
+    return blake3_hash(pair, sizeof(pair), out) ? parser_ok : parser_unexpected_error;
+}
+
+// Call variants are named in snake case, the review shows them capitalized with spaces
+static bool matchCallName(const char *display, const uint8_t *name, uint16_t nameLen) {
+    if (strlen(display) != nameLen) {
+        return false;
+    }
+    for (uint16_t i = 0; i < nameLen; i++) {
+        char expected = display[i] == ' ' ? '_' : display[i];
+        if (expected >= 'A' && expected <= 'Z') {
+            expected = (char)(expected - 'A' + 'a');
+        }
+        if ((uint8_t)expected != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool matchString(const char *expected, const uint8_t *str, uint16_t len) {
+    return strlen(expected) == len && memcmp(expected, str, len) == 0;
+}
+
+// The RuntimeCall variant of the pallet, then the variant of its Call enumeration
+static parser_error_t bindCall(const proof_t *p, const parser_context_t *ctx, uint16_t callOffset) {
+    uint8_t callIdx = 0;
+    CHECK_ERROR(_callIdxAt(ctx, callOffset, &callIdx))
+    const scale_call_def_t *def = _getCallDef(callIdx);
+    if (def == NULL) {
+        return parser_unexpected_method;
+    }
+
+    bool palletFound = false;
+    uint32_t callTypeId = 0;
+    for (uint16_t i = 0; i < p->numLeaves && !palletFound; i++) {
+        uint32_t leafIdx = 0;
+        const uint8_t *leaf = NULL;
+        uint16_t leafLen = 0;
+        variant_t v;
+        CHECK_ERROR(leafAt(p, i, &leafIdx, &leaf, &leafLen))
+        if (readVariant(leaf, leafLen, &v) != parser_ok) {
+            continue;
+        }
+        if (matchString(RUNTIME_CALL_PATH, v.pathLast, v.pathLastLen) && v.index == def->pallet &&
+            matchString(def->palletName, v.name, v.nameLen) && v.numFields == 1 && v.fieldById) {
+            palletFound = true;
+            callTypeId = v.fieldTypeId;
+        }
+    }
+    if (!palletFound) {
+        return parser_metadata_mismatch;
+    }
+
+    for (uint16_t i = 0; i < p->numLeaves; i++) {
+        uint32_t leafIdx = 0;
+        const uint8_t *leaf = NULL;
+        uint16_t leafLen = 0;
+        variant_t v;
+        CHECK_ERROR(leafAt(p, i, &leafIdx, &leaf, &leafLen))
+        if (readVariant(leaf, leafLen, &v) != parser_ok) {
+            continue;
+        }
+        if (v.typeId == callTypeId && v.index == def->method && matchCallName(def->name, v.name, v.nameLen)) {
+            return parser_ok;
+        }
+    }
+    return parser_metadata_mismatch;
+}
+
+// The runtime must describe the chain the review assumes
+static parser_error_t checkExtraInfo(const parser_context_t *ctx, parser_context_t *c) {
+    uint32_t specVersion = 0;
+    const uint8_t *str = NULL;
+    uint16_t strLen = 0;
+    uint8_t prefix[2] = {0};
+    uint8_t decimals = 0;
+
+    CHECK_ERROR(readU32(c, &specVersion))
+    const uint8_t *payloadSpec = ctx->buffer + ctx->tx_obj->specVersionOffset;
+    const uint32_t payloadSpecVersion = (uint32_t)payloadSpec[0] | (uint32_t)payloadSpec[1] << 8 |
+                                        (uint32_t)payloadSpec[2] << 16 | (uint32_t)payloadSpec[3] << 24;
+    CHECK_ERROR(readString(c, &str, &strLen))
+    CHECK_ERROR(readByte(c, &prefix[0]))
+    CHECK_ERROR(readByte(c, &prefix[1]))
+    CHECK_ERROR(readByte(c, &decimals))
+    CHECK_ERROR(readString(c, &str, &strLen))
+
+    if (specVersion != payloadSpecVersion || (uint16_t)(prefix[0] | prefix[1] << 8) != SS58_ADDRESS_TYPE ||
+        decimals != COIN_AMOUNT_DECIMALS || !matchString(COIN_SYMBOL, str, strLen)) {
+        return parser_metadata_mismatch;
+    }
+    return parser_ok;
+}
+
+parser_error_t metadata_proof_verify(const parser_context_t *ctx, const uint8_t *proof, uint16_t proofLen) {
+    if (ctx == NULL || ctx->tx_obj == NULL || proof == NULL || !ctx->tx_obj->checkMetadataHash) {
+        return parser_unexpected_error;
+    }
+    const parser_tx_t *tx_obj = ctx->tx_obj;
+
+    // layout pass: nothing is hashed before the proof is known to be well formed
+    parser_context_t c = {.buffer = proof, .bufferLen = proofLen, .offset = 0, .tx_obj = NULL};
+    proof_t p = {.proof = proof};
+    CHECK_ERROR(skip(&c, HASH_LEN))
+    const uint16_t extraOffset = c.offset;
+    CHECK_ERROR(checkExtraInfo(ctx, &c))
+    const uint16_t extraLen = c.offset - extraOffset;
+
+    CHECK_ERROR(readU32(&c, &p.numTypes))
+    if (p.numTypes == 0 || p.numTypes > METADATA_PROOF_MAX_TYPES) {
+        return parser_value_out_of_range;
+    }
+
+    uint32_t count = 0;
+    CHECK_ERROR(readCompactU32(&c, &count))
+    if (count == 0 || count > METADATA_PROOF_MAX_LEAVES) {
+        return parser_unexpected_number_items;
+    }
+    p.numLeaves = (uint16_t)count;
+    p.leavesOffset = c.offset;
+    uint32_t previous = 0;
+    for (uint16_t i = 0; i < p.numLeaves; i++) {
+        uint32_t leafIdx = 0;
+        const uint8_t *leaf = NULL;
+        uint16_t leafLen = 0;
+        CHECK_ERROR(readU32(&c, &leafIdx))
+        CHECK_ERROR(readString(&c, &leaf, &leafLen))
+        if (leafIdx >= p.numTypes || (i > 0 && leafIdx <= previous)) {
+            return parser_unexpected_value;
+        }
+        previous = leafIdx;
+    }
+
+    CHECK_ERROR(readCompactU32(&c, &count))
+    if (count > METADATA_PROOF_MAX_TYPES) {
+        return parser_unexpected_number_items;
+    }
+    p.nodesOffset = c.offset;
+    p.numNodes = (uint16_t)count;
+    CHECK_ERROR(skip(&c, (uint32_t)HASH_LEN * p.numNodes))
+    if (c.offset != proofLen) {
+        return parser_unexpected_characters;
+    }
+
+    // the calls must be the ones of the metadata
+    CHECK_ERROR(bindCall(&p, ctx, 0))
+    for (uint8_t i = 0; i < tx_obj->numCalls; i++) {
+        CHECK_ERROR(bindCall(&p, ctx, tx_obj->callOffsets[i]))
+    }
+
+    uint8_t root[HASH_LEN] = {0};
+    CHECK_ERROR(nodeHash(&p, 0, 0, root))
+    if (p.nodesUsed != p.numNodes) {
+        return parser_unexpected_characters;
+    }
+
+    // MetadataDigest::V1, the hash the payload commits to
+    blake3_hasher_t hasher;
+    const uint8_t version = METADATA_DIGEST_V1;
+    uint8_t digest[HASH_LEN] = {0};
+    blake3_init(&hasher);
+    if (!blake3_update(&hasher, &version, 1) || !blake3_update(&hasher, root, sizeof(root)) ||
+        !blake3_update(&hasher, proof, HASH_LEN) || !blake3_update(&hasher, proof + extraOffset, extraLen)) {
+        return parser_unexpected_error;
+    }
+    blake3_finalize(&hasher, digest);
+
+    if (memcmp(digest, ctx->buffer + tx_obj->metadataHashOffset, HASH_LEN) != 0) {
+        return parser_metadata_mismatch;
+    }
+    return parser_ok;
+}
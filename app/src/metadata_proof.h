@@ -0,0 +1,47 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "parser_common.h"
+
+// CheckMetadataHash (RFC-78): the payload commits to a BLAKE3 digest of the runtime metadata,
+// and the proof uploaded with it shows that the calls of the payload are the ones its review names.
+//
+// Proof layout; integers are little-endian, counts and lengths are SCALE compacts:
+//   extrinsic metadata hash (32)
+//   extra info: spec version (4), spec name (len + bytes), base58 prefix (2), decimals (1),
+//               token symbol (len + bytes)
+//   number of types in the metadata (4)
+//   leaves: count, then per leaf its index (4) and its encoded TypeInformation (len + bytes),
+//           in increasing index order
+//   nodes: count, then the hashes (32 each), in the order the root computation needs them,
+//          left subtree first
+#define METADATA_PROOF_MAX_LEAVES 64
+#define METADATA_PROOF_MAX_TYPES  65535u
+
+/// Checks the proof against the metadata hash of the payload parsed in ctx and binds every call
+/// of the payload to its pallet and call variants in the proof
+parser_error_t metadata_proof_verify(const parser_context_t *ctx, const uint8_t *proof, uint16_t proofLen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,8 +21,13 @@
 #include <zxmacros.h>
 #include <zxtypes.h>
 
+#include "app_mode.h"
 #include "coin.h"
 #include "crypto.h"
+#include "crypto_helper.h"
+#include "format_scratch.h"
+#include "hex_encode.h"
+#include "metadata_proof.h"
 #include "parser_common.h"
 #include "parser_impl.h"
 
@@ -37,17 +42,257 @@ parser_error_t parser_init_context(parser_context_t *ctx, const uint8_t *buffer,
     return parser_ok;
 }
 
-// For future implementation
 parser_error_t parser_parse(parser_context_t *ctx, const uint8_t *data, size_t dataLen, parser_tx_t *tx_obj) {
-    UNUSED(ctx);
-    UNUSED(data);
-    UNUSED(dataLen);
-    UNUSED(tx_obj);
-    return parser_not_supported_parser;
+    if (dataLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
+    CHECK_ERROR(parser_init_context(ctx, data, (uint16_t)dataLen))
+    ctx->tx_obj = tx_obj;
+    return _readTx(ctx, tx_obj);
+}
+
+parser_error_t parser_parse_with_proof(parser_context_t *ctx, const uint8_t *data, size_t dataLen, const uint8_t *proof,
+                                      size_t proofLen, parser_tx_t *tx_obj) {
+    if (tx_obj == NULL || proof == NULL || proofLen == 0) {
+        return parser_no_data;
+    }
+    if (proofLen > UINT16_MAX) {
+        return parser_value_out_of_range;
+    }
+    tx_obj->checkMetadataHash = 1;
+    CHECK_ERROR(parser_parse(ctx, data, dataLen, tx_obj))
+    return metadata_proof_verify(ctx, proof, (uint16_t)proofLen);
 }
 
-// For future implementation
 parser_error_t parser_validate(parser_context_t *ctx) {
-    UNUSED(ctx);
-    return parser_not_supported_validation;
+    if (ctx == NULL || ctx->tx_obj == NULL) {
+        return parser_unexpected_error;
+    }
+
+    // Iterate through all items and pages to check that all can be shown before the review starts
+    uint8_t numItems = 0;
+    CHECK_ERROR(parser_getNumItems(ctx, &numItems))
+
+    char tmpKey[40] = {0};
+    char tmpVal[40] = {0};
+
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        uint8_t pageCount = 0;
+        CHECK_ERROR(parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), 0, &pageCount))
+        for (uint8_t page = 1; page < pageCount; page++) {
+            CHECK_ERROR(parser_getItem(ctx, idx, tmpKey, sizeof(tmpKey), tmpVal, sizeof(tmpVal), page, &pageCount))
+        }
+    }
+    return parser_ok;
+}
+
+// Review: method, arguments (for batches, per inner call), nonce, tip, then the expert fields
+#define SUBSTRATE_ITEMS_COMMON 2
+#define SUBSTRATE_ITEMS_EXPERT 5
+
+#define AMOUNT_TEXT_LEN 100
+
+static uint8_t callItems(uint8_t callIdx) {
+    const scale_call_def_t *def = _getCallDef(callIdx);
+    return def == NULL ? 0 : 1 + def->numArgs;
+}
+
+parser_error_t parser_getNumItems(const parser_context_t *ctx, uint8_t *num_items) {
+    if (ctx == NULL || ctx->tx_obj == NULL || num_items == NULL) {
+        return parser_unexpected_error;
+    }
+    const parser_tx_t *tx_obj = ctx->tx_obj;
+    uint8_t items = callItems(tx_obj->call.callIdx) + tx_obj->batchItems + SUBSTRATE_ITEMS_COMMON;
+    if (app_mode_expert()) {
+        items += SUBSTRATE_ITEMS_EXPERT;
+    }
+    *num_items = items;
+    return parser_ok;
+}
+
+static uint32_t readU32LE(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static parser_error_t printHex(const uint8_t *data, uint8_t len, char *outVal, uint16_t outValLen, uint8_t pageIdx,
+                               uint8_t *pageCount) {
+    char buffer[2 + 2 * SCALE_HASH_LEN + 1] = {'0', 'x'};
+    if (2 * (uint16_t)len + 3 > sizeof(buffer) ||
+        hex_encode(buffer + 2, sizeof(buffer) - 2, data, len) != 2 * (uint32_t)len) {
+        return parser_unexpected_buffer_end;
+    }
+    pageString(outVal, outValLen, buffer, pageIdx, pageCount);
+    return parser_ok;
+}
+
+static parser_error_t printAmount(const uint256_t *amount, char *outVal, uint16_t outValLen, uint8_t pageIdx,
+                                  uint8_t *pageCount) {
+    uint256_t value = *amount;
+    char *bufferUI = format_scratch_borrow(AMOUNT_TEXT_LEN);
+    if (bufferUI == NULL) {
+        return parser_unexpected_error;
+    }
+
+    parser_error_t err = parser_ok;
+    if (!tostring256(&value, 10, bufferUI, AMOUNT_TEXT_LEN)) {
+        err = parser_unexpected_error;
+    } else if (intstr_to_fpstr_inplace(bufferUI, AMOUNT_TEXT_LEN, COIN_AMOUNT_DECIMALS) == 0) {
+        err = parser_unexpected_value;
+    } else if (z_str3join(bufferUI, AMOUNT_TEXT_LEN, COIN_TICKER, NULL) != zxerr_ok) {
+        err = parser_unexpected_buffer_end;
+    } else {
+        number_inplace_trimming(bufferUI, 1);
+        pageString(outVal, outValLen, bufferUI, pageIdx, pageCount);
+    }
+    format_scratch_return();
+    return err;
+}
+
+static parser_error_t printArg(const parser_context_t *ctx, uint8_t type, const scale_span_t *span, char *outVal,
+                               uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    const uint8_t *data = ctx->buffer + span->offset;
+    uint256_t amount = {0};
+    uint8_t be[SCALE_BALANCE_LEN] = {0};
+
+    switch (type) {
+        case scale_arg_account: {
+            uint8_t address[SS58_ADDRESS_MAX_LEN] = {0};
+            if (crypto_SS58EncodePubkey(address, sizeof(address), SS58_ADDRESS_TYPE, data) == 0) {
+                return parser_invalid_address;
+            }
+            pageString(outVal, outValLen, (const char *)address, pageIdx, pageCount);
+            return parser_ok;
+        }
+        case scale_arg_compact_balance:
+            CHECK_ERROR(_decodeCompact(data, span->len, &amount))
+            return printAmount(&amount, outVal, outValLen, pageIdx, pageCount);
+        case scale_arg_balance:
+            for (uint8_t i = 0; i < SCALE_BALANCE_LEN; i++) {
+                be[i] = data[SCALE_BALANCE_LEN - 1 - i];
+            }
+            CHECK_ERROR(readu256BEBytes(be, sizeof(be), &amount))
+            return printAmount(&amount, outVal, outValLen, pageIdx, pageCount);
+        case scale_arg_bool:
+            snprintf(outVal, outValLen, "%s", data[0] ? "True" : "False");
+            return parser_ok;
+        default:
+            return parser_unexpected_type;
+    }
+}
+
+static parser_error_t printCall(const parser_context_t *ctx, const parser_call_t *call, uint8_t itemIdx,
+                                const char *prefix, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                                uint8_t pageIdx, uint8_t *pageCount) {
+    const scale_call_def_t *def = _getCallDef(call->callIdx);
+    if (def == NULL) {
+        return parser_unexpected_method;
+    }
+    if (itemIdx == 0) {
+        snprintf(outKey, outKeyLen, "%s%s", prefix, def->palletName);
+        pageString(outVal, outValLen, def->name, pageIdx, pageCount);
+        return parser_ok;
+    }
+    const uint8_t arg = itemIdx - 1;
+    snprintf(outKey, outKeyLen, "%s%s", prefix, def->argNames[arg]);
+    return printArg(ctx, def->argTypes[arg], &call->args[arg], outVal, outValLen, pageIdx, pageCount);
+}
+
+static parser_error_t printCompactU64(const parser_context_t *ctx, const scale_span_t *span, char *outVal,
+                                      uint16_t outValLen) {
+    uint256_t value = {0};
+    CHECK_ERROR(_decodeCompact(ctx->buffer + span->offset, span->len, &value))
+    if (uint64_to_str(outVal, outValLen, LOWER(LOWER(value))) != NULL) {
+        return parser_unexpected_buffer_end;
+    }
+    return parser_ok;
+}
+
+static parser_error_t printEra(const parser_context_t *ctx, char *outVal, uint16_t outValLen) {
+    const scale_span_t *era = &ctx->tx_obj->era;
+    if (era->len == 1) {
+        snprintf(outVal, outValLen, "Immortal");
+        return parser_ok;
+    }
+    const uint8_t *p = ctx->buffer + era->offset;
+    const uint16_t encoded = (uint16_t)(p[0] | p[1] << 8);
+    const uint32_t period = 2u << (encoded % 16);
+    const uint32_t phase = (uint32_t)(encoded >> 4) * MAX(period >> 12, 1);
+    snprintf(outVal, outValLen, "Mortal %u/%u", (unsigned)phase, (unsigned)period);
+    return parser_ok;
+}
+
+parser_error_t parser_getItem(const parser_context_t *ctx, uint8_t displayIdx, char *outKey, uint16_t outKeyLen,
+                              char *outVal, uint16_t outValLen, uint8_t pageIdx, uint8_t *pageCount) {
+    if (ctx == NULL || ctx->tx_obj == NULL || outKey == NULL || outVal == NULL || pageCount == NULL) {
+        return parser_unexpected_error;
+    }
+    MEMZERO(outKey, outKeyLen);
+    MEMZERO(outVal, outValLen);
+    *pageCount = 1;
+
+    uint8_t numItems = 0;
+    CHECK_ERROR(parser_getNumItems(ctx, &numItems))
+    if (displayIdx >= numItems) {
+        return parser_display_idx_out_of_range;
+    }
+
+    const parser_tx_t *tx_obj = ctx->tx_obj;
+    uint8_t idx = displayIdx;
+    uint8_t items = callItems(tx_obj->call.callIdx);
+    if (idx < items) {
+        return printCall(ctx, &tx_obj->call, idx, "", outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+    }
+    idx -= items;
+
+    // inner calls: skip the ones before by their header, decode only the one shown
+    if (idx < tx_obj->batchItems) {
+        for (uint8_t i = 0; i < tx_obj->numCalls; i++) {
+            uint8_t callIdx = 0;
+            CHECK_ERROR(_callIdxAt(ctx, tx_obj->callOffsets[i], &callIdx))
+            items = callItems(callIdx);
+            if (idx < items) {
+                parser_call_t call = {0};
+                CHECK_ERROR(_readCallAt(ctx, tx_obj->callOffsets[i], &call))
+                char prefix[8] = {0};
+                snprintf(prefix, sizeof(prefix), "[%d] ", i + 1);
+                return printCall(ctx, &call, idx, prefix, outKey, outKeyLen, outVal, outValLen, pageIdx, pageCount);
+            }
+            idx -= items;
+        }
+        return parser_unexpected_error;
+    }
+    idx -= tx_obj->batchItems;
+
+    switch (idx) {
+        case 0:
+            snprintf(outKey, outKeyLen, "Nonce");
+            return printCompactU64(ctx, &tx_obj->nonce, outVal, outValLen);
+        case 1: {
+            snprintf(outKey, outKeyLen, "Tip");
+            uint256_t tip = {0};
+            CHECK_ERROR(_decodeCompact(ctx->buffer + tx_obj->tip.offset, tx_obj->tip.len, &tip))
+            return printAmount(&tip, outVal, outValLen, pageIdx, pageCount);
+        }
+        case 2:
+            snprintf(outKey, outKeyLen, "Era");
+            return printEra(ctx, outVal, outValLen);
+        case 3:
+            snprintf(outKey, outKeyLen, "Spec version");
+            snprintf(outVal, outValLen, "%u", (unsigned)readU32LE(ctx->buffer + tx_obj->specVersionOffset));
+            return parser_ok;
+        case 4:
+            snprintf(outKey, outKeyLen, "Tx version");
+            snprintf(outVal, outValLen, "%u", (unsigned)readU32LE(ctx->buffer + tx_obj->txVersionOffset));
+            return parser_ok;
+        case 5:
+            snprintf(outKey, outKeyLen, "Genesis hash");
+            return printHex(ctx->buffer + tx_obj->genesisHashOffset, SCALE_HASH_LEN, outVal, outValLen, pageIdx,
+                            pageCount);
+        case 6:
+            snprintf(outKey, outKeyLen, "Block hash");
+            return printHex(ctx->buffer + tx_obj->blockHashOffset, SCALE_HASH_LEN, outVal, outValLen, pageIdx,
+                            pageCount);
+        default:
+            return parser_display_idx_out_of_range;
+    }
 }
@@ -16,6 +16,10 @@
 
 #include "parser_impl.h"
 
+#include <string.h>
+
+#include "coin.h"
+
 const char *parser_getErrorDescription(parser_error_t err) {
     switch (err) {
         case parser_ok:
@@ -40,6 +44,16 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "Unexpected chain";
         case parser_missing_field:
             return "missing field";
+        case parser_unexpected_type:
+            return "Unexpected type";
+        case parser_unexpected_method:
+            return "Unexpected method";
+        case parser_unexpected_number_items:
+            return "Unexpected number of items";
+        case parser_invalid_address:
+            return "Invalid address";
+        case parser_metadata_mismatch:
+            return "Metadata proof mismatch";
 
         case parser_display_idx_out_of_range:
             return "display index out of range";
@@ -50,3 +64,305 @@ const char *parser_getErrorDescription(parser_error_t err) {
             return "Unrecognized error code";
     }
 }
+
+// Supported calls. Call indices are the declaration order of the pallets.
+static const scale_call_def_t CALLS[] = {
+    {PALLET_BALANCES, 0, "Balances", "Transfer allow death", 2,
+     {scale_arg_account, scale_arg_compact_balance}, {"Dest", "Value"}},
+    {PALLET_BALANCES, 3, "Balances", "Transfer keep alive", 2,
+     {scale_arg_account, scale_arg_compact_balance}, {"Dest", "Value"}},
+    {PALLET_BALANCES, 4, "Balances", "Transfer all", 2, {scale_arg_account, scale_arg_bool}, {"Dest", "Keep alive"}},
+    {PALLET_UTILITY, 0, "Utility", "Batch", 0, {0}, {""}},
+    {PALLET_UTILITY, 2, "Utility", "Batch all", 0, {0}, {""}},
+    {PALLET_UTILITY, 4, "Utility", "Force batch", 0, {0}, {""}},
+    {PALLET_PARACHAIN_STAKING, 11, "ParachainStaking", "Join delegators", 2,
+     {scale_arg_account, scale_arg_balance}, {"Collator", "Amount"}},
+    {PALLET_PARACHAIN_STAKING, 13, "ParachainStaking", "Leave delegators", 0, {0}, {""}},
+    {PALLET_PARACHAIN_STAKING, 14, "ParachainStaking", "Delegator stake more", 2,
+     {scale_arg_account, scale_arg_balance}, {"Candidate", "More"}},
+    {PALLET_PARACHAIN_STAKING, 15, "ParachainStaking", "Delegator stake less", 2,
+     {scale_arg_account, scale_arg_balance}, {"Candidate", "Less"}},
+    {PALLET_PARACHAIN_STAKING, 16, "ParachainStaking", "Unlock unstaked", 1, {scale_arg_account}, {"Target"}},
+};
+
+#define CALLS_COUNT (sizeof(CALLS) / sizeof(CALLS[0]))
+
+const scale_call_def_t *_getCallDef(uint8_t callIdx) {
+    if (callIdx >= CALLS_COUNT) {
+        return NULL;
+    }
+    return (const scale_call_def_t *)PIC(&CALLS[callIdx]);
+}
+
+bool _isBatchCall(uint8_t callIdx) {
+    const scale_call_def_t *def = _getCallDef(callIdx);
+    return def != NULL && def->pallet == PALLET_UTILITY;
+}
+
+static parser_error_t readBytes(parser_context_t *ctx, uint16_t len, scale_span_t *span) {
+    if (ctx->offset + len > ctx->bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
+    if (span != NULL) {
+        span->offset = ctx->offset;
+        span->len = len;
+    }
+    ctx->offset += len;
+    return parser_ok;
+}
+
+static parser_error_t readUInt8(parser_context_t *ctx, uint8_t *value) {
+    if (ctx->offset >= ctx->bufferLen) {
+        return parser_unexpected_buffer_end;
+    }
+    *value = ctx->buffer[ctx->offset++];
+    return parser_ok;
+}
+
+parser_error_t _readCompactInt(parser_context_t *ctx, uint8_t maxBytes, scale_span_t *span) {
+    if (ctx == NULL || span == NULL) {
+        return parser_unexpected_error;
+    }
+    const uint16_t start = ctx->offset;
+    uint8_t first = 0;
+    CHECK_ERROR(readUInt8(ctx, &first))
+
+    const uint8_t *p = ctx->buffer + start;
+    switch (first & 0x03) {
+        case 0:
+            break;
+        case 1:
+            CHECK_ERROR(readBytes(ctx, 1, NULL))
+            // values below 2^6 fit in one byte
+            if (p[1] == 0) {
+                return parser_value_out_of_range;
+            }
+            break;
+        case 2:
+            CHECK_ERROR(readBytes(ctx, 3, NULL))
+            // values below 2^14 fit in two bytes
+            if (p[2] == 0 && p[3] == 0) {
+                return parser_value_out_of_range;
+            }
+            break;
+        default: {
+            const uint8_t len = (first >> 2) + 4;
+            if (len > maxBytes) {
+                return parser_value_out_of_range;
+            }
+            CHECK_ERROR(readBytes(ctx, len, NULL))
+            // no leading zero byte, and values below 2^30 use the shorter modes
+            if (p[len] == 0 || (len == 4 && (p[4] >> 6) == 0)) {
+                return parser_value_out_of_range;
+            }
+            break;
+        }
+    }
+    span->offset = start;
+    span->len = ctx->offset - start;
+    return parser_ok;
+}
+
+parser_error_t _decodeCompact(const uint8_t *encoded, uint16_t encodedLen, uint256_t *value) {
+    if (encoded == NULL || value == NULL || encodedLen == 0) {
+        return parser_unexpected_error;
+    }
+    // little-endian value bytes, turned big-endian for readu256BEBytes
+    uint8_t be[UINT256_BYTES] = {0};
+    uint8_t len = 0;
+    switch (encoded[0] & 0x03) {
+        case 0:
+            be[0] = encoded[0] >> 2;
+            len = 1;
+            break;
+        case 1:
+        case 2: {
+            len = (encoded[0] & 0x03) == 1 ? 2 : 4;
+            if (encodedLen != len) {
+                return parser_unexpected_value;
+            }
+            uint32_t v = 0;
+            for (uint8_t i = 0; i < len; i++) {
+                v |= (uint32_t)encoded[i] << (8 * i);
+            }
+            v >>= 2;
+            for (uint8_t i = 0; i < len; i++) {
+                be[len - 1 - i] = (uint8_t)(v >> (8 * i));
+            }
+            break;
+        }
+        default:
+            len = (encoded[0] >> 2) + 4;
+            if (encodedLen != len + 1 || len > UINT256_BYTES) {
+                return parser_unexpected_value;
+            }
+            for (uint8_t i = 0; i < len; i++) {
+                be[len - 1 - i] = encoded[1 + i];
+            }
+            break;
+    }
+    if ((encoded[0] & 0x03) == 0 && encodedLen != 1) {
+        return parser_unexpected_value;
+    }
+    return readu256BEBytes(be, len, value);
+}
+
+static parser_error_t readArg(parser_context_t *ctx, uint8_t type, scale_span_t *span) {
+    switch (type) {
+        case scale_arg_account: {
+            // MultiAddress: only the Id variant names an account that can be shown
+            uint8_t variant = 0;
+            CHECK_ERROR(readUInt8(ctx, &variant))
+            if (variant != 0) {
+                return parser_invalid_address;
+            }
+            return readBytes(ctx, SCALE_ACCOUNT_ID_LEN, span);
+        }
+        case scale_arg_compact_balance:
+            return _readCompactInt(ctx, SCALE_BALANCE_LEN, span);
+        case scale_arg_balance:
+            return readBytes(ctx, SCALE_BALANCE_LEN, span);
+        case scale_arg_bool:
+            CHECK_ERROR(readBytes(ctx, 1, span))
+            return ctx->buffer[span->offset] <= 1 ? parser_ok : parser_unexpected_value;
+        default:
+            return parser_unexpected_type;
+    }
+}
+
+static parser_error_t findCall(parser_context_t *ctx, uint8_t *callIdx) {
+    uint8_t pallet = 0;
+    uint8_t method = 0;
+    CHECK_ERROR(readUInt8(ctx, &pallet))
+    CHECK_ERROR(readUInt8(ctx, &method))
+
+    for (uint8_t i = 0; i < CALLS_COUNT; i++) {
+        const scale_call_def_t *def = _getCallDef(i);
+        if (def->pallet == pallet && def->method == method) {
+            *callIdx = i;
+            return parser_ok;
+        }
+    }
+    return parser_unexpected_method;
+}
+
+static parser_error_t readCall(parser_context_t *ctx, parser_call_t *call) {
+    CHECK_ERROR(findCall(ctx, &call->callIdx))
+    const scale_call_def_t *def = _getCallDef(call->callIdx);
+    for (uint8_t arg = 0; arg < def->numArgs; arg++) {
+        CHECK_ERROR(readArg(ctx, def->argTypes[arg], &call->args[arg]))
+    }
+    return parser_ok;
+}
+
+parser_error_t _callIdxAt(const parser_context_t *ctx, uint16_t offset, uint8_t *callIdx) {
+    if (ctx == NULL || callIdx == NULL) {
+        return parser_unexpected_error;
+    }
+    parser_context_t cursor = *ctx;
+    cursor.offset = offset;
+    return findCall(&cursor, callIdx);
+}
+
+parser_error_t _readCallAt(const parser_context_t *ctx, uint16_t offset, parser_call_t *call) {
+    if (ctx == NULL || call == NULL) {
+        return parser_unexpected_error;
+    }
+    parser_context_t cursor = *ctx;
+    cursor.offset = offset;
+    return readCall(&cursor, call);
+}
+
+static parser_error_t readBatch(parser_context_t *ctx, parser_tx_t *tx_obj) {
+    scale_span_t countSpan = {0};
+    uint256_t count = {0};
+    CHECK_ERROR(_readCompactInt(ctx, sizeof(uint32_t), &countSpan))
+    CHECK_ERROR(_decodeCompact(ctx->buffer + countSpan.offset, countSpan.len, &count))
+    if (count.elements[1].elements[1] == 0 || count.elements[1].elements[1] > PARSER_MAX_BATCH_CALLS) {
+        return parser_unexpected_number_items;
+    }
+    tx_obj->numCalls = (uint8_t)count.elements[1].elements[1];
+    tx_obj->batchItems = 0;
+
+    // validation pass: every call is checked once, then only its offset is kept
+    parser_call_t call = {0};
+    for (uint8_t i = 0; i < tx_obj->numCalls; i++) {
+        tx_obj->callOffsets[i] = ctx->offset;
+        CHECK_ERROR(readCall(ctx, &call))
+        // inner calls are shown flat: no nested batches
+        if (_isBatchCall(call.callIdx)) {
+            return parser_unexpected_method;
+        }
+        tx_obj->batchItems += 1 + _getCallDef(call.callIdx)->numArgs;
+    }
+    return parser_ok;
+}
+
+static parser_error_t readEra(parser_context_t *ctx, scale_span_t *era) {
+    uint8_t first = 0;
+    const uint16_t start = ctx->offset;
+    CHECK_ERROR(readUInt8(ctx, &first))
+    if (first != 0) {
+        // mortal: period is 2^(low 4 bits + 1), phase is quantized to period / 4096
+        uint8_t second = 0;
+        CHECK_ERROR(readUInt8(ctx, &second))
+        const uint16_t encoded = (uint16_t)(first | second << 8);
+        const uint32_t period = 2u << (encoded % 16);
+        const uint32_t quantize = MAX(period >> 12, 1);
+        const uint32_t phase = (uint32_t)(encoded >> 4) * quantize;
+        if (period < 4 || phase >= period) {
+            return parser_unexpected_value;
+        }
+    }
+    era->offset = start;
+    era->len = ctx->offset - start;
+    return parser_ok;
+}
+
+parser_error_t _readTx(parser_context_t *ctx, parser_tx_t *tx_obj) {
+    if (ctx == NULL || tx_obj == NULL) {
+        return parser_unexpected_error;
+    }
+
+    CHECK_ERROR(readCall(ctx, &tx_obj->call))
+    if (_isBatchCall(tx_obj->call.callIdx)) {
+        CHECK_ERROR(readBatch(ctx, tx_obj))
+    }
+
+    scale_span_t span = {0};
+    CHECK_ERROR(readEra(ctx, &tx_obj->era))
+    CHECK_ERROR(_readCompactInt(ctx, sizeof(uint64_t), &tx_obj->nonce))
+    CHECK_ERROR(_readCompactInt(ctx, SCALE_BALANCE_LEN, &tx_obj->tip))
+    if (tx_obj->checkMetadataHash) {
+        // the proof is only meaningful when the signature commits to the hash
+        uint8_t mode = 0;
+        CHECK_ERROR(readUInt8(ctx, &mode))
+        if (mode != 1) {
+            return parser_unexpected_value;
+        }
+    }
+
+    CHECK_ERROR(readBytes(ctx, sizeof(uint32_t), &span))
+    tx_obj->specVersionOffset = span.offset;
+    CHECK_ERROR(readBytes(ctx, sizeof(uint32_t), &span))
+    tx_obj->txVersionOffset = span.offset;
+    CHECK_ERROR(readBytes(ctx, SCALE_HASH_LEN, &span))
+    tx_obj->genesisHashOffset = span.offset;
+    CHECK_ERROR(readBytes(ctx, SCALE_HASH_LEN, &span))
+    tx_obj->blockHashOffset = span.offset;
+    if (tx_obj->checkMetadataHash) {
+        uint8_t some = 0;
+        CHECK_ERROR(readUInt8(ctx, &some))
+        if (some != 1) {
+            return parser_unexpected_value;
+        }
+        CHECK_ERROR(readBytes(ctx, SCALE_HASH_LEN, &span))
+        tx_obj->metadataHashOffset = span.offset;
+    }
+
+    // everything that is signed must be shown
+    if (ctx->offset != ctx->bufferLen) {
+        return parser_unexpected_characters;
+    }
+    return parser_ok;
+}
@@ -15,16 +15,70 @@
  ********************************************************************************/
 #pragma once
 
+#include <stdbool.h>
 #include <zxmacros.h>
 
 #include "parser_common.h"
 #include "parser_txdef.h"
+#include "uint256.h"
 #include "zxtypes.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Pallet indices of the peaq runtime; builds for another runtime version can override them
+#ifndef PALLET_BALANCES
+#define PALLET_BALANCES 5
+#endif
+#ifndef PALLET_UTILITY
+#define PALLET_UTILITY 21
+#endif
+#ifndef PALLET_PARACHAIN_STAKING
+#define PALLET_PARACHAIN_STAKING 23
+#endif
+
+#define SCALE_ACCOUNT_ID_LEN 32
+#define SCALE_BALANCE_LEN    16
+#define SCALE_HASH_LEN       32
+
+typedef enum {
+    scale_arg_account = 0,
+    scale_arg_compact_balance,
+    scale_arg_balance,
+    scale_arg_bool,
+} scale_arg_e;
+
+typedef struct {
+    uint8_t pallet;
+    uint8_t method;
+    char palletName[18];
+    char name[22];
+    uint8_t numArgs;
+    uint8_t argTypes[PARSER_MAX_CALL_ARGS];
+    char argNames[PARSER_MAX_CALL_ARGS][12];
+} scale_call_def_t;
+
+/// \return the definition of a supported call, NULL past the end of the table
+const scale_call_def_t *_getCallDef(uint8_t callIdx);
+
+/// \return true for the utility calls that carry a list of inner calls
+bool _isBatchCall(uint8_t callIdx);
+
+/// Reads a compact integer of at most maxBytes value bytes; only the canonical encoding is accepted
+parser_error_t _readCompactInt(parser_context_t *ctx, uint8_t maxBytes, scale_span_t *span);
+
+/// Looks up the call encoded at offset, without reading its arguments
+parser_error_t _callIdxAt(const parser_context_t *ctx, uint16_t offset, uint8_t *callIdx);
+
+/// Decodes the call encoded at offset, as recorded in parser_tx_t.callOffsets
+parser_error_t _readCallAt(const parser_context_t *ctx, uint16_t offset, parser_call_t *call);
+
+/// Decodes a compact integer read by _readCompactInt
+parser_error_t _decodeCompact(const uint8_t *encoded, uint16_t encodedLen, uint256_t *value);
+
+parser_error_t _readTx(parser_context_t *ctx, parser_tx_t *tx_obj);
+
 #ifdef __cplusplus
 }
 #endif
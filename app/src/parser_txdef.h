@@ -22,10 +22,44 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+// Substrate signing payload: call, signed extensions, then the additional signed data.
+// Nothing is copied out of the transaction buffer: every field is an offset into it.
+#define PARSER_MAX_CALL_ARGS   2
+#define PARSER_MAX_BATCH_CALLS 50
+
+/// Encoded bytes of a field, relative to the start of the transaction buffer
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} scale_span_t;
+
 typedef struct {
-    uint8_t txn_param_0;
-    uint8_t txn_param_1;
-    uint8_t txn_param_N;
+    // position in the supported call table
+    uint8_t callIdx;
+    scale_span_t args[PARSER_MAX_CALL_ARGS];
+} parser_call_t;
+
+typedef struct {
+    parser_call_t call;
+    // inner calls when call is a utility batch: only their position is kept,
+    // each one is decoded again when it is shown
+    uint8_t numCalls;
+    uint16_t callOffsets[PARSER_MAX_BATCH_CALLS];
+    // review items of all the inner calls
+    uint8_t batchItems;
+
+    scale_span_t era;
+    scale_span_t nonce;
+    scale_span_t tip;
+    uint16_t specVersionOffset;
+    uint16_t txVersionOffset;
+    uint16_t genesisHashOffset;
+    uint16_t blockHashOffset;
+
+    // CheckMetadataHash: set before parsing when a metadata proof was uploaded, the
+    // payload then carries the mode byte and the metadata hash the signature commits to
+    uint8_t checkMetadataHash;
+    uint16_t metadataHashOffset;
 } parser_tx_t;
 
 #ifdef __cplusplus
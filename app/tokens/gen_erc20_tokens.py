@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Generates app/src/evm/erc20_tokens.h from erc20.json.
+
+The table is sorted by contract address so the app can look tokens up with a
+binary search. Run it after editing erc20.json, or with --check in CI to make
+sure the checked in header is up to date.
+"""
+
+import argparse
+import json
+import pathlib
+import sys
+
+HERE = pathlib.Path(__file__).resolve().parent
+SOURCE = HERE / "erc20.json"
+TARGET = HERE.parent / "src" / "evm" / "erc20_tokens.h"
+
+# keep in sync with ERC20_SYMBOL_STORED_LEN in evm_erc20.h
+SYMBOL_MAX_LEN = 8
+
+HEADER = """/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+// Generated by app/tokens/gen_erc20_tokens.py from app/tokens/erc20.json, do not edit.
+// Sorted by contract address.
+#pragma once
+
+#include "evm_erc20.h"
+
+static const erc20_tokens_t supportedTokens[] = {
+"""
+
+
+def load_tokens():
+    tokens = json.loads(SOURCE.read_text())
+    seen = set()
+    for token in tokens:
+        address = token["address"].lower().removeprefix("0x")
+        if len(address) != 40:
+            sys.exit(f"{token['symbol']}: address must be 20 bytes")
+        if address in seen:
+            sys.exit(f"{token['symbol']}: duplicated address")
+        seen.add(address)
+        symbol = token["symbol"]
+        if not 0 < len(symbol) <= SYMBOL_MAX_LEN or not symbol.isascii() or not symbol.isprintable():
+            sys.exit(f"{symbol}: symbol must be 1 to {SYMBOL_MAX_LEN} printable characters")
+        if not 0 <= token["decimals"] <= 36:
+            sys.exit(f"{symbol}: unexpected decimals")
+        token["address"] = address
+    return sorted(tokens, key=lambda token: token["address"])
+
+
+def render(tokens):
+    lines = [HEADER]
+    for token in tokens:
+        address = bytes.fromhex(token["address"])
+        first = ", ".join(f"0x{b:02x}" for b in address[:10])
+        second = ", ".join(f"0x{b:02x}" for b in address[10:])
+        lines.append(f"    {{{{{first},\n      {second}}},\n     {token['decimals']},\n     \"{token['symbol']}\"}},\n")
+    lines.append("};\n")
+    return "".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--check", action="store_true", help="fail if the header is not up to date")
+    args = parser.parse_args()
+
+    output = render(load_tokens())
+    if args.check:
+        if not TARGET.exists() or TARGET.read_text() != output:
+            sys.exit(f"{TARGET} is out of date, run {pathlib.Path(__file__).name}")
+        return
+    TARGET.write_text(output)
+
+
+if __name__ == "__main__":
+    main()
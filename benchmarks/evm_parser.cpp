@@ -0,0 +1,219 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+// Host microbenchmarks for the EVM parser and the formatting hot paths.
+// Every blob of tests/evm.json is replayed, grouped by transaction type.
+
+#include <benchmark/benchmark.h>
+#include <hexutils.h>
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "coin_evm.h"
+#include "evm_utils.h"
+#include "parser_evm.h"
+#include "uint256.h"
+
+namespace {
+
+enum TxType { TX_LEGACY = 0, TX_EIP2930, TX_EIP1559, TX_TYPES };
+
+const char *kTypeNames[TX_TYPES] = {"legacy", "eip2930", "eip1559"};
+
+using Blob = std::vector<uint8_t>;
+
+const std::vector<Blob> &blobs(TxType type) {
+    static std::vector<Blob> byType[TX_TYPES];
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        std::ifstream inFile(std::string(TESTVECTORS_DIR) + "evm.json");
+        if (inFile.is_open()) {
+            const nlohmann::json obj = nlohmann::json::parse(inFile);
+            for (const auto &tc : obj) {
+                const auto hex = tc["encoded_tx_hex"].get<std::string>();
+                Blob blob(hex.size() / 2);
+                blob.resize(parseHexString(blob.data(), blob.size(), hex.c_str()));
+                if (blob.empty()) {
+                    continue;
+                }
+                const TxType txType = blob[0] == 0x01 ? TX_EIP2930 : blob[0] == 0x02 ? TX_EIP1559 : TX_LEGACY;
+                byType[txType].push_back(blob);
+            }
+        }
+    }
+    return byType[type];
+}
+
+size_t totalBytes(const std::vector<Blob> &set) {
+    size_t total = 0;
+    for (const auto &blob : set) {
+        total += blob.size();
+    }
+    return total;
+}
+
+bool prepare(benchmark::State &state, TxType type) {
+    app_mode_set_blindsign(true);
+    if (blobs(type).empty()) {
+        state.SkipWithError("no test vectors");
+        return false;
+    }
+    state.SetLabel(kTypeNames[type]);
+    return true;
+}
+
+void BM_ParseEth(benchmark::State &state) {
+    const TxType type = static_cast<TxType>(state.range(0));
+    if (!prepare(state, type)) {
+        return;
+    }
+    const auto &set = blobs(type);
+    parser_context_t ctx = {};
+    for (auto _ : state) {
+        for (const auto &blob : set) {
+            benchmark::DoNotOptimize(parser_parse_eth(&ctx, blob.data(), blob.size()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * set.size());
+    state.SetBytesProcessed(state.iterations() * totalBytes(set));
+}
+
+// validation formats every item once and fills the render cache
+void BM_ValidateEth(benchmark::State &state) {
+    const TxType type = static_cast<TxType>(state.range(0));
+    if (!prepare(state, type)) {
+        return;
+    }
+    const auto &set = blobs(type);
+    parser_context_t ctx = {};
+    for (auto _ : state) {
+        for (const auto &blob : set) {
+            parser_parse_eth(&ctx, blob.data(), blob.size());
+            benchmark::DoNotOptimize(parser_validate_eth(&ctx));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * set.size());
+    state.SetBytesProcessed(state.iterations() * totalBytes(set));
+}
+
+// one call per displayed page, as the UI does while the user scrolls
+void BM_GetItemEthPage(benchmark::State &state) {
+    const TxType type = static_cast<TxType>(state.range(0));
+    if (!prepare(state, type)) {
+        return;
+    }
+    const auto &set = blobs(type);
+    parser_context_t ctx = {};
+    char key[40];
+    char value[40];
+    int64_t pages = 0;
+    for (auto _ : state) {
+        for (const auto &blob : set) {
+            state.PauseTiming();
+            parser_parse_eth(&ctx, blob.data(), blob.size());
+            uint8_t numItems = 0;
+            parser_getNumItemsEth(&ctx, &numItems);
+            state.ResumeTiming();
+
+            for (uint8_t idx = 0; idx < numItems; idx++) {
+                uint8_t pageCount = 1;
+                for (uint8_t page = 0; page < pageCount; page++) {
+                    parser_getItemEth(&ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount);
+                    pages++;
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(pages);
+}
+
+void BM_Tostring256(benchmark::State &state) {
+    // 2^256 - 1: the longest decimal string
+    uint256_t value = {};
+    UPPER(UPPER(value)) = UINT64_MAX;
+    LOWER(UPPER(value)) = UINT64_MAX;
+    UPPER(LOWER(value)) = UINT64_MAX;
+    LOWER(LOWER(value)) = UINT64_MAX;
+    char out[100];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tostring256(&value, 10, out, sizeof(out)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PrintBigIntFixedPoint(benchmark::State &state) {
+    // 32-byte amount shown with 18 decimals
+    uint8_t amount[32];
+    for (uint8_t i = 0; i < sizeof(amount); i++) {
+        amount[i] = static_cast<uint8_t>(0x11 * (i % 15 + 1));
+    }
+    char out[100];
+    uint8_t pageCount = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            printBigIntFixedPoint(amount, sizeof(amount), out, sizeof(out), 0, &pageCount, COIN_DECIMALS));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PageHex(benchmark::State &state) {
+    // a page from the middle of 4 KB of calldata
+    std::vector<uint8_t> data(4096);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    char out[100];
+    uint8_t pageCount = 0;
+    for (auto _ : state) {
+        pageHex(out, sizeof(out), "0x", data.data(), data.size(), 40, &pageCount);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * (sizeof(out) - 1));
+}
+
+void BM_PageEVMAddress(benchmark::State &state) {
+    // every page of one address, lowercase or EIP-55 (hashed once, the host Keccak is a no-op)
+    const bool checksum = state.range(0) != 0;
+    uint8_t address[ETH_ADDR_LEN];
+    for (uint8_t i = 0; i < sizeof(address); i++) {
+        address[i] = static_cast<uint8_t>(0x5a + 13 * i);
+    }
+    char out[18];
+    for (auto _ : state) {
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < pageCount; page++) {
+            benchmark::DoNotOptimize(pageEVMAddress(out, sizeof(out), address, checksum, page, &pageCount));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParseEth)->DenseRange(TX_LEGACY, TX_EIP1559);
+BENCHMARK(BM_ValidateEth)->DenseRange(TX_LEGACY, TX_EIP1559);
+BENCHMARK(BM_GetItemEthPage)->DenseRange(TX_LEGACY, TX_EIP1559);
+BENCHMARK(BM_Tostring256);
+BENCHMARK(BM_PrintBigIntFixedPoint);
+BENCHMARK(BM_PageHex);
+BENCHMARK(BM_PageEVMAddress)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+// Scaling benchmarks over tests/evm_scaling.json (tests/gen_evm_scaling.py).
+// One benchmark per corpus family and phase, with one run per transaction. The
+// runs of a family are fitted against the size the generator recorded, so a
+// super-linear parser, formatter or pager shows up as a worse big-O than O(N).
+
+#include <benchmark/benchmark.h>
+#include <hexutils.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "parser_evm.h"
+
+namespace {
+
+struct Case {
+    std::string name;
+    int64_t size;
+    std::vector<uint8_t> blob;
+};
+
+using Family = std::vector<Case>;
+
+// valid transactions by family, and the rejected ones on their own
+std::map<std::string, Family> loadCorpus() {
+    std::map<std::string, Family> families;
+    std::ifstream inFile(std::string(TESTVECTORS_DIR) + "evm_scaling.json");
+    if (!inFile.is_open()) {
+        return families;
+    }
+    const nlohmann::json obj = nlohmann::json::parse(inFile);
+    for (const auto &tc : obj) {
+        const auto hex = tc["encoded_tx_hex"].get<std::string>();
+        Case c = {tc["description"].get<std::string>(), tc["size"].get<int64_t>(), std::vector<uint8_t>(hex.size() / 2)};
+        c.blob.resize(parseHexString(c.blob.data(), c.blob.size(), hex.c_str()));
+        const std::string family = tc["valid"].get<bool>() ? tc["family"].get<std::string>() : "rejected";
+        families[family].push_back(c);
+    }
+    return families;
+}
+
+const Case &select(benchmark::State &state, const Family *family) {
+    app_mode_set_blindsign(true);
+    const Case &c = (*family)[state.range(0)];
+    state.SetLabel(c.name);
+    // the corpus starts at size 0, a fit needs N > 0
+    state.SetComplexityN(std::max<int64_t>(c.size, 1));
+    return c;
+}
+
+void BM_ParseEthScaling(benchmark::State &state, const Family *family) {
+    const Case &c = select(state, family);
+    parser_context_t ctx = {};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser_parse_eth(&ctx, c.blob.data(), c.blob.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * c.blob.size());
+}
+
+void BM_ValidateEthScaling(benchmark::State &state, const Family *family) {
+    const Case &c = select(state, family);
+    parser_context_t ctx = {};
+    for (auto _ : state) {
+        parser_parse_eth(&ctx, c.blob.data(), c.blob.size());
+        benchmark::DoNotOptimize(parser_validate_eth(&ctx));
+    }
+    state.SetBytesProcessed(state.iterations() * c.blob.size());
+}
+
+// every page of every item, as a user scrolling through the whole review
+void BM_ReviewEthScaling(benchmark::State &state, const Family *family) {
+    const Case &c = select(state, family);
+    parser_context_t ctx = {};
+    parser_parse_eth(&ctx, c.blob.data(), c.blob.size());
+    uint8_t numItems = 0;
+    parser_getNumItemsEth(&ctx, &numItems);
+    char key[40];
+    char value[40];
+    int64_t pages = 0;
+    for (auto _ : state) {
+        for (uint8_t idx = 0; idx < numItems; idx++) {
+            uint8_t pageCount = 1;
+            for (uint8_t page = 0; page < pageCount; page++) {
+                parser_getItemEth(&ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount);
+                pages++;
+            }
+        }
+    }
+    state.SetItemsProcessed(pages);
+}
+
+bool registerScaling() {
+    static const std::map<std::string, Family> families = loadCorpus();
+    for (const auto &entry : families) {
+        const Family *family = &entry.second;
+        std::set<int64_t> sizes;
+        for (const auto &c : *family) {
+            sizes.insert(c.size);
+        }
+        // rejected transactions stop at parsing
+        const bool rejected = entry.first == "rejected";
+        std::vector<std::pair<const char *, void (*)(benchmark::State &, const Family *)>> phases = {
+            {"BM_ParseEthScaling", BM_ParseEthScaling}};
+        if (!rejected) {
+            phases.push_back({"BM_ValidateEthScaling", BM_ValidateEthScaling});
+            phases.push_back({"BM_ReviewEthScaling", BM_ReviewEthScaling});
+        }
+        for (const auto &phase : phases) {
+            const std::string name = std::string(phase.first) + "/" + entry.first;
+            auto *bm = benchmark::RegisterBenchmark(name.c_str(), phase.second, family)
+                           ->DenseRange(0, static_cast<int64_t>(family->size()) - 1);
+            // a fit needs the size to vary
+            if (sizes.size() > 2) {
+                bm->Complexity();
+            }
+        }
+    }
+    return true;
+}
+
+const bool kRegistered = registerScaling();
+
+}  // namespace
@@ -0,0 +1,259 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+// Replays APDU sessions through the host simulator of the handler stack, so
+// chunking, parsing, review rendering and signing run as on the device.
+//
+// Recorded sessions are read from REPLAY_DIR (default benchmarks/sessions), one
+// session per *.apdu file and per block of lines separated by a blank line:
+//   => <command hex>
+//   <= <reply hex, status word included>
+// Lines starting with # are comments. Signatures and keys of the simulator are
+// placeholders, so only the status word and the length of every reply are
+// checked. Sessions made of the test vectors are replayed as well.
+
+#include <benchmark/benchmark.h>
+#include <dirent.h>
+#include <hexutils.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "coin_evm.h"
+#include "sim.h"
+
+namespace {
+
+using Blob = std::vector<uint8_t>;
+
+struct Exchange {
+    Blob command;
+    Blob reply;
+};
+
+struct Session {
+    std::string name;
+    std::vector<Exchange> exchanges;
+};
+
+constexpr uint16_t kSwOk = 0x9000;
+constexpr uint16_t kSwRejected = 0x6986;
+constexpr size_t kChunkSize = 250;
+
+// 44'/60'/0'/0/0, hw-app-eth serialization
+const Blob kEthPath = {0x05, 0x80, 0x00, 0x00, 0x2c, 0x80, 0x00, 0x00, 0x3c, 0x80, 0x00,
+                       0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+Blob fromHex(const std::string &hex) {
+    Blob blob(hex.size() / 2);
+    blob.resize(parseHexString(blob.data(), blob.size(), hex.c_str()));
+    return blob;
+}
+
+uint16_t statusWord(const Blob &reply) {
+    return reply.size() < 2 ? 0 : static_cast<uint16_t>(reply[reply.size() - 2] << 8 | reply.back());
+}
+
+void loadSessionFile(const std::string &path, std::vector<Session> *sessions) {
+    std::ifstream in(path);
+    std::string line;
+    Session session = {path, {}};
+    uint32_t lineNo = 0;
+    const auto flush = [&]() {
+        if (!session.exchanges.empty()) {
+            sessions->push_back(session);
+        }
+        session = {path + ":" + std::to_string(lineNo + 1), {}};
+    };
+    while (std::getline(in, line)) {
+        lineNo++;
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+        if (line.empty()) {
+            flush();
+        } else if (line.rfind("=> ", 0) == 0) {
+            session.exchanges.push_back({fromHex(line.substr(3)), {}});
+        } else if (line.rfind("<= ", 0) == 0 && !session.exchanges.empty()) {
+            session.exchanges.back().reply = fromHex(line.substr(3));
+        }
+    }
+    flush();
+}
+
+std::vector<Session> loadRecorded() {
+    const char *env = std::getenv("REPLAY_DIR");
+    const std::string dir = env != nullptr ? env : std::string(SESSIONS_DIR);
+    std::vector<std::string> files;
+    if (DIR *handle = opendir(dir.c_str())) {
+        while (const dirent *entry = readdir(handle)) {
+            const std::string name = entry->d_name;
+            if (name.size() > 5 && name.compare(name.size() - 5, 5, ".apdu") == 0) {
+                files.push_back(dir + "/" + name);
+            }
+        }
+        closedir(handle);
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<Session> sessions;
+    for (const auto &file : files) {
+        loadSessionFile(file, &sessions);
+    }
+    return sessions;
+}
+
+Blob apdu(uint8_t ins, uint8_t p1, uint8_t p2, const uint8_t *data, size_t len) {
+    Blob command = {CLA_ETH, ins, p1, p2, static_cast<uint8_t>(len)};
+    command.insert(command.end(), data, data + len);
+    return command;
+}
+
+// Splits [path][payload] the way the JS client does: the path and the start of
+// the payload in the first chunk, then chunks of kChunkSize
+Session chunked(const std::string &name, uint8_t ins, const Blob &payload) {
+    Blob data = kEthPath;
+    data.insert(data.end(), payload.begin(), payload.end());
+    Session session = {name, {}};
+    for (size_t offset = 0; offset < data.size(); offset += kChunkSize) {
+        const size_t len = std::min(kChunkSize, data.size() - offset);
+        const uint8_t p1 = offset == 0 ? P1_ETH_FIRST : P1_ETH_MORE;
+        session.exchanges.push_back({apdu(ins, p1, P2_ETH_SIG_COMPACT, data.data() + offset, len), {}});
+    }
+    return session;
+}
+
+std::vector<Session> synthesize() {
+    std::vector<Session> sessions;
+    for (const uint8_t confirm : {0, 1}) {
+        const Blob command = apdu(INS_GET_ADDR_ETH, confirm, P2_NO_CHAINCODE, kEthPath.data(), kEthPath.size());
+        sessions.push_back({confirm != 0 ? "get_addr_confirm" : "get_addr", {{command, {}}}});
+    }
+
+    std::ifstream inFile(std::string(TESTVECTORS_DIR) + "evm.json");
+    if (inFile.is_open()) {
+        const nlohmann::json obj = nlohmann::json::parse(inFile);
+        for (size_t idx = 0; idx < obj.size(); idx++) {
+            const Blob blob = fromHex(obj[idx]["encoded_tx_hex"].get<std::string>());
+            if (!blob.empty()) {
+                sessions.push_back(chunked("sign_eth/" + std::to_string(idx), INS_SIGN_ETH, blob));
+            }
+        }
+    }
+
+    for (const uint32_t len : {32u, 1024u, 8000u}) {
+        // [message length (4, BE)] [message]
+        Blob payload = {static_cast<uint8_t>(len >> 24), static_cast<uint8_t>(len >> 16), static_cast<uint8_t>(len >> 8),
+                        static_cast<uint8_t>(len)};
+        for (uint32_t i = 0; i < len; i++) {
+            payload.push_back(static_cast<uint8_t>('a' + i % 26));
+        }
+        sessions.push_back(chunked("personal_sign/" + std::to_string(len), INS_SIGN_PERSONAL_MESSAGE, payload));
+    }
+    return sessions;
+}
+
+void resetDevice() {
+    sim_init();
+    // recorded sessions may need any of the settings a user can toggle
+    app_mode_set_blindsign(true);
+    app_mode_set_expert(true);
+}
+
+// Runs a session, checking the replies against the expected ones if there are any
+bool replay(Session *session, bool learn, std::string *error) {
+    resetDevice();
+    uint8_t reply[260];
+    for (size_t i = 0; i < session->exchanges.size(); i++) {
+        Exchange &exchange = session->exchanges[i];
+        sim_set_approval(statusWord(exchange.reply) != kSwRejected);
+        const uint16_t replyLen = sim_exchange(exchange.command.data(), static_cast<uint16_t>(exchange.command.size()),
+                                               reply, sizeof(reply));
+        const Blob actual(reply, reply + replyLen);
+        if (learn) {
+            exchange.reply = actual;
+            continue;
+        }
+        if (statusWord(actual) != statusWord(exchange.reply) || actual.size() != exchange.reply.size()) {
+            char detail[64];
+            snprintf(detail, sizeof(detail), " exchange %zu: %04x (%zu bytes), expected %04x (%zu bytes)", i,
+                     statusWord(actual), actual.size(), statusWord(exchange.reply), exchange.reply.size());
+            *error = session->name + detail;
+            return false;
+        }
+    }
+    return true;
+}
+
+void BM_Replay(benchmark::State &state, std::vector<Session> *sessions) {
+    size_t bytes = 0;
+    size_t exchanges = 0;
+    size_t completed = 0;
+    for (const auto &session : *sessions) {
+        for (const auto &exchange : session.exchanges) {
+            bytes += exchange.command.size();
+            completed += statusWord(exchange.reply) == kSwOk ? 1 : 0;
+        }
+        exchanges += session.exchanges.size();
+    }
+
+    uint64_t pages = 0;
+    std::string error;
+    for (auto _ : state) {
+        for (auto &session : *sessions) {
+            if (!replay(&session, false, &error)) {
+                state.SkipWithError(error.c_str());
+                return;
+            }
+            // sim_init clears the page counter
+            pages += sim_rendered_pages();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * exchanges);
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["sessions"] = static_cast<double>(sessions->size());
+    state.counters["ok_replies"] = static_cast<double>(completed);
+    state.counters["pages"] = benchmark::Counter(static_cast<double>(pages), benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    static std::vector<Session> recorded = loadRecorded();
+    static std::vector<Session> synthetic = synthesize();
+
+    // the simulator is deterministic: the first run gives the replies to expect
+    std::string error;
+    for (auto &session : synthetic) {
+        replay(&session, true, &error);
+    }
+
+    if (!recorded.empty()) {
+        benchmark::RegisterBenchmark("BM_Replay/recorded", BM_Replay, &recorded);
+    }
+    benchmark::RegisterBenchmark("BM_Replay/test_vectors", BM_Replay, &synthetic);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+// Host stand-in for the cx API used by the app. Keccak and BLAKE2b are real
+// software implementations, so hashing costs what it costs on the host. Key
+// derivation and signatures are deterministic placeholders: they keep the
+// reply sizes and the control flow of the device, not its cryptography.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t cx_err_t;
+
+#define CX_OK                0x00000000
+#define CX_INVALID_PARAMETER 0xFFFFFF84
+
+#define CX_LAST               (1 << 0)
+#define CX_RND_RFC6979        (3 << 9)
+#define CX_ECCINFO_PARITY_ODD 1
+
+#define CX_SHA256_SIZE    32
+#define CX_RIPEMD160_SIZE 20
+
+typedef enum {
+    CX_NONE = 0,
+    CX_SHA256 = 3,
+    CX_SHA512 = 5,
+    CX_KECCAK = 6,
+    CX_BLAKE2B = 9,
+} cx_md_t;
+
+typedef enum {
+    CX_CURVE_NONE = 0,
+    CX_CURVE_256K1 = 0x21,
+    CX_CURVE_Ed25519 = 0x71,
+} cx_curve_t;
+
+typedef struct {
+    cx_md_t algo;
+} cx_hash_t;
+
+typedef struct {
+    cx_hash_t header;
+    size_t output_size;
+    size_t block_size;
+    size_t blen;
+    uint8_t block[200];
+    uint64_t acc[25];
+} cx_sha3_t;
+
+typedef struct {
+    cx_hash_t header;
+    size_t output_size;
+    uint64_t h[8];
+    uint64_t t[2];
+    uint8_t buf[128];
+    size_t buflen;
+} cx_blake2b_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[32];
+} cx_ecfp_private_key_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[65];
+} cx_ecfp_public_key_t;
+
+#ifndef CATCH_CXERROR
+#define CATCH_CXERROR(CALL)          \
+    do {                             \
+        cx_err_t __cx_err = CALL;    \
+        if (__cx_err != CX_OK) {     \
+            goto catch_cx_error;     \
+        }                            \
+    } while (0)
+#endif
+
+cx_err_t cx_keccak_init_no_throw(cx_sha3_t *hash, size_t size);
+cx_err_t cx_blake2b_init_no_throw(cx_blake2b_t *hash, size_t size);
+cx_err_t cx_hash_no_throw(cx_hash_t *hash, uint32_t mode, const uint8_t *in, size_t len, uint8_t *out, size_t out_len);
+size_t cx_hash_sha256(const uint8_t *in, size_t len, uint8_t *out, size_t out_len);
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve, const uint8_t *rawkey, size_t key_len,
+                                           cx_ecfp_private_key_t *pvkey);
+cx_err_t cx_ecfp_init_public_key_no_throw(cx_curve_t curve, const uint8_t *rawkey, size_t key_len,
+                                          cx_ecfp_public_key_t *key);
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve, cx_ecfp_public_key_t *pubkey, cx_ecfp_private_key_t *privkey,
+                                        bool keepprivate);
+cx_err_t cx_ecdsa_sign_rs_no_throw(const cx_ecfp_private_key_t *key, uint32_t mode, cx_md_t hashID, const uint8_t *hash,
+                                   size_t hash_len, size_t rs_len, uint8_t *sig_r, uint8_t *sig_s, uint32_t *info);
+cx_err_t cx_eddsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey, cx_md_t hashID, const uint8_t *hash,
+                                size_t hash_len, uint8_t *sig, size_t sig_len);
+bool cx_ecdsa_verify_no_throw(const cx_ecfp_public_key_t *pukey, const uint8_t *hash, size_t hash_len,
+                              const uint8_t *sig, size_t sig_len);
+
+#ifdef __cplusplus
+}
+#endif
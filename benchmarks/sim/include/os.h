@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+// Host stand-in for the parts of the Ledger SDK used by the handler stack. The
+// APDU buffer, exceptions and NVM behave as on the device; the I/O side is
+// driven by sim.h instead of the SE proxy.
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bolos_target.h"
+#include "cx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PIC
+#define PIC(x) (x)
+#endif
+
+#define IO_APDU_BUFFER_SIZE 260
+extern uint8_t G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+#define CHANNEL_APDU       0x00
+#define IO_RETURN_AFTER_TX 0x20
+#define IO_ASYNCH_REPLY    0x10
+
+#define BOLOS_UX_OK 0xAA
+#define HDW_NORMAL  0
+
+typedef uint8_t bolos_bool_t;
+typedef uint16_t exception_t;
+
+#define EXCEPTION          1
+#define EXCEPTION_IO_RESET 0x10
+
+typedef struct try_context_s {
+    jmp_buf jmp_buf;
+    struct try_context_s *previous;
+    exception_t ex;
+} try_context_t;
+
+extern try_context_t *G_try_last_open_context;
+
+// Same shape as the SDK macros: one TRY block per function, THROW unwinds to the innermost one
+#define BEGIN_TRY                                                   \
+    {                                                               \
+        try_context_t __try_context;                                \
+        __try_context.previous = G_try_last_open_context;           \
+        G_try_last_open_context = &__try_context;                   \
+        __try_context.ex = (exception_t)setjmp(__try_context.jmp_buf);
+
+#define TRY if (__try_context.ex == 0)
+
+#define CATCH(x)                                                    \
+    else if (__try_context.ex == (x) &&                             \
+             (G_try_last_open_context = __try_context.previous, __try_context.ex = 0, true))
+
+#define CATCH_OTHER(e)                                              \
+    else for (exception_t e = __try_context.ex;                     \
+              (G_try_last_open_context = __try_context.previous, __try_context.ex = 0, e != 0); e = 0)
+
+#define FINALLY                                                     \
+    if (G_try_last_open_context == &__try_context) {                \
+        G_try_last_open_context = __try_context.previous;           \
+    }
+
+#define END_TRY }
+
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+#define THROW(x) os_longjmp(x)
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+
+bolos_bool_t os_global_pin_is_validated(void);
+
+void nvm_write(void *dst_adr, void *src_adr, unsigned int src_len);
+
+cx_err_t os_derive_bip32_no_throw(cx_curve_t curve, const uint32_t *path, size_t path_len, uint8_t *raw_privkey,
+                                  uint8_t *chain_code);
+cx_err_t os_derive_bip32_with_seed_no_throw(unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+                                            size_t path_len, uint8_t *raw_privkey, uint8_t *chain_code,
+                                            unsigned char *seed, size_t seed_len);
+
+#ifdef __cplusplus
+}
+#endif
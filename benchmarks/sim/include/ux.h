@@ -0,0 +1,36 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+#include "os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOLOS_UX_CONTINUE 0x00
+#define BOLOS_UX_IGNORE   0x97
+
+typedef struct {
+    uint8_t ux_id;
+    unsigned int len;
+} bolos_ux_params_t;
+
+extern bolos_ux_params_t G_ux_params;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+#pragma once
+
+// Host simulator of the handler stack: commands go through handleApdu exactly
+// as on the device. Reviews are walked page by page, as a user scrolling
+// through them would, and then approved or rejected.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Brings the app to the state it has after boot
+void sim_init(void);
+
+/// Decision taken on the reviews of the next commands
+void sim_set_approval(bool approve);
+
+/// Runs one command and copies the reply, status word included, to reply
+/// \return reply length, 0 if the reply does not fit
+uint16_t sim_exchange(const uint8_t *command, uint16_t commandLen, uint8_t *reply, uint16_t replyMax);
+
+/// Pages rendered by the reviews since sim_init
+uint64_t sim_rendered_pages(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,376 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <string.h>
+
+#include "cx.h"
+#include "os.h"
+
+// ---- Keccak-256, as used by cx_keccak (original padding, not SHA-3)
+
+#define KECCAK_ROUNDS 24
+
+static const uint64_t keccak_rc[KECCAK_ROUNDS] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL, 0x000000000000808bULL,
+    0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL, 0x0000000000000088ULL,
+    0x0000000080008009ULL, 0x000000008000000aULL, 0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+static const uint8_t keccak_rotc[24] = {1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
+                                        27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44};
+static const uint8_t keccak_piln[24] = {10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+                                        15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1};
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static void keccak_f(uint64_t st[25]) {
+    for (uint8_t round = 0; round < KECCAK_ROUNDS; round++) {
+        uint64_t bc[5];
+        for (uint8_t i = 0; i < 5; i++) {
+            bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+        }
+        for (uint8_t i = 0; i < 5; i++) {
+            const uint64_t t = bc[(i + 4) % 5] ^ ROTL64(bc[(i + 1) % 5], 1);
+            for (uint8_t j = 0; j < 25; j += 5) {
+                st[j + i] ^= t;
+            }
+        }
+        uint64_t t = st[1];
+        for (uint8_t i = 0; i < 24; i++) {
+            const uint8_t j = keccak_piln[i];
+            const uint64_t tmp = st[j];
+            st[j] = ROTL64(t, keccak_rotc[i]);
+            t = tmp;
+        }
+        for (uint8_t j = 0; j < 25; j += 5) {
+            for (uint8_t i = 0; i < 5; i++) {
+                bc[i] = st[j + i];
+            }
+            for (uint8_t i = 0; i < 5; i++) {
+                st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+            }
+        }
+        st[0] ^= keccak_rc[round];
+    }
+}
+
+static void keccak_absorb_block(cx_sha3_t *ctx) {
+    for (size_t i = 0; i < ctx->block_size / 8; i++) {
+        uint64_t lane = 0;
+        for (uint8_t b = 0; b < 8; b++) {
+            lane |= (uint64_t)ctx->block[8 * i + b] << (8 * b);
+        }
+        ctx->acc[i] ^= lane;
+    }
+    keccak_f(ctx->acc);
+    ctx->blen = 0;
+}
+
+static void keccak_update(cx_sha3_t *ctx, const uint8_t *in, size_t len) {
+    while (len > 0) {
+        const size_t part = ctx->block_size - ctx->blen < len ? ctx->block_size - ctx->blen : len;
+        memcpy(ctx->block + ctx->blen, in, part);
+        ctx->blen += part;
+        in += part;
+        len -= part;
+        if (ctx->blen == ctx->block_size) {
+            keccak_absorb_block(ctx);
+        }
+    }
+}
+
+static void keccak_final(cx_sha3_t *ctx, uint8_t *out) {
+    memset(ctx->block + ctx->blen, 0, ctx->block_size - ctx->blen);
+    ctx->block[ctx->blen] ^= 0x01;
+    ctx->block[ctx->block_size - 1] ^= 0x80;
+    keccak_absorb_block(ctx);
+    for (size_t i = 0; i < ctx->output_size; i++) {
+        out[i] = (uint8_t)(ctx->acc[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+cx_err_t cx_keccak_init_no_throw(cx_sha3_t *hash, size_t size) {
+    if (hash == NULL || (size != 224 && size != 256 && size != 384 && size != 512)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memset(hash, 0, sizeof(*hash));
+    hash->header.algo = CX_KECCAK;
+    hash->output_size = size / 8;
+    hash->block_size = 200 - 2 * hash->output_size;
+    return CX_OK;
+}
+
+// ---- BLAKE2b (RFC 7693), unkeyed
+
+static const uint64_t blake2b_iv[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4}, {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13}, {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11}, {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5}, {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}, {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+};
+
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+#define BLAKE2B_G(a, b, c, d, x, y)      \
+    do {                                 \
+        v[a] = v[a] + v[b] + (x);        \
+        v[d] = ROTR64(v[d] ^ v[a], 32);  \
+        v[c] = v[c] + v[d];              \
+        v[b] = ROTR64(v[b] ^ v[c], 24);  \
+        v[a] = v[a] + v[b] + (y);        \
+        v[d] = ROTR64(v[d] ^ v[a], 16);  \
+        v[c] = v[c] + v[d];              \
+        v[b] = ROTR64(v[b] ^ v[c], 63);  \
+    } while (0)
+
+static void blake2b_compress(cx_blake2b_t *ctx, bool last) {
+    uint64_t v[16];
+    uint64_t m[16];
+    for (uint8_t i = 0; i < 8; i++) {
+        v[i] = ctx->h[i];
+        v[i + 8] = blake2b_iv[i];
+    }
+    v[12] ^= ctx->t[0];
+    v[13] ^= ctx->t[1];
+    if (last) {
+        v[14] = ~v[14];
+    }
+    for (uint8_t i = 0; i < 16; i++) {
+        m[i] = 0;
+        for (uint8_t b = 0; b < 8; b++) {
+            m[i] |= (uint64_t)ctx->buf[8 * i + b] << (8 * b);
+        }
+    }
+    for (uint8_t r = 0; r < 12; r++) {
+        const uint8_t *s = blake2b_sigma[r];
+        BLAKE2B_G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+        BLAKE2B_G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+        BLAKE2B_G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+        BLAKE2B_G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+        BLAKE2B_G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+        BLAKE2B_G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+        BLAKE2B_G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+        BLAKE2B_G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->h[i] ^= v[i] ^ v[i + 8];
+    }
+}
+
+static void blake2b_update(cx_blake2b_t *ctx, const uint8_t *in, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        // a full block is only compressed once more data follows, the last one is compressed by final
+        if (ctx->buflen == sizeof(ctx->buf)) {
+            ctx->t[0] += ctx->buflen;
+            ctx->t[1] += ctx->t[0] < ctx->buflen ? 1 : 0;
+            blake2b_compress(ctx, false);
+            ctx->buflen = 0;
+        }
+        ctx->buf[ctx->buflen++] = in[i];
+    }
+}
+
+static void blake2b_final(cx_blake2b_t *ctx, uint8_t *out) {
+    ctx->t[0] += ctx->buflen;
+    ctx->t[1] += ctx->t[0] < ctx->buflen ? 1 : 0;
+    memset(ctx->buf + ctx->buflen, 0, sizeof(ctx->buf) - ctx->buflen);
+    blake2b_compress(ctx, true);
+    for (size_t i = 0; i < ctx->output_size; i++) {
+        out[i] = (uint8_t)(ctx->h[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+cx_err_t cx_blake2b_init_no_throw(cx_blake2b_t *hash, size_t size) {
+    if (hash == NULL || size == 0 || size > 512 || size % 8 != 0) {
+        return CX_INVALID_PARAMETER;
+    }
+    memset(hash, 0, sizeof(*hash));
+    hash->header.algo = CX_BLAKE2B;
+    hash->output_size = size / 8;
+    memcpy(hash->h, blake2b_iv, sizeof(hash->h));
+    hash->h[0] ^= 0x01010000ULL ^ hash->output_size;
+    return CX_OK;
+}
+
+cx_err_t cx_hash_no_throw(cx_hash_t *hash, uint32_t mode, const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+    if (hash == NULL || (in == NULL && len > 0)) {
+        return CX_INVALID_PARAMETER;
+    }
+    switch (hash->algo) {
+        case CX_KECCAK: {
+            cx_sha3_t *ctx = (cx_sha3_t *)hash;
+            keccak_update(ctx, in, len);
+            if ((mode & CX_LAST) != 0) {
+                if (out == NULL || out_len < ctx->output_size) {
+                    return CX_INVALID_PARAMETER;
+                }
+                keccak_final(ctx, out);
+            }
+            return CX_OK;
+        }
+        case CX_BLAKE2B: {
+            cx_blake2b_t *ctx = (cx_blake2b_t *)hash;
+            blake2b_update(ctx, in, len);
+            if ((mode & CX_LAST) != 0) {
+                if (out == NULL || out_len < ctx->output_size) {
+                    return CX_INVALID_PARAMETER;
+                }
+                blake2b_final(ctx, out);
+            }
+            return CX_OK;
+        }
+        default:
+            return CX_INVALID_PARAMETER;
+    }
+}
+
+// ---- placeholders: deterministic, sized like the real thing, not cryptography
+
+static void keccak256(const uint8_t *a, size_t aLen, const uint8_t *b, size_t bLen, uint8_t out[32]) {
+    cx_sha3_t ctx;
+    cx_keccak_init_no_throw(&ctx, 256);
+    keccak_update(&ctx, a, aLen);
+    keccak_update(&ctx, b, bLen);
+    keccak_final(&ctx, out);
+}
+
+// only feeds the ERC-20 descriptor check, which the simulator accepts anyway
+size_t cx_hash_sha256(const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+    if (out == NULL || out_len < CX_SHA256_SIZE) {
+        return 0;
+    }
+    keccak256(in, len, NULL, 0, out);
+    return CX_SHA256_SIZE;
+}
+
+cx_err_t os_derive_bip32_with_seed_no_throw(unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+                                            size_t path_len, uint8_t *raw_privkey, uint8_t *chain_code,
+                                            unsigned char *seed, size_t seed_len) {
+    (void)derivation_mode;
+    (void)seed;
+    (void)seed_len;
+    if (path == NULL || raw_privkey == NULL || path_len == 0 || path_len > 10) {
+        return CX_INVALID_PARAMETER;
+    }
+    uint8_t material[1 + 4 * 10] = {(uint8_t)curve};
+    for (size_t i = 0; i < path_len; i++) {
+        material[1 + 4 * i] = (uint8_t)(path[i] >> 24);
+        material[2 + 4 * i] = (uint8_t)(path[i] >> 16);
+        material[3 + 4 * i] = (uint8_t)(path[i] >> 8);
+        material[4 + 4 * i] = (uint8_t)path[i];
+    }
+    keccak256(material, 1 + 4 * path_len, NULL, 0, raw_privkey);
+    // Ed25519 keys are 64 bytes long
+    if (curve == CX_CURVE_Ed25519) {
+        keccak256(raw_privkey, 32, NULL, 0, raw_privkey + 32);
+    }
+    if (chain_code != NULL) {
+        keccak256(raw_privkey, 32, material, 1, chain_code);
+    }
+    return CX_OK;
+}
+
+cx_err_t os_derive_bip32_no_throw(cx_curve_t curve, const uint32_t *path, size_t path_len, uint8_t *raw_privkey,
+                                  uint8_t *chain_code) {
+    return os_derive_bip32_with_seed_no_throw(HDW_NORMAL, curve, path, path_len, raw_privkey, chain_code, NULL, 0);
+}
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve, const uint8_t *rawkey, size_t key_len,
+                                           cx_ecfp_private_key_t *pvkey) {
+    if (pvkey == NULL || key_len > sizeof(pvkey->d) || (rawkey == NULL && key_len > 0)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memset(pvkey, 0, sizeof(*pvkey));
+    pvkey->curve = curve;
+    pvkey->d_len = key_len;
+    if (key_len > 0) {
+        memcpy(pvkey->d, rawkey, key_len);
+    }
+    return CX_OK;
+}
+
+cx_err_t cx_ecfp_init_public_key_no_throw(cx_curve_t curve, const uint8_t *rawkey, size_t key_len,
+                                          cx_ecfp_public_key_t *key) {
+    if (key == NULL || key_len > sizeof(key->W) || (rawkey == NULL && key_len > 0)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memset(key, 0, sizeof(*key));
+    key->curve = curve;
+    key->W_len = key_len;
+    if (key_len > 0) {
+        memcpy(key->W, rawkey, key_len);
+    }
+    return CX_OK;
+}
+
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve, cx_ecfp_public_key_t *pubkey, cx_ecfp_private_key_t *privkey,
+                                        bool keepprivate) {
+    (void)keepprivate;
+    if (pubkey == NULL || privkey == NULL) {
+        return CX_INVALID_PARAMETER;
+    }
+    pubkey->curve = curve;
+    pubkey->W_len = sizeof(pubkey->W);
+    pubkey->W[0] = 0x04;
+    keccak256(privkey->d, privkey->d_len, NULL, 0, pubkey->W + 1);
+    keccak256(pubkey->W + 1, 32, NULL, 0, pubkey->W + 33);
+    return CX_OK;
+}
+
+cx_err_t cx_ecdsa_sign_rs_no_throw(const cx_ecfp_private_key_t *key, uint32_t mode, cx_md_t hashID, const uint8_t *hash,
+                                   size_t hash_len, size_t rs_len, uint8_t *sig_r, uint8_t *sig_s, uint32_t *info) {
+    (void)mode;
+    (void)hashID;
+    if (key == NULL || hash == NULL || sig_r == NULL || sig_s == NULL || rs_len != 32) {
+        return CX_INVALID_PARAMETER;
+    }
+    keccak256(key->d, key->d_len, hash, hash_len, sig_r);
+    keccak256(sig_r, 32, NULL, 0, sig_s);
+    if (info != NULL) {
+        *info = sig_r[31] & CX_ECCINFO_PARITY_ODD;
+    }
+    return CX_OK;
+}
+
+cx_err_t cx_eddsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey, cx_md_t hashID, const uint8_t *hash,
+                                size_t hash_len, uint8_t *sig, size_t sig_len) {
+    (void)hashID;
+    if (pvkey == NULL || (hash == NULL && hash_len > 0) || sig == NULL || sig_len < 64) {
+        return CX_INVALID_PARAMETER;
+    }
+    keccak256(pvkey->d, pvkey->d_len, hash, hash_len, sig);
+    keccak256(sig, 32, NULL, 0, sig + 32);
+    return CX_OK;
+}
+
+bool cx_ecdsa_verify_no_throw(const cx_ecfp_public_key_t *pukey, const uint8_t *hash, size_t hash_len,
+                              const uint8_t *sig, size_t sig_len) {
+    (void)pukey;
+    (void)hash;
+    (void)hash_len;
+    (void)sig;
+    (void)sig_len;
+    // recorded sessions carry descriptors signed by the real token list key
+    return true;
+}
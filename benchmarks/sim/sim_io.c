@@ -0,0 +1,183 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "actions.h"
+#include "apdu_handler_evm.h"
+#include "app_main.h"
+#include "app_mode.h"
+#include "os.h"
+#include "sim.h"
+#include "tx.h"
+#include "ux.h"
+#include "view.h"
+
+// one screen, as in the parser benchmarks
+#define SIM_KEY_LEN   40
+#define SIM_VALUE_LEN 40
+
+uint8_t G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+try_context_t *G_try_last_open_context = NULL;
+bolos_ux_params_t G_ux_params = {.len = BOLOS_UX_OK};
+
+static struct {
+    viewfunc_getItem_t getItem;
+    viewfunc_getNumItems_t getNumItems;
+    viewfunc_accept_t accept;
+    bool shown;
+} sim_review;
+
+static bool sim_approve = true;
+static uint64_t sim_pages = 0;
+
+static uint8_t sim_reply[IO_APDU_BUFFER_SIZE];
+static uint16_t sim_reply_len = 0;
+static bool sim_replied = false;
+
+void os_longjmp(unsigned int exception) {
+    if (G_try_last_open_context == NULL) {
+        fprintf(stderr, "sim: exception 0x%04x thrown outside of a TRY block\n", exception);
+        abort();
+    }
+    longjmp(G_try_last_open_context->jmp_buf, (int)exception);
+}
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len) {
+    // only the replies sent after a review go through here, handleApdu returns the others
+    if ((channel_and_flags & IO_RETURN_AFTER_TX) != 0 && tx_len <= sizeof(sim_reply)) {
+        memcpy(sim_reply, G_io_apdu_buffer, tx_len);
+        sim_reply_len = tx_len;
+        sim_replied = true;
+    }
+    return 0;
+}
+
+bolos_bool_t os_global_pin_is_validated(void) {
+    return BOLOS_UX_OK;
+}
+
+void nvm_write(void *dst_adr, void *src_adr, unsigned int src_len) {
+    // NV_CONST storage lands in read-only pages on the host, make them writable first
+    const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)dst_adr & ~(pageSize - 1);
+    const uintptr_t end = ((uintptr_t)dst_adr + src_len + pageSize - 1) & ~(pageSize - 1);
+    if (src_len == 0 || mprotect((void *)start, end - start, PROT_READ | PROT_WRITE) != 0) {
+        return;
+    }
+    if (src_adr == NULL) {
+        memset(dst_adr, 0, src_len);
+    } else {
+        memmove(dst_adr, src_adr, src_len);
+    }
+}
+
+void view_init(void) {}
+
+void view_idle_show(uint8_t item_idx, const char *statusString) {
+    (void)item_idx;
+    (void)statusString;
+}
+
+void view_review_init(viewfunc_getItem_t viewfuncGetItem, viewfunc_getNumItems_t viewfuncGetNumItems,
+                      viewfunc_accept_t viewfuncAccept) {
+    sim_review.getItem = viewfuncGetItem;
+    sim_review.getNumItems = viewfuncGetNumItems;
+    sim_review.accept = viewfuncAccept;
+    sim_review.shown = false;
+}
+
+void view_review_show(review_type_e reviewKind) {
+    (void)reviewKind;
+    sim_review.shown = true;
+}
+
+void view_blindsign_error_show(void) {}
+
+// Renders every page of the pending review, false if one of them cannot be shown
+static bool sim_walk_review(void) {
+    uint8_t numItems = 0;
+    if (sim_review.getNumItems == NULL || sim_review.getItem == NULL || sim_review.getNumItems(&numItems) != zxerr_ok) {
+        return false;
+    }
+    char key[SIM_KEY_LEN];
+    char value[SIM_VALUE_LEN];
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < pageCount; page++) {
+            if (sim_review.getItem((int8_t)idx, key, sizeof(key), value, sizeof(value), page, &pageCount) != zxerr_ok) {
+                return false;
+            }
+            sim_pages++;
+        }
+    }
+    return true;
+}
+
+void sim_init(void) {
+    memset(G_io_apdu_buffer, 0, sizeof(G_io_apdu_buffer));
+    memset(&sim_review, 0, sizeof(sim_review));
+    G_try_last_open_context = NULL;
+    sim_approve = true;
+    sim_pages = 0;
+    set_review_pending(false);
+    reset_evm_chunk_state();
+    app_mode_reset();
+    tx_initialize();
+}
+
+void sim_set_approval(bool approve) {
+    sim_approve = approve;
+}
+
+uint64_t sim_rendered_pages(void) {
+    return sim_pages;
+}
+
+uint16_t sim_exchange(const uint8_t *command, uint16_t commandLen, uint8_t *reply, uint16_t replyMax) {
+    if (command == NULL || reply == NULL || commandLen > sizeof(G_io_apdu_buffer)) {
+        return 0;
+    }
+    memcpy(G_io_apdu_buffer, command, commandLen);
+    sim_review.shown = false;
+    sim_replied = false;
+
+    volatile uint32_t flags = 0;
+    volatile uint32_t tx = 0;
+    handleApdu(&flags, &tx, commandLen);
+
+    if ((flags & IO_ASYNCH_REPLY) != 0 && sim_review.shown) {
+        const bool renders = sim_walk_review();
+        if (sim_approve && renders && sim_review.accept != NULL) {
+            sim_review.accept();
+        } else {
+            app_reject();
+        }
+    }
+    if (!sim_replied) {
+        sim_reply_len = tx < sizeof(sim_reply) ? (uint16_t)tx : sizeof(sim_reply);
+        memcpy(sim_reply, G_io_apdu_buffer, sim_reply_len);
+    }
+
+    if (sim_reply_len > replyMax) {
+        return 0;
+    }
+    memcpy(reply, sim_reply, sim_reply_len);
+    return sim_reply_len;
+}
@@ -0,0 +1,517 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Transport from '@ledgerhq/hw-transport'
+
+import {
+  CLA,
+  CLA_ETH,
+  EIP191_BATCH_MAX_MSGS,
+  ETH_ADDRESS_LEN,
+  ETH_BATCH_SIGS_PER_PAGE,
+  ETH_SIGNATURE_RSV_LEN,
+  FEATURE,
+  INS,
+  P1_ADDR_RANGE,
+  P1_ADDR_SILENT,
+  P1_ETH_BATCH_SIGNATURES,
+  P1_ETH_FIRST,
+  P1_ETH_MORE,
+  P1_ETH_PATH_SIGNATURES,
+  P1_ETH_POLICY_CLEAR,
+  P1_ETH_POLICY_SET,
+  P1_ETH_POLICY_STATUS,
+  P1_ETH_UPLOAD_STATUS,
+  P1_SUBSTRATE_ADD,
+  P1_SUBSTRATE_INIT,
+  P1_SUBSTRATE_LAST,
+  P1_SUBSTRATE_PROOF,
+  P2_ETH_SIG_COMPACT,
+  P2_ETH_SIG_DER,
+  P2_ETH_SIG_MULTI,
+  SW_INS_NOT_SUPPORTED,
+  SW_OK,
+} from './consts'
+import { RequestQueue } from './queue'
+import {
+  chunk,
+  parseCapabilities,
+  parseEthSignature,
+  parsePath,
+  parseUploadStatus,
+  parseVersion,
+  serializeEthPath,
+  serializeEthPathList,
+  serializeEthPolicy,
+  serializeSubstratePath,
+} from './serialize'
+import {
+  Capabilities,
+  ClientOptions,
+  CommandMetric,
+  EthSignature,
+  EthSignOptions,
+  EthSigningPolicy,
+  SubstrateAddress,
+  SubstrateSignOptions,
+  UploadStatus,
+  Version,
+} from './types'
+
+const APDU_MAX_PAYLOAD = 255
+const HARDENED = 0x80000000
+
+// Builds without GET_CAPABILITIES only have the RAM buffer and the single flows
+const LEGACY_CAPABILITIES: Capabilities = {
+  version: 0,
+  ramBuffer: 8192,
+  flashBuffer: 0,
+  chunkSize: 250,
+  features: 0,
+  batchTxs: 0,
+  ethAddrBatch: 0,
+  ss58AddrBatch: 0,
+  msgDisplay: 0,
+  batchBytes: 0,
+}
+
+interface Exchange {
+  cla: number
+  ins: number
+  p1: number
+  p2: number
+  data: Buffer
+}
+
+// Device answers carry a status word; anything else is a transport failure and can be retried
+export function isTransportError(e: unknown): boolean {
+  return typeof e !== 'object' || e === null || !('statusCode' in e)
+}
+
+class Command {
+  readonly metric: CommandMetric
+  private readonly started = Date.now()
+
+  constructor(name: string, queuedMs: number) {
+    this.metric = { command: name, exchanges: 0, bytesOut: 0, bytesIn: 0, retries: 0, queuedMs, durationMs: 0, throughput: 0, ok: false }
+  }
+
+  finish(ok: boolean): CommandMetric {
+    this.metric.ok = ok
+    this.metric.durationMs = Date.now() - this.started
+    this.metric.throughput = this.metric.durationMs > 0 ? (this.metric.bytesOut * 1000) / this.metric.durationMs : 0
+    return this.metric
+  }
+}
+
+export class PeaqClient {
+  private readonly queue = new RequestQueue()
+  private readonly retries: number
+  private capabilities?: Promise<Capabilities>
+
+  constructor(
+    private readonly transport: Transport,
+    private readonly options: ClientOptions = {},
+  ) {
+    this.retries = options.retries ?? 2
+  }
+
+  async getVersion(): Promise<Version> {
+    return this.command('getVersion', async cmd => {
+      const apdu = { cla: CLA, ins: INS.GET_VERSION, p1: 0, p2: 0, data: Buffer.alloc(0) }
+      return parseVersion(await this.retried(cmd, () => this.exchange(cmd, apdu)))
+    })
+  }
+
+  /** Read once per client; older builds get the legacy limits */
+  getCapabilities(): Promise<Capabilities> {
+    if (this.capabilities === undefined) {
+      this.capabilities = this.command('getCapabilities', async cmd => {
+        try {
+          const apdu = { cla: CLA, ins: INS.GET_CAPABILITIES, p1: 0, p2: 0, data: Buffer.alloc(0) }
+          return parseCapabilities(await this.retried(cmd, () => this.exchange(cmd, apdu)))
+        } catch (e) {
+          if (!isTransportError(e) && (e as { statusCode: number }).statusCode === SW_INS_NOT_SUPPORTED) {
+            return { ...LEGACY_CAPABILITIES }
+          }
+          throw e
+        }
+      })
+      // ask again on the next call
+      this.capabilities.catch(() => (this.capabilities = undefined))
+    }
+    return this.capabilities
+  }
+
+  async signEthTransaction(path: string, tx: Buffer, options: EthSignOptions = {}): Promise<EthSignature> {
+    const p2 = options.compact ? P2_ETH_SIG_COMPACT : P2_ETH_SIG_DER
+    const header = serializeEthPath(path)
+    const chunks = chunk(header, tx, await this.chunkSize())
+    const resumable = ((await this.getCapabilities()).features & FEATURE.EVM_UPLOAD_RESUME) !== 0
+    return this.command('signEthTransaction', async cmd =>
+      parseEthSignature(await this.upload(cmd, this.ethUpload(INS.SIGN_ETH, p2, chunks), resumable ? header.length : undefined)),
+    )
+  }
+
+  async signPersonalMessage(path: string, message: Buffer, options: EthSignOptions = {}): Promise<EthSignature> {
+    const p2 = options.compact ? P2_ETH_SIG_COMPACT : P2_ETH_SIG_DER
+    const chunks = chunk(this.lengthPrefixedPath(path, message.length), message, await this.chunkSize())
+    return this.command('signPersonalMessage', async cmd =>
+      parseEthSignature(await this.upload(cmd, this.ethUpload(INS.SIGN_PERSONAL_MESSAGE, p2, chunks))),
+    )
+  }
+
+  /** Signs one transaction with every path under one review; signatures are v|r|s, in the order of paths */
+  async signEthTransactionMultiPath(paths: string[], tx: Buffer): Promise<EthSignature[]> {
+    await this.requireFeature(FEATURE.EVM_MULTI_PATH, 'multi path uploads')
+    const chunks = chunk(serializeEthPathList(paths), tx, await this.chunkSize())
+    return this.command('signEthTransactionMultiPath', cmd =>
+      this.batchSignatures(cmd, INS.SIGN_ETH, chunks, paths.length, P2_ETH_SIG_MULTI, P1_ETH_PATH_SIGNATURES),
+    )
+  }
+
+  /** Signs one personal message with every path under one review; signatures are v|r|s, in the order of paths */
+  async signPersonalMessageMultiPath(paths: string[], message: Buffer): Promise<EthSignature[]> {
+    await this.requireFeature(FEATURE.EVM_MULTI_PATH, 'multi path uploads')
+    const len = Buffer.alloc(4)
+    len.writeUInt32BE(message.length, 0)
+    const chunks = chunk(Buffer.concat([serializeEthPathList(paths), len]), message, await this.chunkSize())
+    return this.command('signPersonalMessageMultiPath', cmd =>
+      this.batchSignatures(cmd, INS.SIGN_PERSONAL_MESSAGE, chunks, paths.length, P2_ETH_SIG_MULTI, P1_ETH_PATH_SIGNATURES),
+    )
+  }
+
+  /** Signs transfers with consecutive nonces under one review; signatures are v|r|s, in order */
+  async signEthBatch(path: string, txs: Buffer[]): Promise<EthSignature[]> {
+    const caps = await this.getCapabilities()
+    if ((caps.features & FEATURE.EVM_BATCH_SIGN) === 0) {
+      throw new Error('batch signing is not supported by this build')
+    }
+    if (txs.length === 0 || txs.length > caps.batchTxs) {
+      throw new Error(`batches hold 1 to ${caps.batchTxs} transactions`)
+    }
+    const data = Buffer.concat(txs)
+    if (data.length > caps.batchBytes) {
+      throw new Error(`batches hold up to ${caps.batchBytes} bytes`)
+    }
+    const chunks = chunk(this.lengthPrefixedPath(path, data.length), data, await this.chunkSize())
+    return this.command('signEthBatch', cmd => this.batchSignatures(cmd, INS.SIGN_BATCH_ETH, chunks, txs.length))
+  }
+
+  /** Signs EIP-191 messages under one review; signatures are v|r|s, in order */
+  async signPersonalMessageBatch(path: string, messages: Buffer[]): Promise<EthSignature[]> {
+    const caps = await this.getCapabilities()
+    if ((caps.features & FEATURE.EIP191_BATCH_SIGN) === 0) {
+      throw new Error('message batches are not supported by this build')
+    }
+    if (messages.length === 0 || messages.length > EIP191_BATCH_MAX_MSGS) {
+      throw new Error(`batches hold 1 to ${EIP191_BATCH_MAX_MSGS} messages`)
+    }
+    const data = Buffer.concat(
+      messages.map(message => {
+        if (message.length === 0 || message.length > 0xffff) {
+          throw new Error('batched messages hold 1 to 65535 bytes')
+        }
+        const length = Buffer.alloc(2)
+        length.writeUInt16BE(message.length, 0)
+        return Buffer.concat([length, message])
+      }),
+    )
+    // every message is shown, so the list must fit in the bytes kept for the review
+    if (data.length > caps.msgDisplay) {
+      throw new Error(`message batches hold up to ${caps.msgDisplay} bytes`)
+    }
+    const chunks = chunk(this.lengthPrefixedPath(path, data.length), data, await this.chunkSize())
+    return this.command('signPersonalMessageBatch', cmd =>
+      this.batchSignatures(cmd, INS.SIGN_BATCH_PERSONAL_MESSAGE, chunks, messages.length),
+    )
+  }
+
+  /** Sets the policy under which SIGN_ETH signs transfers without a review, once approved on the device */
+  async setEthSigningPolicy(path: string, policy: EthSigningPolicy): Promise<void> {
+    await this.requireFeature(FEATURE.EVM_SIGN_POLICY, 'signing policies')
+    const data = Buffer.concat([serializeEthPath(path), serializeEthPolicy(policy)])
+    // reviewed on the device, so never sent twice
+    await this.command('setEthSigningPolicy', cmd =>
+      this.exchange(cmd, { cla: CLA_ETH, ins: INS.SET_POLICY_ETH, p1: P1_ETH_POLICY_SET, p2: 0, data }),
+    )
+  }
+
+  async clearEthSigningPolicy(): Promise<void> {
+    await this.requireFeature(FEATURE.EVM_SIGN_POLICY, 'signing policies')
+    await this.command('clearEthSigningPolicy', cmd =>
+      this.retried(cmd, () =>
+        this.exchange(cmd, { cla: CLA_ETH, ins: INS.SET_POLICY_ETH, p1: P1_ETH_POLICY_CLEAR, p2: 0, data: Buffer.alloc(0) }),
+      ),
+    )
+  }
+
+  /** Signatures the active policy still allows, 0 when there is none */
+  async getEthSigningPolicyRemaining(): Promise<number> {
+    await this.requireFeature(FEATURE.EVM_SIGN_POLICY, 'signing policies')
+    return this.command('getEthSigningPolicyRemaining', async cmd => {
+      const resp = await this.retried(cmd, () =>
+        this.exchange(cmd, { cla: CLA_ETH, ins: INS.SET_POLICY_ETH, p1: P1_ETH_POLICY_STATUS, p2: 0, data: Buffer.alloc(0) }),
+      )
+      if (resp.length !== 2) {
+        throw new Error('unexpected policy status length')
+      }
+      return resp.readUInt16BE(0)
+    })
+  }
+
+  /** Addresses of indexes start..start+count-1, replacing the last element of basePath */
+  async getEthAddressBatch(basePath: string, start: number, count: number): Promise<string[]> {
+    const caps = await this.getCapabilities()
+    if ((caps.features & FEATURE.EVM_ADDR_BATCH) === 0 || caps.ethAddrBatch === 0) {
+      throw new Error('address batches are not supported by this build')
+    }
+    const path = serializeEthPath(basePath)
+
+    return this.command('getEthAddressBatch', async cmd => {
+      const addresses: string[] = []
+      while (addresses.length < count) {
+        const pageCount = Math.min(count - addresses.length, caps.ethAddrBatch)
+        const args = Buffer.alloc(5)
+        args.writeUInt32BE(start + addresses.length, 0)
+        args.writeUInt8(pageCount, 4)
+        const page = await this.retried(cmd, () =>
+          this.exchange(cmd, { cla: CLA_ETH, ins: INS.GET_ADDR_BATCH_ETH, p1: 0, p2: 0, data: Buffer.concat([path, args]) }),
+        )
+        if (page.length !== pageCount * ETH_ADDRESS_LEN) {
+          throw new Error('unexpected address batch length')
+        }
+        for (let offset = 0; offset < page.length; offset += ETH_ADDRESS_LEN) {
+          addresses.push('0x' + page.subarray(offset, offset + ETH_ADDRESS_LEN).toString('hex'))
+        }
+      }
+      return addresses
+    })
+  }
+
+  async getSubstrateAddress(path: string): Promise<SubstrateAddress> {
+    const data = serializeSubstratePath(path)
+    return this.command('getSubstrateAddress', async cmd => {
+      const resp = await this.retried(cmd, () => this.exchange(cmd, { cla: CLA, ins: INS.GET_ADDR, p1: P1_ADDR_SILENT, p2: 0, data }))
+      return { publicKey: resp.subarray(0, 32), address: resp.subarray(32).toString('ascii') }
+    })
+  }
+
+  /** SS58 addresses of count consecutive indexes, starting at the last element of path */
+  async getSubstrateAddressRange(path: string, count: number): Promise<SubstrateAddress[]> {
+    const caps = await this.getCapabilities()
+    if ((caps.features & FEATURE.SS58_ADDR_RANGE) === 0 || caps.ss58AddrBatch === 0) {
+      throw new Error('address ranges are not supported by this build')
+    }
+    const elements = parsePath(path)
+    const last = elements[elements.length - 1]
+    const hardened = (last & HARDENED) >>> 0
+    const first = (last & ~HARDENED) >>> 0
+
+    return this.command('getSubstrateAddressRange', async cmd => {
+      const addresses: SubstrateAddress[] = []
+      while (addresses.length < count) {
+        const pageCount = Math.min(count - addresses.length, caps.ss58AddrBatch)
+        const data = Buffer.alloc(4 * elements.length + 1)
+        elements.forEach((e, i) => data.writeUInt32LE(i === elements.length - 1 ? (hardened | (first + addresses.length)) >>> 0 : e, 4 * i))
+        data.writeUInt8(pageCount, data.length - 1)
+
+        const page = await this.retried(cmd, () => this.exchange(cmd, { cla: CLA, ins: INS.GET_ADDR, p1: P1_ADDR_RANGE, p2: 0, data }))
+        for (let offset = 0, n = 0; n < pageCount; n++) {
+          if (offset >= page.length || offset + 1 + page[offset] > page.length) {
+            throw new Error('unexpected address range length')
+          }
+          addresses.push({ address: page.subarray(offset + 1, offset + 1 + page[offset]).toString('ascii') })
+          offset += 1 + page[offset]
+        }
+      }
+      return addresses
+    })
+  }
+
+  /** Returns the 64-byte Ed25519 signature */
+  async signSubstrate(path: string, payload: Buffer, options: SubstrateSignOptions = {}): Promise<Buffer> {
+    const chunkSize = await this.chunkSize()
+    const exchanges: Exchange[] = [{ cla: CLA, ins: INS.SIGN, p1: P1_SUBSTRATE_INIT, p2: 0, data: serializeSubstratePath(path) }]
+    const proof = options.metadataProof
+    if (proof !== undefined) {
+      if (((await this.getCapabilities()).features & FEATURE.SUBSTRATE_METADATA_HASH) === 0) {
+        throw new Error('metadata proofs are not supported by this app version')
+      }
+      for (let offset = 0; offset < proof.length; offset += chunkSize) {
+        exchanges.push({ cla: CLA, ins: INS.SIGN, p1: P1_SUBSTRATE_PROOF, p2: 0, data: proof.subarray(offset, offset + chunkSize) })
+      }
+    }
+    const first = exchanges.length
+    for (let offset = 0; offset < payload.length; offset += chunkSize) {
+      exchanges.push({ cla: CLA, ins: INS.SIGN, p1: P1_SUBSTRATE_ADD, p2: 0, data: payload.subarray(offset, offset + chunkSize) })
+    }
+    if (exchanges.length === first) {
+      throw new Error('empty payload')
+    }
+    exchanges[exchanges.length - 1].p1 = P1_SUBSTRATE_LAST
+
+    return this.command('signSubstrate', async cmd => {
+      const resp = await this.upload(cmd, exchanges)
+      return resp.subarray(1, 65)
+    })
+  }
+
+  private async requireFeature(feature: number, name: string): Promise<void> {
+    if (((await this.getCapabilities()).features & feature) === 0) {
+      throw new Error(`${name} are not supported by this build`)
+    }
+  }
+
+  private async chunkSize(): Promise<number> {
+    const caps = await this.getCapabilities()
+    return Math.min(caps.chunkSize || APDU_MAX_PAYLOAD, this.options.chunkSize ?? APDU_MAX_PAYLOAD)
+  }
+
+  private lengthPrefixedPath(path: string, length: number): Buffer {
+    const len = Buffer.alloc(4)
+    len.writeUInt32BE(length, 0)
+    return Buffer.concat([serializeEthPath(path), len])
+  }
+
+  private ethUpload(ins: number, p2: number, chunks: Buffer[]): Exchange[] {
+    return chunks.map((data, i) => ({ cla: CLA_ETH, ins, p1: i === 0 ? P1_ETH_FIRST : P1_ETH_MORE, p2, data }))
+  }
+
+  // Serializes commands and reports one metric per command
+  // Uploads a batch, then fetches the signatures that did not fit in the approval reply
+  private async batchSignatures(
+    cmd: Command,
+    ins: number,
+    chunks: Buffer[],
+    count: number,
+    p2 = 0,
+    fetchP1 = P1_ETH_BATCH_SIGNATURES,
+  ): Promise<EthSignature[]> {
+    const signatures: EthSignature[] = []
+    const collect = (page: Buffer) => {
+      for (let offset = 0; offset + ETH_SIGNATURE_RSV_LEN <= page.length; offset += ETH_SIGNATURE_RSV_LEN) {
+        if (signatures.length === count) {
+          break
+        }
+        signatures.push(parseEthSignature(page.subarray(offset, offset + ETH_SIGNATURE_RSV_LEN)))
+      }
+    }
+    collect(await this.upload(cmd, this.ethUpload(ins, p2, chunks)))
+    // fetching is read-only, so it can be retried
+    while (signatures.length < count) {
+      const before = signatures.length
+      const index = Buffer.from([before])
+      collect(await this.retried(cmd, () => this.exchange(cmd, { cla: CLA_ETH, ins, p1: fetchP1, p2: 0, data: index })))
+      if (signatures.length - before !== Math.min(ETH_BATCH_SIGS_PER_PAGE, count - before)) {
+        throw new Error('short signature page')
+      }
+    }
+    return signatures
+  }
+
+  private command<T>(name: string, body: (cmd: Command) => Promise<T>): Promise<T> {
+    const queued = Date.now()
+    return this.queue.run(async () => {
+      const cmd = new Command(name, Date.now() - queued)
+      try {
+        const result = await body(cmd)
+        this.options.metrics?.onCommand?.(cmd.finish(true))
+        return result
+      } catch (e) {
+        this.options.metrics?.onCommand?.(cmd.finish(false))
+        throw e
+      }
+    })
+  }
+
+  private async retried<T>(cmd: Command, task: () => Promise<T>): Promise<T> {
+    for (;;) {
+      try {
+        return await task()
+      } catch (e) {
+        if (!isTransportError(e) || cmd.metric.retries >= this.retries) {
+          throw e
+        }
+        cmd.metric.retries++
+      }
+    }
+  }
+
+  // Chunks after the first one are appended to the device buffer, so a failed
+  // upload is restarted from the first chunk, or resumed after the last chunk the
+  // device accepted when headerLen is given. The last one starts the review and
+  // is never sent twice: the user may already have approved it.
+  private async upload(cmd: Command, exchanges: Exchange[], headerLen?: number): Promise<Buffer> {
+    let next = 0
+    for (;;) {
+      let i = next
+      try {
+        let resp = Buffer.alloc(0)
+        for (; i < exchanges.length; i++) {
+          resp = await this.exchange(cmd, exchanges[i])
+        }
+        return resp
+      } catch (e) {
+        if (!isTransportError(e) || i === exchanges.length - 1 || cmd.metric.retries >= this.retries) {
+          throw e
+        }
+        cmd.metric.retries++
+        next = headerLen === undefined ? 0 : await this.resumePoint(cmd, exchanges, headerLen)
+      }
+    }
+  }
+
+  // Index of the chunk after the last one the device accepted, or 0 when the
+  // device holds something else than a prefix of this upload
+  private async resumePoint(cmd: Command, exchanges: Exchange[], headerLen: number): Promise<number> {
+    let status: UploadStatus
+    try {
+      status = parseUploadStatus(
+        await this.exchange(cmd, { cla: CLA_ETH, ins: exchanges[0].ins, p1: P1_ETH_UPLOAD_STATUS, p2: 0, data: Buffer.alloc(0) }),
+      )
+    } catch (e) {
+      if (!isTransportError(e)) {
+        throw e
+      }
+      return 0
+    }
+    if (!status.inProgress || status.chunks === 0 || status.chunks >= exchanges.length) {
+      return 0
+    }
+    const sent = exchanges.slice(0, status.chunks).reduce((sum, apdu) => sum + apdu.data.length, 0) - headerLen
+    return sent === status.received ? status.chunks : 0
+  }
+
+  private async exchange(cmd: Command, apdu: Exchange): Promise<Buffer> {
+    const started = Date.now()
+    const resp = await this.transport.send(apdu.cla, apdu.ins, apdu.p1, apdu.p2, apdu.data, [SW_OK])
+    cmd.metric.exchanges++
+    cmd.metric.bytesOut += apdu.data.length
+    cmd.metric.bytesIn += resp.length
+    this.options.metrics?.onExchange?.({
+      cla: apdu.cla,
+      ins: apdu.ins,
+      p1: apdu.p1,
+      p2: apdu.p2,
+      bytesOut: apdu.data.length,
+      bytesIn: resp.length,
+      durationMs: Date.now() - started,
+      attempt: cmd.metric.retries,
+    })
+    return resp.subarray(0, resp.length - 2)
+  }
+}
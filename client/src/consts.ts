@@ -0,0 +1,92 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+// Instruction set of the peaq app, see docs/APDUSPEC.md
+
+export const CLA = 0x61
+export const CLA_ETH = 0xe0
+
+export const INS = {
+  GET_VERSION: 0x00,
+  GET_ADDR: 0x01,
+  SIGN: 0x02,
+  GET_ADDR_ETH: 0x02,
+  SIGN_ETH: 0x04,
+  SIGN_PERSONAL_MESSAGE: 0x08,
+  GET_ADDR_BATCH_ETH: 0x40,
+  SIGN_BATCH_ETH: 0x44,
+  SIGN_BATCH_PERSONAL_MESSAGE: 0x4c,
+  GET_CAPABILITIES: 0x4a,
+  SET_POLICY_ETH: 0x4e,
+} as const
+
+// chunked EVM uploads
+export const P1_ETH_FIRST = 0x00
+export const P1_ETH_MORE = 0x80
+export const P1_ETH_BATCH_SIGNATURES = 0x01
+export const P1_ETH_UPLOAD_STATUS = 0x01
+export const P1_ETH_PATH_SIGNATURES = 0x02
+
+// SET_POLICY_ETH operations
+export const P1_ETH_POLICY_SET = 0x00
+export const P1_ETH_POLICY_CLEAR = 0x01
+export const P1_ETH_POLICY_STATUS = 0x02
+
+// chunked Substrate uploads
+export const P1_SUBSTRATE_INIT = 0x00
+export const P1_SUBSTRATE_ADD = 0x01
+export const P1_SUBSTRATE_LAST = 0x02
+export const P1_SUBSTRATE_PROOF = 0x03
+
+// Substrate GET_ADDR modes
+export const P1_ADDR_SILENT = 0x00
+export const P1_ADDR_SHOW = 0x01
+export const P1_ADDR_RANGE = 0x02
+
+// EVM signature formats
+export const P2_ETH_SIG_DER = 0x00
+export const P2_ETH_SIG_COMPACT = 0x01
+export const P2_ETH_SIG_MULTI = 0x02
+
+export const SW_OK = 0x9000
+export const SW_INS_NOT_SUPPORTED = 0x6d00
+
+export const ETH_SIGNATURE_RSV_LEN = 65
+export const ETH_ADDRESS_LEN = 20
+export const ETH_BATCH_SIGS_PER_PAGE = 3
+export const ETH_POLICY_MAX_RECIPIENTS = 4
+export const ETH_MULTIPATH_MAX = 5
+export const EIP191_BATCH_MAX_MSGS = 16
+export const SUBSTRATE_PATH_LEN = 5
+
+export const FEATURE = {
+  EVM_TX_STREAMING: 1 << 0,
+  EVM_BATCH_SIGN: 1 << 1,
+  EVM_ADDR_BATCH: 1 << 2,
+  EVM_PUBKEY_CACHE: 1 << 3,
+  EVM_EIP712: 1 << 4,
+  EIP191_STREAMING: 1 << 5,
+  SUBSTRATE_SIGN_PREHASH: 1 << 6,
+  SS58_ADDR_RANGE: 1 << 7,
+  PROFILING: 1 << 8,
+  EIP191_BATCH_SIGN: 1 << 9,
+  EVM_SIGN_RETRY: 1 << 10,
+  EVM_UPLOAD_RESUME: 1 << 11,
+  SUBSTRATE_METADATA_HASH: 1 << 12,
+  EVM_SIGN_POLICY: 1 << 13,
+  EVM_MULTI_PATH: 1 << 14,
+  EVM_EIP7702: 1 << 15,
+} as const
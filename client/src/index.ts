@@ -0,0 +1,33 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+export * from './consts'
+export * from './types'
+export { PeaqClient } from './client'
+export { RequestQueue } from './queue'
+export {
+  chunk,
+  parseCapabilities,
+  parseEthSignature,
+  parsePath,
+  parseVersion,
+  serializeEthPath,
+  serializeEthPathList,
+  serializeEthPolicy,
+  serializeSubstratePath,
+} from './serialize'
+export { DevicePool } from './pool'
+export type { DeviceStatus, PoolDevice, PoolOptions } from './pool'
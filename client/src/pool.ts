@@ -0,0 +1,185 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Transport from '@ledgerhq/hw-transport'
+
+import { isTransportError, PeaqClient } from './client'
+import { ClientOptions, EthSignature, EthSignOptions, SubstrateAddress, Version } from './types'
+
+export interface PoolDevice {
+  id: string
+  transport: Transport
+}
+
+export interface PoolOptions extends ClientOptions {
+  /** GET_VERSION period; unset to check only on demand */
+  healthIntervalMs?: number
+  /** other devices tried when a transport drops during a call */
+  failovers?: number
+}
+
+export interface DeviceStatus {
+  id: string
+  healthy: boolean
+  pending: number
+  completed: number
+  failures: number
+  version?: Version
+}
+
+interface Member {
+  id: string
+  client: PeaqClient
+  status: DeviceStatus
+}
+
+// FNV-1a, enough to spread keys over a handful of devices
+function hash(text: string): number {
+  let h = 0x811c9dc5
+  for (let i = 0; i < text.length; i++) {
+    h = Math.imul(h ^ text.charCodeAt(i), 0x01000193)
+  }
+  return h >>> 0
+}
+
+// A device runs one flow at a time, so signing throughput grows with the number
+// of devices. Calls are routed by key (path or account) with rendezvous hashing:
+// the calls of one account stay on one device, in order, and losing a device only
+// moves the keys it was serving.
+export class DevicePool {
+  private readonly members = new Map<string, Member>()
+  private timer?: ReturnType<typeof setInterval>
+
+  constructor(
+    devices: PoolDevice[],
+    private readonly options: PoolOptions = {},
+  ) {
+    devices.forEach(device => this.add(device))
+    if (options.healthIntervalMs !== undefined) {
+      this.timer = setInterval(() => void this.checkHealth(), options.healthIntervalMs)
+      this.timer.unref?.()
+    }
+  }
+
+  /** New devices take traffic once a health check passed */
+  add(device: PoolDevice): void {
+    if (this.members.has(device.id)) {
+      throw new Error(`device ${device.id} is already in the pool`)
+    }
+    this.members.set(device.id, {
+      id: device.id,
+      client: new PeaqClient(device.transport, this.options),
+      status: { id: device.id, healthy: false, pending: 0, completed: 0, failures: 0 },
+    })
+  }
+
+  remove(id: string): void {
+    this.members.delete(id)
+  }
+
+  /** Sends GET_VERSION to every device; any error takes the device out of rotation */
+  async checkHealth(): Promise<DeviceStatus[]> {
+    await Promise.all(
+      [...this.members.values()].map(async member => {
+        try {
+          member.status.version = await member.client.getVersion()
+          member.status.healthy = true
+        } catch {
+          member.status.healthy = false
+        }
+      }),
+    )
+    return this.status()
+  }
+
+  status(): DeviceStatus[] {
+    return [...this.members.values()].map(member => ({ ...member.status }))
+  }
+
+  /** Runs task on the device serving key, failing over to the next one when the transport drops */
+  async run<T>(key: string, task: (client: PeaqClient) => Promise<T>): Promise<T> {
+    const tried = new Set<string>()
+    const failovers = this.options.failovers ?? 1
+    for (;;) {
+      const member = this.route(key, tried)
+      if (member === undefined) {
+        throw new Error('no healthy device in the pool')
+      }
+      tried.add(member.id)
+      member.status.pending++
+      try {
+        const result = await task(member.client)
+        member.status.completed++
+        return result
+      } catch (e) {
+        member.status.failures++
+        // device answers (rejections, invalid data) would be the same on any device
+        if (!isTransportError(e)) {
+          throw e
+        }
+        member.status.healthy = false
+        if (tried.size > failovers) {
+          throw e
+        }
+      } finally {
+        member.status.pending--
+      }
+    }
+  }
+
+  signEthTransaction(path: string, tx: Buffer, options?: EthSignOptions): Promise<EthSignature> {
+    return this.run(path, client => client.signEthTransaction(path, tx, options))
+  }
+
+  signPersonalMessage(path: string, message: Buffer, options?: EthSignOptions): Promise<EthSignature> {
+    return this.run(path, client => client.signPersonalMessage(path, message, options))
+  }
+
+  signEthBatch(path: string, txs: Buffer[]): Promise<EthSignature[]> {
+    return this.run(path, client => client.signEthBatch(path, txs))
+  }
+
+  signSubstrate(path: string, payload: Buffer): Promise<Buffer> {
+    return this.run(path, client => client.signSubstrate(path, payload))
+  }
+
+  getSubstrateAddress(path: string): Promise<SubstrateAddress> {
+    return this.run(path, client => client.getSubstrateAddress(path))
+  }
+
+  close(): void {
+    if (this.timer !== undefined) {
+      clearInterval(this.timer)
+      this.timer = undefined
+    }
+  }
+
+  private route(key: string, exclude: Set<string>): Member | undefined {
+    let best: Member | undefined
+    let bestScore = -1
+    for (const member of this.members.values()) {
+      if (!member.status.healthy || exclude.has(member.id)) {
+        continue
+      }
+      const score = hash(`${member.id}/${key}`)
+      if (score > bestScore) {
+        best = member
+        bestScore = score
+      }
+    }
+    return best
+  }
+}
@@ -0,0 +1,161 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import { Capabilities, EthSignature, EthSigningPolicy, UploadStatus, Version } from './types'
+import { ETH_ADDRESS_LEN, ETH_MULTIPATH_MAX, ETH_POLICY_MAX_RECIPIENTS, ETH_SIGNATURE_RSV_LEN, SUBSTRATE_PATH_LEN } from './consts'
+
+const HARDENED = 0x80000000
+
+export function parsePath(path: string): number[] {
+  const elements = path.replace(/^m\//, '').split('/')
+  return elements.map(e => {
+    const hardened = e.endsWith("'")
+    const index = Number(hardened ? e.slice(0, -1) : e)
+    if (!Number.isInteger(index) || index < 0 || index >= HARDENED) {
+      throw new Error(`invalid path element ${e}`)
+    }
+    return (hardened ? index + HARDENED : index) >>> 0
+  })
+}
+
+/** EVM paths: [number of items (1)] then big endian items */
+export function serializeEthPath(path: string): Buffer {
+  const elements = parsePath(path)
+  const buf = Buffer.alloc(1 + 4 * elements.length)
+  buf.writeUInt8(elements.length, 0)
+  elements.forEach((e, i) => buf.writeUInt32BE(e, 1 + 4 * i))
+  return buf
+}
+
+/** Multi path uploads: [number of paths (1)] then every path as serializeEthPath does */
+export function serializeEthPathList(paths: string[]): Buffer {
+  if (paths.length < 2 || paths.length > ETH_MULTIPATH_MAX) {
+    throw new Error(`multi path uploads hold 2 to ${ETH_MULTIPATH_MAX} paths`)
+  }
+  return Buffer.concat([Buffer.from([paths.length]), ...paths.map(serializeEthPath)])
+}
+
+/** Substrate paths: exactly five little endian items */
+export function serializeSubstratePath(path: string): Buffer {
+  const elements = parsePath(path)
+  if (elements.length !== SUBSTRATE_PATH_LEN) {
+    throw new Error(`substrate paths have ${SUBSTRATE_PATH_LEN} elements`)
+  }
+  const buf = Buffer.alloc(4 * SUBSTRATE_PATH_LEN)
+  elements.forEach((e, i) => buf.writeUInt32LE(e, 4 * i))
+  return buf
+}
+
+function ethAddress(address: string): Buffer {
+  const buf = Buffer.from(address.replace(/^0x/, ''), 'hex')
+  if (buf.length !== ETH_ADDRESS_LEN) {
+    throw new Error(`invalid address ${address}`)
+  }
+  return buf
+}
+
+function uint256(value: bigint, name: string): Buffer {
+  if (value < 0n || value >= 1n << 256n) {
+    throw new Error(`${name} does not fit in 256 bits`)
+  }
+  return Buffer.from(value.toString(16).padStart(64, '0'), 'hex')
+}
+
+/** SET_POLICY_ETH payload after the path, numbers big endian */
+export function serializeEthPolicy(policy: EthSigningPolicy): Buffer {
+  if (policy.recipients.length === 0 || policy.recipients.length > ETH_POLICY_MAX_RECIPIENTS) {
+    throw new Error(`policies allow 1 to ${ETH_POLICY_MAX_RECIPIENTS} recipients`)
+  }
+  if (!Number.isInteger(policy.signatures) || policy.signatures < 1 || policy.signatures > 0xffff) {
+    throw new Error('policies allow 1 to 65535 signatures')
+  }
+  const header = Buffer.alloc(10)
+  header.writeBigUInt64BE(BigInt(policy.chainId), 0)
+  header.writeUInt16BE(policy.signatures, 8)
+  return Buffer.concat([
+    header,
+    policy.token === undefined ? Buffer.alloc(ETH_ADDRESS_LEN) : ethAddress(policy.token),
+    uint256(policy.valueCap, 'value cap'),
+    uint256(policy.feeCap, 'fee cap'),
+    Buffer.from([policy.recipients.length]),
+    ...policy.recipients.map(ethAddress),
+  ])
+}
+
+/** Splits an upload into APDU payloads; the first one carries header, then as much data as fits */
+export function chunk(header: Buffer, data: Buffer, chunkSize: number): Buffer[] {
+  if (header.length > chunkSize) {
+    throw new Error('header does not fit in one chunk')
+  }
+  const first = Math.min(chunkSize - header.length, data.length)
+  const chunks = [Buffer.concat([header, data.subarray(0, first)])]
+  for (let offset = first; offset < data.length; offset += chunkSize) {
+    chunks.push(data.subarray(offset, offset + chunkSize))
+  }
+  return chunks
+}
+
+export function parseCapabilities(resp: Buffer): Capabilities {
+  if (resp.length < 19) {
+    throw new Error('short GET_CAPABILITIES response')
+  }
+  return {
+    version: resp[0],
+    ramBuffer: resp.readUInt32BE(1),
+    flashBuffer: resp.readUInt32BE(5),
+    chunkSize: resp[9],
+    features: resp.readUInt32BE(10),
+    batchTxs: resp[14],
+    ethAddrBatch: resp[15],
+    ss58AddrBatch: resp[16],
+    msgDisplay: resp.readUInt16BE(17),
+    // earlier builds kept a batch like a personal message
+    batchBytes: resp.length >= 21 ? resp.readUInt16BE(19) : resp.readUInt16BE(17),
+  }
+}
+
+export function parseUploadStatus(resp: Buffer): UploadStatus {
+  if (resp.length < 7) {
+    throw new Error('short upload status response')
+  }
+  return { inProgress: resp[0] === 1, received: resp.readUInt32BE(1), chunks: resp.readUInt16BE(5) }
+}
+
+export function parseVersion(resp: Buffer): Version {
+  if (resp.length < 12) {
+    throw new Error('short GET_VERSION response')
+  }
+  return {
+    testMode: resp[0] !== 0,
+    major: resp.readUInt16BE(1),
+    minor: resp.readUInt16BE(3),
+    patch: resp.readUInt16BE(5),
+    deviceLocked: resp[7] === 1,
+    targetId: resp.subarray(8, 12).toString('hex'),
+  }
+}
+
+/** v|r|s, optionally followed by DER */
+export function parseEthSignature(data: Buffer): EthSignature {
+  if (data.length < ETH_SIGNATURE_RSV_LEN) {
+    throw new Error('short signature')
+  }
+  const signature: EthSignature = { v: data[0], r: data.subarray(1, 33), s: data.subarray(33, 65) }
+  if (data.length > ETH_SIGNATURE_RSV_LEN) {
+    signature.der = data.subarray(ETH_SIGNATURE_RSV_LEN)
+  }
+  return signature
+}
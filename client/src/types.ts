@@ -0,0 +1,125 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+/** Buffers and optional flows of the app build, as answered by GET_CAPABILITIES */
+export interface Capabilities {
+  version: number
+  ramBuffer: number
+  flashBuffer: number
+  /** largest payload of one APDU */
+  chunkSize: number
+  features: number
+  batchTxs: number
+  ethAddrBatch: number
+  ss58AddrBatch: number
+  msgDisplay: number
+  /** serialized size of a SIGN_BATCH_ETH batch */
+  batchBytes: number
+}
+
+/** INS_SIGN_ETH upload in progress on the device */
+export interface UploadStatus {
+  inProgress: boolean
+  /** transaction bytes accepted, path excluded */
+  received: number
+  chunks: number
+}
+
+export interface Version {
+  testMode: boolean
+  major: number
+  minor: number
+  patch: number
+  deviceLocked: boolean
+  targetId: string
+}
+
+export interface EthSignature {
+  v: number
+  r: Buffer
+  s: Buffer
+  /** DER encoding of r and s, only in the DER format */
+  der?: Buffer
+}
+
+export interface SubstrateAddress {
+  publicKey?: Buffer
+  address: string
+}
+
+/** One APDU round trip */
+export interface ExchangeMetric {
+  cla: number
+  ins: number
+  p1: number
+  p2: number
+  bytesOut: number
+  bytesIn: number
+  durationMs: number
+  /** 0 for the first try */
+  attempt: number
+}
+
+/** One client call, from the moment it was queued to its last response */
+export interface CommandMetric {
+  command: string
+  exchanges: number
+  bytesOut: number
+  bytesIn: number
+  retries: number
+  queuedMs: number
+  durationMs: number
+  /** payload bytes sent per second while the command was running */
+  throughput: number
+  ok: boolean
+}
+
+export interface MetricsHooks {
+  onExchange?: (metric: ExchangeMetric) => void
+  onCommand?: (metric: CommandMetric) => void
+}
+
+export interface ClientOptions {
+  /** transport errors tolerated per command before giving up */
+  retries?: number
+  /** upper bound of the chunk size; the device limit from GET_CAPABILITIES is used when lower */
+  chunkSize?: number
+  metrics?: MetricsHooks
+}
+
+export interface SubstrateSignOptions {
+  /** RFC-78 metadata proof, for payloads with CheckMetadataHash enabled */
+  metadataProof?: Buffer
+}
+
+/** Transfers SIGN_ETH signs without a review once the policy is approved on the device */
+export interface EthSigningPolicy {
+  chainId: bigint | number
+  /** signatures allowed before the policy expires */
+  signatures: number
+  /** ERC20 contract of token transfers; native transfers when unset */
+  token?: string
+  /** largest amount per transaction, in wei or in units of the token */
+  valueCap: bigint
+  /** largest gasLimit * fee cap per transaction, in wei */
+  feeCap: bigint
+  recipients: string[]
+}
+
+export interface EthSignOptions {
+  /** v|r|s only, without the DER copy */
+  compact?: boolean
+}
@@ -0,0 +1,262 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Transport from '@ledgerhq/hw-transport'
+
+import {
+  CLA_ETH,
+  INS,
+  P1_ETH_BATCH_SIGNATURES,
+  P1_ETH_FIRST,
+  P1_ETH_MORE,
+  P1_ETH_PATH_SIGNATURES,
+  P1_ETH_POLICY_SET,
+  P1_ETH_POLICY_STATUS,
+  P1_ETH_UPLOAD_STATUS,
+  P1_SUBSTRATE_ADD,
+  P1_SUBSTRATE_INIT,
+  P1_SUBSTRATE_LAST,
+  P1_SUBSTRATE_PROOF,
+  P2_ETH_SIG_MULTI,
+  PeaqClient,
+} from '../src'
+
+const PATH = "m/44'/60'/0'/0/0"
+
+interface Sent {
+  cla: number
+  ins: number
+  p1: number
+  p2: number
+  data: Buffer
+}
+
+// capabilities of a device with 32 byte chunks
+const CAPABILITIES = Buffer.from('01' + '00002400' + '0000a000' + '20' + '000000ff' + '320c05' + '0100' + '0200' + '9000', 'hex')
+const OK = Buffer.from('9000', 'hex')
+
+function mockTransport(answer: (apdu: Sent, sent: Sent[]) => Buffer): { transport: Transport; sent: Sent[] } {
+  const sent: Sent[] = []
+  const transport = {
+    send: async (cla: number, ins: number, p1: number, p2: number, data: Buffer = Buffer.alloc(0)) => {
+      const apdu = { cla, ins, p1, p2, data: Buffer.from(data) }
+      sent.push(apdu)
+      return answer(apdu, sent)
+    },
+  } as unknown as Transport
+  return { transport, sent }
+}
+
+function rsv(v: number): Buffer {
+  return Buffer.concat([Buffer.from([v]), Buffer.alloc(64, v)])
+}
+
+describe('PeaqClient', () => {
+  test('sizes chunks from the capabilities', async () => {
+    const { transport, sent } = mockTransport(apdu => (apdu.ins === INS.GET_CAPABILITIES ? CAPABILITIES : Buffer.concat([rsv(1), OK])))
+    const client = new PeaqClient(transport)
+
+    const tx = Buffer.alloc(20, 0xaa)
+    const signature = await client.signEthTransaction(PATH, tx, { compact: true })
+    expect(signature.v).toEqual(1)
+    expect(signature.der).toBeUndefined()
+
+    const upload = sent.filter(apdu => apdu.ins === INS.SIGN_ETH)
+    // 21 bytes of path, then 11 + 9 bytes of transaction
+    expect(upload.map(apdu => apdu.data.length)).toEqual([32, 9])
+    expect(upload.every(apdu => apdu.cla === CLA_ETH && apdu.p2 === 1)).toBe(true)
+    expect(upload[0].p1).toEqual(P1_ETH_FIRST)
+    expect(upload.slice(1).every(apdu => apdu.p1 === P1_ETH_MORE)).toBe(true)
+    expect(Buffer.concat(upload.map(apdu => apdu.data)).subarray(21)).toEqual(tx)
+  })
+
+  test('restarts interrupted uploads and queues calls', async () => {
+    let failures = 1
+    const { transport, sent } = mockTransport((apdu, all) => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return CAPABILITIES
+      if (apdu.p1 === P1_ETH_MORE && failures > 0 && all.filter(a => a.ins === INS.SIGN_ETH).length === 2) {
+        failures--
+        throw new Error('disconnected')
+      }
+      return Buffer.concat([rsv(0), OK])
+    })
+    const retries: number[] = []
+    const client = new PeaqClient(transport, { metrics: { onCommand: m => retries.push(m.retries) } })
+
+    const tx = Buffer.alloc(600, 0x01)
+    await Promise.all([client.signEthTransaction(PATH, tx), client.signEthTransaction(PATH, tx)])
+    expect(retries).toEqual([0, 1, 0])
+
+    // the failed upload started over from its first chunk
+    const firsts = sent.filter(apdu => apdu.ins === INS.SIGN_ETH && apdu.p1 === P1_ETH_FIRST)
+    expect(firsts.length).toEqual(3)
+  })
+
+  test('resumes interrupted uploads after the last accepted chunk', async () => {
+    const caps = Buffer.from(CAPABILITIES)
+    caps[12] = 0x08
+    // the device keeps the third chunk, its reply is lost
+    const accepted: Buffer[] = []
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return caps
+      if (apdu.p1 === P1_ETH_UPLOAD_STATUS) {
+        const status = Buffer.alloc(7)
+        status[0] = 1
+        status.writeUInt32BE(Buffer.concat(accepted).length - 21, 1)
+        status.writeUInt16BE(accepted.length, 5)
+        return Buffer.concat([status, OK])
+      }
+      accepted.push(apdu.data)
+      if (accepted.length === 3 && sent.filter(a => a.p1 === P1_ETH_UPLOAD_STATUS).length === 0) {
+        throw new Error('disconnected')
+      }
+      return Buffer.concat([rsv(0), OK])
+    })
+    const client = new PeaqClient(transport)
+
+    const tx = Buffer.alloc(200, 0x01)
+    await client.signEthTransaction(PATH, tx)
+    const upload = sent.filter(apdu => apdu.ins === INS.SIGN_ETH && apdu.p1 !== P1_ETH_UPLOAD_STATUS)
+    expect(upload.filter(apdu => apdu.p1 === P1_ETH_FIRST).length).toEqual(1)
+    expect(Buffer.concat(upload.map(apdu => apdu.data)).subarray(21)).toEqual(tx)
+  })
+
+  test('never sends the last chunk twice', async () => {
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return CAPABILITIES
+      throw new Error('disconnected')
+    })
+    const client = new PeaqClient(transport)
+    await expect(client.signEthTransaction(PATH, Buffer.alloc(10))).rejects.toThrow('disconnected')
+    expect(sent.filter(apdu => apdu.ins === INS.SIGN_ETH).length).toEqual(1)
+  })
+
+  test('sends the metadata proof before the Substrate payload', async () => {
+    const caps = Buffer.from(CAPABILITIES)
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return caps
+      return apdu.p1 === P1_SUBSTRATE_LAST ? Buffer.concat([Buffer.from([0]), Buffer.alloc(64, 7), OK]) : OK
+    })
+    const proof = Buffer.alloc(40, 0xcc)
+    const payload = Buffer.alloc(40, 0x05)
+
+    await expect(new PeaqClient(transport).signSubstrate(PATH, payload, { metadataProof: proof })).rejects.toThrow('not supported')
+
+    caps[12] = 0x10
+    sent.length = 0
+    const signature = await new PeaqClient(transport).signSubstrate(PATH, payload, { metadataProof: proof })
+    expect(signature).toEqual(Buffer.alloc(64, 7))
+    const upload = sent.filter(apdu => apdu.ins === INS.SIGN)
+    expect(upload.map(apdu => apdu.p1)).toEqual([
+      P1_SUBSTRATE_INIT,
+      P1_SUBSTRATE_PROOF,
+      P1_SUBSTRATE_PROOF,
+      P1_SUBSTRATE_ADD,
+      P1_SUBSTRATE_LAST,
+    ])
+    expect(Buffer.concat(upload.slice(1, 3).map(apdu => apdu.data))).toEqual(proof)
+  })
+
+  test('sets a signing policy in one reviewed command', async () => {
+    const caps = Buffer.from(CAPABILITIES)
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return caps
+      return apdu.p1 === P1_ETH_POLICY_STATUS ? Buffer.from('00039000', 'hex') : OK
+    })
+    const policy = {
+      chainId: 3338,
+      signatures: 3,
+      valueCap: 10n ** 18n,
+      feeCap: 42000n,
+      recipients: ['0x' + '11'.repeat(20)],
+    }
+
+    await expect(new PeaqClient(transport).setEthSigningPolicy(PATH, policy)).rejects.toThrow('not supported')
+
+    caps[12] = 0x20
+    sent.length = 0
+    const client = new PeaqClient(transport)
+    await client.setEthSigningPolicy(PATH, policy)
+    expect(await client.getEthSigningPolicyRemaining()).toEqual(3)
+
+    const set = sent.filter(apdu => apdu.ins === INS.SET_POLICY_ETH && apdu.p1 === P1_ETH_POLICY_SET)
+    expect(set).toHaveLength(1)
+    // chain id, signatures, no token, value and fee caps, one recipient
+    const amounts = (10n ** 18n).toString(16).padStart(64, '0') + 'a410'.padStart(64, '0')
+    const expected = '0000000000000d0a' + '0003' + '00'.repeat(20) + amounts + '01' + '11'.repeat(20)
+    expect(set[0].data.subarray(21).toString('hex')).toEqual(expected)
+    await expect(client.setEthSigningPolicy(PATH, { ...policy, recipients: [] })).rejects.toThrow('1 to 4 recipients')
+  })
+
+  test('signs one transaction with several paths and fetches the remaining signatures', async () => {
+    const caps = Buffer.from(CAPABILITIES)
+    caps[9] = 0xc8
+    caps[12] = 0x40
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return caps
+      if (apdu.p1 === P1_ETH_PATH_SIGNATURES) return Buffer.concat([rsv(apdu.data[0]), rsv(apdu.data[0] + 1), OK])
+      return Buffer.concat([rsv(0), rsv(1), rsv(2), OK])
+    })
+    const client = new PeaqClient(transport)
+
+    const paths = [0, 1, 2, 3, 4].map(i => `m/44'/60'/0'/0/${i}`)
+    const signatures = await client.signEthTransactionMultiPath(paths, Buffer.alloc(43, 0x02))
+    expect(signatures.map(signature => signature.v)).toEqual([0, 1, 2, 3, 4])
+
+    const sign = sent.filter(apdu => apdu.ins === INS.SIGN_ETH)
+    expect(sign.map(apdu => [apdu.p1, apdu.p2])).toEqual([
+      [P1_ETH_FIRST, P2_ETH_SIG_MULTI],
+      [P1_ETH_PATH_SIGNATURES, 0],
+    ])
+    // [count] then [length][items] per path
+    expect(sign[0].data.subarray(0, 1 + 21).toString('hex')).toEqual('05' + '05' + '8000002c8000003c800000000000000000000000')
+    await expect(client.signEthTransactionMultiPath(paths.slice(0, 1), Buffer.alloc(43))).rejects.toThrow('2 to 5 paths')
+  })
+
+  test('signs a batch of personal messages and fetches the remaining signatures', async () => {
+    const caps = Buffer.from(CAPABILITIES)
+    caps[12] = 0x03
+    const { transport, sent } = mockTransport(apdu => {
+      if (apdu.ins === INS.GET_CAPABILITIES) return caps
+      if (apdu.p1 === P1_ETH_BATCH_SIGNATURES) return Buffer.concat([rsv(apdu.data[0]), OK])
+      return apdu.p1 === P1_ETH_FIRST ? OK : Buffer.concat([rsv(0), rsv(1), rsv(2), OK])
+    })
+    const client = new PeaqClient(transport)
+
+    const messages = ['a', 'bb', 'ccc', 'dddd'].map(m => Buffer.from(m))
+    const signatures = await client.signPersonalMessageBatch(PATH, messages)
+    expect(signatures.map(signature => signature.v)).toEqual([0, 1, 2, 3])
+
+    const upload = sent.filter(apdu => apdu.ins === INS.SIGN_BATCH_PERSONAL_MESSAGE && apdu.p1 !== P1_ETH_BATCH_SIGNATURES)
+    expect(Buffer.concat(upload.map(apdu => apdu.data)).subarray(21).toString('hex')).toEqual(
+      '00000012' + '000161' + '00026262' + '0003636363' + '000464646464',
+    )
+    await expect(client.signPersonalMessageBatch(PATH, [Buffer.alloc(300)])).rejects.toThrow('up to 256 bytes')
+  })
+
+  test('bounds transaction batches by count and by size', async () => {
+    const { transport, sent } = mockTransport(apdu => (apdu.ins === INS.GET_CAPABILITIES ? CAPABILITIES : OK))
+    const client = new PeaqClient(transport)
+
+    await expect(client.signEthBatch(PATH, Array.from({ length: 51 }, () => Buffer.alloc(10)))).rejects.toThrow('1 to 50 transactions')
+    await expect(client.signEthBatch(PATH, [Buffer.alloc(300), Buffer.alloc(300)])).rejects.toThrow('up to 512 bytes')
+    expect(sent.filter(apdu => apdu.ins === INS.SIGN_BATCH_ETH)).toEqual([])
+
+    // without BATCH_BYTES a batch is bound like a personal message
+    const legacy = mockTransport(apdu => (apdu.ins === INS.GET_CAPABILITIES ? Buffer.concat([CAPABILITIES.subarray(0, 19), OK]) : OK))
+    await expect(new PeaqClient(legacy.transport).signEthBatch(PATH, [Buffer.alloc(300)])).rejects.toThrow('up to 256 bytes')
+  })
+})
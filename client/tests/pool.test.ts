@@ -0,0 +1,77 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Transport from '@ledgerhq/hw-transport'
+
+import { DevicePool, INS } from '../src'
+
+const VERSION = Buffer.from('00' + '0001' + '0002' + '0003' + '00' + '33100004' + '9000', 'hex')
+const CAPABILITIES = Buffer.from('01' + '00002400' + '0000a000' + 'ff' + '000000ff' + '320c05' + '0100' + '9000', 'hex')
+const SIGNATURE = Buffer.concat([Buffer.alloc(65, 1), Buffer.from('9000', 'hex')])
+
+function device(id: string, log: string[], state = { connected: true }) {
+  const transport = {
+    send: async (_cla: number, ins: number) => {
+      if (!state.connected) throw new Error('disconnected')
+      if (ins === INS.GET_VERSION) return VERSION
+      if (ins === INS.GET_CAPABILITIES) return CAPABILITIES
+      log.push(id)
+      return SIGNATURE
+    },
+  } as unknown as Transport
+  return { id, transport, state }
+}
+
+const paths = [0, 1, 2, 3, 4, 5, 6, 7].map(i => `m/44'/60'/0'/0/${i}`)
+
+describe('DevicePool', () => {
+  test('keeps every path on one device', async () => {
+    const log: string[] = []
+    const pool = new DevicePool([device('a', log), device('b', log), device('c', log)])
+    const status = await pool.checkHealth()
+    expect(status.every(s => s.healthy && s.version?.minor === 2)).toBe(true)
+
+    for (let round = 0; round < 2; round++) {
+      for (const path of paths) {
+        await pool.signEthTransaction(path, Buffer.alloc(10), { compact: true })
+      }
+    }
+    // same device for a path in both rounds
+    expect(log.slice(paths.length)).toEqual(log.slice(0, paths.length))
+    expect(new Set(log).size).toBeGreaterThan(1)
+  })
+
+  test('fails over when a transport drops', async () => {
+    const log: string[] = []
+    const devices = [device('a', log), device('b', log)]
+    const pool = new DevicePool(devices)
+    await pool.checkHealth()
+
+    devices[0].state.connected = false
+    await Promise.all(paths.map(path => pool.signEthTransaction(path, Buffer.alloc(10))))
+    expect(log).toEqual(paths.map(() => 'b'))
+    expect(pool.status().find(s => s.id === 'a')?.healthy).toBe(false)
+
+    devices[1].state.connected = false
+    await expect(pool.signEthTransaction(paths[0], Buffer.alloc(10))).rejects.toThrow()
+    await expect(pool.signEthTransaction(paths[0], Buffer.alloc(10))).rejects.toThrow('no healthy device')
+
+    devices[0].state.connected = true
+    await pool.checkHealth()
+    await pool.signEthTransaction(paths[0], Buffer.alloc(10))
+    expect(log[log.length - 1]).toEqual('a')
+  })
+})
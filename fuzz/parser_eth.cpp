@@ -0,0 +1,320 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "app_mode.h"
+#include "parser_evm.h"
+#include "parser_impl_evm.h"
+#include "zxformat.h"
+
+#ifdef NDEBUG
+#error "This fuzz target won't work correctly with NDEBUG defined, which will cause asserts to be eliminated"
+#endif
+
+// EVM transactions through parse, validation and every review page.
+//
+// Random bytes rarely survive the RLP envelope, so the custom mutator works on
+// decoded transactions instead: it splits the input into the type byte and the
+// top level items, mutates one of them (or plants a supported chain id, a
+// known selector, another type byte) and encodes a well-formed envelope again.
+// Parser state is reset by parser_parse_eth, so inputs run back to back in one
+// process (persistent mode) without any per-input setup.
+//
+// Seeds: the encoded_tx_hex of tests/evm.json, written by run-fuzzers.py.
+
+using std::size_t;
+
+extern "C" size_t LLVMFuzzerMutate(uint8_t *data, size_t size, size_t maxSize);
+
+namespace {
+char PARSER_KEY[16384];
+char PARSER_VALUE[16384];
+
+using Bytes = std::vector<uint8_t>;
+
+struct Item {
+    bool isList;
+    Bytes payload;
+};
+
+struct Tx {
+    // 0 for legacy transactions
+    uint8_t type;
+    std::vector<Item> items;
+};
+
+// legacy: [nonce, gasPrice, gasLimit, to, value, data, chainId, 0, 0]; typed: chainId first
+constexpr size_t LEGACY_CHAIN_ID_IDX = 6;
+// typed transactions move every field one place (EIP-2930) or two (EIP-1559, two fee fields)
+constexpr size_t TO_IDX_LEGACY = 3;
+constexpr size_t MAX_ITEMS = 16;
+
+constexpr uint8_t ERC20_TRANSFER[] = {0xa9, 0x05, 0x9c, 0xbb};
+
+bool readHeader(const uint8_t *p, size_t avail, bool *isList, size_t *headerLen, size_t *payloadLen) {
+    if (avail == 0) {
+        return false;
+    }
+    const uint8_t b = p[0];
+    *isList = b >= 0xc0;
+    if (b < 0x80) {
+        *headerLen = 0;
+        *payloadLen = 1;
+    } else if (b <= 0xb7 || (b >= 0xc0 && b <= 0xf7)) {
+        *headerLen = 1;
+        *payloadLen = b - (*isList ? 0xc0 : 0x80);
+    } else {
+        const size_t lenLen = b - (*isList ? 0xf7 : 0xb7);
+        if (lenLen > 3 || avail < 1 + lenLen) {
+            return false;
+        }
+        *headerLen = 1 + lenLen;
+        *payloadLen = 0;
+        for (size_t i = 0; i < lenLen; i++) {
+            *payloadLen = (*payloadLen << 8) | p[1 + i];
+        }
+    }
+    return *headerLen + *payloadLen <= avail;
+}
+
+bool decodeTx(const uint8_t *data, size_t size, Tx *tx) {
+    tx->type = 0;
+    tx->items.clear();
+    if (size > 0 && (data[0] == eip2930 || data[0] == eip1559)) {
+        tx->type = data[0];
+        data++;
+        size--;
+    }
+    bool isList = false;
+    size_t headerLen = 0;
+    size_t payloadLen = 0;
+    if (!readHeader(data, size, &isList, &headerLen, &payloadLen) || !isList) {
+        return false;
+    }
+    size_t offset = headerLen;
+    const size_t end = headerLen + payloadLen;
+    while (offset < end && tx->items.size() < MAX_ITEMS) {
+        if (!readHeader(data + offset, end - offset, &isList, &headerLen, &payloadLen)) {
+            return false;
+        }
+        const uint8_t *payload = data + offset + headerLen;
+        tx->items.push_back(Item{isList, Bytes(payload, payload + payloadLen)});
+        offset += headerLen + payloadLen;
+    }
+    return true;
+}
+
+void appendHeader(Bytes *out, size_t len, bool isList) {
+    const uint8_t base = isList ? 0xc0 : 0x80;
+    if (len < 56) {
+        out->push_back((uint8_t)(base + len));
+        return;
+    }
+    uint8_t lenBytes[sizeof(size_t)] = {0};
+    size_t lenLen = 0;
+    for (size_t v = len; v != 0; v >>= 8) {
+        lenBytes[lenLen++] = (uint8_t)v;
+    }
+    out->push_back((uint8_t)(base + 55 + lenLen));
+    while (lenLen > 0) {
+        out->push_back(lenBytes[--lenLen]);
+    }
+}
+
+void appendItem(Bytes *out, const Item &item) {
+    // single bytes below 0x80 are their own encoding
+    if (!item.isList && item.payload.size() == 1 && item.payload[0] < 0x80) {
+        out->push_back(item.payload[0]);
+        return;
+    }
+    appendHeader(out, item.payload.size(), item.isList);
+    out->insert(out->end(), item.payload.begin(), item.payload.end());
+}
+
+Bytes encodeTx(const Tx &tx) {
+    Bytes body;
+    for (const Item &item : tx.items) {
+        appendItem(&body, item);
+    }
+    Bytes out;
+    if (tx.type != 0) {
+        out.push_back(tx.type);
+    }
+    appendHeader(&out, body.size(), true);
+    out.insert(out.end(), body.begin(), body.end());
+    return out;
+}
+
+Bytes minimalBE(uint64_t value) {
+    Bytes out;
+    for (; value != 0; value >>= 8) {
+        out.insert(out.begin(), (uint8_t)value);
+    }
+    return out;
+}
+
+size_t chainIdIdx(const Tx &tx) {
+    return tx.type == 0 ? LEGACY_CHAIN_ID_IDX : 0;
+}
+
+size_t toIdx(const Tx &tx) {
+    if (tx.type == eip1559) {
+        return TO_IDX_LEGACY + 2;
+    }
+    return tx.type == eip2930 ? TO_IDX_LEGACY + 1 : TO_IDX_LEGACY;
+}
+
+// value sits between the recipient and the calldata
+size_t dataIdx(const Tx &tx) {
+    return toIdx(tx) + 2;
+}
+
+void mutateItem(Item *item, std::mt19937 *rng, size_t maxSize) {
+    Bytes &payload = item->payload;
+    const size_t size = payload.size();
+    payload.resize(std::max(size, maxSize));
+    // LLVMFuzzerMutate needs at least one byte to work on
+    if (size == 0) {
+        payload[0] = (uint8_t)(*rng)();
+    }
+    payload.resize(LLVMFuzzerMutate(payload.data(), std::max(size, (size_t)1), payload.size()));
+}
+
+void mutateTx(Tx *tx, std::mt19937 *rng, size_t maxSize) {
+    const size_t numItems = tx->items.size();
+    switch ((*rng)() % 6) {
+        case 0:
+            if (numItems > 0) {
+                mutateItem(&tx->items[(*rng)() % numItems], rng, maxSize);
+            }
+            break;
+        case 1:
+            // a supported chain id gets past the first check of every type
+            if (chainIdIdx(*tx) < numItems) {
+                const uint64_t chainId = supported_networks_evm[(*rng)() % SUPPORTED_NETWORKS_EVM_LEN];
+                tx->items[chainIdIdx(*tx)] = Item{false, minimalBE(chainId)};
+            }
+            break;
+        case 2: {
+            const uint8_t types[] = {0, eip2930, eip1559};
+            tx->type = types[(*rng)() % sizeof(types)];
+            break;
+        }
+        case 3:
+            // ERC-20 transfers take the token review path
+            if (dataIdx(*tx) < numItems) {
+                Bytes calldata(ERC20_TRANSFER, ERC20_TRANSFER + sizeof(ERC20_TRANSFER));
+                calldata.resize(sizeof(ERC20_TRANSFER) + 64);
+                for (size_t i = sizeof(ERC20_TRANSFER) + 12; i < calldata.size(); i++) {
+                    calldata[i] = (uint8_t)(*rng)();
+                }
+                tx->items[dataIdx(*tx)] = Item{false, calldata};
+            }
+            break;
+        case 4:
+            if (numItems > 0 && (*rng)() % 2 == 0) {
+                tx->items.erase(tx->items.begin() + (*rng)() % numItems);
+            } else if (numItems > 0 && numItems < MAX_ITEMS) {
+                const Item copy = tx->items[(*rng)() % numItems];
+                tx->items.insert(tx->items.begin() + (*rng)() % (numItems + 1), copy);
+            }
+            break;
+        default:
+            // recipients are 20 bytes or empty (contract creation)
+            if (toIdx(*tx) < numItems) {
+                Bytes to((*rng)() % 4 == 0 ? 0 : ETH_ADDRESS_LEN);
+                for (uint8_t &b : to) {
+                    b = (uint8_t)(*rng)();
+                }
+                tx->items[toIdx(*tx)] = Item{false, to};
+            }
+            break;
+    }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    // every review path, including blind signed calldata and the expert pages
+    app_mode_set_blindsign(true);
+    app_mode_set_expert(true);
+    return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t *data, size_t size, size_t maxSize, unsigned int seed) {
+    std::mt19937 rng(seed);
+    Tx tx;
+    // some raw mutations keep the envelope checks covered too
+    if (rng() % 8 == 0 || !decodeTx(data, size, &tx)) {
+        return LLVMFuzzerMutate(data, size, maxSize);
+    }
+    mutateTx(&tx, &rng, maxSize);
+    const Bytes out = encodeTx(tx);
+    if (out.size() > maxSize) {
+        return LLVMFuzzerMutate(data, size, maxSize);
+    }
+    memcpy(data, out.data(), out.size());
+    return out.size();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size > UINT16_MAX) {
+        return 0;
+    }
+    parser_context_t ctx;
+    parser_error_t rc = parser_parse_eth(&ctx, data, size);
+    if (rc != parser_ok) {
+        return 0;
+    }
+
+    rc = parser_validate_eth(&ctx);
+    if (rc != parser_ok) {
+        return 0;
+    }
+
+    uint8_t num_items = 0;
+    rc = parser_getNumItemsEth(&ctx, &num_items);
+    if (rc != parser_ok) {
+        fprintf(stderr, "error in parser_getNumItemsEth: %s\n", parser_getErrorDescription(rc));
+        assert(false);
+    }
+
+    for (uint8_t i = 0; i < num_items; i += 1) {
+        uint8_t page_idx = 0;
+        uint8_t page_count = 1;
+        while (page_idx < page_count) {
+            rc = parser_getItemEth(&ctx, i, PARSER_KEY, sizeof(PARSER_KEY), PARSER_VALUE, sizeof(PARSER_VALUE), page_idx,
+                                   &page_count);
+            if (rc != parser_ok) {
+                (void)fprintf(stderr, "error getting item %u at page index %u: %s\n", (unsigned)i, (unsigned)page_idx,
+                              parser_getErrorDescription(rc));
+                assert(false);
+            }
+            page_idx += 1;
+        }
+    }
+
+    return 0;
+}
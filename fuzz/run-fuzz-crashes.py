@@ -11,6 +11,8 @@ MUTATE_DEPTH = random.randint(1, 20)
 # (fuzzer name, max length, max time scale factor)
 CONFIGS = [
     ('parser_parse', 17000, 4),
+    ('parser_eth', 8192, 4),
+    ('uint256_diff', 80, 1),
 ]
 
 for config in CONFIGS:
@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import json
 import os
 import random
 import shlex
@@ -11,8 +12,25 @@ MUTATE_DEPTH = random.randint(1, 20)
 # (fuzzer name, max length, max time scale factor)
 CONFIGS = [
     ('parser_parse', 17000, 4),
+    ('parser_eth', 8192, 4),
+    ('uint256_diff', 80, 1),
 ]
 
+# fuzzer name -> test vectors whose encoded_tx_hex seed an empty corpus
+SEEDS = {
+    'parser_eth': os.path.join('tests', 'evm.json'),
+}
+
+
+def seed_corpus(corpus_dir, vectors):
+    if os.listdir(corpus_dir):
+        return
+    with open(vectors) as f:
+        for i, vector in enumerate(json.load(f)):
+            with open(os.path.join(corpus_dir, f'seed-{i:04d}'), 'wb') as seed:
+                seed.write(bytes.fromhex(vector['encoded_tx_hex']))
+
+
 for config in CONFIGS:
     fuzzer, max_len, scale_factor = config
     max_time = MAX_SECONDS_PER_RUN * scale_factor
@@ -24,6 +42,8 @@ for config in CONFIGS:
 
     os.makedirs(artifact_dir, exist_ok=True)
     os.makedirs(corpus_dir, exist_ok=True)
+    if fuzzer in SEEDS:
+        seed_corpus(corpus_dir, SEEDS[fuzzer])
 
     env = os.environ.copy()
     env['ASAN_OPTIONS'] = 'halt_on_error=1:print_stacktrace=1'
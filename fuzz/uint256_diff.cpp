@@ -0,0 +1,235 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "evm_utils.h"
+#include "parser.h"
+#include "uint256.h"
+
+#ifdef NDEBUG
+#error "This fuzz target won't work correctly with NDEBUG defined, which will cause asserts to be eliminated"
+#endif
+
+// Differential target: uint256.c and the amount formatters of evm_utils.c are
+// checked against a slow byte-wise reference, so fast paths can be rewritten
+// without changing a single digit shown on the device.
+//
+// Input: [lenA (1)] [lenB (1)] [decimals (1)] [a (lenA % 33)] [b (lenB % 33)]
+
+using std::size_t;
+
+namespace {
+
+// 256-bit big-endian number
+using Ref = std::array<uint8_t, 32>;
+
+Ref refFromBE(const uint8_t *bytes, size_t len) {
+    Ref r{};
+    memcpy(r.data() + r.size() - len, bytes, len);
+    return r;
+}
+
+Ref refFromU256(const uint256_t &n) {
+    const uint64_t limbs[4] = {UPPER(UPPER(n)), LOWER(UPPER(n)), UPPER(LOWER(n)), LOWER(LOWER(n))};
+    Ref r{};
+    for (size_t i = 0; i < r.size(); i++) {
+        r[i] = (uint8_t)(limbs[i / 8] >> (8 * (7 - (i % 8))));
+    }
+    return r;
+}
+
+bool refIsZero(const Ref &r) {
+    for (uint8_t b : r) {
+        if (b != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t refDivSmall(Ref *r, uint8_t divisor) {
+    uint16_t rem = 0;
+    for (uint8_t &b : *r) {
+        const uint16_t cur = (uint16_t)(rem << 8) | b;
+        b = (uint8_t)(cur / divisor);
+        rem = cur % divisor;
+    }
+    return (uint8_t)rem;
+}
+
+std::string refToString(Ref r, uint8_t base) {
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), "0123456789abcdef"[refDivSmall(&r, base)]);
+    } while (!refIsZero(r));
+    return digits;
+}
+
+Ref refMul(const Ref &a, const Ref &b) {
+    uint32_t acc[32] = {0};
+    // little-endian byte columns, truncated to 256 bits
+    for (size_t i = 0; i < 32; i++) {
+        for (size_t j = 0; i + j < 32; j++) {
+            acc[i + j] += (uint32_t)a[31 - i] * b[31 - j];
+        }
+        // keep the columns from overflowing
+        for (size_t k = 0; k + 1 < 32; k++) {
+            acc[k + 1] += acc[k] >> 8;
+            acc[k] &= 0xFF;
+        }
+        acc[31] &= 0xFF;
+    }
+    Ref r{};
+    for (size_t i = 0; i < 32; i++) {
+        r[31 - i] = (uint8_t)acc[i];
+    }
+    return r;
+}
+
+bool refGte(const Ref &a, const Ref &b) {
+    return memcmp(a.data(), b.data(), a.size()) >= 0;
+}
+
+void refSub(Ref *a, const Ref &b) {
+    int borrow = 0;
+    for (int i = 31; i >= 0; i--) {
+        const int d = (*a)[i] - b[i] - borrow;
+        borrow = d < 0 ? 1 : 0;
+        (*a)[i] = (uint8_t)(d + (borrow << 8));
+    }
+}
+
+// restoring division, one bit at a time
+void refDivmod(const Ref &l, const Ref &r, Ref *div, Ref *mod) {
+    Ref q{};
+    Ref rem{};
+    for (size_t bit = 0; bit < 256; bit++) {
+        for (size_t i = 0; i < 31; i++) {
+            rem[i] = (uint8_t)(rem[i] << 1 | rem[i + 1] >> 7);
+        }
+        rem[31] = (uint8_t)(rem[31] << 1 | ((l[bit / 8] >> (7 - bit % 8)) & 1));
+        if (refGte(rem, r)) {
+            refSub(&rem, r);
+            q[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+        }
+    }
+    *div = q;
+    *mod = rem;
+}
+
+// integer digits, a point, then the decimals with trailing zeros trimmed down to one
+std::string refFixedPoint(const std::string &digits, uint8_t decimals) {
+    if (decimals == 0) {
+        return digits;
+    }
+    std::string padded = digits;
+    if (padded.size() <= decimals) {
+        padded.insert(0, decimals + 1 - padded.size(), '0');
+    }
+    std::string fraction = padded.substr(padded.size() - decimals);
+    while (fraction.size() > 1 && fraction.back() == '0') {
+        fraction.pop_back();
+    }
+    return padded.substr(0, padded.size() - decimals) + "." + fraction;
+}
+
+void expectEqual(const Ref &expected, const uint256_t &actual, const char *what) {
+    if (expected != refFromU256(actual)) {
+        (void)fprintf(stderr, "%s differs from the reference\n", what);
+        assert(false);
+    }
+}
+
+void expectEqual(const std::string &expected, const char *actual, const char *what) {
+    if (expected != actual) {
+        (void)fprintf(stderr, "%s: expected %s, got %s\n", what, expected.c_str(), actual);
+        assert(false);
+    }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 3) {
+        return 0;
+    }
+    const size_t lenA = data[0] % 33;
+    const size_t lenB = data[1] % 33;
+    const uint8_t decimals = data[2] % 40;
+    if (size < 3 + lenA + lenB) {
+        return 0;
+    }
+    const uint8_t *bytesA = data + 3;
+    const uint8_t *bytesB = bytesA + lenA;
+
+    const Ref refA = refFromBE(bytesA, lenA);
+    const Ref refB = refFromBE(bytesB, lenB);
+
+    // in-place decoding agrees with the padded context reader
+    uint256_t a = {};
+    uint256_t b = {};
+    assert(readu256BEBytes(bytesA, (uint16_t)lenA, &a) == parser_ok);
+    assert(readu256BEBytes(bytesB, (uint16_t)lenB, &b) == parser_ok);
+    expectEqual(refA, a, "readu256BEBytes");
+
+    parser_context_t ctx = {};
+    assert(parser_init_context(&ctx, refA.data(), (uint16_t)refA.size()) == parser_ok);
+    uint256_t fromCtx = {};
+    assert(readu256BE(&ctx, &fromCtx) == parser_ok);
+    expectEqual(refA, fromCtx, "readu256BE");
+
+    char out[100] = {0};
+    const std::string decimalA = refToString(refA, 10);
+    assert(tostring256(&a, 10, out, sizeof(out)));
+    expectEqual(decimalA, out, "tostring256 base 10");
+    assert(tostring256(&a, 16, out, sizeof(out)));
+    expectEqual(refToString(refA, 16), out, "tostring256 base 16");
+
+    uint256_t product = {};
+    mul256(&a, &b, &product);
+    expectEqual(refMul(refA, refB), product, "mul256");
+
+    if (!refIsZero(refB)) {
+        uint256_t div = {};
+        uint256_t mod = {};
+        divmod256(&a, &b, &div, &mod);
+        Ref refDiv{};
+        Ref refMod{};
+        refDivmod(refA, refB, &refDiv, &refMod);
+        expectEqual(refDiv, div, "divmod256 quotient");
+        expectEqual(refMod, mod, "divmod256 remainder");
+    }
+
+    // both amount formatters show the same digits
+    char value[200] = {0};
+    uint8_t pageCount = 0;
+    const rlp_t num = {.kind = RLP_KIND_STRING, .ptr = bytesA, .rlpLen = lenA};
+    assert(printRLPNumber(&num, value, sizeof(value), 0, &pageCount) == parser_ok);
+    expectEqual(decimalA, value, "printRLPNumber");
+
+    assert(printBigIntFixedPoint(bytesA, (uint16_t)lenA, value, sizeof(value), 0, &pageCount, 0) == parser_ok);
+    expectEqual(decimalA, value, "printBigIntFixedPoint");
+    assert(printBigIntFixedPoint(bytesA, (uint16_t)lenA, value, sizeof(value), 0, &pageCount, decimals) == parser_ok);
+    expectEqual(refFixedPoint(decimalA, decimals), value, "printBigIntFixedPoint with decimals");
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_eip191_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+void append(std::vector<uint8_t> &buffer, const std::string &message) {
+    buffer.push_back((uint8_t)(message.size() >> 8));
+    buffer.push_back((uint8_t)message.size());
+    buffer.insert(buffer.end(), message.begin(), message.end());
+}
+
+}  // namespace
+
+TEST(Eip191Batch, SummaryReview) {
+    app_mode_set_blindsign(true);
+    std::vector<uint8_t> buffer;
+    append(buffer, "attest 1");
+    append(buffer, std::string("\x01\x02\x03", 3));
+    append(buffer, "attest 3");
+    ASSERT_EQ(eip191_batch_parse(buffer.data(), buffer.size()), parser_ok);
+    EXPECT_EQ(session_current_flow(), session_flow_eip191_batch);
+    EXPECT_EQ(eip191_batch_count(), 3);
+
+    const std::vector<std::string> expected = {
+        "Sign : Personal Messages",
+        "Messages : 3",
+        "Msg 1 : attest 1",
+        "Msg 2 hex : 010203",
+        "Msg 3 : attest 3",
+        "Digest : 0x0000000000000000000000000000000000000000000000000000000000000000",
+    };
+    EXPECT_EQ(reviewItems(zxerr_ok, eip191_batch_getNumItems, eip191_batch_getItem), expected);
+
+    // signatures are only served once approved, and only for this flow
+    EXPECT_FALSE(eip191_batch_approved());
+    eip191_batch_set_approved(true);
+    EXPECT_TRUE(eip191_batch_approved());
+    EXPECT_NE(eip191_batch_hash(2), nullptr);
+    EXPECT_EQ(eip191_batch_hash(3), nullptr);
+    session_claim(session_flow_evm);
+    EXPECT_FALSE(eip191_batch_approved());
+    EXPECT_EQ(eip191_batch_count(), 0);
+    app_mode_set_blindsign(false);
+}
+
+TEST(Eip191Batch, Rejections) {
+    app_mode_set_blindsign(true);
+    std::vector<uint8_t> buffer;
+    append(buffer, "attest");
+    buffer.pop_back();
+    EXPECT_EQ(eip191_batch_parse(buffer.data(), buffer.size()), parser_unexpected_buffer_end);
+
+    buffer.clear();
+    append(buffer, "");
+    EXPECT_EQ(eip191_batch_parse(buffer.data(), buffer.size()), parser_unexpected_value);
+
+    buffer.clear();
+    for (uint8_t i = 0; i <= EIP191_BATCH_MAX_MSGS; i++) {
+        append(buffer, "m");
+    }
+    EXPECT_EQ(eip191_batch_parse(buffer.data(), buffer.size()), parser_unexpected_number_items);
+
+    app_mode_set_blindsign(false);
+    buffer.clear();
+    append(buffer, "attest");
+    EXPECT_EQ(eip191_batch_parse(buffer.data(), buffer.size()), parser_blindsign_mode_required);
+}
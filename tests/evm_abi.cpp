@@ -0,0 +1,176 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_abi.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "parser_impl_evm.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+const char *kToken = "a810acb7ccdc4ed824b952be940d6392434672cf";
+const char *kDidPrecompile = "0000000000000000000000000000000000000800";
+const char *kStoragePrecompile = "0000000000000000000000000000000000000801";
+
+std::string rlpHeader(size_t len, uint8_t shortBase) {
+    char tmp[8] = {0};
+    if (len <= 55) {
+        snprintf(tmp, sizeof(tmp), "%02x", (unsigned)(shortBase + len));
+    } else if (len <= 0xFF) {
+        snprintf(tmp, sizeof(tmp), "%02x%02x", (unsigned)(shortBase + 56), (unsigned)len);
+    } else {
+        snprintf(tmp, sizeof(tmp), "%02x%04x", (unsigned)(shortBase + 57), (unsigned)len);
+    }
+    return tmp;
+}
+
+std::string str(const std::string &hex) { return rlpHeader(hex.size() / 2, 0x80) + hex; }
+std::string list(const std::string &payload) { return rlpHeader(payload.size() / 2, 0xc0) + payload; }
+
+// right aligned 32-byte word
+std::string word(const std::string &hex) { return std::string(64 - hex.size(), '0') + hex; }
+
+// left aligned, zero padded to whole words, after its length word
+std::string dynamic(const std::string &hex) {
+    char len[8] = {0};
+    snprintf(len, sizeof(len), "%x", (unsigned)(hex.size() / 2));
+    const size_t padded = (hex.size() + 63) / 64 * 64;
+    return word(len) + hex + std::string(padded - hex.size(), '0');
+}
+
+// EIP-1559 call on peaq mainnet, no value
+std::string call(const char *to, const std::string &calldata) {
+    return "02" + list("820d0a" "05" "01" "02" "825208" + str(to) + "80" + str(calldata) + "c0");
+}
+
+std::vector<std::string> reviewItems(const std::string &tx) {
+    const auto buffer = toBytes(tx);
+    parser_context_t ctx = {};
+    EXPECT_EQ(parser_init_context(&ctx, buffer.data(), buffer.size()), parser_ok);
+    EXPECT_EQ(_readEth(&ctx, &eth_tx_obj), parser_ok);
+    EXPECT_EQ(_validateTxEth(), parser_ok);
+
+    return reviewItemsEth(&ctx);
+}
+
+uint8_t decode(const char *to, const std::string &calldata) {
+    const auto toBuffer = toBytes(to);
+    const auto dataBuffer = toBytes(calldata);
+    const rlp_t toView = {.kind = RLP_KIND_STRING, .ptr = toBuffer.data(), .rlpLen = toBuffer.size()};
+    const rlp_t dataView = {.kind = RLP_KIND_STRING, .ptr = dataBuffer.data(), .rlpLen = dataBuffer.size()};
+    return abi_decode(&toView, &dataView);
+}
+
+const std::string kAddAttribute = "cc4a70ca" + word(std::string(40, '4')) + word("80") + word("c0") + word("64") +
+                                  dynamic("6b6579") + dynamic("0102");
+
+}  // namespace
+
+TEST(EvmAbi, ApproveIsClearSigned) {
+    app_mode_set_blindsign(false);
+    const std::string approve = "095ea7b3" + word(std::string(40, '3')) + word("0de0b6b3a7640000");
+    const std::vector<std::string> expected = {
+        "Contract : 0xa810acb7ccdc4ed824b952be940d6392434672cf",
+        "Method : Approve",
+        "Spender : 0x3333333333333333333333333333333333333333",
+        "Amount : AGUS 1.0",
+        "Coin asset : peaq",
+        "Value : 0.0",
+        "Max Priority Fee : 1",
+        "Max Fee : 2",
+        "Gas limit : 21000",
+        "Nonce : 5",
+        "Eth-Hash : " + std::string(64, '0'),
+    };
+    EXPECT_EQ(reviewItems(call(kToken, approve)), expected);
+}
+
+TEST(EvmAbi, PrecompileCalls) {
+    app_mode_set_blindsign(false);
+    const auto items = reviewItems(call(kDidPrecompile, kAddAttribute));
+    EXPECT_THAT(items, testing::IsSupersetOf({
+                           "Method : Add DID attribute",
+                           "DID account : 0x4444444444444444444444444444444444444444",
+                           "Name : key",
+                           "Value : 0x0102",
+                           "Valid for : 100",
+                       }));
+
+    // dynamic values longer than a word
+    const std::string item(80, 'a');
+    const std::string addItem = "257c3c03" + word("40") + word("80") + dynamic("74797065") + dynamic(item);
+    EXPECT_THAT(reviewItems(call(kStoragePrecompile, addItem)),
+                testing::IsSupersetOf(std::vector<std::string>{"Item type : type", "Item : 0x" + item}));
+}
+
+TEST(EvmAbi, Erc721CallsKeepTheirPreview) {
+    // the calls of the erc721 Zemu tests have no entry in the table: their review is unchanged
+    app_mode_set_blindsign(true);
+    app_mode_set_expert(false);
+    const std::string safeTransferFrom =
+        "02f88f820d0a198459682f00850b68b3c16882caf09434bc797f40df0445c8429d485232874b1556172880b86442842e0e000000000000"
+        "00000000000077944eed8d4a00c8bd413f77744751a4d04ea34a0000000000000000000000005d4994bccdd28afbbc6388fbcaaec69dd44c"
+        "04560000000000000000000000000000000000000000000000000000000000000201c0";
+    const std::vector<std::string> expected = {
+        "To : 0x34bc797f40df0445c8429d485232874b15561728",
+        "Coin asset : peaq",
+        "Value : 0.0",
+        "Data : 42842e0e000000000000...",
+        "Max Priority Fee : 1500000000",
+        "Max Fee : 49001251176",
+        "Gas limit : 51952",
+        "Nonce : 25",
+    };
+    EXPECT_EQ(reviewItems(safeTransferFrom), expected);
+
+    const std::string approveForAll =
+        "02f871820d0a82034a8459682f00850322d538d182b67094bd3f82a81c3f74542736765ce4fd579d177b6bc580b844a22cb46500000000"
+        "00000000000000001e0049783f008a0085193e00003d00cd54003c71000000000000000000000000000000000000000000000000000000"
+        "0000000001c0";
+    const auto items = reviewItems(approveForAll);
+    ASSERT_GE(items.size(), 4u);
+    EXPECT_EQ(items[3], "Data : a22cb465000000000000...");
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmAbi, Rejections) {
+    EXPECT_NE(decode(kDidPrecompile, kAddAttribute), ABI_NO_METHOD);
+    // bound to the DID precompile
+    EXPECT_EQ(decode(kStoragePrecompile, kAddAttribute), ABI_NO_METHOD);
+    // trailing bytes
+    EXPECT_EQ(decode(kDidPrecompile, kAddAttribute + "00"), ABI_NO_METHOD);
+    EXPECT_EQ(decode(kDidPrecompile, kAddAttribute + word("00")), ABI_NO_METHOD);
+    // values must follow the head in order
+    const std::string swapped = "cc4a70ca" + word(std::string(40, '4')) + word("c0") + word("80") + word("64") +
+                                dynamic("6b6579") + dynamic("0102");
+    EXPECT_EQ(decode(kDidPrecompile, swapped), ABI_NO_METHOD);
+    // dirty padding
+    EXPECT_EQ(decode(kToken, "095ea7b3" + word("01" + std::string(40, '3')) + word("01")), ABI_NO_METHOD);
+    std::string dirtyTail = kAddAttribute;
+    dirtyTail[dirtyTail.size() - 1] = '1';
+    EXPECT_EQ(decode(kDidPrecompile, dirtyTail), ABI_NO_METHOD);
+    // truncated head
+    EXPECT_EQ(decode(kToken, "095ea7b3" + word(std::string(40, '3'))), ABI_NO_METHOD);
+    // unknown selectors still need blind signing
+    EXPECT_EQ(decode(kToken, "deadbeef"), ABI_NO_METHOD);
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_access_list.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "parser_impl_evm.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+std::string rlpHeader(size_t len, uint8_t shortBase) {
+    char tmp[8] = {0};
+    if (len <= 55) {
+        snprintf(tmp, sizeof(tmp), "%02x", (unsigned)(shortBase + len));
+    } else if (len <= 0xFF) {
+        snprintf(tmp, sizeof(tmp), "%02x%02x", (unsigned)(shortBase + 56), (unsigned)len);
+    } else {
+        snprintf(tmp, sizeof(tmp), "%02x%04x", (unsigned)(shortBase + 57), (unsigned)len);
+    }
+    return tmp;
+}
+
+std::string str(const std::string &hex) { return rlpHeader(hex.size() / 2, 0x80) + hex; }
+std::string list(const std::string &payload) { return rlpHeader(payload.size() / 2, 0xc0) + payload; }
+
+std::string entry(char addr, const std::vector<char> &keys) {
+    std::string encodedKeys;
+    for (const char key : keys) {
+        encodedKeys += str(std::string(64, key));
+    }
+    return list(str(std::string(40, addr)) + list(encodedKeys));
+}
+
+// EIP-1559 transfer of 1 peaq on peaq mainnet carrying the given access list
+std::string tx1559(const std::string &accessList) {
+    return "02" + list("820d0a" "05" "01" "02" "825208" "94" + std::string(40, '1') + "880de0b6b3a7640000" "80" +
+                       accessList);
+}
+
+parser_error_t readTx(const std::vector<uint8_t> &buffer, parser_context_t *ctx) {
+    EXPECT_EQ(parser_init_context(ctx, buffer.data(), buffer.size()), parser_ok);
+    return _readEth(ctx, &eth_tx_obj);
+}
+
+}  // namespace
+
+TEST(EvmAccessList, Iterator) {
+    const auto buffer = toBytes(list(entry('a', {'1', '2'}) + entry('b', {})));
+    parser_context_t ctx = {.buffer = buffer.data(), .bufferLen = (uint16_t)buffer.size(), .offset = 0};
+    rlp_t accessList = {};
+    ASSERT_EQ(rlp_read(&ctx, &accessList), parser_ok);
+
+    uint16_t numAddresses = 0;
+    uint16_t numKeys = 0;
+    ASSERT_EQ(access_list_count(&accessList, &numAddresses, &numKeys), parser_ok);
+    EXPECT_EQ(numAddresses, 2);
+    EXPECT_EQ(numKeys, 2);
+
+    access_list_iter_t iter = {0};
+    access_list_entry_t item = {};
+    ASSERT_EQ(access_list_iter_init(&iter, &accessList), parser_ok);
+    ASSERT_EQ(access_list_iter_next(&iter, &item), parser_ok);
+    EXPECT_EQ(item.numKeys, 2);
+    // entries point into the source buffer
+    EXPECT_GT(item.address.ptr, buffer.data());
+    EXPECT_LT(item.address.ptr, buffer.data() + buffer.size());
+    EXPECT_EQ(item.address.ptr[0], 0xaa);
+
+    rlp_t key = {};
+    ASSERT_EQ(access_list_entry_key(&item, 1, &key), parser_ok);
+    EXPECT_EQ(key.ptr[31], 0x22);
+    EXPECT_EQ(access_list_entry_key(&item, 2, &key), parser_display_idx_out_of_range);
+
+    ASSERT_EQ(access_list_iter_next(&iter, &item), parser_ok);
+    EXPECT_EQ(item.numKeys, 0);
+    EXPECT_EQ(access_list_iter_next(&iter, &item), parser_no_data);
+    EXPECT_EQ(iter.index, 2);
+}
+
+TEST(EvmAccessList, Review) {
+    app_mode_set_blindsign(true);
+    const auto buffer = toBytes(tx1559(list(entry('a', {'1', '2'}) + entry('b', {}))));
+    parser_context_t ctx = {0};
+    ASSERT_EQ(readTx(buffer, &ctx), parser_ok);
+    EXPECT_EQ(_validateTxEth(), parser_ok);
+
+    const std::vector<std::string> expected = {
+        "To : 0x1111111111111111111111111111111111111111",
+        "Coin asset : peaq",
+        "Value : 1.0",
+        "Max Priority Fee : 1",
+        "Max Fee : 2",
+        "Gas limit : 21000",
+        "Nonce : 5",
+        "Access list : 2 addresses / 2 keys",
+        "Access 1 : 0xaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+        "Access 1 key 1 : 0x" + std::string(64, '1'),
+        "Access 1 key 2 : 0x" + std::string(64, '2'),
+        "Access 2 : 0xbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+    };
+    EXPECT_EQ(reviewItemsEth(&ctx), expected);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmAccessList, LongListIsSummarized) {
+    app_mode_set_blindsign(true);
+    std::string entries;
+    for (uint8_t i = 0; i < 67; i++) {
+        entries += entry('c', {'1', '2'});
+    }
+    const auto buffer = toBytes(tx1559(list(entries)));
+    parser_context_t ctx = {0};
+    ASSERT_EQ(readTx(buffer, &ctx), parser_ok);
+    EXPECT_EQ(eth_tx_obj.accessListAddresses, 67);
+    EXPECT_EQ(eth_tx_obj.accessListKeys, 134);
+    EXPECT_TRUE(eth_tx_obj.accessListHidden);
+
+    const auto items = reviewItemsEth(&ctx);
+    EXPECT_THAT(items, testing::Contains("Access list : 67 addresses / 134 keys"));
+    EXPECT_EQ(items.size(), eth_tx_obj.numFields);
+    app_mode_set_blindsign(false);
+    EXPECT_EQ(_validateTxEth(), parser_blindsign_mode_required);
+}
+
+TEST(EvmAccessList, Rejections) {
+    parser_context_t ctx = {0};
+    // storage key shorter than 32 bytes
+    EXPECT_EQ(readTx(toBytes(tx1559(list(list(str(std::string(40, 'a')) + list(str(std::string(62, '1'))))))), &ctx),
+              parser_unexpected_value);
+    // address shorter than 20 bytes
+    EXPECT_EQ(readTx(toBytes(tx1559(list(list(str(std::string(38, 'a')) + list(""))))), &ctx), parser_invalid_address);
+    // extra field in an entry
+    EXPECT_EQ(readTx(toBytes(tx1559(list(list(str(std::string(40, 'a')) + list("") + "80")))), &ctx),
+              parser_unexpected_number_items);
+    // access list encoded as a string
+    EXPECT_EQ(readTx(toBytes(tx1559("80")), &ctx), parser_unexpected_type);
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_authorization.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "evm_utils.h"
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "parser_evm.h"
+#include "parser_impl_evm.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+std::string rlpHeader(size_t len, uint8_t shortBase) {
+    char tmp[8] = {0};
+    if (len <= 55) {
+        snprintf(tmp, sizeof(tmp), "%02x", (unsigned)(shortBase + len));
+    } else if (len <= 0xFF) {
+        snprintf(tmp, sizeof(tmp), "%02x%02x", (unsigned)(shortBase + 56), (unsigned)len);
+    } else {
+        snprintf(tmp, sizeof(tmp), "%02x%04x", (unsigned)(shortBase + 57), (unsigned)len);
+    }
+    return tmp;
+}
+
+std::string str(const std::string &hex) { return rlpHeader(hex.size() / 2, 0x80) + hex; }
+std::string list(const std::string &payload) { return rlpHeader(payload.size() / 2, 0xc0) + payload; }
+
+// [chainId, address, nonce, yParity, r, s], numbers already encoded
+std::string tuple(const std::string &chainId, char addr, const std::string &nonce, const std::string &yParity = "01") {
+    return list(chainId + str(std::string(40, addr)) + nonce + yParity + str(std::string(64, 'e')) +
+                str(std::string(64, 'f')));
+}
+
+// EIP-7702 call of 1 peaq on peaq mainnet, empty access list
+std::string tx7702(const std::string &authorizations, const std::string &to = "94" + std::string(40, '1')) {
+    return "04" + list("820d0a" "05" "01" "02" "825208" + to + "880de0b6b3a7640000" "80" "c0" + authorizations);
+}
+
+parser_error_t readTx(const std::vector<uint8_t> &buffer, parser_context_t *ctx) {
+    EXPECT_EQ(parser_init_context(ctx, buffer.data(), buffer.size()), parser_ok);
+    return _readEth(ctx, &eth_tx_obj);
+}
+
+}  // namespace
+
+TEST(EvmAuthorization, Iterator) {
+    const auto buffer = toBytes(list(tuple("820d0a", 'a', "07") + tuple("80", 'b', "80", "80")));
+    parser_context_t ctx = {.buffer = buffer.data(), .bufferLen = (uint16_t)buffer.size(), .offset = 0};
+    rlp_t authorizationList = {};
+    ASSERT_EQ(rlp_read(&ctx, &authorizationList), parser_ok);
+
+    uint16_t count = 0;
+    ASSERT_EQ(authorization_count(&authorizationList, &count), parser_ok);
+    EXPECT_EQ(count, 2);
+
+    authorization_t authorization = {};
+    ASSERT_EQ(authorization_get(&authorizationList, 1, &authorization), parser_ok);
+    // tuples point into the source buffer
+    EXPECT_GT(authorization.address.ptr, buffer.data());
+    EXPECT_LT(authorization.address.ptr, buffer.data() + buffer.size());
+    EXPECT_EQ(authorization.address.ptr[0], 0xbb);
+    EXPECT_EQ(authorization.chainId.rlpLen, 0);
+    EXPECT_EQ(authorization_get(&authorizationList, 2, &authorization), parser_display_idx_out_of_range);
+}
+
+TEST(EvmAuthorization, Review) {
+    app_mode_set_blindsign(true);
+    const auto buffer = toBytes(tx7702(list(tuple("820d0a", 'a', "07") + tuple("80", 'b', "80", "80"))));
+    parser_context_t ctx = {0};
+    ASSERT_EQ(readTx(buffer, &ctx), parser_ok);
+    EXPECT_EQ(eth_tx_obj.tx_type, eip7702);
+    EXPECT_EQ(_validateTxEth(), parser_ok);
+
+    // the upload handler sizes the envelope past the type byte
+    uint64_t read = 0;
+    uint64_t toRead = 0;
+    ASSERT_EQ(get_tx_rlp_len(buffer.data(), buffer.size(), &read, &toRead), rlp_ok);
+    EXPECT_EQ(read + toRead, buffer.size());
+
+    const std::vector<std::string> expected = {
+        "To : 0x1111111111111111111111111111111111111111",
+        "Coin asset : peaq",
+        "Value : 1.0",
+        "Max Priority Fee : 1",
+        "Max Fee : 2",
+        "Gas limit : 21000",
+        "Nonce : 5",
+        "Delegations : 2",
+        "Delegation 1 chain : 3338",
+        "Delegation 1 to : 0xaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+        "Delegation 1 nonce : 7",
+        "Delegation 2 chain : Any chain",
+        "Delegation 2 to : 0xbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+        "Delegation 2 nonce : 0",
+        "Eth-Hash : " + std::string(64, '0'),
+    };
+    EXPECT_EQ(reviewItemsEth(&ctx), expected);
+
+    // typed transaction: v is the parity alone
+    uint8_t v = 0xff;
+    EXPECT_EQ(parser_compute_eth_v(&ctx, CX_ECCINFO_PARITY_ODD, &v), parser_ok);
+    EXPECT_EQ(v, 1);
+    EXPECT_EQ(parser_compute_eth_v(&ctx, 0, &v), parser_ok);
+    EXPECT_EQ(v, 0);
+    // message signatures do not take v from the parsed transaction
+    EXPECT_EQ(parser_compute_message_v(CX_ECCINFO_PARITY_ODD), 28);
+    EXPECT_EQ(parser_compute_message_v(0), 27);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmAuthorization, SharesTheListingBudget) {
+    app_mode_set_blindsign(true);
+    std::string tuples;
+    for (uint8_t i = 0; i < ETH_MAX_AUTHORIZATIONS; i++) {
+        tuples += tuple("820d0a", 'c', "01");
+    }
+    // 160 storage keys and one address: listed alone, summarized next to 16 delegations
+    std::string keys;
+    for (uint8_t i = 0; i < 160; i++) {
+        keys += str(std::string(64, '3'));
+    }
+    const std::string accessList = list(list(str(std::string(40, 'd')) + list(keys)));
+    const std::string body = "820d0a" "05" "01" "02" "825208" "94" + std::string(40, '1') + "880de0b6b3a7640000" "80";
+    const auto buffer = toBytes("04" + list(body + accessList + list(tuples)));
+    parser_context_t ctx = {0};
+    ASSERT_EQ(readTx(buffer, &ctx), parser_ok);
+    EXPECT_TRUE(eth_tx_obj.accessListHidden);
+
+    const auto items = reviewItemsEth(&ctx);
+    EXPECT_EQ(items.size(), eth_tx_obj.numFields + ETH_MAX_AUTHORIZATIONS * ETH_AUTHORIZATION_ITEMS);
+    EXPECT_THAT(items, testing::Contains("Delegation 16 nonce : 1"));
+    app_mode_set_blindsign(false);
+
+    // one tuple too many
+    tuples += tuple("820d0a", 'c', "01");
+    parser_context_t tooMany = {0};
+    EXPECT_EQ(readTx(toBytes(tx7702(list(tuples))), &tooMany), parser_unexpected_number_items);
+}
+
+TEST(EvmAuthorization, Rejections) {
+    parser_context_t ctx = {0};
+    // empty authorization list
+    EXPECT_EQ(readTx(toBytes(tx7702("c0")), &ctx), parser_unexpected_number_items);
+    // no destination
+    EXPECT_EQ(readTx(toBytes(tx7702(list(tuple("01", 'a', "01")), "80")), &ctx), parser_invalid_address);
+    // y parity other than 0 or 1
+    EXPECT_EQ(readTx(toBytes(tx7702(list(tuple("01", 'a', "01", "02")))), &ctx), parser_unexpected_value);
+    // nonce wider than 64 bits
+    EXPECT_EQ(readTx(toBytes(tx7702(list(tuple("01", 'a', str("010000000000000000"))))), &ctx),
+              parser_value_out_of_range);
+    // address shorter than 20 bytes
+    EXPECT_EQ(readTx(toBytes(tx7702(list(list("01" + str(std::string(38, 'a')) + "01018080")))), &ctx),
+              parser_invalid_address);
+    // missing signature field
+    EXPECT_EQ(readTx(toBytes(tx7702(list(list("01" + str(std::string(40, 'a')) + "010180")))), &ctx),
+              parser_unexpected_number_items);
+    // authorization list encoded as a string
+    EXPECT_EQ(readTx(toBytes(tx7702("80")), &ctx), parser_unexpected_type);
+}
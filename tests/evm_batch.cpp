@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_batch.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+// EIP-1559 transfer of 1 peaq on peaq mainnet, 21000 gas at 2 wei
+std::string transfer(const char *nonce, const char *to) {
+    return std::string("02e9820d0a") + nonce + "0102825208" + "94" + to + "880de0b6b3a764000080c0";
+}
+
+const char *kAlice = "1111111111111111111111111111111111111111";
+const char *kBob = "2222222222222222222222222222222222222222";
+
+}  // namespace
+
+TEST(EvmBatch, AggregateReview) {
+    app_mode_set_blindsign(true);
+    const auto buffer = toBytes(transfer("05", kAlice) + transfer("06", kBob) + transfer("07", kAlice));
+    ASSERT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_ok);
+    EXPECT_EQ(eth_batch_obj.count, 3);
+
+    const std::vector<std::string> expected = {
+        "Batch : 3 transactions",
+        "Coin asset : peaq",
+        "Total value : 3.0",
+        "Recipient 1 : 0x1111111111111111111111111111111111111111",
+        "Recipient 2 : 0x2222222222222222222222222222222222222222",
+        "Nonces : 5 - 7",
+        "Max fees : 0.000000000000126",
+    };
+    EXPECT_EQ(reviewItems(parser_ok, eth_batch_getNumItems, eth_batch_getItem), expected);
+
+    parser_context_t ctx;
+    ASSERT_EQ(eth_batch_select(&ctx, buffer.data(), buffer.size(), 1), parser_ok);
+    rlp_t nonce = {};
+    eth_tx_view(&eth_tx_obj, &eth_tx_obj.tx.nonce, &nonce);
+    EXPECT_EQ(nonce.ptr[0], 0x06);
+    EXPECT_EQ(eth_batch_select(&ctx, buffer.data(), buffer.size(), 3), parser_unexpected_error);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmBatch, Rejections) {
+    app_mode_set_blindsign(true);
+    // nonce gap
+    auto buffer = toBytes(transfer("05", kAlice) + transfer("07", kAlice));
+    EXPECT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_unexpected_value);
+
+    // truncated last transaction
+    buffer = toBytes(transfer("05", kAlice) + transfer("06", kAlice));
+    buffer.pop_back();
+    EXPECT_NE(eth_batch_parse(buffer.data(), buffer.size()), parser_ok);
+
+    // too many distinct recipients
+    std::string many;
+    const char *recipients[] = {"01", "02", "03", "04", "05"};
+    for (uint8_t i = 0; i < 5; i++) {
+        many += transfer(recipients[i], (std::string(38, '0') + recipients[i]).c_str());
+    }
+    buffer = toBytes(many);
+    EXPECT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_unexpected_number_items);
+
+    app_mode_set_blindsign(false);
+    buffer = toBytes(transfer("05", kAlice));
+    EXPECT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_blindsign_mode_required);
+}
+
+// 100-byte transfers with 16-byte fees and a 26-byte value: 50 of them exceed the EIP-191 display size
+TEST(EvmBatch, SizeBound) {
+    app_mode_set_blindsign(true);
+    const auto big = [](uint8_t nonce) {
+        char nonceHex[3];
+        snprintf(nonceHex, sizeof(nonceHex), "%02x", nonce);
+        return std::string("02f861820d0a") + nonceHex + "9001" + std::string(28, '0') + "01" + "9002" +
+               std::string(28, '0') + "01" + "8810" + std::string(14, '0') + "94" + kBob + "9a01" +
+               std::string(48, '0') + nonceHex + "80c0";
+    };
+    std::string txs;
+    for (uint8_t nonce = 1; nonce <= ETH_BATCH_MAX_TXS; nonce++) {
+        txs += big(nonce);
+    }
+    auto buffer = toBytes(txs);
+    ASSERT_EQ(buffer.size(), 5000u);
+    ASSERT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_ok);
+    EXPECT_EQ(eth_batch_obj.count, ETH_BATCH_MAX_TXS);
+
+    // within the count, but not within the bytes
+    buffer.resize(ETH_BATCH_MAX_BYTES + 1);
+    EXPECT_EQ(eth_batch_parse(buffer.data(), buffer.size()), parser_value_out_of_range);
+    app_mode_set_blindsign(false);
+}
@@ -0,0 +1,202 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_eip712.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "utils/common.h"
+
+namespace {
+
+using Fields = std::vector<std::pair<std::string, std::string>>;
+
+parser_error_t addStruct(const std::string &name, const Fields &fields) {
+    std::vector<uint8_t> def;
+    def.push_back(name.size());
+    def.insert(def.end(), name.begin(), name.end());
+    def.push_back(fields.size());
+    for (const auto &field : fields) {
+        def.push_back(field.first.size());
+        def.insert(def.end(), field.first.begin(), field.first.end());
+        def.push_back(field.second.size());
+        def.insert(def.end(), field.second.begin(), field.second.end());
+    }
+    return eip712_add_struct(def.data(), def.size());
+}
+
+parser_error_t start(const std::string &name) {
+    return eip712_start(reinterpret_cast<const uint8_t *>(name.data()), name.size());
+}
+
+parser_error_t feed(const std::string &value, bool more = false) {
+    return eip712_feed_value(reinterpret_cast<const uint8_t *>(value.data()), value.size(), more);
+}
+
+parser_error_t feed(const std::vector<uint8_t> &value) { return eip712_feed_value(value.data(), value.size(), false); }
+
+void addDomain() {
+    ASSERT_EQ(addStruct("EIP712Domain", {{"string", "name"}, {"uint256", "chainId"}}), parser_ok);
+}
+
+void feedDomain() {
+    ASSERT_EQ(start("EIP712Domain"), parser_ok);
+    ASSERT_EQ(feed("Ether Mail"), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>{0x0d, 0x0a}), parser_ok);
+}
+
+}  // namespace
+
+TEST(EvmEip712, MailExample) {
+    eip712_reset();
+    ASSERT_EQ(addStruct("EIP712Domain", {{"string", "name"},
+                                         {"string", "version"},
+                                         {"uint256", "chainId"},
+                                         {"address", "verifyingContract"}}),
+              parser_ok);
+    ASSERT_EQ(addStruct("Mail", {{"Person", "from"}, {"Person", "to"}, {"string", "contents"}}), parser_ok);
+    ASSERT_EQ(addStruct("Person", {{"string", "name"}, {"address", "wallet"}}), parser_ok);
+    EXPECT_EQ(addStruct("Person", {{"string", "name"}}), parser_duplicated_field);
+
+    ASSERT_EQ(start("EIP712Domain"), parser_ok);
+    ASSERT_EQ(feed("Ether ", true), parser_ok);
+    ASSERT_EQ(feed("Mail", true), parser_ok);
+    // a dynamic value is closed by its last part, even an empty one
+    ASSERT_EQ(feed(""), parser_ok);
+    ASSERT_EQ(feed("1"), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>{0x01}), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>(20, 0xcc)), parser_ok);
+    EXPECT_FALSE(eip712_is_complete());
+    EXPECT_EQ(addStruct("Late", {{"bool", "flag"}}), parser_unexpected_method);
+
+    ASSERT_EQ(start("Mail"), parser_ok);
+    ASSERT_EQ(feed("Cow"), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>(20, 0xcd)), parser_ok);
+    ASSERT_EQ(feed("Bob"), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>(20, 0xbb)), parser_ok);
+    ASSERT_EQ(feed("Hello, Bob!"), parser_ok);
+    ASSERT_TRUE(eip712_is_complete());
+    EXPECT_EQ(feed("extra"), parser_unexpected_method);
+
+    const std::string zeros(64, '0');
+    const std::vector<std::string> expected = {
+        "Sign : Typed data",
+        "name : Ether Mail",
+        "version : 1",
+        "chainId : 1",
+        "verifyingContract : 0x" + std::string(40, 'c'),
+        "from.name : Cow",
+        "from.wallet : 0xcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcd",
+        "to.name : Bob",
+        "to.wallet : 0xbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb",
+        "Hidden fields : 1",
+        "Domain hash : " + zeros,
+        "Message hash : " + zeros,
+    };
+    EXPECT_EQ(reviewItems(zxerr_ok, eip712_getNumItems, eip712_getItem), expected);
+
+    app_mode_set_blindsign(false);
+    EXPECT_EQ(eip712_validate(), parser_blindsign_mode_required);
+    app_mode_set_blindsign(true);
+    EXPECT_EQ(eip712_validate(), parser_ok);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmEip712, ArraysAndNumbers) {
+    eip712_reset();
+    addDomain();
+    ASSERT_EQ(addStruct("Order", {{"int64", "delta"}, {"bytes4[2]", "tags"}, {"Leg[]", "legs"}, {"bool", "open"}}),
+              parser_ok);
+    ASSERT_EQ(addStruct("Leg", {{"uint8", "id"}}), parser_ok);
+    feedDomain();
+
+    ASSERT_EQ(start("Order"), parser_ok);
+    EXPECT_EQ(feed(std::vector<uint8_t>(9, 0x01)), parser_value_out_of_range);
+    ASSERT_EQ(feed(std::vector<uint8_t>{0xfb}), parser_ok);
+    // the element count is sent before any array
+    EXPECT_EQ(feed(std::vector<uint8_t>{1, 2, 3, 4}), parser_unexpected_type);
+    EXPECT_EQ(eip712_set_array_len(3), parser_unexpected_value);
+    ASSERT_EQ(eip712_set_array_len(2), parser_ok);
+    EXPECT_EQ(feed(std::vector<uint8_t>{1, 2, 3}), parser_unexpected_value);
+    ASSERT_EQ(feed(std::vector<uint8_t>{1, 2, 3, 4}), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>{5, 6, 7, 8}), parser_ok);
+    ASSERT_EQ(eip712_set_array_len(2), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>{7}), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>{}), parser_ok);
+    EXPECT_EQ(feed(std::vector<uint8_t>{2}), parser_unexpected_value);
+    ASSERT_EQ(feed(std::vector<uint8_t>{1}), parser_ok);
+    ASSERT_TRUE(eip712_is_complete());
+
+    const std::vector<std::string> expected = {
+        "Sign : Typed data", "name : Ether Mail", "chainId : 3338", "delta : -5", "tags : 0x01020304",
+        "tags : 0x05060708", "legs.id : 7",     "legs.id : 0",    "open : true",
+    };
+    auto items = reviewItems(zxerr_ok, eip712_getNumItems, eip712_getItem);
+    items.resize(expected.size());
+    EXPECT_EQ(items, expected);
+}
+
+TEST(EvmEip712, LongKeysKeepTheirEnd) {
+    eip712_reset();
+    addDomain();
+    ASSERT_EQ(addStruct("Outer", {{"Inner", "settlement"}}), parser_ok);
+    ASSERT_EQ(addStruct("Inner", {{"address", "beneficiaryAccount"}}), parser_ok);
+    feedDomain();
+
+    ASSERT_EQ(start("Outer"), parser_ok);
+    ASSERT_EQ(feed(std::vector<uint8_t>(20, 0xaa)), parser_ok);
+    ASSERT_TRUE(eip712_is_complete());
+
+    // settlement.beneficiaryAccount does not fit in 20 characters
+    const auto items = reviewItems(zxerr_ok, eip712_getNumItems, eip712_getItem);
+    ASSERT_GE(items.size(), 4u);
+    EXPECT_EQ(items[3], "..beneficiaryAccount : 0x" + std::string(40, 'a'));
+}
+
+TEST(EvmEip712, Rejections) {
+    eip712_reset();
+    addDomain();
+    ASSERT_EQ(addStruct("Grid", {{"uint8[][]", "cells"}}), parser_ok);
+    ASSERT_EQ(addStruct("Ghost", {{"Missing", "field"}}), parser_ok);
+    ASSERT_EQ(addStruct("Odd", {{"uint7", "field"}}), parser_ok);
+
+    // the domain separator is hashed first
+    EXPECT_EQ(start("Grid"), parser_unexpected_type);
+    EXPECT_EQ(eip712_set_array_len(1), parser_unexpected_method);
+    feedDomain();
+
+    EXPECT_EQ(start("Unknown"), parser_unexpected_type);
+    eip712_reset();
+    addDomain();
+    ASSERT_EQ(addStruct("Ghost", {{"Missing", "field"}}), parser_ok);
+    feedDomain();
+    EXPECT_EQ(start("Ghost"), parser_unexpected_type);
+
+    eip712_reset();
+    addDomain();
+    ASSERT_EQ(addStruct("Grid", {{"uint8[][]", "cells"}}), parser_ok);
+    feedDomain();
+    EXPECT_EQ(start("Grid"), parser_unexpected_type);
+
+    eip712_reset();
+    const uint8_t truncated[] = {4, 'M', 'a', 'i', 'l', 1, 6, 's', 't', 'r'};
+    EXPECT_EQ(eip712_add_struct(truncated, sizeof(truncated)), parser_unexpected_buffer_end);
+    EXPECT_EQ(eip712_validate(), parser_unexpected_method);
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_erc20.h"
+
+#include "evm_erc20_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "parser_impl_evm.h"
+#include "utils/common.h"
+
+TEST(EvmErc20, TokenLookup) {
+    const auto agus = toBytes("a810acb7ccdc4ed824b952be940d6392434672cf");
+    const erc20_tokens_t *token = findERC20Token(agus.data());
+    ASSERT_NE(token, nullptr);
+    EXPECT_EQ(std::string(token->symbol, strnlen(token->symbol, ERC20_SYMBOL_STORED_LEN)), "AGUS");
+    EXPECT_EQ(token->decimals, 18);
+
+    // neighbours of a known address and both ends of the key space
+    const char *unknown[] = {"a810acb7ccdc4ed824b952be940d6392434672ce", "a810acb7ccdc4ed824b952be940d6392434672d0",
+                             "0000000000000000000000000000000000000000", "ffffffffffffffffffffffffffffffffffffffff"};
+    for (const char *address : unknown) {
+        EXPECT_EQ(findERC20Token(toBytes(address).data()), nullptr) << address;
+    }
+    EXPECT_EQ(findERC20Token(nullptr), nullptr);
+}
+
+TEST(EvmErc20, SignedDescriptorCache) {
+    erc20_cache_flush();
+    // "USDT", token contract, 6 decimals, chain 3338, then a dummy DER signature
+    const auto data = toBytes("0455534454" "1111111111111111111111111111111111111111" "00000006" "00000d0a"
+                              "3006020101020101");
+    erc20_descriptor_t descriptor;
+    uint16_t signedLen = 0;
+    ASSERT_EQ(erc20_descriptor_parse(data.data(), data.size(), &descriptor, &signedLen), parser_ok);
+    EXPECT_EQ(signedLen, 1 + 4 + 20 + 4 + 4);
+    EXPECT_EQ(descriptor.chainId, 3338u);
+    EXPECT_EQ(descriptor.token.decimals, 6);
+
+    auto truncated = data;
+    truncated.resize(signedLen + ERC20_DESCRIPTOR_MIN_SIG_LEN - 1);
+    EXPECT_EQ(erc20_descriptor_parse(truncated.data(), truncated.size(), &descriptor, &signedLen),
+              parser_unexpected_buffer_end);
+    auto longSymbol = toBytes("09" "414141414141414141");
+    EXPECT_EQ(erc20_descriptor_parse(longSymbol.data(), longSymbol.size(), &descriptor, &signedLen),
+              parser_unexpected_value);
+
+    ASSERT_EQ(erc20_descriptor_parse(data.data(), data.size(), &descriptor, &signedLen), parser_ok);
+    erc20_cache_insert(&descriptor);
+    EXPECT_NE(erc20_cache_lookup(descriptor.token.address, 3338), nullptr);
+    EXPECT_EQ(erc20_cache_lookup(descriptor.token.address, 1), nullptr);
+
+    // transfer(0x22..22, 1000000) on the cached token
+    const auto calldata = toBytes("a9059cbb" "0000000000000000000000002222222222222222222222222222222222222222"
+                                  "00000000000000000000000000000000000000000000000000000000000f4240");
+    // [chain id | contract | calldata], fields are offsets into it
+    std::vector<uint8_t> buffer = {0x0d, 0x0a};
+    buffer.insert(buffer.end(), descriptor.token.address, descriptor.token.address + ETH_ADDRESS_LEN);
+    buffer.insert(buffer.end(), calldata.begin(), calldata.end());
+    eth_tx_t tx = {};
+    tx.buffer = buffer.data();
+    tx.chainId = {.kind = RLP_KIND_STRING, .fieldOffset = 0, .valueOffset = 0, .valueLen = 2};
+    tx.tx.to = {.kind = RLP_KIND_STRING, .fieldOffset = 2, .valueOffset = 2, .valueLen = ETH_ADDRESS_LEN};
+    tx.tx.data = {.kind = RLP_KIND_STRING, .fieldOffset = 22, .valueOffset = 22, .valueLen = (uint16_t)calldata.size()};
+
+    char value[100] = {0};
+    uint8_t pageCount = 0;
+    ASSERT_EQ(printERC20Value(&tx, value, sizeof(value), 0, &pageCount), parser_ok);
+    EXPECT_STREQ(value, "USDT 1.0");
+
+    // the oldest descriptor is evicted once the cache is full
+    for (uint8_t i = 0; i < ERC20_CACHE_ENTRIES; i++) {
+        erc20_descriptor_t other = descriptor;
+        other.token.address[0] = 0xa0 + i;
+        erc20_cache_insert(&other);
+    }
+    EXPECT_EQ(erc20_cache_lookup(descriptor.token.address, 3338), nullptr);
+    ASSERT_EQ(printERC20Value(&tx, value, sizeof(value), 0, &pageCount), parser_ok);
+    EXPECT_STREQ(value, "?? 1000000");
+    erc20_cache_flush();
+}
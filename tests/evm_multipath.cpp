@@ -0,0 +1,121 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_multipath.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "utils/common.h"
+
+namespace {
+
+std::string path(const char *index) {
+    return std::string("05") + "8000002c" + "8000003c" + "80000000" + "00000000" + index;
+}
+
+parser_error_t parse(const std::string &hex, uint32_t *consumed) {
+    const auto data = toBytes(hex);
+    return eth_multipath_parse(data.data(), (uint32_t)data.size(), consumed);
+}
+
+// stands for the review of the payload
+zxerr_t payloadNumItems(uint8_t *num_items) {
+    *num_items = 1;
+    return zxerr_ok;
+}
+
+zxerr_t payloadItem(int8_t displayIdx, char *outKey, uint16_t outKeyLen, char *outVal, uint16_t outValLen,
+                    uint8_t pageIdx, uint8_t *pageCount) {
+    if (displayIdx != 0) {
+        return zxerr_no_data;
+    }
+    snprintf(outKey, outKeyLen, "Nonce");
+    snprintf(outVal, outValLen, "5");
+    *pageCount = 1;
+    return zxerr_ok;
+}
+
+}  // namespace
+
+TEST(EvmMultipath, PathListAndReview) {
+    uint32_t consumed = 0;
+    // the payload follows the list
+    ASSERT_EQ(parse("03" + path("00000000") + path("00000001") + path("00000002") + "02e9", &consumed), parser_ok);
+    EXPECT_EQ(consumed, 1 + 3 * 21);
+    EXPECT_EQ(eth_multipath_count(), 3);
+
+    uint32_t hdPath[HDPATH_LEN_DEFAULT] = {0};
+    uint32_t hdPathLen = 0;
+    ASSERT_TRUE(eth_multipath_path(2, hdPath, &hdPathLen));
+    EXPECT_EQ(hdPathLen, 5);
+    EXPECT_EQ(hdPath[4], 2);
+    EXPECT_FALSE(eth_multipath_path(3, hdPath, &hdPathLen));
+
+    const char *addresses[] = {"1111111111111111111111111111111111111111", "2222222222222222222222222222222222222222",
+                               "3333333333333333333333333333333333333333"};
+    for (uint8_t i = 0; i < 3; i++) {
+        eth_multipath_set_address(i, toBytes(addresses[i]).data());
+    }
+    eth_multipath_review(payloadItem, payloadNumItems);
+    const std::vector<std::string> expected = {
+        "Account 1/3 : 0x1111111111111111111111111111111111111111",
+        "Account 2/3 : 0x2222222222222222222222222222222222222222",
+        "Account 3/3 : 0x3333333333333333333333333333333333333333",
+        "Nonce : 5",
+    };
+    EXPECT_EQ(reviewItems(zxerr_ok, eth_multipath_getNumItems, eth_multipath_getItem), expected);
+
+    // signatures are only served for an approved digest
+    EXPECT_EQ(eth_multipath_digest(), nullptr);
+    const std::vector<uint8_t> digest(ETH_MULTIPATH_HASH_LEN, 0xab);
+    eth_multipath_approve(digest.data(), false);
+    ASSERT_NE(eth_multipath_digest(), nullptr);
+    EXPECT_EQ(std::vector<uint8_t>(eth_multipath_digest(), eth_multipath_digest() + ETH_MULTIPATH_HASH_LEN), digest);
+    EXPECT_FALSE(eth_multipath_is_message());
+    // personal messages are signed with v = 27 + parity
+    eth_multipath_approve(digest.data(), true);
+    EXPECT_TRUE(eth_multipath_is_message());
+    eth_multipath_revoke();
+    EXPECT_EQ(eth_multipath_digest(), nullptr);
+    EXPECT_FALSE(eth_multipath_is_message());
+    EXPECT_EQ(eth_multipath_count(), 3);
+
+    eth_multipath_reset();
+    EXPECT_EQ(eth_multipath_count(), 0);
+}
+
+TEST(EvmMultipath, Rejections) {
+    uint32_t consumed = 0;
+    // a single path, more paths than supported
+    EXPECT_EQ(parse("01" + path("00000000"), &consumed), parser_unexpected_number_items);
+    std::string six = "06";
+    for (const char *index : {"00000000", "00000001", "00000002", "00000003", "00000004", "00000005"}) {
+        six += path(index);
+    }
+    EXPECT_EQ(parse(six, &consumed), parser_unexpected_number_items);
+    // the same account twice
+    EXPECT_EQ(parse("02" + path("00000000") + path("00000000"), &consumed), parser_unexpected_value);
+    // not an Ethereum account
+    EXPECT_EQ(parse("02" + path("00000000") + "038000002c800001b280000000", &consumed), parser_unexpected_value);
+    // truncated list
+    const std::string two = "02" + path("00000000") + path("00000001");
+    EXPECT_EQ(parse(two.substr(0, two.size() - 2), &consumed), parser_unexpected_buffer_end);
+    EXPECT_EQ(parse("02" + path("00000000"), &consumed), parser_unexpected_buffer_end);
+    EXPECT_EQ(eth_multipath_count(), 0);
+    EXPECT_EQ(consumed, 0);
+}
@@ -0,0 +1,196 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "coin_evm.h"
+#include "evm_utils.h"
+#include "gmock/gmock.h"
+#include "hex_encode.h"
+#include "hexutils.h"
+#include "parser_evm.h"
+#include "zxformat.h"
+
+namespace {
+
+std::string hexOf(const std::vector<uint8_t> &data) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (uint8_t b : data) {
+        hex += digits[b >> 4];
+        hex += digits[b & 0x0F];
+    }
+    return hex;
+}
+
+}  // namespace
+
+// the windowed formatters must page exactly like pageString over the full string
+TEST(EvmPaging, MatchesPageString) {
+    std::vector<uint8_t> data;
+    for (uint16_t len = 0; len < 90; len += 7) {
+        data.resize(len);
+        for (uint16_t i = 0; i < len; i++) {
+            data[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+        const std::string text(len, 'a');
+        const std::string hex = "0x" + hexOf(data);
+
+        for (uint16_t outLen : {2, 3, 17, 18, 40, 101}) {
+            uint8_t expectedPages = 0;
+            uint8_t pages = 0;
+            std::vector<char> expected(outLen);
+            std::vector<char> actual(outLen);
+
+            pageString(expected.data(), outLen, hex.c_str(), 0, &expectedPages);
+            for (uint8_t page = 0; page <= expectedPages; page++) {
+                pageString(expected.data(), outLen, hex.c_str(), page, &expectedPages);
+                pageHex(actual.data(), outLen, "0x", data.data(), data.size(), page, &pages);
+                ASSERT_EQ(pages, expectedPages);
+                ASSERT_STREQ(actual.data(), expected.data()) << len << " " << outLen << " " << (int)page;
+            }
+
+            pageString(expected.data(), outLen, text.c_str(), 0, &expectedPages);
+            for (uint8_t page = 0; page <= expectedPages; page++) {
+                pageString(expected.data(), outLen, text.c_str(), page, &expectedPages);
+                pageText(actual.data(), outLen, text.data(), text.size(), page, &pages);
+                ASSERT_EQ(pages, expectedPages);
+                ASSERT_STREQ(actual.data(), expected.data());
+            }
+        }
+    }
+}
+
+TEST(EvmPaging, PageCountSaturates) {
+    EXPECT_EQ(pageCountForLength(0, 20), 0);
+    EXPECT_EQ(pageCountForLength(19, 20), 1);
+    EXPECT_EQ(pageCountForLength(20, 20), 2);
+    EXPECT_EQ(pageCountForLength(100000, 20), UINT8_MAX);
+    EXPECT_EQ(pageCountForLength(10, 1), 0);
+}
+
+// every window of every byte value matches the nibble by nibble encoding
+TEST(EvmPaging, HexWindowMatchesNibbles) {
+    std::vector<uint8_t> data(256);
+    for (uint16_t i = 0; i < 256; i++) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+    const std::string hex = hexOf(data);
+    for (uint32_t start = 0; start < 10; start++) {
+        for (uint32_t len = 0; start + len <= hex.size(); len += 13) {
+            std::string out(len + 1, '*');
+            hex_encode_window(&out[0], data.data(), start, len);
+            EXPECT_EQ(out.substr(0, len), hex.substr(start, len)) << start << " " << len;
+            EXPECT_EQ(out[len], '*');
+        }
+    }
+
+    char out[9];
+    EXPECT_EQ(hex_encode(out, sizeof(out), data.data() + 0xfc, 4), 8u);
+    EXPECT_STREQ(out, "fcfdfeff");
+    EXPECT_EQ(hex_encode(out, sizeof(out) - 1, data.data(), 4), 0u);
+    EXPECT_EQ(hex_encode(out, sizeof(out), data.data(), 0), 0u);
+    EXPECT_STREQ(out, "");
+}
+
+// EIP-55 vectors, hashes are keccak256 of the lowercase digits
+TEST(EvmPaging, Eip55Checksum) {
+    const struct {
+        const char *address;
+        const char *hash;
+    } vectors[] = {
+        {"0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed", "d385650ce8fdc6db7ee3a091d34814dbc4ce18219ffae52182efff4034d707e5"},
+        {"0xfB6916095ca1df60bB79Ce92cE3Ea74c37c5d359", "5cfac663f45837b409c4d3dc1cef5f4759734f4989dd53a31b1265734c0b28f4"},
+        {"0xdbF03B407c01E7cD3CBea99509d93f8DDDC8C6FB", "75cd3958e251de0c49f54da99b77f79adbef92caed36af8e81f3a7ddbde17bb9"},
+        {"0xD1220A0cf47c7B9Be7A2E6BA89F429762e7b9aDb", "c8bc5d10249238b92acb838a86d883bb9253c4b02ceb1b3f927d0c3ec09eef6c"},
+    };
+    for (const auto &v : vectors) {
+        std::string lower(v.address + 2);
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        uint8_t hash[32];
+        ASSERT_EQ(parseHexString(hash, sizeof(hash), v.hash), sizeof(hash));
+
+        std::string full = lower;
+        eip55_checksum_window(&full[0], 0, full.size(), hash);
+        EXPECT_EQ("0x" + full, v.address);
+
+        // a page window is checksummed on its own, from its offset in the address
+        for (uint32_t first = 0; first < lower.size(); first += 7) {
+            std::string window = lower.substr(first, 9);
+            eip55_checksum_window(&window[0], first, window.size(), hash);
+            EXPECT_EQ(window, std::string(v.address + 2).substr(first, 9)) << first;
+        }
+    }
+
+    // unchecksummed, an address pages like any other hex
+    std::vector<uint8_t> address(20, 0xab);
+    char expected[18];
+    char actual[18];
+    uint8_t expectedPages = 0;
+    uint8_t pages = 0;
+    for (uint8_t page = 0; page < 3; page++) {
+        pageHex(expected, sizeof(expected), "0x", address.data(), address.size(), page, &expectedPages);
+        ASSERT_EQ(pageEVMAddress(actual, sizeof(actual), address.data(), false, page, &pages), parser_ok);
+        EXPECT_EQ(pages, expectedPages);
+        EXPECT_STREQ(actual, expected);
+    }
+}
+
+// legacy contract call with 40 bytes of calldata: expert mode pages through all of it
+TEST(EvmPaging, ExpertShowsFullCalldata) {
+    std::string calldata;
+    for (uint8_t i = 0; i < 40; i++) {
+        calldata += "ab";
+    }
+    const std::string blob =
+        "f84e01843b9aca00830f4240941d80c49bbbcd1c0911346656b529df9e5c2f783d80a8" + calldata + "820d0a8080";
+    std::vector<uint8_t> buffer(blob.size() / 2);
+    parseHexString(buffer.data(), buffer.size(), blob.c_str());
+
+    const auto dataValue = [&](bool expert) {
+        app_mode_set_expert(expert);
+        parser_context_t ctx = {};
+        EXPECT_EQ(parser_parse_eth(&ctx, buffer.data(), buffer.size()), parser_ok);
+        uint8_t numItems = 0;
+        EXPECT_EQ(parser_getNumItemsEth(&ctx, &numItems), parser_ok);
+        for (uint8_t idx = 0; idx < numItems; idx++) {
+            char key[40] = {0};
+            char value[18] = {0};
+            uint8_t pageCount = 0;
+            EXPECT_EQ(parser_getItemEth(&ctx, idx, key, sizeof(key), value, sizeof(value), 0, &pageCount), parser_ok);
+            if (std::string(key) != "Data") {
+                continue;
+            }
+            std::string full = value;
+            for (uint8_t page = 1; page < pageCount; page++) {
+                EXPECT_EQ(parser_getItemEth(&ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount),
+                          parser_ok);
+                full += value;
+            }
+            return full;
+        }
+        return std::string();
+    };
+
+    app_mode_set_blindsign(true);
+    EXPECT_EQ(dataValue(false), calldata.substr(0, 2 * DATA_BYTES_TO_PRINT) + "...");
+    EXPECT_EQ(dataValue(true), "0x" + calldata);
+    app_mode_set_expert(false);
+    app_mode_set_blindsign(false);
+}
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_policy.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "session.h"
+#include "utils/common.h"
+
+namespace {
+
+const uint32_t kPath[] = {0x8000002c, 0x8000003c, 0x80000000, 0, 0};
+const uint32_t kOtherPath[] = {0x8000002c, 0x8000003c, 0x80000000, 0, 1};
+
+const char *kAlice = "1111111111111111111111111111111111111111";
+const char *kBob = "2222222222222222222222222222222222222222";
+const char *kAgus = "a810acb7ccdc4ed824b952be940d6392434672cf";
+
+std::string u256(const char *hex) {
+    return std::string(64 - strlen(hex), '0') + hex;
+}
+
+// chain 3338, signatures, token or zero, value cap, fee cap of 42000 wei, recipients
+std::string policy(const char *uses, const char *token, const char *valueCap, const std::vector<const char *> &to) {
+    std::string hex = std::string("0000000000000d0a") + uses + token + u256(valueCap) + u256("a410");
+    hex += to.size() < 16 ? "0" + std::to_string(to.size()) : std::to_string(to.size());
+    for (const char *address : to) {
+        hex += address;
+    }
+    return hex;
+}
+
+// EIP-1559 transfer of 1 peaq on peaq mainnet, 21000 gas at 2 wei
+std::string transfer(const char *to, const char *gasLimit = "825208") {
+    return std::string("02e9820d0a050102") + gasLimit + "94" + to + "880de0b6b3a764000080c0";
+}
+
+// ERC20 transfer of amount to recipient on token
+std::string tokenTransfer(const char *token, const char *recipient, const char *amount) {
+    return std::string("02f866820d0a050102825208") + "94" + token + "80" + "b844" + "a9059cbb" + std::string(24, '0') +
+           recipient + u256(amount) + "c0";
+}
+
+parser_error_t setPolicy(const std::string &hex) {
+    const auto data = toBytes(hex);
+    const parser_error_t err = eth_policy_parse(data.data(), (uint16_t)data.size(), kPath, 5);
+    if (err == parser_ok) {
+        eth_policy_activate();
+    }
+    return err;
+}
+
+bool matches(const std::string &hex, const uint32_t *path = kPath) {
+    static std::vector<uint8_t> buffer;
+    buffer = toBytes(hex);
+    parser_context_t ctx;
+    EXPECT_EQ(parser_init_context(&ctx, buffer.data(), (uint16_t)buffer.size()), parser_ok);
+    EXPECT_EQ(_readEth(&ctx, &eth_tx_obj), parser_ok);
+    return eth_policy_match(&eth_tx_obj, path, 5);
+}
+
+}  // namespace
+
+TEST(EvmPolicy, NativeTransfers) {
+    eth_policy_clear();
+    const auto data = toBytes(policy("0002", std::string(40, '0').c_str(), "0de0b6b3a7640000", {kAlice}));
+    ASSERT_EQ(eth_policy_parse(data.data(), (uint16_t)data.size(), kPath, 5), parser_ok);
+
+    const std::vector<std::string> expected = {
+        "Policy : Sign without review",
+        "Asset : peaq",
+        "Max amount : 1.0",
+        "Recipient 1 : 0x1111111111111111111111111111111111111111",
+        "Max fee : 0.000000000000042",
+        "Chain ID : 3338",
+        "Signatures : 2",
+    };
+    EXPECT_EQ(reviewItems(zxerr_ok, eth_policy_getNumItems, eth_policy_getItem), expected);
+
+    // nothing is covered before the review is approved
+    EXPECT_FALSE(matches(transfer(kAlice)));
+    eth_policy_activate();
+    EXPECT_EQ(eth_policy_remaining(), 2);
+    EXPECT_TRUE(matches(transfer(kAlice)));
+
+    EXPECT_FALSE(matches(transfer(kBob)));
+    EXPECT_FALSE(matches(transfer(kAlice), kOtherPath));
+    // 21001 gas goes over the fee cap
+    EXPECT_FALSE(matches(transfer(kAlice, "825209")));
+    // ERC20 transfers are not covered by a native policy
+    EXPECT_FALSE(matches(tokenTransfer(kAgus, kAlice, "01")));
+
+    // the policy ends with its last signature
+    eth_policy_consume();
+    EXPECT_TRUE(matches(transfer(kAlice)));
+    eth_policy_consume();
+    EXPECT_EQ(eth_policy_remaining(), 0);
+    EXPECT_FALSE(matches(transfer(kAlice)));
+}
+
+TEST(EvmPolicy, TokenTransfers) {
+    eth_policy_clear();
+    ASSERT_EQ(setPolicy(policy("0010", kAgus, "64", {kAlice, kBob})), parser_ok);
+
+    EXPECT_TRUE(matches(tokenTransfer(kAgus, kBob, "64")));
+    EXPECT_FALSE(matches(tokenTransfer(kAgus, kBob, "65")));
+    EXPECT_FALSE(matches(tokenTransfer(kAgus, "3333333333333333333333333333333333333333", "01")));
+    // the cap is in token units, native transfers stay reviewed
+    EXPECT_FALSE(matches(transfer(kAlice)));
+
+    eth_policy_clear();
+    EXPECT_EQ(eth_policy_remaining(), 0);
+    EXPECT_FALSE(matches(tokenTransfer(kAgus, kBob, "01")));
+}
+
+TEST(EvmPolicy, Rejections) {
+    eth_policy_clear();
+    const std::string zero(40, '0');
+    // unknown token contract
+    EXPECT_EQ(setPolicy(policy("0001", kAlice, "01", {kBob})), parser_unexpected_value);
+    // no signatures
+    EXPECT_EQ(setPolicy(policy("0000", zero.c_str(), "01", {kBob})), parser_value_out_of_range);
+    // no recipients, too many recipients
+    EXPECT_EQ(setPolicy(policy("0001", zero.c_str(), "01", {})), parser_unexpected_number_items);
+    EXPECT_EQ(setPolicy(policy("0001", zero.c_str(), "01", {kAlice, kBob, kAlice, kBob, kAlice})),
+              parser_unexpected_number_items);
+    // unsupported chain
+    std::string hex = policy("0001", zero.c_str(), "01", {kBob});
+    hex.replace(12, 4, "0001");
+    EXPECT_EQ(setPolicy(hex), parser_invalid_chain_id);
+    // truncated and trailing bytes
+    hex = policy("0001", zero.c_str(), "01", {kBob});
+    EXPECT_EQ(setPolicy(hex.substr(0, hex.size() - 2)), parser_unexpected_characters);
+    EXPECT_EQ(setPolicy(hex + "00"), parser_unexpected_characters);
+    EXPECT_EQ(eth_policy_remaining(), 0);
+}
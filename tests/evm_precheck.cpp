@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <hexutils.h>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "parser_evm.h"
+
+namespace {
+
+constexpr uint64_t kMaxTxLen = 16384;
+
+parser_error_t precheck(const char *hex, uint64_t maxTxLen = kMaxTxLen) {
+    uint8_t buffer[300];
+    const auto bufferLen = parseHexString(buffer, sizeof(buffer), hex);
+    return parser_precheck_eth(buffer, bufferLen, maxTxLen);
+}
+
+}  // namespace
+
+TEST(EvmPrecheck, UnsupportedType) { EXPECT_EQ(precheck("03f8"), parser_unsupported_tx); }
+
+TEST(EvmPrecheck, IncompleteFieldsAreAccepted) {
+    app_mode_set_blindsign(true);
+    // EIP-1559 envelope with the chain id cut in the middle
+    EXPECT_EQ(precheck("02f86e82"), parser_ok);
+    // envelope only
+    EXPECT_EQ(precheck("02f86e"), parser_ok);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmPrecheck, ChainId) {
+    app_mode_set_blindsign(true);
+    // peaq mainnet (3338) and chain id 1
+    EXPECT_EQ(precheck("02f86e820d0a01"), parser_ok);
+    EXPECT_EQ(precheck("02f86e0101"), parser_invalid_chain_id);
+    // legacy EIP-155: chain id follows the data field
+    EXPECT_EQ(precheck("ea0101825208940000000000000000000000000000000000000001808001"), parser_invalid_chain_id);
+    EXPECT_EQ(precheck("ec0101825208940000000000000000000000000000000000000001808082"), parser_ok);
+    app_mode_set_blindsign(false);
+}
+
+TEST(EvmPrecheck, BlindSignRequired) {
+    app_mode_set_blindsign(false);
+    // plain transfer with empty calldata
+    EXPECT_EQ(precheck("02ed820d0a0101018252089400000000000000000000000000000000000000018080c0"),
+              parser_blindsign_mode_required);
+    // calldata not received yet
+    EXPECT_EQ(precheck("02f86e820d0a010101825208940000000000000000000000000000000000000001"), parser_ok);
+    // too large to be buffered
+    EXPECT_EQ(precheck("02f86e820d0a", 64), parser_blindsign_mode_required);
+
+    app_mode_set_blindsign(true);
+    EXPECT_EQ(precheck("02ed820d0a0101018252089400000000000000000000000000000000000000018080c0"), parser_ok);
+    app_mode_set_blindsign(false);
+}
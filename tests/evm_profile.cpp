@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_profile.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace {
+
+uint32_t readU32BE(const std::vector<uint8_t> &buffer, size_t offset) {
+    return (uint32_t)buffer[offset] << 24 | (uint32_t)buffer[offset + 1] << 16 | (uint32_t)buffer[offset + 2] << 8 |
+           buffer[offset + 3];
+}
+
+}  // namespace
+
+TEST(EvmProfile, CountersAreSerializedBigEndian) {
+    evm_profile_reset();
+    evm_profile_add_phase(profile_phase_parse, 0);
+    evm_profile_add_phase(profile_phase_parse, 0);
+    evm_profile_add_phase(profile_phase_sign, 0);
+    evm_profile_count_hash(300);
+    evm_profile_count_hash(32);
+    evm_profile_count_nvm(0x12345);
+    evm_profile_count_item();
+
+    std::vector<uint8_t> out(PROFILE_SERIALIZED_LEN);
+    ASSERT_EQ(evm_profile_serialize(out.data(), out.size()), PROFILE_SERIALIZED_LEN);
+    EXPECT_EQ(out[0], PROFILE_PHASE_COUNT);
+
+    const size_t phases = 1;
+    EXPECT_EQ(readU32BE(out, phases + profile_phase_ingest * 8 + 4), 0u);
+    EXPECT_EQ(readU32BE(out, phases + profile_phase_parse * 8 + 4), 2u);
+    EXPECT_EQ(readU32BE(out, phases + profile_phase_sign * 8 + 4), 1u);
+
+    const size_t totals = phases + PROFILE_PHASE_COUNT * 8;
+    EXPECT_EQ(readU32BE(out, totals), 2u);
+    EXPECT_EQ(readU32BE(out, totals + 4), 332u);
+    EXPECT_EQ(readU32BE(out, totals + 8), 0x12345u);
+    EXPECT_EQ(readU32BE(out, totals + 12), 1u);
+
+    EXPECT_EQ(out[totals + 16], STACK_PROBE_COUNT);
+    EXPECT_EQ(readU32BE(out, totals + 17 + stack_probe_sign_eth * 4), 0u);
+
+    // too small a buffer writes nothing
+    EXPECT_EQ(evm_profile_serialize(out.data(), PROFILE_SERIALIZED_LEN - 1), 0);
+
+    evm_profile_reset();
+    EXPECT_EQ(evm_profile_get()->hashCalls, 0u);
+    EXPECT_EQ(evm_profile_get()->phases[profile_phase_parse].calls, 0u);
+}
+
+TEST(EvmProfile, StackKeepsDeepestUse) {
+    evm_profile_reset();
+    evm_profile_record_stack(stack_probe_sign_eip191, 1200);
+    evm_profile_record_stack(stack_probe_sign_eip191, 800);
+    evm_profile_record_stack(STACK_PROBE_NONE, 4000);
+    EXPECT_EQ(evm_profile_get()->stackUsed[stack_probe_sign_eip191], 1200u);
+    EXPECT_EQ(evm_profile_get()->stackUsed[stack_probe_sign_eth], 0u);
+
+    std::vector<uint8_t> out(PROFILE_SERIALIZED_LEN);
+    ASSERT_EQ(evm_profile_serialize(out.data(), out.size()), PROFILE_SERIALIZED_LEN);
+    const size_t probes = 1 + PROFILE_PHASE_COUNT * 8 + 16 + 1;
+    EXPECT_EQ(readU32BE(out, probes + stack_probe_sign_eip191 * 4), 1200u);
+
+    // host builds do not paint the stack, closing a probe records nothing
+    evm_profile_stack_begin(stack_probe_get_addr_eth);
+    evm_profile_stack_end();
+    EXPECT_EQ(evm_profile_get()->stackUsed[stack_probe_get_addr_eth], 0u);
+    evm_profile_reset();
+}
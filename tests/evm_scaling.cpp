@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "parser_evm.h"
+#include "utils/common.h"
+
+namespace {
+
+// tests/evm_scaling.json, written by tests/gen_evm_scaling.py
+nlohmann::json corpus() {
+    std::ifstream inFile(std::string(TESTVECTORS_DIR) + "evm_scaling.json");
+    if (!inFile.is_open()) {
+        return nlohmann::json::array();
+    }
+    return nlohmann::json::parse(inFile);
+}
+
+// every page of every item, concatenated per item
+std::vector<std::string> renderAll(const parser_context_t *ctx) {
+    std::vector<std::string> items;
+    uint8_t numItems = 0;
+    EXPECT_EQ(parser_getNumItemsEth(ctx, &numItems), parser_ok);
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        char key[40] = {0};
+        char value[40] = {0};
+        std::string item;
+        uint8_t pageCount = 1;
+        for (uint8_t page = 0; page < pageCount; page++) {
+            EXPECT_EQ(parser_getItemEth(ctx, idx, key, sizeof(key), value, sizeof(value), page, &pageCount), parser_ok)
+                << (int)idx << " " << (int)page;
+            item += value;
+        }
+        EXPECT_GT(pageCount, 0) << key;
+        items.push_back(std::string(key) + " : " + item);
+    }
+    return items;
+}
+
+}  // namespace
+
+TEST(EvmScaling, Corpus) {
+    const auto obj = corpus();
+    ASSERT_FALSE(obj.empty());
+    app_mode_set_blindsign(true);
+    app_mode_set_expert(true);
+
+    for (const auto &tc : obj) {
+        SCOPED_TRACE(tc["description"].get<std::string>());
+        const auto buffer = toBytes(tc["encoded_tx_hex"].get<std::string>());
+        parser_context_t ctx = {};
+        parser_error_t err = parser_parse_eth(&ctx, buffer.data(), buffer.size());
+        if (err == parser_ok) {
+            err = parser_validate_eth(&ctx);
+        }
+        if (!tc["valid"].get<bool>()) {
+            EXPECT_STREQ(parser_getErrorDescription(err), tc["error"].get<std::string>().c_str());
+            continue;
+        }
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+
+        const auto items = renderAll(&ctx);
+        if (tc["family"] == "value") {
+            // paging a multi-page amount must give back every digit
+            const size_t digits = tc["size"].get<size_t>();
+            const auto value = std::find_if(items.begin(), items.end(),
+                                            [](const std::string &item) { return item.rfind("Value : ", 0) == 0; });
+            ASSERT_NE(value, items.end());
+            EXPECT_GE(value->size(), strlen("Value : ") + digits) << *value;
+        }
+    }
+
+    app_mode_set_expert(false);
+    app_mode_set_blindsign(false);
+}
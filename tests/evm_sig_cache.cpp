@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_sig_cache.h"
+
+#include <vector>
+
+#include "coin_evm.h"
+#include "gmock/gmock.h"
+
+namespace {
+
+const uint32_t kPath[] = {0x8000002c, 0x8000003c, 0x80000000, 0, 0};
+const uint32_t kOtherPath[] = {0x8000002c, 0x8000003c, 0x80000000, 0, 1};
+
+std::vector<uint8_t> digest(uint8_t seed) {
+    return std::vector<uint8_t>(SIG_CACHE_DIGEST_LEN, seed);
+}
+
+bool lookup(const uint32_t *path, uint8_t format, const std::vector<uint8_t> &hash, std::vector<uint8_t> *sig) {
+    uint8_t out[ETH_SIGNATURE_MAX_LEN] = {0};
+    uint16_t outLen = 0;
+    if (!sig_cache_lookup(path, 5, format, hash.data(), out, sizeof(out), &outLen)) {
+        return false;
+    }
+    sig->assign(out, out + outLen);
+    return true;
+}
+
+}  // namespace
+
+TEST(SigCache, ServesOnlyTheSameRequest) {
+    sig_cache_flush();
+    const std::vector<uint8_t> sig(ETH_SIGNATURE_RSV_LEN, 0x5a);
+    sig_cache_store(kPath, 5, P2_ETH_SIG_COMPACT, digest(1).data(), sig.data(), sig.size());
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(lookup(kPath, P2_ETH_SIG_COMPACT, digest(1), &out));
+    EXPECT_EQ(out, sig);
+    // served again as long as nothing else was uploaded
+    EXPECT_TRUE(lookup(kPath, P2_ETH_SIG_COMPACT, digest(1), &out));
+
+    EXPECT_FALSE(lookup(kPath, P2_ETH_SIG_COMPACT, digest(2), &out));
+    EXPECT_FALSE(lookup(kOtherPath, P2_ETH_SIG_COMPACT, digest(1), &out));
+    EXPECT_FALSE(lookup(kPath, P2_ETH_SIG_DER, digest(1), &out));
+
+    uint8_t small[ETH_SIGNATURE_RSV_LEN - 1];
+    uint16_t smallLen = 0;
+    EXPECT_FALSE(sig_cache_lookup(kPath, 5, P2_ETH_SIG_COMPACT, digest(1).data(), small, sizeof(small), &smallLen));
+
+    sig_cache_flush();
+    EXPECT_FALSE(lookup(kPath, P2_ETH_SIG_COMPACT, digest(1), &out));
+}
+
+TEST(SigCache, ExpiresAfterTheWindow) {
+    sig_cache_flush();
+    const std::vector<uint8_t> sig(ETH_SIGNATURE_MAX_LEN, 0x33);
+    sig_cache_store(kPath, 5, P2_ETH_SIG_DER, digest(7).data(), sig.data(), sig.size());
+
+    std::vector<uint8_t> out;
+    for (uint8_t i = 0; i < SIG_CACHE_TTL_COMMANDS - 1; i++) {
+        sig_cache_tick();
+    }
+    EXPECT_TRUE(lookup(kPath, P2_ETH_SIG_DER, digest(7), &out));
+    sig_cache_tick();
+    EXPECT_FALSE(lookup(kPath, P2_ETH_SIG_DER, digest(7), &out));
+
+    // oversized replies are not kept
+    const std::vector<uint8_t> big(ETH_SIGNATURE_MAX_LEN + 1, 0x33);
+    sig_cache_store(kPath, 5, P2_ETH_SIG_DER, digest(7).data(), big.data(), big.size());
+    EXPECT_FALSE(lookup(kPath, P2_ETH_SIG_DER, digest(7), &out));
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "evm_stream.h"
+
+#include <string>
+#include <vector>
+
+#include "app_mode.h"
+#include "gmock/gmock.h"
+#include "parser_evm.h"
+#include "parser_impl_evm.h"
+
+namespace {
+
+std::vector<uint8_t> sink_out;
+
+uint32_t vector_sink(const uint8_t *data, uint32_t len) {
+    sink_out.insert(sink_out.end(), data, data + len);
+    return len;
+}
+
+// EIP-1559 transaction on peaq mainnet carrying dataLen bytes of calldata
+std::vector<uint8_t> build_eip1559(uint32_t dataLen, uint32_t *listOffset) {
+    std::vector<uint8_t> payload = {0x82, 0x0d, 0x0a, 0x01, 0x01, 0x02, 0x82, 0x52, 0x08, 0x94};
+    for (uint8_t i = 0; i < 20; i++) {
+        payload.push_back(0x10 + i);
+    }
+    payload.push_back(0x80);
+    payload.push_back(0xb9);
+    payload.push_back((dataLen >> 8) & 0xFF);
+    payload.push_back(dataLen & 0xFF);
+    for (uint32_t i = 0; i < dataLen; i++) {
+        payload.push_back(i & 0xFF);
+    }
+    payload.push_back(0xc0);
+
+    std::vector<uint8_t> tx = {0x02, 0xf9, (uint8_t)(payload.size() >> 8), (uint8_t)(payload.size() & 0xFF)};
+    *listOffset = tx.size();
+    tx.insert(tx.end(), payload.begin(), payload.end());
+    return tx;
+}
+
+}  // namespace
+
+TEST(EvmStream, KeepsDataPrefix) {
+    uint32_t offset = 0;
+    const auto tx = build_eip1559(3000, &offset);
+
+    sink_out.clear();
+    evm_stream_t stream;
+    ASSERT_EQ(evm_stream_start(&stream, 2, tx.size() - offset, vector_sink), parser_ok);
+
+    // feed in chunks that split headers and payloads at arbitrary points
+    uint32_t pos = offset;
+    while (pos < tx.size()) {
+        const uint32_t chunk = std::min<uint32_t>(37, tx.size() - pos);
+        uint32_t consumed = 0;
+        ASSERT_EQ(evm_stream_feed(&stream, tx.data() + pos, chunk, &consumed), parser_ok);
+        ASSERT_EQ(consumed, chunk);
+        pos += chunk;
+    }
+    ASSERT_TRUE(evm_stream_complete(&stream));
+    EXPECT_EQ(stream.dataLen, 3000u);
+
+    uint32_t expectedOffset = 0;
+    const auto expected = build_eip1559(EVM_STREAM_DATA_PREFIX_LEN, &expectedOffset);
+    EXPECT_EQ(sink_out, expected);
+
+    parser_context_t ctx;
+    ASSERT_EQ(parser_parse_eth(&ctx, sink_out.data(), sink_out.size()), parser_ok);
+    ASSERT_EQ(parser_set_truncated_data_eth(stream.dataLen), parser_ok);
+
+    // streamed calldata is never classified, so review goes through blind signing
+    app_mode_set_blindsign(true);
+    uint8_t numItems = 0;
+    ASSERT_EQ(parser_getNumItemsEth(&ctx, &numItems), parser_ok);
+
+    bool found = false;
+    char key[40];
+    char value[100];
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        uint8_t pageCount = 0;
+        ASSERT_EQ(parser_getItemEth(&ctx, idx, key, sizeof(key), value, sizeof(value), 0, &pageCount), parser_ok);
+        if (std::string(key) == "Data size") {
+            EXPECT_EQ(std::string(value), "3000 bytes");
+            found = true;
+        }
+    }
+    app_mode_set_blindsign(false);
+    EXPECT_TRUE(found);
+}
+
+TEST(EvmStream, RejectsListAsData) {
+    const uint8_t payload[] = {0x01, 0x01, 0x82, 0x52, 0x08, 0x80, 0x80, 0xc1, 0x00};
+
+    sink_out.clear();
+    evm_stream_t stream;
+    ASSERT_EQ(evm_stream_start(&stream, 0, sizeof(payload), vector_sink), parser_ok);
+    uint32_t consumed = 0;
+    EXPECT_EQ(evm_stream_feed(&stream, payload, sizeof(payload), &consumed), parser_unexpected_type);
+}
+
+TEST(EvmStream, SchemaLayouts) {
+    // the streamed calldata position comes from the same table as the decoder
+    const uint16_t data = offsetof(eth_tx_t, tx.data);
+    EXPECT_EQ(eth_tx_schema_index(eth_tx_schema(legacy), data), 5);
+    EXPECT_EQ(eth_tx_schema_index(eth_tx_schema(eip2930), data), 6);
+    EXPECT_EQ(eth_tx_schema_index(eth_tx_schema(eip1559), data), 7);
+    EXPECT_EQ(eth_tx_schema_index(eth_tx_schema(eip7702), data), 7);
+    EXPECT_EQ(eth_tx_schema(0x03), nullptr);
+
+    evm_stream_t stream = {};
+    EXPECT_EQ(evm_stream_start(&stream, 0x03, 10, vector_sink), parser_unsupported_tx);
+    EXPECT_EQ(evm_stream_start(&stream, 0, 10, vector_sink), parser_ok);
+    EXPECT_EQ(stream.dataIdx, 5);
+}
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "format_scratch.h"
+
+#include "gmock/gmock.h"
+
+TEST(FormatScratch, BorrowAndReturn) {
+    char *first = format_scratch_borrow(FORMAT_SCRATCH_SIZE);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first[0], 0);
+    first[0] = 'x';
+    format_scratch_return();
+
+    // zeroed again for the next formatter
+    char *second = format_scratch_borrow(16);
+    ASSERT_EQ(second, first);
+    EXPECT_EQ(second[0], 0);
+    format_scratch_return();
+
+    EXPECT_EQ(format_scratch_borrow(FORMAT_SCRATCH_SIZE + 1), nullptr);
+}
+
+TEST(FormatScratch, NestingIsRejected) {
+    ASSERT_NE(format_scratch_borrow(8), nullptr);
+    EXPECT_DEBUG_DEATH(EXPECT_EQ(format_scratch_borrow(8), nullptr), "scratch_borrowed");
+    format_scratch_return();
+}
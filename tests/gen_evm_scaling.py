@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Generates tests/evm_scaling.json, the corpus of large and pathological EVM transactions.
+
+tests/evm.json holds typical transactions; this corpus sweeps the sizes where the
+parser, the formatters and the paging could stop scaling linearly. Every family
+grows one dimension and records it as `size`, the benchmarks fit their timings
+against it. Run it after editing the families, or with --check in CI to make sure
+the checked in corpus is up to date.
+"""
+
+import argparse
+import json
+import pathlib
+import sys
+
+HERE = pathlib.Path(__file__).resolve().parent
+TARGET = HERE / "evm_scaling.json"
+
+# keep in sync with FLASH_BUFFER_SIZE in app/src/common/tx.c; larger uploads are streamed
+# and only a calldata prefix reaches the parser
+UPLOAD_BUFFER_SIZE = 16384
+# keep in sync with ETH_MAX_ACCESS_LIST_ITEMS in app/src/evm/parser_impl_evm.h
+ACCESS_LIST_MAX_ITEMS = 200
+
+PEAQ_CHAIN_ID = 3338
+CONTRACT = bytes.fromhex("1d80c49bbbcd1c0911346656b529df9e5c2f783d")
+RECIPIENT = bytes.fromhex("2222222222222222222222222222222222222222")
+U256_MAX = (1 << 256) - 1
+
+BUFFER_END = "Unexpected buffer end"
+OUT_OF_RANGE = "Value out of range"
+
+
+def rlp_length(length, offset):
+    if length < 56:
+        return bytes([offset + length])
+    encoded = length.to_bytes((length.bit_length() + 7) // 8, "big")
+    return bytes([offset + 55 + len(encoded)]) + encoded
+
+
+def rlp_bytes(value):
+    if len(value) == 1 and value[0] < 0x80:
+        return value
+    return rlp_length(len(value), 0x80) + value
+
+
+def rlp_list(items):
+    payload = b"".join(items)
+    return rlp_length(len(payload), 0xC0) + payload
+
+
+def rlp_int(value):
+    return rlp_bytes(value.to_bytes((value.bit_length() + 7) // 8, "big"))
+
+
+def access_list(entries):
+    return rlp_list(
+        [rlp_list([rlp_bytes(address), rlp_list([rlp_bytes(key) for key in keys])]) for address, keys in entries]
+    )
+
+
+def eip1559(to, value=0, data=b"", entries=(), gas_limit=100000, max_fee=2000000000, priority_fee=1000000000):
+    fields = [
+        rlp_int(PEAQ_CHAIN_ID),
+        rlp_int(1),
+        rlp_int(priority_fee),
+        rlp_int(max_fee),
+        rlp_int(gas_limit),
+        rlp_bytes(to),
+        rlp_int(value),
+        rlp_bytes(data),
+        access_list(entries),
+    ]
+    return b"\x02" + rlp_list(fields)
+
+
+def legacy_fields(to, value=0, data=b"", gas_limit=100000, gas_price=1000000000):
+    return [
+        rlp_int(1),
+        rlp_int(gas_price),
+        rlp_int(gas_limit),
+        rlp_bytes(to),
+        rlp_int(value),
+        rlp_bytes(data),
+        rlp_int(PEAQ_CHAIN_ID),
+        rlp_int(0),
+        rlp_int(0),
+    ]
+
+
+def legacy(to, **kwargs):
+    return rlp_list(legacy_fields(to, **kwargs))
+
+
+def calldata(length):
+    # unknown selector, so the calldata is blind signed and shown as hex
+    return bytes((0xAB + 7 * i) & 0xFF for i in range(length))
+
+
+def storage_key(idx):
+    return idx.to_bytes(32, "big")
+
+
+def case(description, family, size, tx, error=""):
+    return {
+        "description": description,
+        "family": family,
+        "size": size,
+        "valid": error == "",
+        "error": error,
+        "encoded_tx_hex": tx.hex(),
+    }
+
+
+def calldata_family():
+    # around every RLP length boundary: 0x80..0xb7 short form, 0xb8 and 0xb9 long form
+    sizes = [0, 1, 55, 56, 255, 256, 1024, 4096, 8192, 12288, 16000]
+    return [case(f"calldata_{n}", "calldata", n, eip1559(CONTRACT, data=calldata(n))) for n in sizes]
+
+
+def access_list_family():
+    cases = []
+    # one storage key per address, up to the review limit and past it (summarized)
+    for addresses in [1, 10, 50, 100, 101, 150, 250]:
+        entries = [(idx.to_bytes(20, "big"), [storage_key(idx)]) for idx in range(1, addresses + 1)]
+        cases.append(
+            case(f"access_list_{addresses}_addresses", "access_list", addresses * 2, eip1559(CONTRACT, entries=entries))
+        )
+    # a single address with a long key list
+    for keys in [ACCESS_LIST_MAX_ITEMS - 1, 400]:
+        entries = [(RECIPIENT, [storage_key(idx) for idx in range(keys)])]
+        cases.append(case(f"access_list_{keys}_keys", "access_list", keys + 1, eip1559(CONTRACT, entries=entries)))
+    return cases
+
+
+def long_form_family():
+    cases = []
+    fields = legacy_fields(RECIPIENT)
+    # nonce, gas price, gas limit, to and value, the calldata header comes next
+    head = b"".join(fields[:5])
+
+    # 0xb8..0xbf: the calldata header declares one byte more than is left in the buffer
+    for length_bytes in range(1, 9):
+        prefix = 0xB7 + length_bytes
+        declared = (1 << (8 * length_bytes)) - 1
+        header = bytes([prefix]) + declared.to_bytes(length_bytes, "big")
+        tx = rlp_list([head, header])
+        cases.append(case(f"long_string_0x{prefix:02x}", "long_form", length_bytes, tx, BUFFER_END))
+
+    # 0xf8..0xff: the top-level list declares more than the upload holds
+    for length_bytes in range(1, 9):
+        prefix = 0xF7 + length_bytes
+        declared = (1 << (8 * length_bytes)) - 1
+        tx = bytes([prefix]) + declared.to_bytes(length_bytes, "big") + b"".join(fields)
+        cases.append(case(f"long_list_0x{prefix:02x}", "long_form", length_bytes, tx, BUFFER_END))
+
+    # the length bytes themselves are cut short
+    cases.append(case("long_string_truncated_length", "long_form", 8, rlp_list([head, b"\xbf\xff\xff"]), BUFFER_END))
+    cases.append(case("long_list_truncated_length", "long_form", 8, b"\xff\xff\xff", BUFFER_END))
+
+    # canonical long forms wrapping large payloads, every nesting level long
+    for n in [56, 256, 4096]:
+        entries = [(RECIPIENT, [storage_key(idx) for idx in range(n // 32)])]
+        tx = eip1559(CONTRACT, data=calldata(n), entries=entries)
+        cases.append(case(f"long_form_nested_{n}", "long_form", n, tx))
+    return cases
+
+
+def max_fee_family():
+    top = U256_MAX
+    return [
+        case("max_fee_eip1559", "max_fee", 32, eip1559(RECIPIENT, gas_limit=top, max_fee=top, priority_fee=top)),
+        case("max_fee_legacy", "max_fee", 32, legacy(RECIPIENT, gas_limit=top, gas_price=top)),
+        case("max_fee_gas_limit_only", "max_fee", 32, eip1559(RECIPIENT, gas_limit=top)),
+        case("max_fee_price_only", "max_fee", 32, eip1559(RECIPIENT, max_fee=top, priority_fee=top)),
+        # one byte past uint256
+        case("max_fee_33_bytes", "max_fee", 33, eip1559(RECIPIENT, max_fee=top + 1), OUT_OF_RANGE),
+    ]
+
+
+def value_family():
+    cases = []
+    # the decimal string grows with the value until it spans several pages
+    for digits in [1, 18, 19, 40, 60, 77]:
+        value = 10**digits - 1
+        cases.append(case(f"value_{digits}_digits", "value", digits, eip1559(RECIPIENT, value=value)))
+    cases.append(case("value_u256_max", "value", 78, eip1559(RECIPIENT, value=U256_MAX)))
+    cases.append(case("value_u256_max_legacy", "value", 78, legacy(RECIPIENT, value=U256_MAX)))
+    # amounts are uint256: one more byte is rejected by the parser, like the fees
+    cases.append(case("value_33_bytes", "value", 33, eip1559(RECIPIENT, value=U256_MAX + 1), OUT_OF_RANGE))
+    return cases
+
+
+def render():
+    cases = calldata_family() + access_list_family() + long_form_family() + max_fee_family() + value_family()
+    for tc in cases:
+        if len(tc["encoded_tx_hex"]) // 2 > UPLOAD_BUFFER_SIZE:
+            sys.exit(f"{tc['description']}: does not fit the upload buffer")
+    return json.dumps(cases, indent=2) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--check", action="store_true", help="fail if the corpus is not up to date")
+    args = parser.parse_args()
+
+    output = render()
+    if args.check:
+        if not TARGET.exists() or TARGET.read_text() != output:
+            sys.exit(f"{TARGET} is out of date, run {pathlib.Path(__file__).name}")
+        return
+    TARGET.write_text(output)
+
+
+if __name__ == "__main__":
+    main()
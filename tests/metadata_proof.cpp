@@ -0,0 +1,252 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "metadata_proof.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "blake3.h"
+#include "coin.h"
+#include "gmock/gmock.h"
+#include "parser.h"
+#include "utils/common.h"
+
+namespace {
+
+typedef std::vector<uint8_t> bytes_t;
+
+std::string toHex(const uint8_t *data, size_t len) {
+    std::string hex;
+    char byte[3];
+    for (size_t i = 0; i < len; i++) {
+        snprintf(byte, sizeof(byte), "%02x", data[i]);
+        hex += byte;
+    }
+    return hex;
+}
+
+bytes_t blake3(const bytes_t &data) {
+    bytes_t out(BLAKE3_OUT_LEN);
+    EXPECT_TRUE(blake3_hash(data.data(), data.size(), out.data()));
+    return out;
+}
+
+void append(bytes_t *out, const bytes_t &data) {
+    out->insert(out->end(), data.begin(), data.end());
+}
+
+// compacts of at most two bytes are enough for these tests
+bytes_t compact(size_t v) {
+    if (v < 64) {
+        return {static_cast<uint8_t>(v << 2)};
+    }
+    return {static_cast<uint8_t>((v << 2) | 1), static_cast<uint8_t>(v >> 6)};
+}
+
+bytes_t str(const std::string &s) {
+    bytes_t out = compact(s.size());
+    out.insert(out.end(), s.begin(), s.end());
+    return out;
+}
+
+bytes_t u32(uint32_t v) {
+    return {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v >> 16),
+            static_cast<uint8_t>(v >> 24)};
+}
+
+// TypeInformation of one enumeration variant; fields are given encoded
+bytes_t variant(const std::vector<std::string> &path, const std::string &name, uint8_t numFields,
+                const bytes_t &fields, uint8_t index, uint8_t typeId) {
+    bytes_t out = {static_cast<uint8_t>(path.size() << 2)};
+    for (const auto &segment : path) {
+        append(&out, str(segment));
+    }
+    out.push_back(0x01);
+    append(&out, str(name));
+    out.push_back(static_cast<uint8_t>(numFields << 2));
+    append(&out, fields);
+    out.push_back(static_cast<uint8_t>(index << 2));
+    out.push_back(static_cast<uint8_t>(typeId << 2));
+    return out;
+}
+
+// Root as RFC-78 builds it: pair the last two nodes and push the parent to the front
+bytes_t treeRoot(std::deque<bytes_t> nodes) {
+    while (nodes.size() > 1) {
+        const bytes_t right = nodes.back();
+        nodes.pop_back();
+        bytes_t left = nodes.back();
+        nodes.pop_back();
+        append(&left, right);
+        nodes.push_front(blake3(left));
+    }
+    return nodes.front();
+}
+
+const std::string kAccount = std::string(64, '1');
+const uint8_t kCallType = 40;
+
+struct Fixture {
+    bytes_t runtimeCall;
+    bytes_t call;
+    bytes_t extraInfo;
+    std::vector<bytes_t> fillers;
+
+    Fixture() {
+        // RuntimeCall::Balances(pallet_balances::Call), the Call enumeration is type 40
+        runtimeCall = variant({"peaq_runtime", "RuntimeCall"}, "Balances", 1, {0x00, 0x16, kCallType << 2, 0x00},
+                              PALLET_BALANCES, 10);
+        // transfer_keep_alive { dest: type 12, value: Compact<u128> }
+        bytes_t fields = {0x01};
+        append(&fields, str("dest"));
+        append(&fields, {0x16, 12 << 2, 0x00, 0x01});
+        append(&fields, str("value"));
+        append(&fields, {0x13, 0x00});
+        call = variant({"pallet_balances", "pallet", "Call"}, "transfer_keep_alive", 2, fields, 3, kCallType);
+
+        extraInfo = u32(3000);
+        append(&extraInfo, str("peaq-node"));
+        append(&extraInfo, {SS58_ADDRESS_TYPE & 0xff, SS58_ADDRESS_TYPE >> 8, COIN_AMOUNT_DECIMALS});
+        append(&extraInfo, str(COIN_SYMBOL));
+
+        for (uint8_t i = 0; i < 3; i++) {
+            fillers.push_back(bytes_t(BLAKE3_OUT_LEN, static_cast<uint8_t>(0xe0 + i)));
+        }
+    }
+
+    // five types: the two variants are leaves 1 and 3
+    bytes_t digest() const {
+        const bytes_t root = treeRoot({fillers[0], blake3(runtimeCall), fillers[1], blake3(call), fillers[2]});
+        bytes_t preimage = {0x01};
+        append(&preimage, root);
+        append(&preimage, bytes_t(BLAKE3_OUT_LEN, 0xcc));
+        append(&preimage, extraInfo);
+        return blake3(preimage);
+    }
+
+    bytes_t proof() const {
+        bytes_t out(BLAKE3_OUT_LEN, 0xcc);
+        append(&out, extraInfo);
+        append(&out, u32(5));
+        out.push_back(2 << 2);
+        append(&out, u32(1));
+        append(&out, compact(runtimeCall.size()));
+        append(&out, runtimeCall);
+        append(&out, u32(3));
+        append(&out, compact(call.size()));
+        append(&out, call);
+        // nodes: leaf 4, leaf 0, leaf 2, in the order the root is recomputed
+        out.push_back(3 << 2);
+        append(&out, fillers[2]);
+        append(&out, fillers[0]);
+        append(&out, fillers[1]);
+        return out;
+    }
+};
+
+// Balances.transfer_keep_alive(Id(account), 1 planck) with CheckMetadataHash enabled
+bytes_t payload(const bytes_t &digest, const std::string &mode = "01") {
+    return toBytes("0503" "00" + kAccount + "04" + "00" "14" "00" + mode + "b80b0000" "01000000" +
+                   std::string(64, 'a') + std::string(64, 'b') + "01" + toHex(digest.data(), digest.size()));
+}
+
+parser_error_t parseWithProof(const bytes_t &data, const bytes_t &proof) {
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    return parser_parse_with_proof(&ctx, data.data(), data.size(), proof.data(), proof.size(), &tx_obj);
+}
+
+}  // namespace
+
+TEST(Blake3, ReferenceVectors) {
+    // inputs of the official test vectors: byte i is i % 251
+    bytes_t input(2049);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<uint8_t>(i % 251);
+    }
+    const std::vector<std::pair<size_t, std::string>> vectors = {
+        {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+        {1, "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"},
+        {1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+        {1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+        {2049, "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030"},
+    };
+    for (const auto &vector : vectors) {
+        const bytes_t out = blake3(bytes_t(input.begin(), input.begin() + vector.first));
+        EXPECT_EQ(toHex(out.data(), out.size()), vector.second) << vector.first;
+    }
+
+    // the same input fed in uneven parts
+    blake3_hasher_t hasher;
+    blake3_init(&hasher);
+    for (size_t offset = 0; offset < input.size(); offset += 77) {
+        ASSERT_TRUE(blake3_update(&hasher, input.data() + offset, std::min<size_t>(77, input.size() - offset)));
+    }
+    uint8_t out[BLAKE3_OUT_LEN];
+    blake3_finalize(&hasher, out);
+    EXPECT_EQ(toHex(out, sizeof(out)), vectors.back().second);
+}
+
+TEST(MetadataProof, VerifiesTransfer) {
+    const Fixture fixture;
+    const bytes_t data = payload(fixture.digest());
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    const bytes_t proof = fixture.proof();
+    ASSERT_EQ(parser_parse_with_proof(&ctx, data.data(), data.size(), proof.data(), proof.size(), &tx_obj), parser_ok);
+
+    uint8_t numItems = 0;
+    ASSERT_EQ(parser_getNumItems(&ctx, &numItems), parser_ok);
+    EXPECT_EQ(numItems, 5);
+
+    // without the proof the extension bytes are not expected
+    tx_obj = {};
+    EXPECT_EQ(parser_parse(&ctx, data.data(), data.size(), &tx_obj), parser_unexpected_characters);
+}
+
+TEST(MetadataProof, Rejections) {
+    Fixture fixture;
+    const bytes_t digest = fixture.digest();
+
+    // hash of other metadata
+    bytes_t other = digest;
+    other[0] ^= 1;
+    EXPECT_EQ(parseWithProof(payload(other), fixture.proof()), parser_metadata_mismatch);
+    // metadata hash disabled
+    EXPECT_EQ(parseWithProof(payload(digest, "00"), fixture.proof()), parser_unexpected_value);
+
+    // a node that is not the one of the tree
+    bytes_t proof = fixture.proof();
+    proof[proof.size() - 1] ^= 1;
+    EXPECT_EQ(parseWithProof(payload(digest), proof), parser_metadata_mismatch);
+    // missing node
+    proof = fixture.proof();
+    proof.resize(proof.size() - BLAKE3_OUT_LEN);
+    EXPECT_NE(parseWithProof(payload(digest), proof), parser_ok);
+
+    // the runtime puts another pallet at the index the review assumes
+    Fixture renamed;
+    renamed.runtimeCall = variant({"peaq_runtime", "RuntimeCall"}, "Assets", 1, {0x00, 0x16, kCallType << 2, 0x00},
+                                  PALLET_BALANCES, 10);
+    EXPECT_EQ(parseWithProof(payload(renamed.digest()), renamed.proof()), parser_metadata_mismatch);
+
+    // another token
+    Fixture token;
+    token.extraInfo.back() = 'X';
+    EXPECT_EQ(parseWithProof(payload(token.digest()), token.proof()), parser_metadata_mismatch);
+}
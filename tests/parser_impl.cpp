@@ -21,11 +21,16 @@
 #include <hexutils.h>
 
 #include <iostream>
+#include <string>
 #include <vector>
 
+#include "app_mode.h"
+#include "coin.h"
+#include "crypto_helper.h"
 #include "gmock/gmock.h"
 #include "parser.h"
 #include "parser_txdef.h"
+#include "utils/common.h"
 
 using namespace std;
 
@@ -60,3 +65,209 @@ TEST(SCALE, ReadBytes) {
     //     EXPECT_EQ(testArray2[i], bytesArray[i+4]);
     // }
 }
+
+namespace {
+
+const std::string kAccount = std::string(64, '1');
+const std::string kCollator = std::string(64, '2');
+// immortal era, nonce 5, no tip, spec version 3000, tx version 1, genesis and block hashes
+const std::string kExtra = "00" "14" "00" "b80b0000" "01000000" + std::string(64, 'a') + std::string(64, 'b');
+
+std::string ss58(const std::string &hex) {
+    const auto pubkey = toBytes(hex);
+    uint8_t address[SS58_ADDRESS_MAX_LEN] = {0};
+    EXPECT_GT(crypto_SS58EncodePubkey(address, sizeof(address), SS58_ADDRESS_TYPE, pubkey.data()), 0);
+    return reinterpret_cast<const char *>(address);
+}
+
+parser_error_t parse(const std::vector<uint8_t> &buffer, parser_context_t *ctx, parser_tx_t *tx_obj) {
+    *tx_obj = {};
+    CHECK_ERROR(parser_parse(ctx, buffer.data(), buffer.size(), tx_obj))
+    return parser_validate(ctx);
+}
+
+}  // namespace
+
+TEST(SCALE, CompactCanonical) {
+    const struct {
+        const char *hex;
+        uint8_t maxBytes;
+        parser_error_t expected;
+    } cases[] = {
+        {"fc", 16, parser_ok},  // 63
+        {"0101", 16, parser_ok},  // 64
+        {"0500", 16, parser_value_out_of_range},  // 1 in two bytes
+        {"feff0300", 16, parser_ok},  // 2^16 - 1
+        {"02000100", 16, parser_ok},  // 2^14
+        {"feff0000", 16, parser_value_out_of_range},  // 2^14 - 1 in four bytes
+        {"0300000040", 16, parser_ok},  // 2^30
+        {"03ffffff3f", 16, parser_value_out_of_range},
+        {"070000000000", 16, parser_value_out_of_range},  // leading zero byte
+        {"130000000000000001", 8, parser_ok},
+        {"17000000000000000001", 8, parser_value_out_of_range},
+        {"13000000", 16, parser_unexpected_buffer_end},
+    };
+    for (const auto &tc : cases) {
+        const auto buffer = toBytes(tc.hex);
+        parser_context_t ctx = {};
+        ASSERT_EQ(parser_init_context(&ctx, buffer.data(), buffer.size()), parser_ok);
+        scale_span_t span = {};
+        EXPECT_EQ(_readCompactInt(&ctx, tc.maxBytes, &span), tc.expected) << tc.hex;
+        if (tc.expected == parser_ok) {
+            EXPECT_EQ(span.len, buffer.size()) << tc.hex;
+        }
+    }
+
+    const auto buffer = toBytes("0300000040");
+    uint256_t value = {};
+    ASSERT_EQ(_decodeCompact(buffer.data(), buffer.size(), &value), parser_ok);
+    EXPECT_EQ(value.elements[1].elements[1], 1ull << 30);
+}
+
+TEST(SCALE, Transfer) {
+    app_mode_set_expert(false);
+    // Balances.transfer_keep_alive(Id(account), 1 PEAQ)
+    const auto buffer = toBytes("0503" "00" + kAccount + "13000064a7b3b6e00d" + kExtra);
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    ASSERT_EQ(parse(buffer, &ctx, &tx_obj), parser_ok);
+
+    const std::vector<std::string> expected = {
+        "Balances : Transfer keep alive",
+        "Dest : " + ss58(kAccount),
+        "Value : PEAQ 1.0",
+        "Nonce : 5",
+        "Tip : PEAQ 0.0",
+    };
+    EXPECT_EQ(reviewItems(&ctx), expected);
+    EXPECT_EQ(tx_obj.call.args[0].offset, 3);
+}
+
+TEST(SCALE, ValidateRendersEveryItem) {
+    app_mode_set_expert(true);
+    const auto buffer = toBytes("0503" "00" + kAccount + "13000064a7b3b6e00d" + kExtra);
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    ASSERT_EQ(parse(buffer, &ctx, &tx_obj), parser_ok);
+
+    // a value that cannot be decoded for display is caught before the review starts
+    tx_obj.call.args[1].len = 3;
+    EXPECT_EQ(parser_validate(&ctx), parser_unexpected_value);
+    app_mode_set_expert(false);
+}
+
+TEST(SCALE, BatchExpert) {
+    app_mode_set_expert(true);
+    // Utility.batch([transfer_keep_alive(account, 1 planck), join_delegators(collator, 2 PEAQ)]), mortal era
+    const std::string extra = "c500" + kExtra.substr(2);
+    const auto buffer = toBytes("1500" "08" "0503" "00" + kAccount + "04" "170b" "00" + kCollator +
+                                "0000c84e676dc11b0000000000000000" + extra);
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    ASSERT_EQ(parse(buffer, &ctx, &tx_obj), parser_ok);
+    EXPECT_EQ(tx_obj.numCalls, 2);
+
+    const std::vector<std::string> expected = {
+        "Utility : Batch",
+        "[1] Balances : Transfer keep alive",
+        "[1] Dest : " + ss58(kAccount),
+        "[1] Value : PEAQ 0.000000000000000001",
+        "[2] ParachainStaking : Join delegators",
+        "[2] Collator : " + ss58(kCollator),
+        "[2] Amount : PEAQ 2.0",
+        "Nonce : 5",
+        "Tip : PEAQ 0.0",
+        "Era : Mortal 12/64",
+        "Spec version : 3000",
+        "Tx version : 1",
+        "Genesis hash : 0x" + std::string(64, 'a'),
+        "Block hash : 0x" + std::string(64, 'b'),
+    };
+    EXPECT_EQ(reviewItems(&ctx), expected);
+    app_mode_set_expert(false);
+}
+
+TEST(SCALE, Rejections) {
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    const std::string transfer = "0503" "00" + kAccount + "04";
+
+    // trailing byte
+    EXPECT_EQ(parse(toBytes(transfer + kExtra + "00"), &ctx, &tx_obj), parser_unexpected_characters);
+    // truncated
+    EXPECT_EQ(parse(toBytes(transfer + kExtra.substr(0, kExtra.size() - 2)), &ctx, &tx_obj),
+              parser_unexpected_buffer_end);
+    // unknown call
+    EXPECT_EQ(parse(toBytes("0507" "00" + kAccount + "04" + kExtra), &ctx, &tx_obj), parser_unexpected_method);
+    // MultiAddress other than Id
+    EXPECT_EQ(parse(toBytes("0503" "01" + kAccount + "04" + kExtra), &ctx, &tx_obj), parser_invalid_address);
+    // non canonical amount
+    EXPECT_EQ(parse(toBytes("0503" "00" + kAccount + "0500" + kExtra), &ctx, &tx_obj), parser_value_out_of_range);
+    // keep alive flag that is not a bool
+    EXPECT_EQ(parse(toBytes("0504" "00" + kAccount + "02" + kExtra), &ctx, &tx_obj), parser_unexpected_value);
+    // nested and empty batches
+    EXPECT_EQ(parse(toBytes("1500" "04" "1502" "04" + transfer + kExtra), &ctx, &tx_obj), parser_unexpected_method);
+    EXPECT_EQ(parse(toBytes("1500" "00" + kExtra), &ctx, &tx_obj), parser_unexpected_number_items);
+    // invalid era: phase past the period
+    EXPECT_EQ(parse(toBytes(transfer + "4100" + kExtra.substr(2)), &ctx, &tx_obj), parser_unexpected_value);
+
+    // more inner calls than can be reviewed
+    std::string batch = "1500" "cc";
+    for (uint8_t i = 0; i < PARSER_MAX_BATCH_CALLS + 1; i++) {
+        batch += transfer;
+    }
+    EXPECT_EQ(parse(toBytes(batch + kExtra), &ctx, &tx_obj), parser_unexpected_number_items);
+}
+
+TEST(SCALE, LongBatch) {
+    // eight transfers take the payload past MAX_SIGN_SIZE, which is then signed through its hash
+    std::string batch = "1502" "20";
+    for (uint8_t i = 0; i < 8; i++) {
+        batch += "0503" "00" + kAccount + "04";
+    }
+    const auto buffer = toBytes(batch + kExtra);
+    ASSERT_GT(buffer.size(), MAX_SIGN_SIZE);
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    ASSERT_EQ(parse(buffer, &ctx, &tx_obj), parser_ok);
+    EXPECT_EQ(tx_obj.numCalls, 8);
+
+    uint8_t numItems = 0;
+    ASSERT_EQ(parser_getNumItems(&ctx, &numItems), parser_ok);
+    EXPECT_EQ(numItems, 1 + 8 * 3 + 2);
+}
+
+TEST(SCALE, FullBatch) {
+    // Utility.batch_all of PARSER_MAX_BATCH_CALLS staking top-ups, each one decoded when it is shown
+    std::string batch = "1502" "c8";
+    for (uint8_t i = 0; i < PARSER_MAX_BATCH_CALLS; i++) {
+        batch += "170e" "00" + kCollator + "0000c84e676dc11b0000000000000000";
+    }
+    const auto buffer = toBytes(batch + kExtra);
+    parser_context_t ctx = {};
+    parser_tx_t tx_obj = {};
+    ASSERT_EQ(parse(buffer, &ctx, &tx_obj), parser_ok);
+    EXPECT_EQ(tx_obj.numCalls, PARSER_MAX_BATCH_CALLS);
+
+    const auto items = reviewItems(&ctx);
+    ASSERT_EQ(items.size(), 1 + PARSER_MAX_BATCH_CALLS * 3 + 2);
+    EXPECT_EQ(items[items.size() - 5], "[50] ParachainStaking : Delegator stake more");
+    EXPECT_EQ(items[items.size() - 4], "[50] Candidate : " + ss58(kCollator));
+    EXPECT_EQ(items[items.size() - 3], "[50] More : PEAQ 2.0");
+}
+
+TEST(SCALE, SS58Prefix) {
+    uint8_t prefix[SS58_PREFIX_MAX_LEN] = {0};
+    ASSERT_EQ(crypto_SS58CalculatePrefix(42, prefix), 1);
+    EXPECT_EQ(prefix[0], 42);
+    ASSERT_EQ(crypto_SS58CalculatePrefix(255, prefix), 2);
+    EXPECT_EQ(prefix[0], 0x7f);
+    EXPECT_EQ(prefix[1], 0xc0);
+    EXPECT_EQ(crypto_SS58CalculatePrefix(16384, prefix), 0);
+
+    // prefix 42 addresses of 32-byte keys are 48 characters long
+    EXPECT_EQ(ss58(kAccount).size(), 48);
+    uint8_t small[SS58_ADDRESS_MAX_LEN - 1] = {0};
+    const auto pubkey = toBytes(kAccount);
+    EXPECT_EQ(crypto_SS58EncodePubkey(small, sizeof(small), SS58_ADDRESS_TYPE, pubkey.data()), 0);
+}
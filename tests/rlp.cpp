@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "rlp.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "utils/common.h"
+
+TEST(Rlp, FieldDescriptors) {
+    // [0x05, "", "abc", [0x01]] followed by a 56-byte string
+    const auto buffer = toBytes("c805" "80" "83616263" "c101"
+                                "b838" "0000000000000000000000000000000000000000000000000000000000000000"
+                                "000000000000000000000000000000000000000000000000");
+    parser_context_t ctx = {.buffer = buffer.data(), .bufferLen = (uint16_t)buffer.size(), .offset = 0};
+
+    rlp_field_t list = {};
+    ASSERT_EQ(rlp_readField(&ctx, &list), parser_ok);
+    EXPECT_EQ(list.kind, RLP_KIND_LIST);
+    EXPECT_EQ(list.fieldOffset, 0);
+    EXPECT_EQ(list.valueOffset, 1);
+    EXPECT_EQ(list.valueLen, 8);
+
+    rlp_field_t longString = {};
+    ASSERT_EQ(rlp_readField(&ctx, &longString), parser_ok);
+    EXPECT_EQ(longString.kind, RLP_KIND_STRING);
+    EXPECT_EQ(longString.valueOffset, 11);
+    EXPECT_EQ(longString.valueLen, 56);
+    EXPECT_EQ(ctx.offset, buffer.size());
+
+    // descriptors stay valid when the buffer moves
+    const std::vector<uint8_t> moved(buffer);
+    rlp_t view = {};
+    rlp_fieldView(moved.data(), &list, &view);
+    rlp_field_t items[4] = {};
+    uint16_t numItems = 0;
+    ASSERT_EQ(rlp_readList(&view, items, &numItems, 4), parser_ok);
+    ASSERT_EQ(numItems, 4);
+    EXPECT_EQ(items[0].kind, RLP_KIND_BYTE);
+    EXPECT_EQ(view.ptr[items[0].valueOffset], 0x05);
+    EXPECT_EQ(items[1].valueLen, 0);
+    EXPECT_EQ(items[2].valueLen, 3);
+    EXPECT_EQ(view.ptr[items[2].valueOffset], 'a');
+    EXPECT_EQ(items[3].kind, RLP_KIND_LIST);
+}
+
+TEST(Rlp, TruncatedPayload) {
+    const auto buffer = toBytes("836162");
+    parser_context_t ctx = {.buffer = buffer.data(), .bufferLen = (uint16_t)buffer.size(), .offset = 0};
+    rlp_field_t field = {};
+    EXPECT_EQ(rlp_readField(&ctx, &field), parser_unexpected_buffer_end);
+
+    // length of length running past the end
+    const auto header = toBytes("b9ff");
+    ctx = {.buffer = header.data(), .bufferLen = (uint16_t)header.size(), .offset = 0};
+    EXPECT_EQ(rlp_readField(&ctx, &field), parser_unexpected_buffer_end);
+}
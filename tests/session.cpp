@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "session.h"
+
+#include "gmock/gmock.h"
+
+TEST(Session, ClaimKeepsStateOfTheSameFlow) {
+    session_claim(session_flow_evm);
+    eth_batch_obj.count = 3;
+    session_claim(session_flow_evm);
+    EXPECT_EQ(eth_batch_obj.count, 3);
+
+    // the next flow never sees the state of the previous one
+    session_claim(session_flow_substrate);
+    EXPECT_EQ(session_current_flow(), session_flow_substrate);
+    EXPECT_EQ(session_arena.views.substrate.tx.nonce.len, 0);
+    session_arena.views.substrate.tx.nonce.len = 2;
+    session_claim(session_flow_evm);
+    EXPECT_EQ(eth_batch_obj.count, 0);
+}
+
+namespace {
+int evictions = 0;
+void onEvict() {
+    evictions++;
+}
+}  // namespace
+
+TEST(Session, EvictionNotifiesThePreviousOwner) {
+    session_claim(session_flow_evm);
+    session_on_evict(session_flow_evm, onEvict);
+    evictions = 0;
+
+    session_claim(session_flow_evm);
+    EXPECT_EQ(evictions, 0);
+    session_claim(session_flow_substrate);
+    EXPECT_EQ(evictions, 1);
+    // only the flow that lost the arena is told
+    session_claim(session_flow_eip712);
+    EXPECT_EQ(evictions, 1);
+
+    session_on_evict(session_flow_evm, nullptr);
+    session_release(session_flow_eip712);
+}
+
+TEST(Session, ReleaseOnlyDropsTheOwner) {
+    session_claim(session_flow_evm);
+    eth_batch_obj.count = 2;
+    session_release(session_flow_eip712);
+    EXPECT_EQ(session_current_flow(), session_flow_evm);
+    EXPECT_EQ(eth_batch_obj.count, 2);
+
+    session_release(session_flow_evm);
+    EXPECT_EQ(session_current_flow(), session_flow_none);
+    EXPECT_EQ(eth_batch_obj.count, 0);
+}
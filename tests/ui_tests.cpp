@@ -116,7 +116,7 @@ std::vector<testcase_t> GetEVMJsonTestCases(const std::string &jsonFile, Generat
     return answer;
 }
 
-void check_testcase(const testcase_t &tc, bool expert_mode, bool is_eth) {
+void check_testcase(const testcase_t &tc, bool expert_mode, bool is_eth, bool validate = false) {
     app_mode_set_expert(expert_mode);
 
     parser_error_t err;
@@ -135,6 +135,12 @@ void check_testcase(const testcase_t &tc, bool expert_mode, bool is_eth) {
     }
     ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
 
+    if (validate) {
+        // validation fills the render cache; pages must match on-demand formatting
+        err = is_eth ? parser_validate_eth(&ctx) : parser_validate(&ctx);
+        ASSERT_EQ(err, parser_ok) << parser_getErrorDescription(err);
+    }
+
     auto output = dumpUI(&ctx, 39, 39);
 
     std::cout << std::endl;
@@ -162,3 +168,7 @@ INSTANTIATE_TEST_SUITE_P(EVMTransactions, VerifyEvmTransactions,
 TEST_P(VerifyEvmTransactions, CheckUIOutput_CurrentTX_Normal) {
     check_testcase(GetParam(), false, true);
 }
+
+TEST_P(VerifyEvmTransactions, CheckUIOutput_CurrentTX_Validated) {
+    check_testcase(GetParam(), false, true, true);
+}
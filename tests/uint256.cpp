@@ -0,0 +1,158 @@
+/*******************************************************************************
+ *   (c) 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ********************************************************************************/
+
+#include "uint256.h"
+
+#include <hexutils.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace {
+
+uint256_t fromHex(const std::string &hex) {
+    std::vector<uint8_t> bytes(32);
+    parseHexString(bytes.data(), bytes.size(), (std::string(64 - hex.size(), '0') + hex).c_str());
+    parser_context_t ctx = {.buffer = bytes.data(), .bufferLen = 32, .offset = 0};
+    uint256_t value;
+    EXPECT_EQ(readu256BE(&ctx, &value), parser_ok);
+    return value;
+}
+
+// least significant word first
+uint256_t fromWords(const uint64_t words[4]) {
+    uint256_t value = {};
+    LOWER(LOWER(value)) = words[0];
+    UPPER(LOWER(value)) = words[1];
+    LOWER(UPPER(value)) = words[2];
+    UPPER(UPPER(value)) = words[3];
+    return value;
+}
+
+// digit by digit reference using divmod256
+std::string reference(uint256_t value) {
+    uint256_t ten = {};
+    LOWER(LOWER(ten)) = 10;
+    std::string digits;
+    do {
+        uint256_t mod;
+        divmod256(&value, &ten, &value, &mod);
+        digits.insert(digits.begin(), static_cast<char>('0' + LOWER(LOWER(mod))));
+    } while (!zero256(&value));
+    return digits;
+}
+
+std::string decimal(uint256_t value, uint32_t outLen = 100) {
+    char out[100] = {0};
+    if (!tostring256(&value, 10, out, outLen)) {
+        return "<error>";
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(Uint256, DecimalConversion) {
+    EXPECT_EQ(decimal(fromHex("00")), "0");
+    EXPECT_EQ(decimal(fromHex("ffffffffffffffff")), "18446744073709551615");
+    EXPECT_EQ(decimal(fromHex("010000000000000000")), "18446744073709551616");
+    EXPECT_EQ(decimal(fromHex("0de0b6b3a7640000")), "1000000000000000000");
+    // chunks with inner zeros
+    EXPECT_EQ(decimal(fromHex("2cd76fe086b93ce2f768a00b22a00000000000")), "1000000000000000000000000000000000000000000000");
+    EXPECT_EQ(decimal(fromHex(std::string(64, 'f'))),
+              "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+
+    // the terminator needs room too
+    EXPECT_EQ(decimal(fromHex("03e8"), 5), "1000");
+    EXPECT_EQ(decimal(fromHex("03e8"), 4), "<error>");
+    EXPECT_EQ(decimal(fromHex(std::string(64, 'f')), 78), "<error>");
+}
+
+TEST(Uint256, DecimalMatchesReference) {
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 2000; i++) {
+        // spread the magnitudes over every limb
+        uint64_t words[4] = {0};
+        for (int l = 0; l <= i % 4; l++) {
+            words[l] = rng() >> (rng() % 64);
+        }
+        const uint256_t value = fromWords(words);
+        ASSERT_EQ(decimal(value), reference(value));
+    }
+}
+
+TEST(Uint256, LimbArithmeticMatchesShiftSubtract) {
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 2000; i++) {
+        uint64_t a[4] = {0};
+        uint64_t b[4] = {0};
+        for (int l = 0; l <= i % 4; l++) {
+            a[l] = rng() >> (rng() % 64);
+        }
+        for (int l = 0; l <= (i / 4) % 4; l++) {
+            b[l] = rng() >> (rng() % 64);
+        }
+        uint256_t x = fromWords(a);
+        uint256_t y = fromWords(b);
+        if (zero256(&y)) {
+            continue;
+        }
+
+        // q * y + r == x and r < y
+        uint256_t q;
+        uint256_t r;
+        divmod256(&x, &y, &q, &r);
+        ASSERT_TRUE(gt256(&y, &r));
+        uint256_t back;
+        mul256(&q, &y, &back);
+        add256(&back, &r, &back);
+        ASSERT_TRUE(equal256(&back, &x)) << i;
+
+        // multiplication against repeated doubling of the 128-bit halves
+        uint256_t product;
+        mul256(&x, &y, &product);
+        uint256_t expected = {};
+        uint256_t shifted;
+        copy256(&shifted, &x);
+        for (uint32_t bit = 0; bit < bits256(&y); bit++) {
+            uint256_t probe;
+            shiftr256(&y, bit, &probe);
+            if (LOWER(LOWER(probe)) & 1) {
+                add256(&expected, &shifted, &expected);
+            }
+            shiftl256(&shifted, 1, &shifted);
+        }
+        ASSERT_TRUE(equal256(&product, &expected)) << i;
+    }
+}
+
+TEST(Uint256, BigEndianLoader) {
+    const uint8_t bytes[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    uint256_t value;
+    ASSERT_EQ(readu256BEBytes(bytes, sizeof(bytes), &value), parser_ok);
+    EXPECT_EQ(LOWER(LOWER(value)), 0x0102030405u);
+    EXPECT_EQ(UPPER(LOWER(value)), 0u);
+    ASSERT_EQ(readu256BEBytes(nullptr, 0, &value), parser_ok);
+    EXPECT_TRUE(zero256(&value));
+
+    std::vector<uint8_t> wide(33, 0xff);
+    EXPECT_EQ(readu256BEBytes(wide.data(), wide.size(), &value), parser_value_out_of_range);
+    ASSERT_EQ(readu256BEBytes(wide.data(), 32, &value), parser_ok);
+    EXPECT_EQ(UPPER(UPPER(value)), UINT64_MAX);
+}
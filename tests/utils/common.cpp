@@ -15,9 +15,13 @@
  ********************************************************************************/
 #include "common.h"
 
+#include <hexutils.h>
+
 #include <sstream>
 #include <string>
 
+#include "parser_impl_evm.h"
+
 std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen) {
     auto answer = std::vector<std::string>();
 
@@ -61,3 +65,26 @@ std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint1
 
     return answer;
 }
+
+std::vector<uint8_t> toBytes(const std::string &hex) {
+    std::vector<uint8_t> buffer(hex.size() / 2);
+    buffer.resize(parseHexString(buffer.data(), buffer.size(), hex.c_str()));
+    return buffer;
+}
+
+std::vector<std::string> reviewItems(const parser_context_t *ctx) {
+    const auto numItems = [ctx](uint8_t *num) { return parser_getNumItems(ctx, num); };
+    const auto item = [ctx](uint8_t idx, char *key, uint16_t keyLen, char *value, uint16_t valueLen, uint8_t page,
+                            uint8_t *pageCount) {
+        return parser_getItem(ctx, idx, key, keyLen, value, valueLen, page, pageCount);
+    };
+    return reviewItems(parser_ok, numItems, item);
+}
+
+std::vector<std::string> reviewItemsEth(const parser_context_t *ctx) {
+    const auto item = [ctx](uint8_t idx, char *key, uint16_t keyLen, char *value, uint16_t valueLen, uint8_t page,
+                            uint8_t *pageCount) {
+        return _getItemEth(ctx, idx, key, keyLen, value, valueLen, page, pageCount);
+    };
+    return reviewItems(parser_ok, _getNumItemsEth, item);
+}
@@ -13,9 +13,40 @@
  *  See the License for the specific language governing permissions and
  *  limitations under the License.
  ********************************************************************************/
+#pragma once
+
 #include <parser.h>
 #include <parser_evm.h>
 
 #include <string>
 #include <vector>
+
+#include "gmock/gmock.h"
+
 std::vector<std::string> dumpUI(parser_context_t *ctx, uint16_t maxKeyLen, uint16_t maxValueLen);
+
+// Bytes of a hex string, up to its first character that is not hex
+std::vector<uint8_t> toBytes(const std::string &hex);
+
+// First page of every item of a review, as "key : value". The getters follow the
+// getNumItems / getItem signatures of the app; every call is expected to return ok.
+template <typename Err, typename NumItemsFn, typename ItemFn>
+std::vector<std::string> reviewItems(Err ok, NumItemsFn getNumItems, ItemFn getItem) {
+    std::vector<std::string> items;
+    uint8_t numItems = 0;
+    EXPECT_EQ(getNumItems(&numItems), ok);
+    for (uint8_t idx = 0; idx < numItems; idx++) {
+        char key[40] = {0};
+        char value[100] = {0};
+        uint8_t pageCount = 0;
+        EXPECT_EQ(getItem(idx, key, sizeof(key), value, sizeof(value), 0, &pageCount), ok);
+        items.push_back(std::string(key) + " : " + value);
+    }
+    return items;
+}
+
+// Review of the Substrate transaction parsed in ctx
+std::vector<std::string> reviewItems(const parser_context_t *ctx);
+
+// Review of the EVM transaction read into eth_tx_obj from ctx
+std::vector<std::string> reviewItemsEth(const parser_context_t *ctx);
@@ -1,4 +1,11 @@
 const Zemu = require('@zondax/zemu')
+const { execSync } = require('child_process')
+
+// Profile mode (tests/profiler.ts): qemu-arm inside Speculos reads QEMU_LOG from
+// its environment, so the emulator image is derived with it. The ELF directory
+// is mounted in the container, which puts the log in ../app/output.
+const PROFILE_LABEL = 'peaq.profile'
+const QEMU_LOG_DIR = process.env.PROFILE_CONTAINER_DIR ?? '/home/zondax/speculos/apps'
 
 const catchExit = async () => {
   process.on('SIGINT', () => {
@@ -8,8 +15,44 @@ const catchExit = async () => {
   })
 }
 
+const emuImage = () => process.env.ZEMU_IMAGE ?? Zemu.DEFAULT_EMU_IMG
+
+const isProfileImage = image => {
+  try {
+    return execSync(`docker image inspect --format '{{ index .Config.Labels "${PROFILE_LABEL}" }}' ${image}`).toString().trim() === '1'
+  } catch {
+    return false
+  }
+}
+
+// The derived image keeps the name zemu starts, drop it before a normal run
+const dropProfileImage = () => {
+  const image = emuImage()
+  if (image !== undefined && isProfileImage(image)) {
+    execSync(`docker rmi ${image}`)
+  }
+}
+
+const buildProfileImage = () => {
+  const image = emuImage()
+  if (image === undefined) {
+    throw new Error('set ZEMU_IMAGE to the emulator image used by zemu')
+  }
+  const dockerfile = [
+    `FROM ${image}`,
+    `LABEL ${PROFILE_LABEL}=1`,
+    `ENV QEMU_LOG=in_asm,exec,nochain QEMU_LOG_FILENAME=${QEMU_LOG_DIR}/qemu-%d.log`,
+  ].join('\n')
+  execSync(`docker build -t ${image} -`, { input: dockerfile, stdio: ['pipe', 'inherit', 'inherit'] })
+}
+
 module.exports = async () => {
+  const profile = process.env.ZEMU_PROFILE === '1'
   await catchExit()
+  dropProfileImage()
   await Zemu.default.checkAndPullImage()
   await Zemu.default.stopAllEmuContainers()
+  if (profile) {
+    buildProfileImage()
+  }
 }
@@ -16,7 +16,7 @@
 
 import Zemu from '@zondax/zemu'
 import { PeaqApp } from '@zondax/ledger-peaq'
-import { ETH_PATH, defaultOptions, models } from './common'
+import { ETH_PATH, defaultOptions, models, recordSession } from './common'
 import { ec } from 'elliptic'
 
 jest.setTimeout(90000)
@@ -39,6 +39,7 @@ describe.each(models)('EIP191', function (m) {
     const sim = new Zemu(m.path)
     try {
       await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
       const app = new PeaqApp(sim.getTransport())
       const msgData = data.message
 
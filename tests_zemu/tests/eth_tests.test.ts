@@ -16,8 +16,25 @@
 
 import Zemu, { ButtonKind, isTouchDevice } from '@zondax/zemu'
 import { PeaqApp } from '@zondax/ledger-peaq'
-import { ETH_PATH, EXPECTED_ETH_ADDRESS, EXPECTED_ETH_PK, defaultOptions, models } from './common'
+import {
+  CLA_ETH,
+  ETH_PATH,
+  EXPECTED_ETH_ADDRESS,
+  EXPECTED_ETH_PK,
+  ERC20_TEST_SIGNER_KEY,
+  INS_GET_ADDR_BATCH_ETH,
+  INS_GET_XPUB_ETH,
+  INS_PROVIDE_ERC20_INFO,
+  INS_SIGN_BATCH_ETH,
+  INS_SIGN_EIP712_ETH,
+  INS_SIGN_ETH,
+  defaultOptions,
+  models,
+  recordSession,
+  serializeEthPath,
+} from './common'
 import { ec } from 'elliptic'
+import { createHash } from 'crypto'
 
 jest.setTimeout(90000)
 
@@ -135,6 +152,7 @@ describe.each(models)('ETHT', function (m) {
     const sim = new Zemu(m.path)
     try {
       await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
       const app = new PeaqApp(sim.getTransport())
 
       const resp = await app.getETHAddress(ETH_PATH, false, true)
@@ -151,6 +169,62 @@ describe.each(models)('ETHT', function (m) {
     }
   })
 
+  test.concurrent('get address batch', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      const app = new PeaqApp(sim.getTransport())
+
+      const start = Buffer.alloc(4)
+      start.writeUInt32BE(0, 0)
+      const payload = Buffer.concat([serializeEthPath("m/44'/60'/0'/0/0"), start, Buffer.from([3])])
+      const resp = await sim.getTransport().send(CLA_ETH, INS_GET_ADDR_BATCH_ETH, 0, 0, payload)
+
+      // 3 packed addresses plus the status word
+      expect(resp.length).toEqual(3 * 20 + 2)
+      expect(resp.readUInt16BE(resp.length - 2)).toEqual(0x9000)
+
+      for (let i = 0; i < 3; i++) {
+        const single = await app.getETHAddress(`m/44'/60'/0'/0/${i}`, false, false)
+        expect('0x' + resp.subarray(i * 20, (i + 1) * 20).toString('hex')).toEqual(single.address)
+      }
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('export account xpub', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({
+        ...defaultOptions,
+        model: m.name,
+        approveKeyword: isTouchDevice(m.name) ? 'Confirm' : '',
+        approveAction: ButtonKind.ApproveTapButton,
+      })
+      recordSession(sim, m.name)
+      const app = new PeaqApp(sim.getTransport())
+      const ACCOUNT_PATH = "m/44'/60'/0'"
+
+      const request = sim.getTransport().send(CLA_ETH, INS_GET_XPUB_ETH, 0, 0, serializeEthPath(ACCOUNT_PATH))
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.compareSnapshotsAndApprove('.', `${m.prefix.toLowerCase()}-export_eth_xpub`)
+
+      const resp = await request
+      // compressed public key (33) + chain code (32) + status word
+      expect(resp.length).toEqual(33 + 32 + 2)
+      expect(resp.readUInt16BE(resp.length - 2)).toEqual(0x9000)
+
+      const account = await app.getETHAddress(ACCOUNT_PATH, false, false)
+      const EC = new ec('secp256k1')
+      const compressed = EC.keyFromPublic(account.publicKey.toString(), 'hex').getPublic(true, 'hex')
+      expect(resp.subarray(0, 33).toString('hex')).toEqual(compressed)
+    } finally {
+      await sim.close()
+    }
+  })
+
   test.concurrent('show address', async function () {
     const sim = new Zemu(m.path)
     try {
@@ -160,6 +234,7 @@ describe.each(models)('ETHT', function (m) {
         approveKeyword: isTouchDevice(m.name) ? 'Confirm' : '',
         approveAction: ButtonKind.ApproveTapButton,
       })
+      recordSession(sim, m.name)
       const app = new PeaqApp(sim.getTransport())
 
       const resp = app.getETHAddress(ETH_PATH, true, true)
@@ -178,6 +253,7 @@ describe.each(models)('ETHT', function (m) {
     const sim = new Zemu(m.path)
     try {
       await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
       const app = new PeaqApp(sim.getTransport())
       const msg = data.op
 
@@ -216,6 +292,7 @@ describe.each(models)('ETHT', function (m) {
     const sim = new Zemu(m.path)
     try {
       await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
       const app = new PeaqApp(sim.getTransport())
       const msg = data.op
 
@@ -252,4 +329,278 @@ describe.each(models)('ETHT', function (m) {
       await sim.close()
     }
   })
+
+  test.concurrent('batch sign transactions', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      await sim.toggleBlindSigning()
+      const transport = sim.getTransport()
+
+      // four EIP-1559 transfers of 1 peaq with consecutive nonces
+      const txs = [0, 1, 2, 3].map(nonce =>
+        Buffer.from(
+          `02e9820d0a${nonce.toString(16).padStart(2, '0')}0102825208941d80c49bbbcd1c0911346656b529df9e5c2f783d880de0b6b3a764000080c0`,
+          'hex',
+        ),
+      )
+      const blob = Buffer.concat(txs)
+
+      // same framing as personal messages: path, total length, then the transactions back to back
+      const length = Buffer.alloc(4)
+      length.writeUInt32BE(blob.length, 0)
+      const payload = Buffer.concat([serializeEthPath(ETH_PATH), length, blob])
+      const chunks = []
+      for (let i = 0; i < payload.length; i += 250) {
+        chunks.push(payload.subarray(i, i + 250))
+      }
+      for (let i = 0; i < chunks.length - 1; i++) {
+        await transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, i === 0 ? 0x00 : 0x80, 0, chunks[i])
+      }
+      const request = transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, chunks.length === 1 ? 0x00 : 0x80, 0, chunks[chunks.length - 1])
+
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.compareSnapshotsAndApprove('.', `${m.prefix.toLowerCase()}-eth-batch_sign`)
+
+      // the approval returns the first three signatures, the last one is fetched
+      const first = await request
+      expect(first.length).toEqual(3 * 65 + 2)
+      expect(first.readUInt16BE(first.length - 2)).toEqual(0x9000)
+      const next = await transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, 0x01, 0, Buffer.from([3]))
+      expect(next.length).toEqual(65 + 2)
+      const signatures = Buffer.concat([first.subarray(0, 3 * 65), next.subarray(0, 65)])
+
+      const EC = new ec('secp256k1')
+      const pubKey = Buffer.from('024f1dd50f180bfd546339e75410b127331469837fa618d950f7cfb8be351b0020', 'hex')
+      txs.forEach((tx, i) => {
+        const sig = signatures.subarray(i * 65, (i + 1) * 65)
+        const signatureOK = EC.verify(sha3.keccak256(tx), { r: sig.subarray(1, 33), s: sig.subarray(33, 65) }, pubKey, 'hex')
+        expect(signatureOK).toEqual(true)
+      })
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('batch sign transactions larger than the message display', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      await sim.toggleBlindSigning()
+      const transport = sim.getTransport()
+
+      // 50 EIP-1559 transfers of 100 bytes each, 5000 bytes: more than the 4096 bytes kept of a personal message
+      const txs = Array.from({ length: 50 }, (_, i) => {
+        const nonce = (i + 1).toString(16).padStart(2, '0')
+        const priorityFee = `9001${'00'.repeat(14)}01`
+        const maxFee = `9002${'00'.repeat(14)}01`
+        const gasLimit = `8810${'00'.repeat(7)}`
+        const value = `9a01${'00'.repeat(24)}${i.toString(16).padStart(2, '0')}`
+        const to = '941d80c49bbbcd1c0911346656b529df9e5c2f783d'
+        return Buffer.from(`02f861820d0a${nonce}${priorityFee}${maxFee}${gasLimit}${to}${value}80c0`, 'hex')
+      })
+      const blob = Buffer.concat(txs)
+      expect(blob.length).toEqual(5000)
+
+      const length = Buffer.alloc(4)
+      length.writeUInt32BE(blob.length, 0)
+      const payload = Buffer.concat([serializeEthPath(ETH_PATH), length, blob])
+      const chunks = []
+      for (let i = 0; i < payload.length; i += 250) {
+        chunks.push(payload.subarray(i, i + 250))
+      }
+      for (let i = 0; i < chunks.length - 1; i++) {
+        await transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, i === 0 ? 0x00 : 0x80, 0, chunks[i])
+      }
+      const request = transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, 0x80, 0, chunks[chunks.length - 1])
+
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.navigateUntilText('.', `${m.prefix.toLowerCase()}-eth-batch_sign_large`, sim.startOptions.approveKeyword, true, false)
+
+      // every transaction of the upload is signed, not a prefix of it
+      const first = await request
+      expect(first.readUInt16BE(first.length - 2)).toEqual(0x9000)
+      let signatures = first.subarray(0, first.length - 2)
+      while (signatures.length < txs.length * 65) {
+        const next = await transport.send(CLA_ETH, INS_SIGN_BATCH_ETH, 0x01, 0, Buffer.from([signatures.length / 65]))
+        expect(next.readUInt16BE(next.length - 2)).toEqual(0x9000)
+        signatures = Buffer.concat([signatures, next.subarray(0, next.length - 2)])
+      }
+      expect(signatures.length).toEqual(txs.length * 65)
+
+      const EC = new ec('secp256k1')
+      const pubKey = Buffer.from('024f1dd50f180bfd546339e75410b127331469837fa618d950f7cfb8be351b0020', 'hex')
+      txs.forEach((tx, i) => {
+        const sig = signatures.subarray(i * 65, (i + 1) * 65)
+        const signatureOK = EC.verify(sha3.keccak256(tx), { r: sig.subarray(1, 33), s: sig.subarray(33, 65) }, pubKey, 'hex')
+        expect(signatureOK).toEqual(true)
+      })
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('sign transaction with compact signature', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      const transport = sim.getTransport()
+      const tx = SIGN_TEST_DATA_CLEARSIGN[0].op
+
+      // P2 = 1 asks for v|r|s only, without the DER copy of r and s
+      const request = transport.send(CLA_ETH, INS_SIGN_ETH, 0x00, 0x01, Buffer.concat([serializeEthPath(ETH_PATH), tx]))
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      // same transaction and review as the clear sign test, so it shares its screens
+      await sim.compareSnapshotsAndApprove('.', `${m.prefix.toLowerCase()}-eth-sign_compact`, true, 0, 15000, false)
+
+      const resp = await request
+      expect(resp.length).toEqual(65 + 2)
+      expect(resp.readUInt16BE(65)).toEqual(0x9000)
+
+      const EC = new ec('secp256k1')
+      const pubKey = Buffer.from('024f1dd50f180bfd546339e75410b127331469837fa618d950f7cfb8be351b0020', 'hex')
+      const signatureOK = EC.verify(sha3.keccak256(tx), { r: resp.subarray(1, 33), s: resp.subarray(33, 65) }, pubKey, 'hex')
+      expect(signatureOK).toEqual(true)
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('sign typed data', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      // the mail contents do not fit in the review
+      await sim.toggleBlindSigning()
+      const transport = sim.getTransport()
+
+      const str = (value: string) => Buffer.concat([Buffer.from([value.length]), Buffer.from(value)])
+      const struct = (name: string, fields: [string, string][]) =>
+        Buffer.concat([str(name), Buffer.from([fields.length]), ...fields.map(([type, field]) => Buffer.concat([str(type), str(field)]))])
+      const send = (p1: number, data: Buffer, p2 = 0) => transport.send(CLA_ETH, INS_SIGN_EIP712_ETH, p1, p2, data)
+
+      // example of the EIP-712 specification
+      await send(0x00, serializeEthPath(ETH_PATH))
+      await send(
+        0x01,
+        struct('EIP712Domain', [
+          ['string', 'name'],
+          ['string', 'version'],
+          ['uint256', 'chainId'],
+          ['address', 'verifyingContract'],
+        ]),
+      )
+      await send(0x01, struct('Person', [['string', 'name'], ['address', 'wallet']]))
+      await send(0x01, struct('Mail', [['Person', 'from'], ['Person', 'to'], ['string', 'contents']]))
+
+      await send(0x02, str('EIP712Domain'))
+      await send(0x04, Buffer.from('Ether Mail'))
+      await send(0x04, Buffer.from('1'))
+      await send(0x04, Buffer.from([1]))
+      await send(0x04, Buffer.from('cccccccccccccccccccccccccccccccccccccccc', 'hex'))
+
+      await send(0x02, str('Mail'))
+      await send(0x04, Buffer.from('Cow'))
+      await send(0x04, Buffer.from('cd2a3d9f938e13cd947ec05abc7fe734df8dd826', 'hex'))
+      await send(0x04, Buffer.from('Bob'))
+      await send(0x04, Buffer.from('bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb', 'hex'))
+      await send(0x04, Buffer.from('Hello, '), 0x01)
+      const request = send(0x04, Buffer.from('Bob!'))
+
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.compareSnapshotsAndApprove('.', `${m.prefix.toLowerCase()}-eth-sign_eip712`)
+
+      const resp = await request
+      expect(resp.readUInt16BE(resp.length - 2)).toEqual(0x9000)
+
+      const EC = new ec('secp256k1')
+      const digest = 'be609aee343fb3c4b28e1df9e632fca64fcfaede20f02e86244efddf30957bd2'
+      const pubKey = Buffer.from('024f1dd50f180bfd546339e75410b127331469837fa618d950f7cfb8be351b0020', 'hex')
+      const signatureOK = EC.verify(digest, { r: resp.subarray(1, 33), s: resp.subarray(33, 65) }, pubKey, 'hex')
+      expect(signatureOK).toEqual(true)
+      // typed data signatures carry v = 27 + parity, whatever was signed before
+      const v = resp[0]
+      expect([27, 28]).toContain(v)
+      const recovered = EC.recoverPubKey(Buffer.from(digest, 'hex'), { r: resp.subarray(1, 33), s: resp.subarray(33, 65) }, v - 27)
+      expect(recovered.encode('hex', true)).toEqual(pubKey.toString('hex'))
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('sign personal message with several paths', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      await sim.toggleBlindSigning()
+      const app = new PeaqApp(sim.getTransport())
+      const paths = [ETH_PATH, "m/44'/60'/0'/0'/6"]
+      const publicKeys = []
+      for (const path of paths) {
+        publicKeys.push((await app.getETHAddress(path, false, false)).publicKey.toString())
+      }
+
+      // a typed transaction first: its v must not leak into the message signatures
+      const tx = Buffer.from('02e9820d0a800102825208941d80c49bbbcd1c0911346656b529df9e5c2f783d880de0b6b3a764000080c0', 'hex')
+      const txRequest = app.signEthTransaction(ETH_PATH, tx)
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.navigateUntilText('.', `${m.prefix.toLowerCase()}-eth-multipath_message_tx`, sim.startOptions.approveKeyword, true, false)
+      await txRequest
+
+      const message = Buffer.from('Hello peaq')
+      const request = app.signPersonalMessageMultiPath(paths, message)
+      await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+      await sim.navigateUntilText('.', `${m.prefix.toLowerCase()}-eth-multipath_message`, sim.startOptions.approveKeyword, true, false)
+      const signatures = await request
+      expect(signatures.length).toEqual(paths.length)
+
+      const EC = new ec('secp256k1')
+      const digest = sha3.keccak256(Buffer.concat([Buffer.from(`\x19Ethereum Signed Message:\n${message.length}`), message]))
+      signatures.forEach((sig, i) => {
+        expect([27, 28]).toContain(sig.v)
+        const recovered = EC.recoverPubKey(Buffer.from(digest, 'hex'), { r: sig.r, s: sig.s }, sig.v - 27)
+        expect(recovered.encode('hex', false)).toEqual(publicKeys[i])
+      })
+    } finally {
+      await sim.close()
+    }
+  })
+
+  test.concurrent('provide erc20 token info', async function () {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      recordSession(sim, m.name)
+      const transport = sim.getTransport()
+
+      // [symbolLen] [symbol] [address] [decimals (4)] [chainId (4)]
+      const descriptor = Buffer.concat([
+        Buffer.from([4]),
+        Buffer.from('USDT'),
+        Buffer.from('1111111111111111111111111111111111111111', 'hex'),
+        Buffer.from('00000006', 'hex'),
+        Buffer.from('00000d0a', 'hex'),
+      ])
+      const EC = new ec('secp256k1')
+      const digest = createHash('sha256').update(descriptor).digest()
+      const signature = Buffer.from(EC.keyFromPrivate(ERC20_TEST_SIGNER_KEY, 'hex').sign(digest).toDER())
+
+      const resp = await transport.send(CLA_ETH, INS_PROVIDE_ERC20_INFO, 0, 0, Buffer.concat([descriptor, signature]))
+      expect(resp.readUInt16BE(resp.length - 2)).toEqual(0x9000)
+
+      // a descriptor altered after signing is refused
+      const forged = Buffer.from(descriptor)
+      forged[forged.length - 5] = 18
+      await expect(
+        transport.send(CLA_ETH, INS_PROVIDE_ERC20_INFO, 0, 0, Buffer.concat([forged, signature])),
+      ).rejects.toHaveProperty('statusCode', 0x6984)
+    } finally {
+      await sim.close()
+    }
+  })
 })
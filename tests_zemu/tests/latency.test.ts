@@ -0,0 +1,273 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Zemu from '@zondax/zemu'
+import { PeaqApp } from '@zondax/ledger-peaq'
+import {
+  CLA_ETH,
+  ETH_PATH,
+  INS_GET_PROFILE_ETH,
+  INS_SIGN_ETH,
+  INS_SIGN_PERSONAL_MESSAGE,
+  defaultOptions,
+  models,
+  serializeEthPath,
+} from './common'
+import { ec } from 'elliptic'
+import { execSync } from 'child_process'
+import { mkdirSync, readFileSync, writeFileSync } from 'fs'
+import { resolve } from 'path'
+
+// Wall-clock latency of chunked signing flows. Slow and timing sensitive, so it
+// only runs when asked for: `yarn latency`
+// One JSON artifact per model is written to LATENCY_OUTPUT (default ./latency),
+// compare two of them with `yarn latency:compare <base.json> <head.json>`.
+const ENABLED = process.env.ZEMU_LATENCY === '1'
+const OUTPUT_DIR = resolve(process.env.LATENCY_OUTPUT ?? 'latency')
+const LATENCY_MODELS = (process.env.LATENCY_MODELS ?? 'nanox,stax').split(',')
+
+jest.setTimeout(600000)
+
+const sha3 = require('js-sha3')
+
+const CHUNK_SIZE = 250
+const EXPECTED_PUBLIC_KEY = '024f1dd50f180bfd546339e75410b127331469837fa618d950f7cfb8be351b0020'
+
+// The upload buffer is 8 KB of RAM, then 16 KB of flash (N_appdata); larger
+// transactions are streamed. Sizes are the calldata lengths.
+const TX_CASES = [
+  { name: 'tx_single_chunk', dataLen: 64 },
+  { name: 'tx_ram_4k', dataLen: 4000 },
+  { name: 'tx_ram_8k', dataLen: 8000 },
+  { name: 'tx_flash_9k', dataLen: 9000 },
+  { name: 'tx_flash_16k', dataLen: 16000 },
+  { name: 'tx_streamed_24k', dataLen: 24000 },
+]
+
+// Large and pathological transactions of tests/evm_scaling.json (tests/gen_evm_scaling.py),
+// the calldata sweep is already covered by TX_CASES
+type ScalingCase = { description: string; family: string; valid: boolean; encoded_tx_hex: string }
+const SCALING_CASES = (JSON.parse(readFileSync(resolve('../tests/evm_scaling.json'), 'utf8')) as ScalingCase[]).filter(
+  c => c.valid && c.family !== 'calldata',
+)
+
+const MSG_CASES = [
+  { name: 'msg_32', len: 32 },
+  { name: 'msg_1k', len: 1024 },
+  { name: 'msg_8k', len: 8000 },
+  { name: 'msg_flash_12k', len: 12000 },
+]
+
+const PROFILE_PHASES = ['ingest', 'parse', 'validate', 'digest', 'sign']
+const STACK_PROBES = ['signEth', 'signEip191', 'getAddrEth']
+
+type Profile = {
+  phases: Record<string, { ticks: number; calls: number }>
+  hashCalls: number
+  hashedBytes: number
+  nvmBytes: number
+  itemsRendered: number
+  stackUsed: Record<string, number>
+}
+
+type CaseResult = {
+  name: string
+  bytes: number
+  chunks: number
+  // sum of the round trips of every chunk but the last one
+  uploadMs: number
+  meanChunkMs: number
+  maxChunkMs: number
+  // last chunk sent until the review is on screen: reassembly, parsing and validation
+  lastChunkToReviewMs: number
+  // first chunk sent until the signature is back, review navigation included
+  timeToSignatureMs: number
+  profile?: Profile
+}
+
+function rlpLength(len: number, offset: number): Buffer {
+  if (len < 56) {
+    return Buffer.from([offset + len])
+  }
+  const hex = len.toString(16)
+  const lenBytes = Buffer.from(hex.length % 2 ? `0${hex}` : hex, 'hex')
+  return Buffer.concat([Buffer.from([offset + 55 + lenBytes.length]), lenBytes])
+}
+
+function rlpBytes(value: Buffer): Buffer {
+  if (value.length === 1 && value[0] < 0x80) {
+    return value
+  }
+  return Buffer.concat([rlpLength(value.length, 0x80), value])
+}
+
+function rlpList(items: Buffer[]): Buffer {
+  const payload = Buffer.concat(items.map(rlpBytes))
+  return Buffer.concat([rlpLength(payload.length, 0xc0), payload])
+}
+
+// Legacy EIP-155 contract call on peaq mainnet; the selector is unknown so it is blind signed
+function legacyTx(dataLen: number): Buffer {
+  const data = Buffer.alloc(dataLen, 0xab)
+  return rlpList([
+    Buffer.from('01', 'hex'),
+    Buffer.from('3b9aca00', 'hex'),
+    Buffer.from('0f4240', 'hex'),
+    Buffer.from('1d80c49bbbcd1c0911346656b529df9e5c2f783d', 'hex'),
+    Buffer.alloc(0),
+    data,
+    Buffer.from('0d0a', 'hex'),
+    Buffer.alloc(0),
+    Buffer.alloc(0),
+  ])
+}
+
+function splitChunks(payload: Buffer): Buffer[] {
+  const chunks = []
+  for (let i = 0; i < payload.length; i += CHUNK_SIZE) {
+    chunks.push(payload.subarray(i, i + CHUNK_SIZE))
+  }
+  return chunks
+}
+
+function elapsedMs(start: bigint): number {
+  return Number(process.hrtime.bigint() - start) / 1e6
+}
+
+function gitCommit(): string {
+  if (process.env.GITHUB_SHA) {
+    return process.env.GITHUB_SHA
+  }
+  try {
+    return execSync('git rev-parse HEAD').toString().trim()
+  } catch {
+    return 'unknown'
+  }
+}
+
+// Uploads the chunks, approves the review and returns the timings and the signature response
+async function timeSigningFlow(sim: Zemu, ins: number, name: string, chunks: Buffer[]) {
+  const transport = sim.getTransport()
+  const rtts = []
+  const start = process.hrtime.bigint()
+  for (let i = 0; i < chunks.length - 1; i++) {
+    const chunkStart = process.hrtime.bigint()
+    await transport.send(CLA_ETH, ins, i === 0 ? 0x00 : 0x80, 0, chunks[i])
+    rtts.push(elapsedMs(chunkStart))
+  }
+
+  const lastStart = process.hrtime.bigint()
+  const request = transport.send(CLA_ETH, ins, chunks.length === 1 ? 0x00 : 0x80, 0, chunks[chunks.length - 1])
+  await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+  const lastChunkToReviewMs = elapsedMs(lastStart)
+
+  await sim.navigateUntilText('.', name, sim.startOptions.approveKeyword, true, false)
+  const response = await request
+  const timeToSignatureMs = elapsedMs(start)
+  await sim.waitUntilScreenIs(sim.getMainMenuSnapshot())
+
+  const uploadMs = rtts.reduce((a, b) => a + b, 0)
+  return {
+    response,
+    timings: {
+      chunks: chunks.length,
+      uploadMs,
+      meanChunkMs: rtts.length > 0 ? uploadMs / rtts.length : 0,
+      maxChunkMs: rtts.length > 0 ? Math.max(...rtts) : 0,
+      lastChunkToReviewMs,
+      timeToSignatureMs,
+    },
+  }
+}
+
+// Counters of APP_TESTING builds (INS_GET_PROFILE_ETH), read and cleared after each case
+async function readProfile(sim: Zemu, testMode: boolean): Promise<Profile | undefined> {
+  if (!testMode) {
+    return undefined
+  }
+  const resp = await sim.getTransport().send(CLA_ETH, INS_GET_PROFILE_ETH, 0x01, 0, Buffer.alloc(0))
+  let offset = 0
+  const u32 = () => {
+    offset += 4
+    return resp.readUInt32BE(offset - 4)
+  }
+  const numPhases = resp.readUInt8(offset++)
+  const phases: Profile['phases'] = {}
+  for (let i = 0; i < numPhases; i++) {
+    phases[PROFILE_PHASES[i] ?? `phase${i}`] = { ticks: u32(), calls: u32() }
+  }
+  const counters = { hashCalls: u32(), hashedBytes: u32(), nvmBytes: u32(), itemsRendered: u32() }
+  const numProbes = resp.readUInt8(offset++)
+  const stackUsed: Profile['stackUsed'] = {}
+  for (let i = 0; i < numProbes; i++) {
+    stackUsed[STACK_PROBES[i] ?? `probe${i}`] = u32()
+  }
+  return { phases, ...counters, stackUsed }
+}
+
+function verify(hash: string, resp: Buffer) {
+  // [v (1)] [r (32)] [s (32)]
+  const signature = { r: resp.subarray(1, 33), s: resp.subarray(33, 65) }
+  expect(new ec('secp256k1').verify(hash, signature, Buffer.from(EXPECTED_PUBLIC_KEY, 'hex'), 'hex')).toEqual(true)
+}
+
+const describeLatency = ENABLED ? describe.each(models.filter(m => LATENCY_MODELS.includes(m.name))) : describe.skip.each(models)
+
+describeLatency('Latency', function (m) {
+  test('chunked signing flows', async function () {
+    const sim = new Zemu(m.path)
+    const results: CaseResult[] = []
+    try {
+      await sim.start({ ...defaultOptions, model: m.name, logging: false })
+      await sim.toggleBlindSigning()
+      const version = await new PeaqApp(sim.getTransport()).getVersion()
+      const testMode = version.testMode === true
+      await readProfile(sim, testMode)
+
+      const path = serializeEthPath(ETH_PATH)
+      for (const c of TX_CASES) {
+        const tx = legacyTx(c.dataLen)
+        const { response, timings } = await timeSigningFlow(sim, INS_SIGN_ETH, c.name, splitChunks(Buffer.concat([path, tx])))
+        verify(sha3.keccak256(tx), response)
+        results.push({ name: c.name, bytes: tx.length, ...timings, profile: await readProfile(sim, testMode) })
+      }
+
+      for (const c of SCALING_CASES) {
+        const tx = Buffer.from(c.encoded_tx_hex, 'hex')
+        const { response, timings } = await timeSigningFlow(sim, INS_SIGN_ETH, c.description, splitChunks(Buffer.concat([path, tx])))
+        verify(sha3.keccak256(tx), response)
+        results.push({ name: c.description, bytes: tx.length, ...timings, profile: await readProfile(sim, testMode) })
+      }
+
+      for (const c of MSG_CASES) {
+        const msg = Buffer.alloc(c.len, 0x61)
+        const length = Buffer.alloc(4)
+        length.writeUInt32BE(msg.length, 0)
+        const chunks = splitChunks(Buffer.concat([path, length, msg]))
+        const { response, timings } = await timeSigningFlow(sim, INS_SIGN_PERSONAL_MESSAGE, c.name, chunks)
+        const prefixed = Buffer.concat([Buffer.from(`\x19Ethereum Signed Message:\n${msg.length}`, 'utf8'), msg])
+        verify(sha3.keccak256(prefixed), response)
+        results.push({ name: c.name, bytes: msg.length, ...timings, profile: await readProfile(sim, testMode) })
+      }
+    } finally {
+      await sim.close()
+    }
+
+    mkdirSync(OUTPUT_DIR, { recursive: true })
+    const artifact = { model: m.name, commit: gitCommit(), date: new Date().toISOString(), chunkSize: CHUNK_SIZE, results }
+    writeFileSync(resolve(OUTPUT_DIR, `${m.name}.json`), `${JSON.stringify(artifact, null, 2)}\n`)
+  })
+})
@@ -0,0 +1,61 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+// Compares two latency artifacts written by latency.test.ts:
+//   yarn latency:compare base/nanox.json head/nanox.json [threshold %]
+// Exits with 1 when the time to signature of a case grew by more than the threshold.
+import { readFileSync } from 'fs'
+
+type Result = { name: string; uploadMs: number; lastChunkToReviewMs: number; timeToSignatureMs: number }
+type Artifact = { model: string; commit: string; results: Result[] }
+
+const [basePath, headPath, thresholdArg] = process.argv.slice(2)
+if (basePath === undefined || headPath === undefined) {
+  console.error('usage: latency_compare <base.json> <head.json> [threshold %]')
+  process.exit(2)
+}
+const threshold = Number(thresholdArg ?? '20')
+
+const load = (path: string): Artifact => JSON.parse(readFileSync(path, 'utf8'))
+const base = load(basePath)
+const head = load(headPath)
+if (base.model !== head.model) {
+  console.error(`artifacts are for different models: ${base.model} / ${head.model}`)
+  process.exit(2)
+}
+
+const delta = (from: number, to: number) => (from === 0 ? 0 : ((to - from) / from) * 100)
+const fmt = (value: number) => `${value >= 0 ? '+' : ''}${value.toFixed(1)}%`
+
+console.log(`${head.model}: ${base.commit.slice(0, 10)} -> ${head.commit.slice(0, 10)}`)
+let regressions = 0
+for (const h of head.results) {
+  const b = base.results.find(r => r.name === h.name)
+  if (b === undefined) {
+    console.log(`${h.name.padEnd(20)} new case`)
+    continue
+  }
+  const total = delta(b.timeToSignatureMs, h.timeToSignatureMs)
+  const regressed = total > threshold
+  regressions += regressed ? 1 : 0
+  console.log(
+    `${h.name.padEnd(20)} upload ${fmt(delta(b.uploadMs, h.uploadMs)).padStart(8)}` +
+      `  review ${fmt(delta(b.lastChunkToReviewMs, h.lastChunkToReviewMs)).padStart(8)}` +
+      `  signature ${fmt(total).padStart(8)} (${b.timeToSignatureMs.toFixed(0)} -> ${h.timeToSignatureMs.toFixed(0)} ms)` +
+      (regressed ? '  REGRESSION' : ''),
+  )
+}
+process.exit(regressions > 0 ? 1 : 0)
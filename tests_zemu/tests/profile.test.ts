@@ -0,0 +1,152 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+import Zemu from '@zondax/zemu'
+import { PeaqApp } from '@zondax/ledger-peaq'
+import { ETH_PATH, PATH, defaultOptions, models } from './common'
+import { FlowMarker, FlowProfile, PROFILE_ENABLED, beginFlow, dropLog, endFlow, folded, loadSymbols } from './profiler'
+import { execSync } from 'child_process'
+import { mkdirSync, writeFileSync } from 'fs'
+import { resolve } from 'path'
+
+// Instruction counts per flow and per app symbol, from the qemu trace of
+// Speculos. Very slow, so it only runs when asked for: `yarn profile`
+// Writes PROFILE_OUTPUT/<model>.folded (flame graph input) and <model>.json,
+// compare two of the latter with `yarn profile:compare <base.json> <head.json>`.
+const OUTPUT_DIR = resolve(process.env.PROFILE_OUTPUT ?? 'profile')
+const PROFILE_MODELS = (process.env.PROFILE_MODELS ?? 'nanox').split(',')
+
+jest.setTimeout(1800000)
+
+type Flow = {
+  name: string
+  blind: boolean
+  run: (sim: Zemu, app: PeaqApp) => Promise<unknown>
+}
+
+async function approve(sim: Zemu, name: string, request: Promise<unknown>) {
+  await sim.waitUntilScreenIsNot(sim.getMainMenuSnapshot())
+  await sim.navigateUntilText('.', name, sim.startOptions.approveKeyword, true, false)
+  await request
+  await sim.waitUntilScreenIs(sim.getMainMenuSnapshot())
+}
+
+// five u32 LE path elements
+function substratePath(path: string): Buffer {
+  const elements = path.replace(/^m\//, '').split('/')
+  const buf = Buffer.alloc(4 * elements.length)
+  elements.forEach((e, i) => buf.writeUInt32LE((parseInt(e, 10) + (e.endsWith("'") ? 0x80000000 : 0)) >>> 0, 4 * i))
+  return buf
+}
+
+const FLOWS: Flow[] = [
+  {
+    name: 'eth_address',
+    blind: false,
+    run: (_sim, app) => app.getETHAddress(ETH_PATH, false, false),
+  },
+  {
+    // EIP-1559 transfer: RLP decoding, u256 formatting, review paging
+    name: 'eth_1559_transfer',
+    blind: true,
+    run: (sim, app) =>
+      approve(
+        sim,
+        'eth_1559_transfer',
+        app.signEVMTransaction(
+          ETH_PATH,
+          Buffer.from(
+            '02f7820d0a8402a8af41843b9aca00850d8c7b50e68303d090944a2962ac08962819a8a17661970e3c0db765565e8817addd0864728ae780c0',
+            'hex',
+          ),
+          null,
+        ),
+      ),
+  },
+  {
+    name: 'eth_erc20_transfer',
+    blind: false,
+    run: (sim, app) =>
+      approve(
+        sim,
+        'eth_erc20_transfer',
+        app.signEVMTransaction(
+          ETH_PATH,
+          Buffer.from(
+            'f86e80856d6e2edc00832dc6c0941d80c49bbbcd1c0911346656b529df9e5c2f783d8203e8b844a9059cbb000000000000000000000000b7784e5ad303d44067d2a6353441b784c226ccaf00000000000000000000000000000000000000000000000000000000075bca00820d0a8080',
+            'hex',
+          ),
+          null,
+        ),
+      ),
+  },
+  {
+    name: 'eth_personal_sign_1k',
+    blind: true,
+    run: (sim, app) => approve(sim, 'eth_personal_sign_1k', app.signPersonalMessage(ETH_PATH, Buffer.alloc(1024, 0x61).toString('hex'))),
+  },
+  {
+    name: 'substrate_address',
+    blind: false,
+    run: sim => sim.getTransport().send(0x61, 0x01, 0x00, 0x00, substratePath(PATH)),
+  },
+]
+
+function gitCommit(): string {
+  if (process.env.GITHUB_SHA) {
+    return process.env.GITHUB_SHA
+  }
+  try {
+    return execSync('git rev-parse HEAD').toString().trim()
+  } catch {
+    return 'unknown'
+  }
+}
+
+const describeProfile = PROFILE_ENABLED ? describe.each(models.filter(m => PROFILE_MODELS.includes(m.name))) : describe.skip.each(models)
+
+describeProfile('Profile', function (m) {
+  test('instruction counts per flow', async function () {
+    const symbols = loadSymbols(m.path)
+    const profiles: FlowProfile[] = []
+
+    // one emulator per flow, so every log holds a single flow
+    for (const flow of FLOWS) {
+      const sim = new Zemu(m.path)
+      let marker: FlowMarker | undefined
+      try {
+        await sim.start({ ...defaultOptions, model: m.name, logging: false })
+        if (flow.blind) {
+          await sim.toggleBlindSigning()
+        }
+        marker = beginFlow()
+        await flow.run(sim, new PeaqApp(sim.getTransport()))
+      } finally {
+        await sim.close()
+      }
+      if (marker !== undefined) {
+        profiles.push(await endFlow(marker, flow.name, symbols))
+        dropLog(marker)
+      }
+    }
+
+    mkdirSync(OUTPUT_DIR, { recursive: true })
+    writeFileSync(resolve(OUTPUT_DIR, `${m.name}.folded`), folded(m.name, profiles))
+    const artifact = { model: m.name, commit: gitCommit(), date: new Date().toISOString(), flows: profiles }
+    writeFileSync(resolve(OUTPUT_DIR, `${m.name}.json`), `${JSON.stringify(artifact, null, 2)}\n`)
+    expect(profiles.every(p => p.instructions > 0)).toBe(true)
+  })
+})
@@ -0,0 +1,70 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+// Compares two profile artifacts written by profile.test.ts:
+//   yarn profile:compare base/nanox.json head/nanox.json [threshold %]
+// Instruction counts do not depend on the host, so the default threshold is
+// tight. Exits with 1 when the count of a flow grew by more than the threshold.
+import { readFileSync } from 'fs'
+
+type Flow = { name: string; instructions: number; symbols: Record<string, number> }
+type Artifact = { model: string; commit: string; flows: Flow[] }
+
+const TOP_SYMBOLS = 5
+
+const [basePath, headPath, thresholdArg] = process.argv.slice(2)
+if (basePath === undefined || headPath === undefined) {
+  console.error('usage: profile_compare <base.json> <head.json> [threshold %]')
+  process.exit(2)
+}
+const threshold = Number(thresholdArg ?? '2')
+
+const load = (path: string): Artifact => JSON.parse(readFileSync(path, 'utf8'))
+const base = load(basePath)
+const head = load(headPath)
+if (base.model !== head.model) {
+  console.error(`artifacts are for different models: ${base.model} / ${head.model}`)
+  process.exit(2)
+}
+
+const delta = (from: number, to: number) => (from === 0 ? 0 : ((to - from) / from) * 100)
+const fmt = (value: number) => `${value >= 0 ? '+' : ''}${value.toFixed(1)}%`
+
+console.log(`${head.model}: ${base.commit.slice(0, 10)} -> ${head.commit.slice(0, 10)}`)
+let regressions = 0
+for (const h of head.flows) {
+  const b = base.flows.find(f => f.name === h.name)
+  if (b === undefined) {
+    console.log(`${h.name.padEnd(24)} new flow`)
+    continue
+  }
+  const total = delta(b.instructions, h.instructions)
+  const regressed = total > threshold
+  regressions += regressed ? 1 : 0
+  console.log(`${h.name.padEnd(24)} ${fmt(total).padStart(8)} (${b.instructions} -> ${h.instructions})` + (regressed ? '  REGRESSION' : ''))
+
+  // symbols that moved the most, to tell where a regression comes from
+  const names = new Set([...Object.keys(b.symbols), ...Object.keys(h.symbols)])
+  const moves = [...names]
+    .map(name => ({ name, diff: (h.symbols[name] ?? 0) - (b.symbols[name] ?? 0) }))
+    .filter(m => m.diff !== 0)
+    .sort((x, y) => Math.abs(y.diff) - Math.abs(x.diff))
+    .slice(0, TOP_SYMBOLS)
+  for (const m of moves) {
+    console.log(`    ${m.name.padEnd(32)} ${m.diff > 0 ? '+' : ''}${m.diff}`)
+  }
+}
+process.exit(regressions > 0 ? 1 : 0)
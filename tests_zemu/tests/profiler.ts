@@ -0,0 +1,166 @@
+/** ******************************************************************************
+ *  (c) 2018 - 2024 Zondax AG
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************* */
+
+// Instruction counts of Speculos flows, attributed to app symbols.
+//
+// Speculos runs the app under qemu-arm, which logs every translated block
+// (in_asm) and every block execution (exec,nochain) when QEMU_LOG is set in its
+// environment. In profile mode globalsetup.js derives the emulator image with
+// that environment, so the log lands next to the ELF (../app/output). A flow is
+// the part of the log written between beginFlow() and endFlow(): executions are
+// counted there, while translations are read from the whole log since blocks
+// are often translated before the flow starts.
+import { execFileSync } from 'child_process'
+import { createReadStream, existsSync, readdirSync, statSync, unlinkSync } from 'fs'
+import { createInterface } from 'readline'
+import { resolve } from 'path'
+
+export const PROFILE_ENABLED = process.env.ZEMU_PROFILE === '1'
+export const PROFILE_LOG_DIR = resolve(process.env.PROFILE_LOG_DIR ?? '../app/output')
+// where Speculos maps the app code when it is not run at its link address
+const LOAD_BASE = parseInt(process.env.PROFILE_LOAD_BASE ?? '0x40000000', 16)
+const OUTSIDE_APP = '[speculos]'
+
+type ElfSymbol = { address: number; size: number; name: string }
+
+export type FlowProfile = {
+  name: string
+  instructions: number
+  blocks: number
+  symbols: Record<string, number>
+}
+
+export type FlowMarker = { log: string; offset: number }
+
+function newestLog(): string | undefined {
+  if (!existsSync(PROFILE_LOG_DIR)) {
+    return undefined
+  }
+  const logs = readdirSync(PROFILE_LOG_DIR)
+    .filter(f => /^qemu-\d+\.log$/.test(f))
+    .map(f => resolve(PROFILE_LOG_DIR, f))
+    .sort((a, b) => statSync(b).mtimeMs - statSync(a).mtimeMs)
+  return logs[0]
+}
+
+/** Call once the emulator is up and on the main menu */
+export function beginFlow(): FlowMarker {
+  const log = newestLog()
+  if (log === undefined) {
+    throw new Error(`no qemu log in ${PROFILE_LOG_DIR}, was the profile image built by globalsetup?`)
+  }
+  return { log, offset: statSync(log).size }
+}
+
+/** Function symbols of the ELF, sorted by address */
+export function loadSymbols(elf: string): ElfSymbol[] {
+  const nm = process.env.NM ?? 'arm-none-eabi-nm'
+  const out = execFileSync(nm, ['--defined-only', '-S', '-n', elf], { maxBuffer: 64 * 1024 * 1024 }).toString()
+  const symbols: ElfSymbol[] = []
+  for (const line of out.split('\n')) {
+    const m = /^([0-9a-f]+) ([0-9a-f]+) [tTwW] (\S+)$/.exec(line)
+    if (m) {
+      // thumb bit is not part of the address
+      symbols.push({ address: parseInt(m[1], 16) & ~1, size: parseInt(m[2], 16), name: m[3] })
+    }
+  }
+  return symbols
+}
+
+function lookup(symbols: ElfSymbol[], pc: number): string | undefined {
+  let lo = 0
+  let hi = symbols.length - 1
+  while (lo <= hi) {
+    const mid = (lo + hi) >> 1
+    if (symbols[mid].address <= pc) {
+      lo = mid + 1
+    } else {
+      hi = mid - 1
+    }
+  }
+  const s = symbols[hi]
+  return s !== undefined && pc < s.address + Math.max(s.size, 2) ? s.name : undefined
+}
+
+/** Reads the flow part of the log and attributes executed instructions to symbols */
+export async function endFlow(marker: FlowMarker, name: string, symbols: ElfSymbol[]): Promise<FlowProfile> {
+  // block start -> instructions, from the latest translation
+  const blockSize = new Map<number, number>()
+  const executions = new Map<number, number>()
+  let position = 0
+  let current: number | undefined
+
+  const lines = createInterface({ input: createReadStream(marker.log), crlfDelay: Infinity })
+  for await (const line of lines) {
+    position += line.length + 1
+    if (line.startsWith('IN:')) {
+      current = undefined
+      continue
+    }
+    const insn = /^0x([0-9a-f]+):\s/.exec(line)
+    if (insn) {
+      const pc = parseInt(insn[1], 16)
+      if (current === undefined) {
+        current = pc
+        blockSize.set(pc, 0)
+      }
+      blockSize.set(current, (blockSize.get(current) ?? 0) + 1)
+      continue
+    }
+    current = undefined
+    if (position <= marker.offset) {
+      continue
+    }
+    // "Trace 0: 0x7f.. [00000000/c0de1234/00000000/ff200000] ..." or "Trace 0x.. [c0de1234] ..."
+    const exec = /^Trace (?:\d+: )?0x[0-9a-f]+ \[(?:[0-9a-f]+\/)?([0-9a-f]+)/.exec(line)
+    if (exec) {
+      const pc = parseInt(exec[1], 16)
+      executions.set(pc, (executions.get(pc) ?? 0) + 1)
+    }
+  }
+
+  // the app either runs at its link address or is mapped at LOAD_BASE
+  const textStart = symbols.length > 0 ? symbols[0].address : 0
+  const relocate = (pc: number) => (lookup(symbols, pc) !== undefined ? pc : pc - LOAD_BASE + textStart)
+
+  const profile: FlowProfile = { name, instructions: 0, blocks: 0, symbols: {} }
+  for (const [pc, count] of executions) {
+    const instructions = count * (blockSize.get(pc) ?? 1)
+    const symbol = lookup(symbols, relocate(pc)) ?? OUTSIDE_APP
+    profile.symbols[symbol] = (profile.symbols[symbol] ?? 0) + instructions
+    profile.instructions += instructions
+    profile.blocks += count
+  }
+  return profile
+}
+
+/** Collapsed stacks (flamegraph.pl, speedscope, inferno): "model;flow;symbol count" */
+export function folded(model: string, profiles: FlowProfile[]): string {
+  const lines = []
+  for (const p of profiles) {
+    for (const [symbol, count] of Object.entries(p.symbols).sort((a, b) => b[1] - a[1])) {
+      lines.push(`${model};${p.name};${symbol} ${count}`)
+    }
+  }
+  return `${lines.join('\n')}\n`
+}
+
+/** qemu truncates the log when the next emulator opens it, remove it so flows never mix */
+export function dropLog(marker: FlowMarker) {
+  if (existsSync(marker.log)) {
+    unlinkSync(marker.log)
+  }
+}
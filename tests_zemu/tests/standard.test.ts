@@ -16,7 +16,7 @@
 
 import Zemu, { zondaxMainmenuNavigation } from '@zondax/zemu'
 import { PeaqApp } from '@zondax/ledger-peaq'
-import { defaultOptions, models } from './common'
+import { CLA_ETH, defaultOptions, INS_GET_CAPABILITIES, models } from './common'
 
 // @ts-expect-error
 import ed25519 from 'ed25519-supercop'
@@ -67,4 +67,24 @@ describe('Standard', function () {
       await sim.close()
     }
   })
+
+  test.concurrent.each(models)('get capabilities', async function (m) {
+    const sim = new Zemu(m.path)
+    try {
+      await sim.start({ ...defaultOptions, model: m.name })
+      const resp = await sim.getTransport().send(CLA_ETH, INS_GET_CAPABILITIES, 0, 0, Buffer.alloc(0))
+
+      // 21 bytes of capabilities followed by the return code
+      expect(resp.length).toEqual(23)
+      expect(resp.readUInt16BE(21)).toEqual(0x9000)
+      expect(resp[0]).toEqual(1)
+      expect(resp.readUInt32BE(1)).toBeGreaterThan(0)
+      expect(resp.readUInt32BE(5)).toBeGreaterThanOrEqual(resp.readUInt32BE(1))
+      expect(resp[9]).toBeGreaterThan(0)
+      // streaming, batching, caching and Substrate signing are always compiled in
+      expect(resp.readUInt32BE(10) & 0xff).toEqual(0xff)
+    } finally {
+      await sim.close()
+    }
+  })
 })